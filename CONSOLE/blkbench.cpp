@@ -0,0 +1,308 @@
+/*
+    SimWindows - 1D Semiconductor Device Simulator
+    Copyright (C) 2013 David W. Winston
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "comincl.h"
+#include <stdio.h>
+#include <time.h>
+#include "simblock.h"
+
+/*************************************************************************
+
+SimWindows block solver benchmark - times the factorization and solve of
+random diagonally dominant block tridiagonal systems with block_factor<V>
+and block_solve<V> against the general elimination loops they replaced.
+It is built like the batch driver, e.g.
+
+	g++ -O2 -DNDEBUG -INUMERIC/INCLUDE -IFormulc CONSOLE/blkbench.cpp
+		CONSOLE/ciofunc.cpp NUMERIC/[0-9a-z]*.cpp -x c++ Formulc/formulc.c
+		-o blkbench -lpthread
+
+Usage:
+	blkbench [repetitions]
+
+Each system with 1, 3 and 4 unknowns per node and 1000, 10000 and 100000
+nodes is solved repetitions*100000/nodes times by each routine, 20 by
+default. The time of one factorization and solve, the speedup and the
+largest difference between the two solutions are printed. Both routines
+eliminate in the same order, so the difference is expected to be zero.
+
+Exit status is 0 if the solutions agree and 1 if they do not.
+
+**************************************************************************/
+
+//********************************* Global Variables *******************************************
+
+#include "strtable.h"
+
+TPreferences preferences;
+
+logical quiet_output=TRUE;
+
+//********************************** Benchmark functions ***************************************
+
+/*
+	The general elimination loops used before block_factor<V> and block_solve<V>, working on
+	row pointers. Up to BLOCK_BENCH_VARIABLES unknowns per node.
+*/
+#define BLOCK_BENCH_VARIABLES	4
+
+void general_factor(prec **jacobian, int variables, int unknown_nodes)
+{
+	int i,k,l,m;
+	prec **current_row_ptr;
+	prec *diagonal_ptr;
+	prec **reduce_row_ptr;
+	prec *reduce_element_ptr;
+
+	current_row_ptr=jacobian;
+
+	for (i=0;i<unknown_nodes;i++) {
+
+		for (l=0;l<variables;l++) {
+			diagonal_ptr=*(current_row_ptr)+variables+l;
+			reduce_row_ptr=current_row_ptr+1;
+
+			for (k=l+1;k<variables;k++) {
+				reduce_element_ptr=*(reduce_row_ptr)+variables+l;
+
+				*reduce_element_ptr/=(*(diagonal_ptr));
+
+				for(m=1;m<variables-l;m++) {
+					*(reduce_element_ptr+m)-=(*(reduce_element_ptr))*(*(diagonal_ptr+m));
+				}
+
+				if (i!=unknown_nodes-1) {
+					for(m=0;m<variables;m++) {
+						*(reduce_element_ptr+variables-l+m)-=
+							(*(reduce_element_ptr))*(*(diagonal_ptr+variables-l+m));
+					}
+				}
+				reduce_row_ptr++;
+			}
+
+			if (i!=unknown_nodes-1) {
+
+				for (k=0;k<variables;k++) {
+					reduce_element_ptr=*(reduce_row_ptr)+l;
+
+					*(reduce_element_ptr)/=(*(diagonal_ptr));
+
+					for(m=1;m<variables-l;m++) {
+						*(reduce_element_ptr+m)-=(*(reduce_element_ptr))*(*(diagonal_ptr+m));
+					}
+
+					for(m=0;m<variables;m++) {
+						*(reduce_element_ptr+variables-l+m)-=
+							(*(reduce_element_ptr))*(*(diagonal_ptr+variables-l+m));
+					}
+					reduce_row_ptr++;
+				}
+			}
+			current_row_ptr++;
+		}
+	}
+}
+
+void general_solve(prec **jacobian, prec **solution, int variables, int unknown_nodes)
+{
+	int i,k,l;
+	prec** jacobian_ptr;
+	prec *diagonal_ptr;
+	prec *solution_ptr[BLOCK_BENCH_VARIABLES];
+
+//	Forward Solve
+
+	jacobian_ptr=jacobian;
+	for (k=0;k<variables;k++) solution_ptr[k]=solution[k];
+
+	for (i=1;i<=unknown_nodes;i++) {
+		for (k=0;k<variables;k++) {
+			diagonal_ptr=*(jacobian_ptr)+variables+k;
+
+			if (i!=1) {
+				for (l=-variables-k;l<=-1-k;l++)
+					*(solution_ptr[k])-=*(diagonal_ptr+l)*(*(solution_ptr[l+k+variables]-1));
+			}
+
+			for (l=-k;l<=-1;l++)
+				*(solution_ptr[k])-=*(diagonal_ptr+l)*(*(solution_ptr[k+l]));
+
+			jacobian_ptr++;
+		}
+		for (k=0;k<variables;k++) solution_ptr[k]++;
+	}
+
+//	Backward Solve
+
+	jacobian_ptr=jacobian+variables*unknown_nodes-1;
+	for (k=0;k<variables;k++) solution_ptr[k]=solution[k]+unknown_nodes-1;
+
+	for (i=unknown_nodes;i>=1;i--) {
+		for (k=0;k<variables;k++) {
+			diagonal_ptr=*(jacobian_ptr)+2*variables-(k+1);
+
+			if (i!=unknown_nodes) {
+				for (l=variables+k;l>=1+k;l--)
+					*(solution_ptr[variables-1-k])-=*(diagonal_ptr+l)*(*(solution_ptr[l-k-1]+1));
+			}
+
+			for (l=k;l>=1;l--)
+				*(solution_ptr[variables-1-k])-=*(diagonal_ptr+l)*(*(solution_ptr[variables-1-k+l]));
+
+			*(solution_ptr[variables-1-k])/=*(diagonal_ptr);
+
+			jacobian_ptr--;
+		}
+		for (k=0;k<variables;k++) solution_ptr[k]--;
+	}
+}
+
+void block_factor_solve(prec *jacobian, prec **solution, int variables, int unknown_nodes)
+{
+	switch(variables) {
+		case 1:
+			block_factor<1>(jacobian,unknown_nodes);
+			block_solve<1>(jacobian,solution,unknown_nodes);
+			break;
+		case 3:
+			block_factor<3>(jacobian,unknown_nodes);
+			block_solve<3>(jacobian,solution,unknown_nodes);
+			break;
+		case 4:
+			block_factor<4>(jacobian,unknown_nodes);
+			block_solve<4>(jacobian,solution,unknown_nodes);
+			break;
+		default: break;
+	}
+}
+
+/*
+	Fills the rows of a system with random values between -0.5 and 0.5 and adds 4*variables
+	to the diagonal. The couplings of the first and the last node to nodes outside the system
+	are left in place since neither routine reads them.
+*/
+void fill_system(prec *jacobian, prec *rhs, int variables, int unknown_nodes)
+{
+	int i, row, column, rows;
+
+	rows=variables*unknown_nodes;
+	srand(1);
+	for (row=0;row<rows;row++) {
+		for (column=0;column<3*variables;column++) {
+			jacobian[row*3*variables+column]=(prec)rand()/(prec)RAND_MAX-0.5;
+			if (column==variables+row%variables) jacobian[row*3*variables+column]+=4.0*variables;
+		}
+	}
+	for (i=0;i<rows;i++) rhs[i]=(prec)rand()/(prec)RAND_MAX;
+}
+
+/*
+	Times repetitions factorizations and solves of one system with each routine. Returns the
+	largest difference between the two solutions.
+*/
+prec run_benchmark(int variables, int unknown_nodes, int repetitions)
+{
+	int i, k, rows, values;
+	clock_t start;
+	clock_t general_time=0, block_time=0;
+	prec difference, max_difference=0.0;
+	prec *original, *rhs, *general_solution, *block_solution;
+	prec **rows_ptr;
+	prec *general_column[BLOCK_BENCH_VARIABLES], *block_column[BLOCK_BENCH_VARIABLES];
+	TBlockJacobian jacobian;
+	BlockJacobianView view;
+
+	rows=variables*unknown_nodes;
+	values=3*variables*rows;
+	original=new prec[values];
+	rhs=new prec[rows];
+	general_solution=new prec[rows];
+	block_solution=new prec[rows];
+	rows_ptr=new prec*[rows];
+	jacobian.allocate(values);
+	view=jacobian.get_view(variables);
+
+	fill_system(original,rhs,variables,unknown_nodes);
+	for (i=0;i<rows;i++) rows_ptr[i]=view.get_row(i);
+	for (k=0;k<variables;k++) {
+		general_column[k]=general_solution+k*unknown_nodes;
+		block_column[k]=block_solution+k*unknown_nodes;
+	}
+
+	for (i=0;i<repetitions;i++) {
+		memcpy(view.data,original,values*sizeof(prec));
+		memcpy(general_solution,rhs,rows*sizeof(prec));
+		start=clock();
+		general_factor(rows_ptr,variables,unknown_nodes);
+		general_solve(rows_ptr,general_column,variables,unknown_nodes);
+		general_time+=clock()-start;
+
+		memcpy(view.data,original,values*sizeof(prec));
+		memcpy(block_solution,rhs,rows*sizeof(prec));
+		start=clock();
+		block_factor_solve(view.data,block_column,variables,unknown_nodes);
+		block_time+=clock()-start;
+	}
+
+	for (i=0;i<rows;i++) {
+		difference=fabs(general_solution[i]-block_solution[i]);
+		if (difference>max_difference) max_difference=difference;
+	}
+
+	if (!block_time) block_time=1;
+	printf("%d\t\t%d\t\t%.1lf\t\t%.1lf\t\t%.2lf\t%.3le\n",variables,unknown_nodes,
+		   1e6*(double)general_time/CLOCKS_PER_SEC/repetitions,
+		   1e6*(double)block_time/CLOCKS_PER_SEC/repetitions,
+		   (double)general_time/(double)block_time,max_difference);
+	fflush(stdout);
+
+	delete[] original;
+	delete[] rhs;
+	delete[] general_solution;
+	delete[] block_solution;
+	delete[] rows_ptr;
+	return(max_difference);
+}
+
+//*************************************** Main program *****************************************
+
+int main(int argc, char *argv[])
+{
+	int i, j, repetitions, base_repetitions=20;
+	int variables[]= { 1, 3, 4 };
+	int nodes[]= { 1000, 10000, 100000 };
+	logical agree=TRUE;
+
+	if (argc>1) base_repetitions=atoi(argv[1]);
+	if (base_repetitions<1) base_repetitions=1;
+
+	printf("Unknowns\tNodes\t\tGeneral (us)\tBlock (us)\tSpeedup\tMax difference\n");
+	for (i=0;i<3;i++) {
+		for (j=0;j<3;j++) {
+			repetitions=(int)(((long)base_repetitions*100000L)/nodes[j]);
+			if (repetitions<1) repetitions=1;
+			if (run_benchmark(variables[i],nodes[j],repetitions)!=0.0) agree=FALSE;
+		}
+	}
+
+	if (!agree) {
+		printf("The block and general solutions differ\n");
+		return(1);
+	}
+	return(0);
+}
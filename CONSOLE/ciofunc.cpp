@@ -0,0 +1,134 @@
+/*
+    SimWindows - 1D Semiconductor Device Simulator
+    Copyright (C) 2013 David W. Winston
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "comincl.h"
+#include <stdio.h>
+
+/*************************************************************************
+
+Output functions for the console batch driver. Status goes to stdout,
+errors go to stderr. Convergence output is suppressed in quiet mode.
+
+**************************************************************************/
+
+extern logical quiet_output;
+
+/********************************** device output functions ***********************************/
+
+void out_error_message(logical clear_error)
+{
+	TErrorHandler& error_handler=current_context->error_handler;
+	string error_string;
+
+	error_string=error_handler.get_error_string();
+	fprintf(stderr,"Error: %s\n",error_string.c_str());
+#ifndef NDEBUG
+	fprintf(stderr,"Error code: %d File: %s Line: %d\n",(int)error_handler.get_error_number(),
+			error_handler.get_source_file().c_str(),error_handler.get_line_number());
+#endif
+	if (clear_error) error_handler.clear();
+}
+
+void out_elect_convergence(short iterations, FundamentalParam error)
+{
+	if (quiet_output) return;
+
+	if (iterations==1) printf("Electrical Convergence Values\n");
+	if (error.eta_c || error.eta_v)
+		printf("%d\tEta c = %.4le\t\tPsi = %.4le\t\tEta v = %.4le\n",
+			   iterations,error.eta_c,error.psi,error.eta_v);
+	else
+		printf("%d\tPsi = %.4le\n",iterations,error.psi);
+}
+
+void out_optic_convergence(short iterations, prec error)
+{
+	if (quiet_output) return;
+
+	printf("Photon Convergence Values\n");
+	printf("%d\tS = %.4le\n",iterations,error);
+}
+
+void out_therm_convergence(short iterations, prec error)
+{
+	if (quiet_output) return;
+
+	if (iterations==1) printf("Thermal Convergence Values\n");
+	printf("%d\tT = %.4le\n",iterations,error);
+}
+
+void out_outer_therm_convergence(short iterations, prec error)
+{
+	if (quiet_output) return;
+
+	printf("Outer Thermal Convergence Values\n");
+	printf("%d\tT = %.4le\n",iterations,error);
+}
+
+void out_tunnel_evaluations(long evaluations)
+{
+	if (quiet_output) return;
+
+	printf("Tunneling Transmission Evaluations\n");
+	printf("%ld\n",evaluations);
+}
+
+void out_coarse_mode_convergence(short iterations, prec error)
+{
+	if (quiet_output) return;
+
+	if (iterations==1) printf("Coarse Laser Mode Search\n");
+	printf("%d\tLambda = %.4le\n",iterations,error);
+}
+
+void out_fine_mode_convergence(short iterations, prec error)
+{
+	if (quiet_output) return;
+
+	if (iterations==1) printf("Fine Laser Mode Search\n");
+	printf("%d\tLambda = %.4le\n",iterations,error);
+}
+
+void out_operating_condition(void)
+{
+	TEnvironment& environment=current_context->environment;
+	printf("Bias: Left Contact=%.3lf V Right Contact=%.3lf V\n",
+		   environment.get_value(CONTACT,APPLIED_BIAS,0),
+		   environment.get_value(CONTACT,APPLIED_BIAS,1));
+	printf("Temp: Left Surface=%.3lf K Right Surface=%.3lf K\n",
+		   environment.get_value(SURFACE,TEMPERATURE,0),
+		   environment.get_value(SURFACE,TEMPERATURE,1));
+	fflush(stdout);
+}
+
+void out_simulation_result(void)
+{
+	string result_string;
+	TEnvironment& environment=current_context->environment;
+
+	result_string="Current solution: "+get_solve_string((SolveType)environment.get_value(DEVICE,CURRENT_SOLUTION));
+	printf("%s\n",result_string.c_str());
+	result_string="Current status: "+get_status_string((StatusType)environment.get_value(DEVICE,CURRENT_STATUS));
+	printf("%s\n",result_string.c_str());
+	fflush(stdout);
+}
+
+void out_message(string message)
+{
+	printf("%s\n",message.c_str());
+}
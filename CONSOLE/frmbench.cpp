@@ -0,0 +1,198 @@
+/*
+    SimWindows - 1D Semiconductor Device Simulator
+    Copyright (C) 2013 David W. Winston
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "comincl.h"
+#include <stdio.h>
+#include <time.h>
+
+/*************************************************************************
+
+SimWindows fermi integral benchmark - times the array forms of
+fermi_integral_minus_1_half(), fermi_integral_1_half() and
+fermi_integral_3_half() against a loop over the single value functions and
+checks that they agree. It is built like the batch driver, e.g.
+
+	g++ -O2 -DNDEBUG -INUMERIC/INCLUDE -IFormulc CONSOLE/frmbench.cpp
+		CONSOLE/ciofunc.cpp NUMERIC/[0-9a-z]*.cpp -x c++ Formulc/formulc.c
+		-o frmbench -lpthread
+
+Usage:
+	frmbench [repetitions]
+
+The width of the vector kernel chosen for the processor is printed first,
+1 when the array forms use the scalar loop. FERMI_BENCH_VALUES Planck
+potentials between -40 and 40 are then taken repetitions times, 200 by
+default, in blocks of FERMI_BATCH_NODES as the grid passes do. The time
+per value of each form and the speedup are printed. The forms are
+compared at those values, at the ends of the exponential range, at the
+points where the approximations have |x-c|=0 and at random values
+between -800 and 800, and the largest relative difference with the
+argument where it occurs is printed.
+
+Exit status is 0 if the largest difference is below
+FERMI_BENCH_TOLERANCE and 1 otherwise.
+
+**************************************************************************/
+
+//********************************* Global Variables *******************************************
+
+#include "strtable.h"
+
+TPreferences preferences;
+
+logical quiet_output=TRUE;
+
+//********************************** Benchmark functions ***************************************
+
+#define FERMI_BENCH_VALUES		100000
+#define FERMI_BENCH_RANDOM		200000
+#define FERMI_BENCH_TOLERANCE	1e-13
+
+typedef prec (*ScalarFermi)(TSimulationContext *, prec);
+typedef void (*ArrayFermi)(TSimulationContext *, const prec *, prec *, int);
+
+struct FermiDifference {
+	prec max_difference;
+	prec max_x;
+};
+
+void add_difference(FermiDifference& difference, prec array_value, prec scalar_value, prec x)
+{
+	prec relative;
+
+	if (scalar_value==0.0) relative=fabs(array_value);
+	else relative=fabs((array_value-scalar_value)/scalar_value);
+	if (relative>difference.max_difference) {
+		difference.max_difference=relative;
+		difference.max_x=x;
+	}
+}
+
+void array_blocks(ArrayFermi array_function, const prec *x, prec *result, int count)
+{
+	int i;
+
+	for (i=0;i<count;i+=FERMI_BATCH_NODES) {
+		if (count-i<FERMI_BATCH_NODES) array_function(current_context,x+i,result+i,count-i);
+		else array_function(current_context,x+i,result+i,FERMI_BATCH_NODES);
+	}
+}
+
+/*
+	Compares the two forms at count values. The array form is called in blocks of
+	FERMI_BATCH_NODES and on each value alone, so a tail shorter than a vector is covered.
+*/
+void compare_forms(ScalarFermi scalar_function, ArrayFermi array_function, const prec *x, int count,
+				   FermiDifference& difference)
+{
+	int i;
+	prec single_value;
+	prec *result;
+
+	result=new prec[count];
+	array_blocks(array_function,x,result,count);
+	for (i=0;i<count;i++) {
+		add_difference(difference,result[i],scalar_function(current_context,x[i]),x[i]);
+		array_function(current_context,x+i,&single_value,1);
+		if (single_value!=result[i]) add_difference(difference,1.0,0.0,x[i]);
+	}
+	delete[] result;
+}
+
+/*
+	Times both forms on the benchmark values and returns the largest relative difference over
+	those, the edge points and the random points.
+*/
+prec run_benchmark(const char *name, ScalarFermi scalar_function, ArrayFermi array_function,
+				   int repetitions)
+{
+	int i, j;
+	clock_t start, scalar_time, array_time;
+	prec *x, *scalar_result, *array_result;
+	prec edge_x[]= { -800.0, -745.2, -709.8, -709.7, -100.0, -1.0, 0.0, 1e-300, 1.495, 2.105, 2.715,
+					 1.495+1e-12, 2.105-1e-12, 2.715+1e-12, 1.0, 100.0, 708.0, 709.8, 745.1, 745.2,
+					 800.0 };
+	FermiDifference difference;
+
+	x=new prec[FERMI_BENCH_RANDOM];
+	scalar_result=new prec[FERMI_BENCH_VALUES];
+	array_result=new prec[FERMI_BENCH_VALUES];
+	for (i=0;i<FERMI_BENCH_VALUES;i++) x[i]=-40.0+80.0*(prec)i/(prec)(FERMI_BENCH_VALUES-1);
+
+	start=clock();
+	for (j=0;j<repetitions;j++) {
+		for (i=0;i<FERMI_BENCH_VALUES;i++) scalar_result[i]=scalar_function(current_context,x[i]);
+	}
+	scalar_time=clock()-start;
+
+	start=clock();
+	for (j=0;j<repetitions;j++) array_blocks(array_function,x,array_result,FERMI_BENCH_VALUES);
+	array_time=clock()-start;
+	if (!array_time) array_time=1;
+
+	difference.max_difference=0.0;
+	difference.max_x=0.0;
+	compare_forms(scalar_function,array_function,x,FERMI_BENCH_VALUES,difference);
+	compare_forms(scalar_function,array_function,edge_x,sizeof(edge_x)/sizeof(prec),difference);
+	srand(1);
+	for (i=0;i<FERMI_BENCH_RANDOM;i++) x[i]=1600.0*(prec)rand()/(prec)RAND_MAX-800.0;
+	compare_forms(scalar_function,array_function,x,FERMI_BENCH_RANDOM,difference);
+
+	printf("%s\t%.2lf\t\t%.2lf\t\t%.2lf\t%.3le at x=%.6lf\n",name,
+		   1e9*(double)scalar_time/CLOCKS_PER_SEC/repetitions/FERMI_BENCH_VALUES,
+		   1e9*(double)array_time/CLOCKS_PER_SEC/repetitions/FERMI_BENCH_VALUES,
+		   (double)scalar_time/(double)array_time,difference.max_difference,difference.max_x);
+	fflush(stdout);
+
+	delete[] x;
+	delete[] scalar_result;
+	delete[] array_result;
+	return(difference.max_difference);
+}
+
+//*************************************** Main program *****************************************
+
+int main(int argc, char *argv[])
+{
+	int repetitions=200;
+	logical agree=TRUE;
+	ScalarFermi minus_1_half=fermi_integral_minus_1_half;
+	ScalarFermi one_half=fermi_integral_1_half;
+	ScalarFermi three_half=fermi_integral_3_half;
+	ArrayFermi array_minus_1_half=fermi_integral_minus_1_half;
+	ArrayFermi array_one_half=fermi_integral_1_half;
+	ArrayFermi array_three_half=fermi_integral_3_half;
+
+	if (argc>1) repetitions=atoi(argv[1]);
+	if (repetitions<1) repetitions=1;
+
+	printf("Kernel width: %d\n",fermi_vector_width());
+	printf("Integral\tScalar (ns)\tArray (ns)\tSpeedup\tMax relative difference\n");
+	if (run_benchmark("F_-1/2",minus_1_half,array_minus_1_half,repetitions)>FERMI_BENCH_TOLERANCE)
+		agree=FALSE;
+	if (run_benchmark("F_1/2",one_half,array_one_half,repetitions)>FERMI_BENCH_TOLERANCE)
+		agree=FALSE;
+	if (run_benchmark("F_3/2",three_half,array_three_half,repetitions)>FERMI_BENCH_TOLERANCE)
+		agree=FALSE;
+
+	if (!agree) {
+		printf("The array and single value forms differ\n");
+		return(1);
+	}
+	return(0);
+}
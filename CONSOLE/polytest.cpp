@@ -0,0 +1,222 @@
+/*
+    SimWindows - 1D Semiconductor Device Simulator
+    Copyright (C) 2013 David W. Winston
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "comincl.h"
+#include <stdio.h>
+
+/*************************************************************************
+
+SimWindows polylogarithm accuracy test - compares dilog() and trilog() and
+the power series they replaced with a long double reference. It is built
+like the batch driver, e.g.
+
+	g++ -O2 -DNDEBUG -INUMERIC/INCLUDE -IFormulc CONSOLE/polytest.cpp
+		CONSOLE/ciofunc.cpp NUMERIC/[0-9a-z]*.cpp -x c++ Formulc/formulc.c
+		-o polytest -lpthread
+
+Usage:
+	polytest [points]
+
+The reference is the integral Li_s(x)=x/(s-1)! int t^(s-1)/(e^t-x) dt from
+0 to infinity, taken in long double with the double exponential rule. It is
+first checked against the closed forms at x=-1, 1/2 and 1. The functions are
+then evaluated at the ends of each range of dilog() and trilog() and at
+random points in [-1,1], 2000 by default. The largest relative error of
+each function and of the former series, with the argument where it occurs,
+is printed.
+
+Exit status is 0 if the reference matches the closed forms to 1e-17 and
+dilog() and trilog() match the reference to POLYLOG_TEST_TOLERANCE, and 1
+otherwise.
+
+**************************************************************************/
+
+//********************************* Global Variables *******************************************
+
+#include "strtable.h"
+
+TPreferences preferences;
+
+logical quiet_output=TRUE;
+
+//************************************ Test functions ******************************************
+
+#define POLYLOG_TEST_TOLERANCE		1e-14
+#define POLYLOG_REFERENCE_STEP		(1.0/64.0)
+#define POLYLOG_REFERENCE_RANGE		4.0
+
+/*
+	The power series used by dilog() and trilog() before range reduction, summed until a
+	term falls below 1e-7 of the total.
+*/
+prec series_dilog(prec x)
+{
+	prec n;
+	prec next_term, next_numerator;
+	prec result;
+
+	result=0.0;
+	next_numerator=x;
+	n=1.0;
+	do {
+		next_term=next_numerator/sq(n);
+		result+=next_term;
+		next_numerator*=x;
+		n++;
+	} while ((fabs(next_term/result)>=1.0e-7) && n<=2500.0);
+
+	return(result);
+}
+
+prec series_trilog(prec x)
+{
+	prec n;
+	prec next_term, next_numerator;
+	prec result;
+
+	result=0.0;
+	next_numerator=x;
+	n=1.0;
+	do {
+		next_term=next_numerator/(sq(n)*n);
+		result+=next_term;
+		next_numerator*=x;
+		n++;
+	} while ((fabs(next_term/result)>=1.0e-7) && n<=210.0);
+
+	return(result);
+}
+
+/*
+	Li_s(x) for s=2 or 3 and x<=1 from its integral form. The substitution
+	t=exp(pi/2 sinh(u)) makes the integrand decay double exponentially at both ends, so the
+	trapezoid rule in u converges to long double precision. e^t-x is computed as
+	expm1(t)+(1-x) so that it keeps its precision for small t when x is close to 1.
+*/
+long double reference_polylog(int order, prec x)
+{
+	long double u, t, weight, sum=0.0L;
+	long double half_pi=1.5707963267948966192313216916397514L;
+	long double one_minus_x=1.0L-(long double)x;
+
+	if (x==0.0) return(0.0L);
+
+	for (u=-POLYLOG_REFERENCE_RANGE;u<=POLYLOG_REFERENCE_RANGE;u+=POLYLOG_REFERENCE_STEP) {
+		t=expl(half_pi*sinhl(u));
+		if (t>11000.0L) break;
+		weight=t*half_pi*coshl(u);
+		if (order==2) sum+=weight*t/(expm1l(t)+one_minus_x);
+		else sum+=weight*t*t/(expm1l(t)+one_minus_x);
+	}
+	sum*=(long double)x*POLYLOG_REFERENCE_STEP;
+	if (order==3) sum/=2.0L;
+	return(sum);
+}
+
+logical check_reference(void)
+{
+	int i;
+	long double difference, max_difference=0.0L;
+	long double pi=3.1415926535897932384626433832795029L;
+	long double zeta_3=1.2020569031595942853997381615114500L;
+	long double log_2=0.6931471805599453094172321214581766L;
+	prec x[]= { -1.0, 0.5, 1.0, -1.0, 0.5, 1.0 };
+	int order[]= { 2, 2, 2, 3, 3, 3 };
+	long double exact[6];
+
+	exact[0]=-pi*pi/12.0L;
+	exact[1]=pi*pi/12.0L-log_2*log_2/2.0L;
+	exact[2]=pi*pi/6.0L;
+	exact[3]=-0.75L*zeta_3;
+	exact[4]=7.0L*zeta_3/8.0L-pi*pi*log_2/12.0L+log_2*log_2*log_2/6.0L;
+	exact[5]=zeta_3;
+
+	for (i=0;i<6;i++) {
+		difference=fabsl(reference_polylog(order[i],x[i])/exact[i]-1.0L);
+		if (difference>max_difference) max_difference=difference;
+	}
+	printf("Reference against closed forms: %.3Le\n",max_difference);
+	return(max_difference<1e-17L);
+}
+
+struct PolylogError {
+	prec max_error;
+	prec max_x;
+};
+
+void add_error(PolylogError& error, prec value, long double reference, prec x)
+{
+	prec relative;
+
+	if (reference==0.0L) relative=fabs(value);
+	else relative=(prec)fabsl(((long double)value-reference)/reference);
+	if (relative>error.max_error) {
+		error.max_error=relative;
+		error.max_x=x;
+	}
+}
+
+void test_point(prec x, PolylogError *error)
+{
+	long double dilog_reference, trilog_reference;
+
+	dilog_reference=reference_polylog(2,x);
+	trilog_reference=reference_polylog(3,x);
+	add_error(error[0],dilog(x),dilog_reference,x);
+	add_error(error[1],series_dilog(x),dilog_reference,x);
+	add_error(error[2],trilog(x),trilog_reference,x);
+	add_error(error[3],series_trilog(x),trilog_reference,x);
+}
+
+//*************************************** Main program *****************************************
+
+int main(int argc, char *argv[])
+{
+	int i, points=2000;
+	logical passed;
+	prec edge_x[]= { -1.0, -0.999999, -0.75, -0.5, -TRILOG_SERIES_LIMIT, -DILOG_SERIES_LIMIT,
+					 -1e-10, 0.0, 1e-10, DILOG_SERIES_LIMIT, TRILOG_SERIES_LIMIT, 0.5,
+					 0.5000001, 0.75, 0.9, 0.999999, 1.0 };
+	const char *name[]= { "dilog", "former dilog series", "trilog", "former trilog series" };
+	PolylogError error[4];
+
+	if (argc>1) points=atoi(argv[1]);
+	if (points<0) points=0;
+
+	passed=check_reference();
+
+	for (i=0;i<4;i++) {
+		error[i].max_error=0.0;
+		error[i].max_x=0.0;
+	}
+	for (i=0;i<(int)(sizeof(edge_x)/sizeof(prec));i++) test_point(edge_x[i],error);
+	srand(1);
+	for (i=0;i<points;i++) test_point(2.0*(prec)rand()/(prec)RAND_MAX-1.0,error);
+
+	for (i=0;i<4;i++)
+		printf("%s: max relative error %.3le at x=%.10lf\n",name[i],error[i].max_error,error[i].max_x);
+
+	if ((error[0].max_error>POLYLOG_TEST_TOLERANCE) || (error[2].max_error>POLYLOG_TEST_TOLERANCE))
+		passed=FALSE;
+
+	if (!passed) {
+		printf("Polylogarithm test failed\n");
+		return(1);
+	}
+	return(0);
+}
@@ -0,0 +1,225 @@
+/*
+    SimWindows - 1D Semiconductor Device Simulator
+    Copyright (C) 2013 David W. Winston
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "comincl.h"
+#include <stdio.h>
+#include <sys/time.h>
+#include "simblock.h"
+
+/*************************************************************************
+
+SimWindows partitioned solver benchmark - times the factorization and solve
+of random diagonally dominant block tridiagonal systems with the
+partitioned solver on the worker pool against the sequential solver. It is
+built like the batch driver, e.g.
+
+	g++ -O2 -DNDEBUG -INUMERIC/INCLUDE -IFormulc CONSOLE/prtbench.cpp
+		CONSOLE/ciofunc.cpp NUMERIC/[0-9a-z]*.cpp -x c++ Formulc/formulc.c
+		-o prtbench -lpthread
+
+Usage:
+	prtbench [repetitions]
+
+Each system with 1, 3 and 4 unknowns per node and 100000, 200000, 500000
+and 1000000 nodes is solved repetitions times, 3 by default, by each
+solver, on pools of 1, 2, 4 and so on up to one worker per processor. The
+system is split into partitions as TSolution does it, one per worker with
+at least MIN_PARTITION_NODES nodes each and at most MAX_BLOCK_PARTITIONS,
+but into at least 2 so that a single worker shows the cost of the
+partitioned solver that TSolution avoids. The wall clock time of one
+factorization and solve, the speedup, the largest difference between the
+two solutions and the largest residual of the partitioned solution are
+printed.
+
+Exit status is 0 if all differences and residuals are below 1e-10 and 1
+otherwise.
+
+**************************************************************************/
+
+//********************************* Global Variables *******************************************
+
+#include "strtable.h"
+
+TPreferences preferences;
+
+logical quiet_output=TRUE;
+
+//********************************** Benchmark functions ***************************************
+
+#define PARTITION_BENCH_VARIABLES	4
+#define PARTITION_BENCH_TOLERANCE	1e-10
+
+/*
+	Fills the rows of a system with random values between -0.5 and 0.5 and adds 4*variables
+	to the diagonal. The couplings of the first and the last node to nodes outside the system
+	are left in place since neither solver reads them.
+*/
+void fill_system(prec *jacobian, prec *rhs, int variables, int unknown_nodes)
+{
+	int i, row, column, rows;
+
+	rows=variables*unknown_nodes;
+	srand(1);
+	for (row=0;row<rows;row++) {
+		for (column=0;column<3*variables;column++) {
+			jacobian[row*3*variables+column]=(prec)rand()/(prec)RAND_MAX-0.5;
+			if (column==variables+row%variables) jacobian[row*3*variables+column]+=4.0*variables;
+		}
+	}
+	for (i=0;i<rows;i++) rhs[i]=(prec)rand()/(prec)RAND_MAX;
+}
+
+/*
+	Largest absolute value of the rows of the original system times the solution minus the
+	right hand side.
+*/
+prec comp_residual(prec *jacobian, prec *rhs, prec *solution, int variables, int unknown_nodes)
+{
+	int i, row, column, node;
+	prec sum, max_residual=0.0;
+
+	for (row=0;row<variables*unknown_nodes;row++) {
+		i=row/variables;
+		sum=-rhs[(row%variables)*unknown_nodes+i];
+		for (column=0;column<3*variables;column++) {
+			node=i-1+column/variables;
+			if ((node<0) || (node>=unknown_nodes)) continue;
+			sum+=jacobian[row*3*variables+column]*solution[(column%variables)*unknown_nodes+node];
+		}
+		if (fabs(sum)>max_residual) max_residual=fabs(sum);
+	}
+	return(max_residual);
+}
+
+double wall_time(void)
+{
+	struct timeval time_value;
+
+	gettimeofday(&time_value,(struct timezone *)0);
+	return((double)time_value.tv_sec+1e-6*(double)time_value.tv_usec);
+}
+
+/*
+	Times repetitions factorizations and solves of one system with each solver. Returns the
+	larger of the difference between the two solutions and the residual of the partitioned
+	one.
+*/
+prec run_benchmark(int variables, int unknown_nodes, int repetitions, TWorkerPool *pool)
+{
+	int i, k, rows, values, partitions;
+	double start;
+	double sequential_time=0.0, partitioned_time=0.0;
+	prec difference, max_difference=0.0, residual;
+	prec *original, *rhs, *sequential_solution, *partitioned_solution;
+	prec *sequential_column[PARTITION_BENCH_VARIABLES], *partitioned_column[PARTITION_BENCH_VARIABLES];
+	TBlockJacobian jacobian;
+	BlockJacobianView view;
+
+	partitions=unknown_nodes/MIN_PARTITION_NODES;
+	if (partitions>pool->get_number_workers()) partitions=pool->get_number_workers();
+	if (partitions>MAX_BLOCK_PARTITIONS) partitions=MAX_BLOCK_PARTITIONS;
+	if (partitions<2) partitions=2;
+
+	rows=variables*unknown_nodes;
+	values=3*variables*rows;
+	original=new prec[values];
+	rhs=new prec[rows];
+	sequential_solution=new prec[rows];
+	partitioned_solution=new prec[rows];
+	jacobian.allocate(values);
+	view=jacobian.get_view(variables);
+
+	fill_system(original,rhs,variables,unknown_nodes);
+	for (k=0;k<variables;k++) {
+		sequential_column[k]=sequential_solution+k*unknown_nodes;
+		partitioned_column[k]=partitioned_solution+k*unknown_nodes;
+	}
+
+	for (i=0;i<repetitions;i++) {
+		memcpy(view.data,original,values*sizeof(prec));
+		memcpy(sequential_solution,rhs,rows*sizeof(prec));
+		start=wall_time();
+		jacobian.factor(variables,unknown_nodes,0,pool);
+		jacobian.solve(variables,sequential_column,unknown_nodes);
+		sequential_time+=wall_time()-start;
+
+		memcpy(view.data,original,values*sizeof(prec));
+		memcpy(partitioned_solution,rhs,rows*sizeof(prec));
+		start=wall_time();
+		jacobian.factor(variables,unknown_nodes,partitions,pool);
+		jacobian.solve(variables,partitioned_column,unknown_nodes);
+		partitioned_time+=wall_time()-start;
+	}
+
+	for (i=0;i<rows;i++) {
+		difference=fabs(sequential_solution[i]-partitioned_solution[i]);
+		if (difference>max_difference) max_difference=difference;
+	}
+	residual=comp_residual(original,rhs,partitioned_solution,variables,unknown_nodes);
+
+	if (partitioned_time<=0.0) partitioned_time=1e-6;
+	printf("%d\t\t%d\t\t%d\t\t%d\t\t%.2lf\t\t%.2lf\t\t%.2lf\t%.3le\t%.3le\n",variables,unknown_nodes,
+		   pool->get_number_workers(),partitions,1e3*sequential_time/repetitions,1e3*partitioned_time/repetitions,
+		   sequential_time/partitioned_time,max_difference,residual);
+	fflush(stdout);
+
+	delete[] original;
+	delete[] rhs;
+	delete[] sequential_solution;
+	delete[] partitioned_solution;
+	if (residual>max_difference) return(residual);
+	return(max_difference);
+}
+
+//*************************************** Main program *****************************************
+
+int main(int argc, char *argv[])
+{
+	int i, j, workers, processors, repetitions=3;
+	int variables[]= { 1, 3, 4 };
+	int nodes[]= { 100000, 200000, 500000, 1000000 };
+	logical agree=TRUE;
+	TWorkerPool *pool;
+
+	if (argc>1) repetitions=atoi(argv[1]);
+	if (repetitions<1) repetitions=1;
+
+	processors=get_number_processors();
+	printf("Processors: %d\n",processors);
+	printf("Unknowns\tNodes\t\tWorkers\t\tPartitions\tSequential (ms)\tPartitioned (ms)\tSpeedup\tMax difference\tResidual\n");
+	for (workers=1;;) {
+		pool=new TWorkerPool(current_context,workers);
+		for (i=0;i<3;i++) {
+			for (j=0;j<4;j++) {
+				if (run_benchmark(variables[i],nodes[j],repetitions,pool)>PARTITION_BENCH_TOLERANCE)
+					agree=FALSE;
+			}
+		}
+		delete pool;
+
+		if (workers>=processors) break;
+		workers*=2;
+		if (workers>processors) workers=processors;
+	}
+
+	if (!agree) {
+		printf("The partitioned solutions are not accurate\n");
+		return(1);
+	}
+	return(0);
+}
@@ -0,0 +1,549 @@
+/*
+    SimWindows - 1D Semiconductor Device Simulator
+    Copyright (C) 2013 David W. Winston
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "comincl.h"
+#include <stdio.h>
+#include "simparse.h"
+
+/*************************************************************************
+
+SimWindows console batch driver - load, solve and write without the user
+interface. Only the NUMERIC and Formulc sources are needed, e.g.
+
+	g++ -O2 -DNDEBUG -INUMERIC/INCLUDE -IFormulc CONSOLE/simbatch.cpp
+		CONSOLE/ciofunc.cpp NUMERIC/[0-9a-z]*.cpp -x c++ Formulc/formulc.c
+		-o simbatch -lpthread
+
+Usage:
+	simbatch [-q] [-j workers] [-p predictor] [-m material_file] job_file
+	simbatch [-q] [-j workers] [-p predictor] [-m material_file] -command [arguments] [-command [arguments] ...]
+
+A job file holds one command per line, '#' starts a comment. On the command
+line each command is preceded by '-'. Commands are executed in order:
+
+	LOAD file					load a device input file or a state file
+	MATERIAL file				load a material parameters file
+	RESET						reset the device
+	BIAS contact volts			applied bias, contact is LEFT, RIGHT, 0 or 1
+	TEMPERATURE surface kelvin	lattice temperature of a surface
+	SPECTRUM file				load an incident spectrum
+	MULTIPLIER value			incident spectrum multiplier
+	SET parameter value			simulation parameter, e.g. MAX_ELECTRICAL_ERROR
+	EFFECT effect ON|OFF		simulation effect, CLAMP_POTENTIAL, CLAMP_TEMPERATURE,
+								COUPLED_THERMAL, COUPLED_PHOTONS or FERMI_TABLE
+	SOLVE						solve the device at the present operating point
+	SWEEP file contact start end step [ADAPTIVE]
+								solve a bias sweep of a contact and write the
+								bias and the contact currents of each point,
+								ADAPTIVE starts with step and then adapts it
+	WRITE_DATA file [combo]		write a data file, combo is BAND (default),
+								RECOMB, ELECTROSTATICS, CURRENT, FREE_CONC,
+								BOUND_CONC, TOTAL_CONC, ALL_CONC, DOPING,
+								MATERIAL, LASER, SPECTRUM or STRUCTURE
+	WRITE_STATE file			write a state file
+
+A sweep is split among the given number of workers, by default one per
+processor. The starting point of each sweep bias is given by the predictor,
+NONE, LINEAR, QUADRATIC (default) or TANGENT.
+
+SET NEWTON_REFACTOR_RATIO r with r above zero switches the electrical
+iteration to modified Newton, reusing the factored jacobian while the error
+of an iteration is at most r times the error of the one before and drops at
+least as fast as in the one before. Otherwise the step is discarded and the
+iteration repeated with a new jacobian.
+
+SET MAX_LINE_SEARCH_ITER n with n above zero damps an electrical Newton
+update that would be clamped by a backtracking line search on the residual
+along the unclamped update, with up to n step cuts. The clamped update is
+taken when no cut does better.
+
+SET ANDERSON_DEPTH m with m above zero replaces the relaxed temperature
+update of the outer thermal loop by Anderson mixing of the last m passes,
+at most 10. The photon number of a laser is extrapolated with the same
+coefficients. Mixing is only used while the relaxed passes converge slowly
+and falls back to the relaxed update whenever a mixed pass does worse.
+
+SET TUNNEL_QUAD_ORDER n with n above zero integrates the tunneling current
+of each heterojunction with an n point Gauss-Legendre rule, at most 32,
+instead of the 25 step trapezoid rule. SET TUNNEL_QUAD_TOLERANCE t with t
+above zero integrates it with adaptive Gauss-Kronrod to a relative error of
+t instead. The number of transmission evaluations of each solve is reported
+with the convergence values.
+
+SET ASSEMBLY_MIN_NODES n assembles the electrical and thermal jacobians and
+residuals of a device with at least n nodes on all processors, with the same
+results as the serial assembly. The default is 4000. 0 always assembles
+serially. The devices of a parallel sweep are always assembled serially.
+
+SET PROPERTY_MIN_NODES n computes the node properties (mobilities, densities
+of states, band gaps, recombination and the other material parameters) of a
+device with at least n nodes on all processors, with the same results as the
+serial loop. The default is 4000. 0 always computes them serially, as do the
+devices of a parallel sweep.
+
+SET PARTITION_MIN_NODES n solves the jacobians of a device with at least n
+nodes in partitions, one per processor. The partitioned solver does several
+times the work of the sequential one and only gains with enough processors;
+prtbench prints the speedup for each number of workers. The results differ
+from the sequential solver by rounding and depend on the number of
+processors. The default is 0, which always uses the sequential solver, as do
+a single processor and the devices of a parallel sweep.
+
+EFFECT COUPLED_THERMAL ON solves the electrical and the lattice temperature
+equations of a non-isothermal device in one Newton iteration instead of
+alternating between them. Only the lattice temperature is coupled; the
+electron and hole temperatures of the hot carrier mode follow the lattice
+and are still solved in the outer loop.
+
+EFFECT COUPLED_PHOTONS ON solves the photon number of a laser with the
+electrical equations in one Newton iteration instead of the outer photon loop.
+
+EFFECT FERMI_TABLE ON takes the Fermi integrals of Fermi-Dirac statistics
+from interpolated tables, with a relative error below 3e-8, instead of the
+analytic approximations, which are off by up to 1e-2.
+
+Exit status is 0 on success, 1 on an error and 2 if the last solution did not
+converge.
+
+**************************************************************************/
+
+//********************************* Global Variables *******************************************
+
+#include "strtable.h"
+
+TPreferences preferences;
+
+logical quiet_output=FALSE;
+
+//********************************** Command tables *******************************************
+
+struct BatchSetting {
+	const char *name;
+	flag flag_value;
+};
+
+#define BATCH_SETTING(name) { #name, name }
+
+static BatchSetting batch_settings[]={
+	BATCH_SETTING(POT_CLAMP_VALUE),
+	BATCH_SETTING(TEMPERATURE),
+	BATCH_SETTING(MAX_ELECTRICAL_ERROR),
+	BATCH_SETTING(MAX_THERMAL_ERROR),
+	BATCH_SETTING(MAX_OPTIC_ERROR),
+	BATCH_SETTING(COARSE_MODE_ERROR),
+	BATCH_SETTING(FINE_MODE_ERROR),
+	BATCH_SETTING(MAX_INNER_ELECT_ITER),
+	BATCH_SETTING(MAX_INNER_THERM_ITER),
+	BATCH_SETTING(MAX_OUTER_OPTIC_ITER),
+	BATCH_SETTING(MAX_OUTER_THERM_ITER),
+	BATCH_SETTING(MAX_INNER_MODE_ITER),
+	BATCH_SETTING(TEMP_CLAMP_VALUE),
+	BATCH_SETTING(TEMP_RELAX_VALUE),
+	BATCH_SETTING(NEWTON_REFACTOR_RATIO),
+	BATCH_SETTING(MAX_LINE_SEARCH_ITER),
+	BATCH_SETTING(ANDERSON_DEPTH),
+	BATCH_SETTING(TUNNEL_QUAD_ORDER),
+	BATCH_SETTING(TUNNEL_QUAD_TOLERANCE),
+	BATCH_SETTING(ASSEMBLY_MIN_NODES),
+	BATCH_SETTING(PARTITION_MIN_NODES),
+	BATCH_SETTING(PROPERTY_MIN_NODES),
+	{ (const char *)0, 0 }
+};
+
+#define BATCH_EFFECT(name) { #name, ENV_##name }
+
+static BatchSetting batch_effects[]={
+	BATCH_EFFECT(CLAMP_POTENTIAL),
+	BATCH_EFFECT(CLAMP_TEMPERATURE),
+	BATCH_EFFECT(COUPLED_THERMAL),
+	BATCH_EFFECT(COUPLED_PHOTONS),
+	BATCH_EFFECT(FERMI_TABLE),
+	{ (const char *)0, 0 }
+};
+
+// Same order as the FlagCombo enumeration
+static const char *batch_combos[]={
+	"BAND", "RECOMB", "ELECTROSTATICS", "CURRENT", "FREE_CONC", "BOUND_CONC",
+	"TOTAL_CONC", "ALL_CONC", "DOPING", "MATERIAL", "LASER", "SPECTRUM",
+	"STRUCTURE", (const char *)0
+};
+
+// Same order as the PredictorType enumeration
+static const char *batch_predictors[]={
+	"NONE", "LINEAR", "QUADRATIC", "TANGENT", (const char *)0
+};
+
+static logical material_loaded=FALSE;
+static logical last_converged=TRUE;
+static int sweep_workers=0;
+static PredictorType sweep_predictor=PREDICT_QUADRATIC;
+
+//*********************************** Batch functions *****************************************
+
+static void batch_usage(void)
+{
+	fprintf(stderr,"Usage: simbatch [-q] [-j workers] [-p predictor] [-m material_file] job_file\n");
+	fprintf(stderr,"       simbatch [-q] [-j workers] [-p predictor] [-m material_file] -command [arguments] ...\n");
+	fprintf(stderr,"Predictors: NONE, LINEAR, QUADRATIC, TANGENT\n");
+	fprintf(stderr,"Commands: LOAD, MATERIAL, RESET, BIAS, TEMPERATURE, SPECTRUM, MULTIPLIER,\n");
+	fprintf(stderr,"          SET, EFFECT, SOLVE, SWEEP, WRITE_DATA, WRITE_STATE\n");
+}
+
+static void batch_load_material(const char *filename)
+{
+	TParseMaterial *material_parser;
+
+	printf("Loading material parameters: %s\n",filename);
+	material_parser=new TParseMaterial(current_context,filename);
+	if (!current_context->error_handler.fail()) material_parser->parse_material();
+	delete material_parser;
+	material_loaded=!current_context->error_handler.fail();
+}
+
+static void batch_default_material(void)
+{
+	extern char executable_path[MAXPATH];
+	string material_string;
+	char upper_name[MAXPATH];
+
+	material_string=string(executable_path)+preferences.get_material_parameters_file();
+	if (access(material_string.c_str(),0)!=0) {
+		strncpy(upper_name,preferences.get_material_parameters_file().c_str(),MAXPATH-1);
+		upper_name[MAXPATH-1]='\0';
+		material_string=string(executable_path)+string(strupr(upper_name));
+	}
+	batch_load_material(material_string.c_str());
+}
+
+static int batch_object(const char *name)
+{
+	if (!strcmp(name,"LEFT") || !strcmp(name,"0")) return(0);
+	if (!strcmp(name,"RIGHT") || !strcmp(name,"1")) return(1);
+	return(-1);
+}
+
+static logical batch_number(const char *number_string, prec& value)
+{
+	char *end_ptr;
+
+	value=strtod(number_string,&end_ptr);
+	return((end_ptr!=number_string) && (*end_ptr=='\0'));
+}
+
+static logical batch_require_device(void)
+{
+	if (!current_context->environment.device()) {
+		fprintf(stderr,"Error: no device loaded\n");
+		return(FALSE);
+	}
+	return(TRUE);
+}
+
+static void batch_solve(void)
+{
+	out_operating_condition();
+	current_context->environment.solve();
+	if (!current_context->error_handler.fail()) {
+		out_simulation_result();
+		last_converged=(current_context->environment.get_value(DEVICE,CURRENT_STATUS)!=NOT_CONVERGED);
+	}
+}
+
+static void batch_sweep(const char *filename, int contact, prec start_bias, prec end_bias, prec step,
+						logical adaptive)
+{
+	static flag sweep_flags[]={ APPLIED_BIAS, TOTAL_CURRENT, ELECTRON_CURRENT, HOLE_CURRENT };
+	const int number_parameters=sizeof(sweep_flags)/sizeof(flag);
+	int i, number_values;
+	FlagType flag_type_array[number_parameters];
+	int object_array[number_parameters];
+	prec *record_data[number_parameters];
+	TBiasSweep *bias_sweep;
+
+	if ((end_bias!=start_bias) && (step!=0)) number_values=round((end_bias-start_bias)/step)+1;
+	else number_values=1;
+	if (number_values<1) {
+		fprintf(stderr,"Error: invalid sweep step\n");
+		return;
+	}
+
+	for (i=0;i<number_parameters;i++) {
+		flag_type_array[i]=CONTACT;
+		object_array[i]=contact;
+		record_data[i]=new prec[number_values];
+	}
+
+	bias_sweep=new TBiasSweep(current_context,contact,start_bias,step,number_values,number_parameters,
+							  flag_type_array,sweep_flags,object_array,record_data);
+	if (sweep_workers) bias_sweep->put_number_workers(sweep_workers);
+	bias_sweep->put_predictor(sweep_predictor);
+	bias_sweep->put_adaptive_step(adaptive);
+	if (adaptive) printf("Adaptive bias sweep: initial step %g V\n",step);
+	else printf("Bias sweep: %d points in %d chunks\n",number_values,bias_sweep->get_number_chunks());
+	bias_sweep->execute();
+	printf("Points solved: %d\n",bias_sweep->get_solved_values());
+	if (!current_context->error_handler.fail()) {
+		out_simulation_result();
+		last_converged=(current_context->environment.get_value(DEVICE,CURRENT_STATUS)!=NOT_CONVERGED);
+		bias_sweep->write_data_file(filename);
+	}
+	if (!current_context->error_handler.fail()) printf("Data written: %s\n",filename);
+
+	delete bias_sweep;
+	for (i=0;i<number_parameters;i++) delete[] record_data[i];
+}
+
+static void batch_write_data(const char *filename, const char *combo_name)
+{
+	int i;
+	TValueFlag write_flags;
+
+	for (i=0;batch_combos[i];i++) if (!strcmp(batch_combos[i],combo_name)) break;
+	if (!batch_combos[i]) {
+		fprintf(stderr,"Error: unknown data combination %s\n",combo_name);
+		return;
+	}
+	write_flags.set_write_combo((FlagCombo)i);
+	current_context->environment.write_data_file(filename,write_flags);
+	if (!current_context->error_handler.fail()) printf("Data written: %s\n",filename);
+}
+
+/*
+	Executes a single command. Command names and keywords are upper case, file names are
+	passed unchanged. Returns FALSE if the batch has to stop.
+*/
+static logical batch_command(char *command, int number_args, char **args)
+{
+	TEnvironment& environment=current_context->environment;
+	TErrorHandler& error_handler=current_context->error_handler;
+	int i, object;
+	logical file_command;
+	prec value, start_bias, end_bias;
+
+	strupr(command);
+	file_command=!strcmp(command,"LOAD") || !strcmp(command,"MATERIAL") ||
+				 !strcmp(command,"SPECTRUM") || !strcmp(command,"SWEEP") ||
+				 !strncmp(command,"WRITE_",6);
+	for (i=(file_command) ? 1 : 0;i<number_args;i++) strupr(args[i]);
+
+	if (!strcmp(command,"LOAD") && (number_args==1)) {
+		if (!material_loaded) batch_default_material();
+		if (error_handler.fail()) return(FALSE);
+		printf("Loading device: %s\n",args[0]);
+		environment.load_file(args[0]);
+		if (!error_handler.fail()) {
+			value=environment.get_value(ENVIRONMENT,EFFECTS);
+			environment.put_value(ENVIRONMENT,EFFECTS,(prec)((flag)value & ~ENV_UNDO_SIMULATION));
+			printf("Device successfully created\n");
+		}
+	}
+	else if (!strcmp(command,"MATERIAL") && (number_args==1)) batch_load_material(args[0]);
+	else if (!strcmp(command,"RESET") && (number_args==0)) {
+		if (!batch_require_device()) return(FALSE);
+		environment.init_device();
+		printf("Device Reset\n");
+	}
+	else if ((!strcmp(command,"BIAS") || !strcmp(command,"TEMPERATURE")) && (number_args==2)) {
+		if (!batch_require_device()) return(FALSE);
+		object=batch_object(args[0]);
+		if ((object<0) || !batch_number(args[1],value)) {
+			fprintf(stderr,"Error: invalid arguments to %s\n",command);
+			return(FALSE);
+		}
+		if (!strcmp(command,"BIAS")) environment.put_value(CONTACT,APPLIED_BIAS,value,object);
+		else environment.put_value(SURFACE,TEMPERATURE,value,object);
+		environment.process_recompute_flags();
+	}
+	else if (!strcmp(command,"SPECTRUM") && (number_args==1)) {
+		environment.load_spectrum(args[0]);
+		environment.process_recompute_flags();
+	}
+	else if ((!strcmp(command,"MULTIPLIER") || !strcmp(command,"SET")) &&
+			 (number_args==(strcmp(command,"SET") ? 1 : 2))) {
+		if (!batch_number(args[number_args-1],value)) {
+			fprintf(stderr,"Error: invalid number %s\n",args[number_args-1]);
+			return(FALSE);
+		}
+		if (!strcmp(command,"MULTIPLIER")) environment.put_value(ENVIRONMENT,SPECTRUM_MULTIPLIER,value);
+		else {
+			for (i=0;batch_settings[i].name;i++) if (!strcmp(batch_settings[i].name,args[0])) break;
+			if (!batch_settings[i].name) {
+				fprintf(stderr,"Error: unknown parameter %s\n",args[0]);
+				return(FALSE);
+			}
+			environment.put_value(ENVIRONMENT,batch_settings[i].flag_value,value);
+		}
+		environment.process_recompute_flags();
+	}
+	else if (!strcmp(command,"EFFECT") && (number_args==2)) {
+		for (i=0;batch_effects[i].name;i++) if (!strcmp(batch_effects[i].name,args[0])) break;
+		if (!batch_effects[i].name || (strcmp(args[1],"ON") && strcmp(args[1],"OFF"))) {
+			fprintf(stderr,"Error: invalid arguments to %s\n",command);
+			return(FALSE);
+		}
+		value=environment.get_value(ENVIRONMENT,EFFECTS);
+		if (!strcmp(args[1],"ON")) value=(prec)((flag)value | batch_effects[i].flag_value);
+		else value=(prec)((flag)value & ~batch_effects[i].flag_value);
+		environment.put_value(ENVIRONMENT,EFFECTS,value);
+		environment.process_recompute_flags();
+	}
+	else if (!strcmp(command,"SOLVE") && (number_args==0)) {
+		if (!batch_require_device()) return(FALSE);
+		batch_solve();
+	}
+	else if (!strcmp(command,"SWEEP") && ((number_args==5) || (number_args==6))) {
+		if (!batch_require_device()) return(FALSE);
+		object=batch_object(args[1]);
+		if ((object<0) || !batch_number(args[2],start_bias) ||
+			!batch_number(args[3],end_bias) || !batch_number(args[4],value) ||
+			((number_args==6) && strcmp(args[5],"ADAPTIVE"))) {
+			fprintf(stderr,"Error: invalid arguments to %s\n",command);
+			return(FALSE);
+		}
+		batch_sweep(args[0],object,start_bias,end_bias,value,number_args==6);
+	}
+	else if (!strcmp(command,"WRITE_DATA") && (number_args==1 || number_args==2)) {
+		if (!batch_require_device()) return(FALSE);
+		batch_write_data(args[0],(number_args==2) ? args[1] : "BAND");
+	}
+	else if (!strcmp(command,"WRITE_STATE") && (number_args==1)) {
+		if (!batch_require_device()) return(FALSE);
+		environment.write_state_file(args[0]);
+		if (!error_handler.fail()) printf("State written: %s\n",args[0]);
+	}
+	else {
+		fprintf(stderr,"Error: invalid command %s\n",command);
+		return(FALSE);
+	}
+
+	if (error_handler.fail()) {
+		out_error_message(TRUE);
+		return(FALSE);
+	}
+	return(TRUE);
+}
+
+static logical batch_job_file(const char *filename)
+{
+	FILE *job_file;
+	char line[512];
+	char *tokens[16];
+	int number_tokens, line_number=0;
+	logical result=TRUE;
+
+	job_file=fopen(filename,"r");
+	if (!job_file) {
+		current_context->error_handler.set_error(ERROR_FILE_NOT_OPEN,0,"",filename);
+		out_error_message(TRUE);
+		return(FALSE);
+	}
+
+	while (result && fgets(line,sizeof(line),job_file)) {
+		line_number++;
+		if (strchr(line,'#')) *strchr(line,'#')='\0';
+		number_tokens=0;
+		tokens[0]=strtok(line," \t\r\n");
+		while (tokens[number_tokens] && (number_tokens<15))
+			tokens[++number_tokens]=strtok((char *)0," \t\r\n");
+		if (number_tokens==0) continue;
+		result=batch_command(tokens[0],number_tokens-1,tokens+1);
+		if (!result) fprintf(stderr,"Stopped at %s line %d\n",filename,line_number);
+	}
+	fclose(job_file);
+	return(result);
+}
+
+static logical batch_is_command(const char *arg)
+{
+	return((arg[0]=='-') && isalpha(arg[1]));
+}
+
+int main(int argc, char *argv[])
+{
+	extern char executable_path[MAXPATH];
+	const char *path_end;
+	int i,j;
+	logical result=TRUE;
+
+	rnd_init();
+
+	executable_path[0]='\0';
+	path_end=strrchr(argv[0],'/');
+	if (path_end && (path_end-argv[0]<MAXPATH-1)) {
+		strncpy(executable_path,argv[0],path_end-argv[0]+1);
+		executable_path[path_end-argv[0]+1]='\0';
+	}
+
+	i=1;
+	while ((i<argc) && result) {
+		if (!strcmp(argv[i],"-q")) {
+			quiet_output=TRUE;
+			i++;
+		}
+		else if (!strcmp(argv[i],"-j") && (i+1<argc)) {
+			sweep_workers=atoi(argv[i+1]);
+			i+=2;
+		}
+		else if (!strcmp(argv[i],"-p") && (i+1<argc)) {
+			for (j=0;batch_predictors[j];j++) if (!strcmp(batch_predictors[j],argv[i+1])) break;
+			if (batch_predictors[j]) sweep_predictor=(PredictorType)j;
+			else {
+				fprintf(stderr,"Error: unknown predictor %s\n",argv[i+1]);
+				result=FALSE;
+			}
+			i+=2;
+		}
+		else if (!strcmp(argv[i],"-m") && (i+1<argc)) {
+			batch_load_material(argv[i+1]);
+			if (current_context->error_handler.fail()) {
+				out_error_message(TRUE);
+				result=FALSE;
+			}
+			i+=2;
+		}
+		else break;
+	}
+
+	if (result && (i>=argc)) {
+		batch_usage();
+		return(1);
+	}
+
+	if (result) {
+		if (!batch_is_command(argv[i])) {
+			if (i+1<argc) {
+				batch_usage();
+				return(1);
+			}
+			result=batch_job_file(argv[i]);
+		}
+		else {
+			while ((i<argc) && result) {
+				for (j=i+1;(j<argc) && !batch_is_command(argv[j]);j++);
+				result=batch_command(argv[i]+1,j-i-1,argv+i+1);
+				i=j;
+			}
+		}
+	}
+
+	current_context->environment.delete_device();
+
+	if (!result) return(1);
+	if (!last_converged) return(2);
+	return(0);
+}
@@ -56,27 +56,35 @@
   /* nothing */
 #endif
 
+/* evaluation and translation state is kept per thread, so that
+   functions can be used by simulations running on several threads */
+#ifdef _MSC_VER
+#define FC_THREAD __declspec(thread)
+#else
+#define FC_THREAD __thread
+#endif
+
 static double pi(void);
 
 static double value(formu function);
 
-static const char *i_error; /*pointer to the character in source[]
+static FC_THREAD const char *i_error; /*pointer to the character in source[]
 			that causes an error */
 #define Max_ctable 255
    /*maximum number of items in a table of constants */
    /* Max_ctable must be less than 256 */
-static int i_pctable; /* number of items in a table of constants -
+static FC_THREAD int i_pctable; /* number of items in a table of constants -
                          used only by the translating functions */
-static double *i_ctable; /*current table of constants -
+static FC_THREAD double *i_ctable; /*current table of constants -
                            used only by the translating functions */
 static UCHAR *i_trans(UCHAR *function, char *begin, char *end);
 static char  *my_strtok(char *s);
 static UCHAR *comp_time(UCHAR *function, UCHAR *fend, int npars);
 
-static char *errmes = NULL;
+static FC_THREAD char *errmes = NULL;
 static void fset_error(char *);
 
-static double param['z'-'a'+1];
+static FC_THREAD double param['z'-'a'+1];
 typedef struct {
   char *name;
   Func f;    /* pointer to function*/
@@ -97,7 +105,7 @@ static formu_item ftable[TABLESIZE]=
   {"asin", asin,1,0},
   {"acos", acos,1,0},
   {"atan", atan,1,0},
-  {"atan2",(Func) atan2,2,0},
+  {"atan2",(Func) (Func2) atan2,2,0},
   {"abs",  fabs,1,0},
   {"sqrt",  sqrt,1,0},
   {"pi", (Func) pi,0,0},
@@ -29,6 +29,7 @@
 class T2DElectron {
 	friend TBoundElectron;
 protected:
+	TSimulationContext *context;
 	TNode** grid_ptr;
 	QuantumWellNodes nodes;
 	flag qw_effects;
@@ -45,7 +46,7 @@ protected:
     prec auger_coefficient;
 
 public:
-	T2DElectron(TNode** grid);
+	T2DElectron(TSimulationContext *new_context, TNode** grid);
 private:
 	prec comp_dos(prec dos_mass, prec temp);
 public:
@@ -74,8 +75,9 @@ public:
 };
 */
 
-T2DElectron::T2DElectron(TNode** grid)
+T2DElectron::T2DElectron(TSimulationContext *new_context, TNode** grid)
 {
+	context=new_context;
 	grid_ptr=grid;
 	qw_effects=0;
 	nodes.prev_node_ptr=(TNode*)0;
@@ -99,6 +101,7 @@ T2DElectron::T2DElectron(TNode** grid)
 
 prec T2DElectron::comp_dos(prec dos_mass, prec temp)
 {
+	NormalizeConstants& normalization=context->normalization;
 	return((dos_mass*SIM_mo*SIM_k*temp*normalization.temp/(SIM_pi*sq(SIM_hb)))/
 		   (1e4*normalization.conc*normalization.length));
 }
@@ -137,14 +140,15 @@ void T2DElectron::comp_equil_planck_potential(prec hole_equil_dos, prec hole_ene
 	prec bulk_band_gap;
 	prec lattice_temp;
 	flag effects;
-	static prec old_donor_conc=0.0, old_acceptor_conc=0.0;
-	static prec old_electron_equil_dos=0.0, old_hole_equil_dos=0.0;
-	static long old_donor_degeneracy=0, old_acceptor_degeneracy=0;
-	static prec old_donor_level=0.0, old_acceptor_level=0.0;
-	static prec old_electron_energy_level=0.0, old_hole_energy_level=0.0;
-	static prec old_bulk_band_gap=0.0, old_lattice_temp=0.0;
-	static logical old_fermi_method=FALSE, old_ionized_doping_method=FALSE;
-	static prec old_result=0.0;
+	static SIM_THREAD_LOCAL prec old_donor_conc=0.0, old_acceptor_conc=0.0;
+	static SIM_THREAD_LOCAL prec old_electron_equil_dos=0.0, old_hole_equil_dos=0.0;
+	static SIM_THREAD_LOCAL long old_donor_degeneracy=0, old_acceptor_degeneracy=0;
+	static SIM_THREAD_LOCAL prec old_donor_level=0.0, old_acceptor_level=0.0;
+	static SIM_THREAD_LOCAL prec old_electron_energy_level=0.0, old_hole_energy_level=0.0;
+	static SIM_THREAD_LOCAL prec old_bulk_band_gap=0.0, old_lattice_temp=0.0;
+	static SIM_THREAD_LOCAL int old_fermi_method=0;
+	static SIM_THREAD_LOCAL logical old_ionized_doping_method=FALSE;
+	static SIM_THREAD_LOCAL prec old_result=0.0;
 	logical same_values=FALSE;
 
 	acceptor_degeneracy=nodes.curr_node_ptr->get_value(HOLE,DOPING_DEGENERACY,NORMALIZED);
@@ -163,7 +167,7 @@ void T2DElectron::comp_equil_planck_potential(prec hole_equil_dos, prec hole_ene
 		(bulk_band_gap==old_bulk_band_gap) && (lattice_temp==old_lattice_temp)) same_values=TRUE;
 
 	if ( same_values &&
-		 (((effects & GRID_FERMI_DIRAC)!=0)==old_fermi_method) &&
+		 (fermi_method(context,effects)==old_fermi_method) &&
 		 (((effects & GRID_INCOMPLETE_IONIZATION)!=0)==old_ionized_doping_method) )
 		 equil_planck_potential=old_result;
 	else {
@@ -222,7 +226,7 @@ void T2DElectron::comp_equil_planck_potential(prec hole_equil_dos, prec hole_ene
 		old_bulk_band_gap=bulk_band_gap;
 		old_lattice_temp=lattice_temp;
 
-		old_fermi_method=((effects & GRID_FERMI_DIRAC)!=0);
+		old_fermi_method=fermi_method(context,effects);
 		old_ionized_doping_method=((effects & GRID_INCOMPLETE_IONIZATION)!=0);
 
 		old_result=equil_planck_potential;
@@ -290,6 +294,7 @@ void T2DElectron::comp_doping_conc(void)
 
 void T2DElectron::comp_eigenvalues(void)
 {
+	NormalizeConstants& normalization=context->normalization;
 	prec qw_dos_mass, bulk_dos_mass;
 	prec curr_trans_result, qw_depth;
 	logical energy_level_found;
@@ -330,7 +335,7 @@ void T2DElectron::comp_wavefunctions(prec start_position)
 		 temp_ptr++) {
 		wave_function=sqrt(2.0/qw_length)*
 					  sin(SIM_pi*((*temp_ptr)->get_value(GRID_ELECTRICAL,POSITION,NORMALIZED)-start_position)/qw_length);
-		(*temp_ptr)->TBoundElectron::wave_function=wave_function;
+		((TBoundElectron *)*temp_ptr)->wave_function=wave_function;
 	}
 }
 
@@ -354,7 +359,7 @@ void T2DElectron::comp_qw_top(void)
 		 temp_ptr++) {
 		energy_level_ref=-(*temp_ptr)->get_value(GRID_ELECTRICAL,ELECTRON_AFFINITY,NORMALIZED)
 						 -(*temp_ptr)->get_value(GRID_ELECTRICAL,POTENTIAL,NORMALIZED);
-		(*temp_ptr)->TBoundElectron::qw_energy_top=qw_energy_top-energy_level_ref;
+		((TBoundElectron *)*temp_ptr)->qw_energy_top=qw_energy_top-energy_level_ref;
 	}
 
 	qw_energy_top-=(-nodes.curr_node_ptr->get_value(GRID_ELECTRICAL,ELECTRON_AFFINITY,NORMALIZED)
@@ -374,12 +379,13 @@ void T2DElectron::comp_stimulated_factor(prec band_gap)
 
 void T2DElectron::comp_auger_coefficient(void)
 {
+	NormalizeConstants& normalization=context->normalization;
 	prec values[]={ nodes.curr_node_ptr->get_value(GRID_ELECTRICAL,ALLOY_CONC),
 					nodes.curr_node_ptr->get_value(GRID_ELECTRICAL,POSITION,NORMALIZED) };
 
-	auger_coefficient=material_parameters.evaluate(MAT_QW_ELECTRON_AUGER_COEFFICIENT,
-												   (MaterialType)nodes.curr_node_ptr->get_value(GRID_ELECTRICAL,MATERIAL),
-												   (AlloyType)nodes.curr_node_ptr->get_value(GRID_ELECTRICAL,ALLOY_TYPE),
+	auger_coefficient=context->material_parameters.evaluate(MAT_QW_ELECTRON_AUGER_COEFFICIENT,
+															(MaterialType)nodes.curr_node_ptr->get_value(GRID_ELECTRICAL,MATERIAL),
+															(AlloyType)nodes.curr_node_ptr->get_value(GRID_ELECTRICAL,ALLOY_TYPE),
 												    values)*sq(normalization.length*normalization.conc)*normalization.time;
 
 }
@@ -401,13 +407,13 @@ prec T2DElectron::get_value(flag flag_value, ScaleType scale)
 		default: assert(FALSE); return(0.0);
 	}
 
-	if (scale==UNNORMALIZED) return_value*=get_normalize_value(QW_ELECTRON,flag_value);
+	if (scale==UNNORMALIZED) return_value*=get_normalize_value(context,QW_ELECTRON,flag_value);
 	return(return_value);
 }
 
 void T2DElectron::put_value(flag flag_value, prec value, ScaleType scale)
 {
-	if (scale==UNNORMALIZED) value/=get_normalize_value(QW_ELECTRON,flag_value);
+	if (scale==UNNORMALIZED) value/=get_normalize_value(context,QW_ELECTRON,flag_value);
 
 	switch(flag_value) {
 		case EQUIL_DOS: equil_dos=value; return;
@@ -458,6 +464,7 @@ void T2DElectron::write_state_file(FILE *file_ptr)
 class T2DHole {
 	friend TBoundHole;
 protected:
+	TSimulationContext *context;
 	TNode** grid_ptr;
 	QuantumWellNodes nodes;
 	flag qw_effects;
@@ -474,7 +481,7 @@ protected:
     prec auger_coefficient;
 
 public:
-	T2DHole(TNode** grid);
+	T2DHole(TSimulationContext *new_context, TNode** grid);
 private:
 	prec comp_dos(prec dos_mass, prec temp);
 public:
@@ -500,8 +507,9 @@ public:
 };
 */
 
-T2DHole::T2DHole(TNode** grid)
+T2DHole::T2DHole(TSimulationContext *new_context, TNode** grid)
 {
+	context=new_context;
 	grid_ptr=grid;
 	qw_effects=0;
 	nodes.prev_node_ptr=(TNode*)0;
@@ -525,6 +533,7 @@ T2DHole::T2DHole(TNode** grid)
 
 prec T2DHole::comp_dos(prec dos_mass, prec temp)
 {
+	NormalizeConstants& normalization=context->normalization;
 	return((dos_mass*SIM_mo*SIM_k*temp*normalization.temp/(SIM_pi*sq(SIM_hb)))/
 		   (1e4*normalization.conc*normalization.length));
 }
@@ -563,14 +572,15 @@ void T2DHole::comp_equil_planck_potential(prec electron_equil_dos, prec electron
 	prec bulk_band_gap;
 	prec lattice_temp;
 	flag effects;
-	static prec old_donor_conc=0.0, old_acceptor_conc=0.0;
-	static prec old_electron_equil_dos=0.0, old_hole_equil_dos=0.0;
-	static long old_donor_degeneracy=0, old_acceptor_degeneracy=0;
-	static prec old_donor_level=0.0, old_acceptor_level=0.0;
-	static prec old_electron_energy_level=0.0, old_hole_energy_level=0.0;
-	static prec old_bulk_band_gap=0.0, old_lattice_temp=0.0;
-	static logical old_fermi_method=FALSE, old_ionized_doping_method=FALSE;
-	static prec old_result=0.0;
+	static SIM_THREAD_LOCAL prec old_donor_conc=0.0, old_acceptor_conc=0.0;
+	static SIM_THREAD_LOCAL prec old_electron_equil_dos=0.0, old_hole_equil_dos=0.0;
+	static SIM_THREAD_LOCAL long old_donor_degeneracy=0, old_acceptor_degeneracy=0;
+	static SIM_THREAD_LOCAL prec old_donor_level=0.0, old_acceptor_level=0.0;
+	static SIM_THREAD_LOCAL prec old_electron_energy_level=0.0, old_hole_energy_level=0.0;
+	static SIM_THREAD_LOCAL prec old_bulk_band_gap=0.0, old_lattice_temp=0.0;
+	static SIM_THREAD_LOCAL int old_fermi_method=0;
+	static SIM_THREAD_LOCAL logical old_ionized_doping_method=FALSE;
+	static SIM_THREAD_LOCAL prec old_result=0.0;
 	logical same_values=FALSE;
 
 	acceptor_degeneracy=nodes.curr_node_ptr->get_value(HOLE,DOPING_DEGENERACY,NORMALIZED);
@@ -589,7 +599,7 @@ void T2DHole::comp_equil_planck_potential(prec electron_equil_dos, prec electron
 		(bulk_band_gap==old_bulk_band_gap) && (lattice_temp==old_lattice_temp)) same_values=TRUE;
 
 	if ( same_values &&
-		 (((effects & GRID_FERMI_DIRAC)!=0)==old_fermi_method) &&
+		 (fermi_method(context,effects)==old_fermi_method) &&
 		 (((effects & GRID_INCOMPLETE_IONIZATION)!=0)==old_ionized_doping_method) )
 		 equil_planck_potential=old_result;
 	else {
@@ -648,7 +658,7 @@ void T2DHole::comp_equil_planck_potential(prec electron_equil_dos, prec electron
 		old_bulk_band_gap=bulk_band_gap;
 		old_lattice_temp=lattice_temp;
 
-		old_fermi_method=((effects & GRID_FERMI_DIRAC)!=0);
+		old_fermi_method=fermi_method(context,effects);
 		old_ionized_doping_method=((effects & GRID_INCOMPLETE_IONIZATION)!=0);
 
 		old_result=equil_planck_potential;
@@ -738,7 +748,7 @@ void T2DHole::comp_qw_top(void)
 						 -(*temp_ptr)->get_value(GRID_ELECTRICAL,POTENTIAL,NORMALIZED)
 						 -(*temp_ptr)->get_value(GRID_ELECTRICAL,BAND_GAP,NORMALIZED);
 
-		(*temp_ptr)->TBoundHole::qw_energy_top=qw_energy_top-energy_level_ref;
+		((TBoundHole *)*temp_ptr)->qw_energy_top=qw_energy_top-energy_level_ref;
 	}
 
 	qw_energy_top=(-nodes.curr_node_ptr->get_value(GRID_ELECTRICAL,ELECTRON_AFFINITY,NORMALIZED)
@@ -748,6 +758,7 @@ void T2DHole::comp_qw_top(void)
 
 void T2DHole::comp_eigenvalues(void)
 {
+	NormalizeConstants& normalization=context->normalization;
 	prec qw_dos_mass, bulk_dos_mass;
 	prec qw_depth, curr_trans_result;
 	logical energy_level_found;
@@ -790,7 +801,7 @@ void T2DHole::comp_wavefunctions(prec start_position)
 		 temp_ptr++) {
 		wave_function=sqrt(2.0/qw_length)*
 					  sin(SIM_pi*((*temp_ptr)->get_value(GRID_ELECTRICAL,POSITION,NORMALIZED)-start_position)/qw_length);
-		(*temp_ptr)->TBoundHole::wave_function=wave_function;
+		((TBoundHole *)*temp_ptr)->wave_function=wave_function;
 	}
 }
 
@@ -807,12 +818,13 @@ void T2DHole::comp_stimulated_factor(prec band_gap)
 
 void T2DHole::comp_auger_coefficient(void)
 {
+	NormalizeConstants& normalization=context->normalization;
 	prec values[]={ nodes.curr_node_ptr->get_value(GRID_ELECTRICAL,ALLOY_CONC),
 					nodes.curr_node_ptr->get_value(GRID_ELECTRICAL,POSITION,NORMALIZED) };
 
-	auger_coefficient=material_parameters.evaluate(MAT_QW_HOLE_AUGER_COEFFICIENT,
-												   (MaterialType)nodes.curr_node_ptr->get_value(GRID_ELECTRICAL,MATERIAL),
-												   (AlloyType)nodes.curr_node_ptr->get_value(GRID_ELECTRICAL,ALLOY_TYPE),
+	auger_coefficient=context->material_parameters.evaluate(MAT_QW_HOLE_AUGER_COEFFICIENT,
+															(MaterialType)nodes.curr_node_ptr->get_value(GRID_ELECTRICAL,MATERIAL),
+															(AlloyType)nodes.curr_node_ptr->get_value(GRID_ELECTRICAL,ALLOY_TYPE),
 												    values)*sq(normalization.length*normalization.conc)*normalization.time;
 
 }
@@ -834,13 +846,13 @@ prec T2DHole::get_value(flag flag_value, ScaleType scale)
 		default: assert(FALSE); return(0.0);
 	}
 
-	if (scale==UNNORMALIZED) return_value*=get_normalize_value(QW_HOLE,flag_value);
+	if (scale==UNNORMALIZED) return_value*=get_normalize_value(context,QW_HOLE,flag_value);
 	return(return_value);
 }
 
 void T2DHole::put_value(flag flag_value, prec value, ScaleType scale)
 {
-	if (scale==UNNORMALIZED) value/=get_normalize_value(QW_HOLE,flag_value);
+	if (scale==UNNORMALIZED) value/=get_normalize_value(context,QW_HOLE,flag_value);
 
 	switch(flag_value) {
 		case EQUIL_DOS: equil_dos=value; return;
@@ -21,11 +21,15 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <time.h>
+#ifdef __BORLANDC__
 #include <io.h>
 #include <alloc.h>
 #include <fstream.h>
 #include <cstring.h>
 #include <complex.h>
+#else
+#include "simport.h"
+#endif
 #include "simconst.h"
 #include "globfunc.h"
 #include "formulc.h"
@@ -36,4 +40,9 @@
 #include "simmat.h"
 #include "siminf.h"
 #include "simenv.h"
+#include "simctx.h"
+#include "simthrd.h"
+#include "simpred.h"
+#include "simsweep.h"
+#include "simarena.h"
 
@@ -21,27 +21,45 @@
 #define sq(x) ((x)*(x))
 #define round(x) ((int)((((double)(x)-floor(x)) <= 0.5) ? floor(x) : ceil(x)))
 
+class TSimulationContext;
+
 int _matherr(exception *new_error);
 void convert_mantissa_exp(float& mantissa, int& exponent);
 prec bernoulli(prec x);
 prec deriv_bernoulli(prec x);
+void bernoulli_pair(prec x, prec& bern_pos, prec& bern_neg, prec& deriv_pos, prec& deriv_neg);
+void bernoulli_pair(const prec *x, prec *bern_pos, prec *bern_neg, prec *deriv_pos,
+					prec *deriv_neg, int count);
 prec fermi(prec x,prec degeneracy=1.0);
 prec deriv_fermi(prec x,prec degeneracy=1.0);
+void init_fermi_tables(void);
+prec fermi_table_integral(FermiTableOrder order, prec x);
+int fermi_method(TSimulationContext *context, flag effects);
 prec fermi_integral_minus_2_half(prec x);
-prec fermi_integral_minus_1_half(prec x);
+prec fermi_integral_minus_1_half(TSimulationContext *context, prec x);
 prec fermi_integral_0_half(prec x);
-prec fermi_integral_1_half(prec x);
-prec fermi_integral_2_half(prec x);
-prec fermi_integral_3_half(prec x);
-prec fermi_integral_4_half(prec x);
-prec fermi_integral_5_half(prec x);
-prec fermi_integral_6_half(prec x);
-prec fermi_integral_8_half(prec x);
+prec fermi_integral_1_half(TSimulationContext *context, prec x);
+prec fermi_integral_2_half(TSimulationContext *context, prec x);
+prec fermi_integral_3_half(TSimulationContext *context, prec x);
+prec fermi_integral_4_half(TSimulationContext *context, prec x);
+prec fermi_integral_5_half(TSimulationContext *context, prec x);
+prec fermi_integral_6_half(TSimulationContext *context, prec x);
+prec fermi_integral_8_half(TSimulationContext *context, prec x);
+void fermi_integral_minus_1_half(TSimulationContext *context, const prec *x, prec *result, int count);
+void fermi_integral_1_half(TSimulationContext *context, const prec *x, prec *result, int count);
+void fermi_integral_3_half(TSimulationContext *context, const prec *x, prec *result, int count);
+int fermi_vector_width(void);
+logical vector_fermi_integral_minus_1_half(const prec *x, prec *result, int count);
+logical vector_fermi_integral_1_half(const prec *x, prec *result, int count);
+logical vector_fermi_integral_3_half(const prec *x, prec *result, int count);
 prec incomp_gamma(prec x);
 prec log_1_x(prec x);
 prec log_1_div_1_x(prec x);
 prec dilog(prec x);
 prec trilog(prec x);
+void dilog(const prec *x, prec *result, int count);
+void trilog(const prec *x, prec *result, int count);
+void gauss_legendre(int order, prec *node, prec *weight);
 double rnd(void);
 void rnd_init(void);
 void scale(float *data, int points, float& minimum, float& maximum);
@@ -52,7 +70,7 @@ void swap(int& value_1, int& value_2);
 void swap(float& value_1, float& value_2);
 int bit_position(flag flag_value);
 int bit_count(flag flag_value);
-prec get_normalize_value(FlagType flag_type, flag flag_value);
+prec get_normalize_value(TSimulationContext *context, FlagType flag_type, flag flag_value);
 string shorten_path(string long_path);
 string prec_to_string(prec value, int precision, NumberFormat format=NORMAL);
 string int_to_string(int value);
@@ -62,8 +80,8 @@ void long_string_to_flag(string long_string, FlagType& flag_type, flag& flag_val
 void short_string_to_flag(string short_string, FlagType& flag_type, flag& flag_value);
 int material_string_to_value(string material_string);
 string material_value_to_string(int material_value);
-string get_short_location_string(FlagType flag_type, int object_number);
-string get_long_location_string(FlagType flag_type, int object_number);
+string get_short_location_string(TSimulationContext *context, FlagType flag_type, int object_number);
+string get_long_location_string(TSimulationContext *context, FlagType flag_type, int object_number);
 string get_region_string(RegionType region);
 string get_mirror_string(MirrorType mirror);
 string get_cavity_string(CavityType cavity);
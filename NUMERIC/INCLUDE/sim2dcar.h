@@ -19,6 +19,7 @@
 class T2DElectron {
 	friend TBoundElectron;
 protected:
+	TSimulationContext *context;
 	TNode** grid_ptr;
 	QuantumWellNodes nodes;
 	flag qw_effects;
@@ -34,7 +35,7 @@ protected:
 	prec stimulated_factor;
     prec auger_coefficient;
 public:
-	T2DElectron(TNode** grid);
+	T2DElectron(TSimulationContext *new_context, TNode** grid);
 private:
 	prec comp_dos(prec dos_mass, prec temp);
 public:
@@ -62,6 +63,7 @@ public:
 class T2DHole {
 	friend TBoundHole;
 protected:
+	TSimulationContext *context;
 	TNode** grid_ptr;
 	QuantumWellNodes nodes;
 	flag qw_effects;
@@ -78,7 +80,7 @@ protected:
     prec auger_coefficient;
 
 public:
-	T2DHole(TNode** grid);
+	T2DHole(TSimulationContext *new_context, TNode** grid);
 private:
 	prec comp_dos(prec dos_mass, prec temp);
 public:
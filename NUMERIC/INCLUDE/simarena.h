@@ -0,0 +1,58 @@
+/*
+    SimWindows - 1D Semiconductor Device Simulator
+    Copyright (C) 2013 David W. Winston
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/*************************************************************************
+
+Object arena - bump allocator for the objects that live as long as the
+device: the nodes, quantum wells, contacts and surfaces of TDevice and the
+elements of TSolution. Memory comes from a chain of blocks of at least
+ARENA_BLOCK_BYTES and is only given back all at once by release() or the
+destructor, so an object is created with new(arena) and destroyed by
+calling its destructor explicitly, never with delete.
+
+Objects are laid out in the order they are allocated. reserve() makes
+sure the next allocations, up to the given number of bytes as a sum of
+object_size() values, fit in one block, so a grid built in order is also
+contiguous in memory. allocate() returns (void *)0 when out of memory,
+the same as new, and the existing checks on the new pointer still apply.
+
+**************************************************************************/
+
+struct ArenaBlock {
+	ArenaBlock *next_block;
+};
+
+class TObjectArena {
+private:
+	ArenaBlock *first_block;
+	char *next_free;
+	char *block_end;
+public:
+	TObjectArena(void) { first_block=(ArenaBlock *)0; next_free=block_end=(char *)0; }
+	~TObjectArena(void) { release(); }
+	static size_t object_size(size_t bytes)
+		{ return(((bytes+ARENA_ALIGNMENT-1)/ARENA_ALIGNMENT)*ARENA_ALIGNMENT); }
+	logical reserve(size_t bytes);
+	void *allocate(size_t bytes);
+	void release(void);
+private:
+	logical add_block(size_t bytes);
+};
+
+inline void *operator new(size_t bytes, TObjectArena& arena) throw() { return(arena.allocate(bytes)); }
+inline void operator delete(void * /*object*/, TObjectArena& /*arena*/) throw() {}
@@ -36,8 +36,9 @@ public:
 	void comp_equil_dos(void);
 	void comp_non_equil_dos(void);
 
-	prec get_value(flag flag_value, ScaleType scale=UNNORMALIZED);
-	void put_value(flag flag_value, prec value, ScaleType scale=UNNORMALIZED);
+	prec get_value(TSimulationContext *context, flag flag_value, ScaleType scale=UNNORMALIZED);
+	void put_value(TSimulationContext *context, flag flag_value, prec value,
+				   ScaleType scale=UNNORMALIZED);
 
 	void read_state_file(FILE *file_ptr);
 	void write_state_file(FILE *file_ptr);
@@ -63,8 +64,9 @@ public:
 	void comp_equil_dos(void);
 	void comp_non_equil_dos(void);
 
-	prec get_value(flag flag_value, ScaleType scale=UNNORMALIZED);
-	void put_value(flag flag_value, prec value, ScaleType scale=UNNORMALIZED);
+	prec get_value(TSimulationContext *context, flag flag_value, ScaleType scale=UNNORMALIZED);
+	void put_value(TSimulationContext *context, flag flag_value, prec value,
+				   ScaleType scale=UNNORMALIZED);
 
 	void read_state_file(FILE *file_ptr);
 	void write_state_file(FILE *file_ptr);
@@ -0,0 +1,356 @@
+/*
+    SimWindows - 1D Semiconductor Device Simulator
+    Copyright (C) 2013 David W. Winston
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/*************************************************************************
+
+Block tridiagonal solver - LU factorization without pivoting and the
+forward/backward solve of the Jacobians built by TSolution. The number of
+unknowns per node is a template parameter, so all loops inside a node have
+fixed bounds and are unrolled by the compiler.
+
+The Jacobian is kept in one buffer, aligned to JACOBIAN_ALIGNMENT bytes,
+node after node. With V unknowns per node, unknown k of node i is row
+i*V+k and each row holds the 3*V columns of the previous, present and next
+node, so the diagonal of row i*V+k is column V+k and the V rows of a node
+are 3*V*V consecutive values. TBlockJacobian owns the buffer and
+BlockJacobianView gives the rows for a given number of unknowns; the
+buffer is only reallocated when it has to grow.
+
+The factorization works in place on the rows of two nodes at a time and
+leaves the multipliers in place of the lower part. The operations are done
+in the same order as in the general elimination, so the results do not
+depend on the number of unknowns being fixed at compile time.
+
+solution[k] points to the right hand side of unknown k, one value per
+node, and is replaced by the update.
+
+Long systems can be factored in partitions on the worker pool passed to
+factor() (see partition_factor() below). factor() and solve() pick the
+partitioned or the sequential solver; solve() uses the one and the pool
+the last factor() used.
+
+**************************************************************************/
+
+struct BlockJacobianView {
+	prec *data;
+	int variables;
+	prec *get_row(int row_number) { return(data+row_number*3*variables); }
+};
+
+struct BlockPartitionView {
+	prec *data;
+	int unknown_nodes;
+	int partitions;
+	prec *spike;
+	prec *reduced;
+	prec *reduced_solution;
+	prec *workspace;
+	prec **solution;
+};
+
+class TBlockJacobian {
+private:
+	prec *buffer;
+	prec *data;
+	int size;
+	prec *partition_buffer;
+	int partition_size;
+	int partitions;
+	TWorkerPool *partition_pool;
+public:
+	TBlockJacobian(void)
+		{ buffer=data=partition_buffer=(prec *)0; size=partition_size=partitions=0;
+		  partition_pool=(TWorkerPool *)0; }
+	~TBlockJacobian(void) { delete[] buffer; delete[] partition_buffer; }
+	logical allocate(int new_size);
+	BlockJacobianView get_view(int variables);
+	void factor(int variables, int unknown_nodes, int new_partitions, TWorkerPool *pool);
+	void solve(int variables, prec **solution, int unknown_nodes);
+private:
+	logical allocate_partitions(int variables, int unknown_nodes, int new_partitions);
+	BlockPartitionView get_partition_view(int variables, int unknown_nodes);
+};
+
+template <int V> void block_factor(prec *jacobian, int unknown_nodes)
+{
+	int i,k,l,m;
+	logical last_node;
+	prec *current, *next;
+	prec *pivot_row, *row;
+	prec pivot, multiplier;
+
+	current=jacobian;
+	for (i=0;i<unknown_nodes;i++) {
+		last_node=(i==unknown_nodes-1);
+		next=current+3*V*V;
+
+		for (l=0;l<V;l++) {
+			pivot_row=current+l*3*V;
+			pivot=pivot_row[V+l];
+
+// Rows of the present node below the diagonal
+			for (k=l+1;k<V;k++) {
+				row=current+k*3*V;
+				multiplier=row[V+l]/pivot;
+				row[V+l]=multiplier;
+				for (m=l+1;m<V;m++) row[V+m]-=multiplier*pivot_row[V+m];
+				if (!last_node) {
+					for (m=0;m<V;m++) row[2*V+m]-=multiplier*pivot_row[2*V+m];
+				}
+			}
+
+// Rows of the next node
+			if (!last_node) {
+				for (k=0;k<V;k++) {
+					row=next+k*3*V;
+					multiplier=row[l]/pivot;
+					row[l]=multiplier;
+					for (m=l+1;m<V;m++) row[m]-=multiplier*pivot_row[V+m];
+					for (m=0;m<V;m++) row[V+m]-=multiplier*pivot_row[2*V+m];
+				}
+			}
+		}
+		current=next;
+	}
+}
+
+template <int V> void block_solve(prec *jacobian, prec **solution, int unknown_nodes)
+{
+	int i,j,k;
+	prec *row_ptr;
+	prec previous[V], present[V];
+
+//	Forward Solve
+
+	for (j=0;j<V;j++) previous[j]=0.0;
+
+	for (i=0;i<unknown_nodes;i++) {
+		for (k=0;k<V;k++) {
+			row_ptr=jacobian+(i*V+k)*3*V;
+			present[k]=solution[k][i];
+
+			if (i!=0) {
+				for (j=0;j<V;j++) present[k]-=row_ptr[j]*previous[j];
+			}
+			for (j=0;j<k;j++) present[k]-=row_ptr[V+j]*present[j];
+		}
+		for (k=0;k<V;k++) {
+			solution[k][i]=present[k];
+			previous[k]=present[k];
+		}
+	}
+
+//	Backward Solve
+
+	for (i=unknown_nodes-1;i>=0;i--) {
+		for (k=V-1;k>=0;k--) {
+			row_ptr=jacobian+(i*V+k)*3*V;
+			present[k]=solution[k][i];
+
+			if (i!=unknown_nodes-1) {
+				for (j=V-1;j>=0;j--) present[k]-=row_ptr[2*V+j]*previous[j];
+			}
+			for (j=V-1;j>k;j--) present[k]-=row_ptr[V+j]*present[j];
+
+			present[k]/=row_ptr[V+k];
+		}
+		for (k=0;k<V;k++) {
+			solution[k][i]=present[k];
+			previous[k]=present[k];
+		}
+	}
+}
+
+/*************************************************************************
+
+Partitioned solver - the nodes are split into partitions of consecutive
+nodes and the last node of every partition but the last is kept as a
+separator. With the separators removed the partitions are independent
+block tridiagonal systems, each factored with block_factor() on its own
+task. The coupling of the first node of a partition to the separator
+before it, and of the last node to the separator after it, is solved
+through the partition as a spike (V columns each). Only the first and last
+node of each spike are kept: together with the separator rows they give a
+block tridiagonal system of the separators alone, the reduced system,
+which is small and factored serially.
+
+The solve is the same in three steps: the partitions are solved with the
+right hand side alone (in parallel), the reduced system gives the
+separators (serially) and the partitions are solved again with the
+separators moved to the right hand side (in parallel).
+
+The factoring of a partition leaves the first block of its first row and
+the last block of its last row as they were, so the couplings to the
+separators are read from the Jacobian itself. The partitions only depend
+on the number of nodes and partitions, so the results do not depend on
+the number of workers.
+
+Spikes of partition p are stored in 4*V*V values: the first and last node
+of the spike of the separator before it, then the first and last node of
+the spike of the separator after it, each a VxV block by rows. The
+workspace holds V columns of unknown_nodes values.
+
+**************************************************************************/
+
+inline void partition_nodes(BlockPartitionView *view, int partition, int& first, int& last)
+{
+	first=(int)(((long)view->unknown_nodes*partition)/view->partitions);
+	last=(int)(((long)view->unknown_nodes*(partition+1))/view->partitions)-1;
+	if (partition<view->partitions-1) last--;
+}
+
+template <int V> void partition_spike(prec *partition_data, prec **column, int nodes,
+									  int coupling_node, int coupling_offset,
+									  prec *spike_first, prec *spike_last)
+{
+	int i,k,c;
+
+	for (c=0;c<V;c++) {
+		for (k=0;k<V;k++) {
+			for (i=0;i<nodes;i++) column[k][i]=0.0;
+			column[k][coupling_node]=partition_data[(coupling_node*V+k)*3*V+coupling_offset+c];
+		}
+		block_solve<V>(partition_data,column,nodes);
+		for (k=0;k<V;k++) {
+			spike_first[k*V+c]=column[k][0];
+			spike_last[k*V+c]=column[k][nodes-1];
+		}
+	}
+}
+
+template <int V> void partition_factor_task(void *task_data, int partition)
+{
+	int k,first,last;
+	prec *partition_data, *spike;
+	prec *column[V];
+	BlockPartitionView *view=(BlockPartitionView *)task_data;
+
+	partition_nodes(view,partition,first,last);
+	partition_data=view->data+first*3*V*V;
+	spike=view->spike+partition*4*V*V;
+	for (k=0;k<V;k++) column[k]=view->workspace+k*view->unknown_nodes+first;
+
+	block_factor<V>(partition_data,last-first+1);
+	if (partition>0)
+		partition_spike<V>(partition_data,column,last-first+1,0,0,spike,spike+V*V);
+	if (partition<view->partitions-1)
+		partition_spike<V>(partition_data,column,last-first+1,last-first,2*V,
+						   spike+2*V*V,spike+3*V*V);
+}
+
+template <int V> void partition_factor(BlockPartitionView *view, TWorkerPool *pool)
+{
+	int i,j,k,m,first,last,separators;
+	prec *row_ptr, *reduced_ptr, *before, *after;
+
+	pool->run(partition_factor_task<V>,view,view->partitions);
+
+	separators=view->partitions-1;
+	for (k=0;k<separators;k++) {
+		partition_nodes(view,k,first,last);
+		row_ptr=view->data+(last+1)*3*V*V;
+		reduced_ptr=view->reduced+k*3*V*V;
+		before=view->spike+k*4*V*V;
+		after=view->spike+(k+1)*4*V*V;
+
+		for (i=0;i<V;i++) {
+			for (j=0;j<V;j++) {
+				reduced_ptr[i*3*V+j]=0.0;
+				reduced_ptr[i*3*V+V+j]=row_ptr[i*3*V+V+j];
+				reduced_ptr[i*3*V+2*V+j]=0.0;
+				for (m=0;m<V;m++) {
+					reduced_ptr[i*3*V+V+j]-=row_ptr[i*3*V+m]*before[3*V*V+m*V+j]+
+											row_ptr[i*3*V+2*V+m]*after[m*V+j];
+					if (k>0) reduced_ptr[i*3*V+j]-=row_ptr[i*3*V+m]*before[V*V+m*V+j];
+					if (k<separators-1) reduced_ptr[i*3*V+2*V+j]-=row_ptr[i*3*V+2*V+m]*after[2*V*V+m*V+j];
+				}
+			}
+		}
+	}
+	block_factor<V>(view->reduced,separators);
+}
+
+template <int V> void partition_forward_task(void *task_data, int partition)
+{
+	int i,k,first,last;
+	prec *column[V];
+	BlockPartitionView *view=(BlockPartitionView *)task_data;
+
+	partition_nodes(view,partition,first,last);
+	for (k=0;k<V;k++) {
+		column[k]=view->workspace+k*view->unknown_nodes+first;
+		for (i=first;i<=last;i++) column[k][i-first]=view->solution[k][i];
+	}
+	block_solve<V>(view->data+first*3*V*V,column,last-first+1);
+}
+
+template <int V> void partition_back_task(void *task_data, int partition)
+{
+	int k,m,first,last;
+	prec *row_ptr;
+	prec *column[V];
+	BlockPartitionView *view=(BlockPartitionView *)task_data;
+
+	partition_nodes(view,partition,first,last);
+	if (partition>0) {
+		for (k=0;k<V;k++) {
+			row_ptr=view->data+(first*V+k)*3*V;
+			for (m=0;m<V;m++) view->solution[k][first]-=row_ptr[m]*view->solution[m][first-1];
+		}
+	}
+	if (partition<view->partitions-1) {
+		for (k=0;k<V;k++) {
+			row_ptr=view->data+(last*V+k)*3*V;
+			for (m=0;m<V;m++) view->solution[k][last]-=row_ptr[2*V+m]*view->solution[m][last+1];
+		}
+	}
+	for (k=0;k<V;k++) column[k]=view->solution[k]+first;
+	block_solve<V>(view->data+first*3*V*V,column,last-first+1);
+}
+
+template <int V> void partition_solve(BlockPartitionView *view, prec **solution, TWorkerPool *pool)
+{
+	int i,k,m,first,last,separators;
+	prec *row_ptr, *workspace;
+	prec *reduced_column[V];
+
+	view->solution=solution;
+	workspace=view->workspace;
+	pool->run(partition_forward_task<V>,view,view->partitions);
+
+	separators=view->partitions-1;
+	for (k=0;k<V;k++) reduced_column[k]=view->reduced_solution+k*separators;
+	for (i=0;i<separators;i++) {
+		partition_nodes(view,i,first,last);
+		for (k=0;k<V;k++) {
+			row_ptr=view->data+((last+1)*V+k)*3*V;
+			reduced_column[k][i]=solution[k][last+1];
+			for (m=0;m<V;m++)
+				reduced_column[k][i]-=row_ptr[m]*workspace[m*view->unknown_nodes+last]+
+									  row_ptr[2*V+m]*workspace[m*view->unknown_nodes+last+2];
+		}
+	}
+	block_solve<V>(view->reduced,reduced_column,separators);
+	for (i=0;i<separators;i++) {
+		partition_nodes(view,i,first,last);
+		for (k=0;k<V;k++) solution[k][last+1]=reduced_column[k][i];
+	}
+
+	pool->run(partition_back_task<V>,view,view->partitions);
+}
+
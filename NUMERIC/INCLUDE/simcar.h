@@ -44,18 +44,18 @@ protected:
 	long collision_factor;
 
 public:
-	TElectron(RegionType region, TQuantumWell *qw_ptr);
+	TElectron(TSimulationContext *new_context, RegionType region, TQuantumWell *qw_ptr);
 
 // Comp functions
 	void comp_auger_coefficient(MaterialSpecification material, prec position);
 	void comp_auger_hotcarriers(prec intrinsic_conc, prec hole_conc,
-    							prec hole_auger_coeff, prec rec_auger);
-	void comp_b_b_hotcarriers(prec rec_b_b);
+    							prec hole_auger_coeff, prec rec_auger, prec fermi_ratio=0.0);
+	void comp_b_b_hotcarriers(prec rec_b_b, prec fermi_ratio=0.0);
 	void comp_kin_optical_generation_hotcarriers(prec rec_opt_gen, prec inc_pho_ene,
 												 prec band_gap, prec r_dos_mass);
 	void comp_ref_optical_generation_hotcarriers(prec rec_opt_gen);
 	void comp_stim_hotcarriers(prec rec_stim, prec r_dos_mass, prec band_gap, prec inc_pho_ene);
-	void comp_relax_hotcarriers(prec lat_temp);
+	void comp_relax_hotcarriers(prec lat_temp, prec fermi_ratio=0.0);
 	void comp_shr_hotcarriers(prec intrinsic_conc, prec lattice_temp, prec hole_conc,
 							  prec hole_shr_lifetime, prec shr_recomb);
 	void comp_total_hotcarriers(void);
@@ -63,12 +63,18 @@ public:
 	void comp_cond_mass(MaterialSpecification material, prec position);
 	void comp_collision_factor(MaterialSpecification material, prec position);
 	void comp_current(int start_node_number, int node_number,
-					  float position, prec recombination_total);
+					  float position, prec recombination_total, CurrentSweep& sweep);
 	void comp_deriv_conc(void);
+	void comp_fermi_conc(prec fermi_1_half)
+		{ TFreeElectron::comp_fermi_conc(fermi_1_half); total_conc=TFreeElectron::concentration; }
+	void comp_fermi_deriv_conc(prec fermi_minus_1_half)
+		{ TFreeElectron::comp_fermi_deriv_conc(fermi_minus_1_half);
+		  total_deriv_conc_eta_c=TFreeElectron::deriv_conc_eta_c; }
 	void comp_deriv_ionized_doping(void);
 	void comp_deriv_hotcarriers(Recombination recombination, prec lat_temp,
 								prec intrinsic_conc, prec hole_conc,
-                                prec hole_shr_lifetime, prec hole_auger_coeff);
+                                prec hole_shr_lifetime, prec hole_auger_coeff, prec fermi_ratio=0.0);
+	prec fermi_energy_ratio(prec fermi_ratio);
 	void comp_dos_mass(MaterialSpecification material, prec position);
 	void comp_equil_dos(prec lat_temp);
 	void comp_non_equil_dos(void);
@@ -83,6 +89,7 @@ public:
 								prec band_gap);
 	void comp_ionized_doping(void);
 	void store_temperature(void) { stored_temperature=temperature; }
+	logical bulk_fermi_dirac(void) { return(!qw_ptr && (effects & GRID_FERMI_DIRAC)); }
 
 	//Init functions
 	void init_conc(void);
@@ -125,18 +132,18 @@ protected:
 	long collision_factor;
 
 public:
-	THole(RegionType region, TQuantumWell *qw_ptr);
+	THole(TSimulationContext *new_context, RegionType region, TQuantumWell *qw_ptr);
 
 // Comp functions
 	void comp_auger_coefficient(MaterialSpecification material, prec position);
 	void comp_auger_hotcarriers(prec intrinsic_conc, prec electron_conc,
-    						    prec electron_auger_coeff, prec rec_auger);
-	void comp_b_b_hotcarriers(prec rec_b_b);
+    						    prec electron_auger_coeff, prec rec_auger, prec fermi_ratio=0.0);
+	void comp_b_b_hotcarriers(prec rec_b_b, prec fermi_ratio=0.0);
 	void comp_kin_optical_generation_hotcarriers(prec rec_opt_gen, prec inc_pho_ene,
 											 prec band_gap, prec r_dos_mass);
 	void comp_ref_optical_generation_hotcarriers(prec rec_opt_gen);
 	void comp_stim_hotcarriers(prec rec_stim, prec r_dos_mass, prec band_gap, prec inc_pho_ene);
-	void comp_relax_hotcarriers(prec lat_temp);
+	void comp_relax_hotcarriers(prec lat_temp, prec fermi_ratio=0.0);
 	void comp_shr_hotcarriers(prec intrinsic_conc, prec lattice_temp, prec electron_conc,
 							  prec electron_shr_lifetime, prec shr_recomb);
 	void comp_total_hotcarriers(void);
@@ -144,12 +151,18 @@ public:
 	void comp_cond_mass(MaterialSpecification material, prec position);
 	void comp_collision_factor(MaterialSpecification material, prec position);
 	void comp_current(int start_node_number, int node_number,
-					  float position, prec recombination_total);
+					  float position, prec recombination_total, CurrentSweep& sweep);
 	void comp_deriv_conc(void);
+	void comp_fermi_conc(prec fermi_1_half)
+		{ TFreeHole::comp_fermi_conc(fermi_1_half); total_conc=TFreeHole::concentration; }
+	void comp_fermi_deriv_conc(prec fermi_minus_1_half)
+		{ TFreeHole::comp_fermi_deriv_conc(fermi_minus_1_half);
+		  total_deriv_conc_eta_v=TFreeHole::deriv_conc_eta_v; }
 	void comp_deriv_ionized_doping(void);
 	void comp_deriv_hotcarriers(Recombination recombination, prec lat_temp,
     							prec intrinsic_conc, prec electron_conc,
-                                prec electron_shr_lifetime, prec electron_auger_coeff);
+                                prec electron_shr_lifetime, prec electron_auger_coeff, prec fermi_ratio=0.0);
+	prec fermi_energy_ratio(prec fermi_ratio);
 	void comp_dos_mass(MaterialSpecification material, prec position);
 	void comp_equil_dos(prec lat_temp);
 	void comp_non_equil_dos(void);
@@ -164,6 +177,7 @@ public:
 								prec band_gap);
 	void comp_ionized_doping(void);
 	void store_temperature(void) { stored_temperature=temperature; }
+	logical bulk_fermi_dirac(void) { return(!qw_ptr && (effects & GRID_FERMI_DIRAC)); }
 
 // Init functions
 	void init_conc(void);
@@ -18,6 +18,7 @@
 
 class TCavity {
 private:
+	TSimulationContext *context;
 	CavityType type;
 	prec area;
 	prec length;
@@ -25,7 +26,7 @@ private:
 	TMirror mirror_0;
 	TMirror mirror_1;
 public:
-	TCavity(TDevice *ptr, TNode** grid);
+	TCavity(TSimulationContext *new_context, TDevice *ptr, TNode** grid);
 	void init(void);
 
 	error field_iterate(prec& iteration_error, prec initial_error, int iteration_number);
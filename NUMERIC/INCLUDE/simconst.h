@@ -83,6 +83,13 @@ enum MacroType { VOLTAGE_MACRO=1 };
 enum ElementSide { FIRSTHALF, SECONDHALF };
 enum NodeSide { PREVIOUS_NODE=1, CURRENT_NODE, NEXT_NODE };
 enum ValidatorType { INCLUSIVE, EXCLUSIVE };
+enum PredictorType { PREDICT_NONE, PREDICT_LINEAR, PREDICT_QUADRATIC, PREDICT_TANGENT };
+enum DualVariable { DUAL_PREV_PSI, DUAL_PREV_ETA, DUAL_NEXT_PSI, DUAL_NEXT_ETA };
+enum QuadratureType { QUAD_TRAPEZOID, QUAD_GAUSS_LEGENDRE, QUAD_GAUSS_KRONROD };
+enum AssemblyPass { ASSEMBLE_ELECTRICAL_VALUES, ASSEMBLE_ELECTRICAL_DERIVATIVES, ASSEMBLE_ELECTRICAL_SOLUTION,
+					ASSEMBLE_ELECTRICAL_JACOBIAN, ASSEMBLE_THERMAL_SOLUTION, ASSEMBLE_THERMAL_JACOBIAN };
+enum FermiTableOrder { FERMI_TABLE_MINUS_1_HALF, FERMI_TABLE_1_HALF, FERMI_TABLE_2_HALF, FERMI_TABLE_3_HALF,
+					   FERMI_TABLE_4_HALF, FERMI_TABLE_5_HALF, FERMI_TABLE_6_HALF, FERMI_TABLE_8_HALF };
 
 #ifndef NULL
 	#define NULL	0
@@ -112,12 +119,94 @@ enum ValidatorType { INCLUSIVE, EXCLUSIVE };
 	#define MAXEXT  5
 #endif
 
+// Storage class for data owned by the calling thread
+#ifdef _MSC_VER
+	#define SIM_THREAD_LOCAL	__declspec(thread)
+#else
+	#define SIM_THREAD_LOCAL	__thread
+#endif
+
 #define MAX_NUMBER_PLOTS	6
 #define MAX_LABEL_LENGTH	30
 #define MAX_TITLE_LENGTH	50
 #define MAX_MATERIAL_NAME	30
 #define MAX_ALLOY_NAME		30
 
+// Bias sweep parameters
+#define SWEEP_COARSE_ERROR_FACTOR	100.0
+#define SWEEP_MAX_COARSE_SPLITS		4
+#define MAX_PREDICTOR_POINTS		3
+#define SWEEP_MIN_STEP_FACTOR		(1.0/64.0)
+#define SWEEP_MAX_STEP_FACTOR		8.0
+#define SWEEP_GROW_ITERATIONS		4
+#define SWEEP_MAX_DEVIATION			0.5
+#define SWEEP_MAX_MONITORS			2
+
+// Jacobian storage parameters
+#define JACOBIAN_ALIGNMENT			64				// bytes
+#define MAX_ELECT_VARIABLES			3
+
+// Object arena parameters
+#define ARENA_BLOCK_BYTES			16384
+#define ARENA_ALIGNMENT				16				// bytes
+
+// Line search parameters
+#define LINE_SEARCH_DECREASE		1e-4
+#define LINE_SEARCH_REDUCTION		0.5
+#define LINE_SEARCH_MAX_CLAMPS		4.0
+
+// Coupled electro-thermal and photon solve parameters (psi, eta_c, eta_v and the
+// lattice temperature; carrier temperatures are not coupled)
+#define COUPLED_VARIABLES			4
+#define COUPLED_PERTURBATION		1e-7
+#define PHOTON_MIN_FRACTION			0.1
+
+// Anderson mixing parameters
+#define MAX_ANDERSON_DEPTH			10
+#define ANDERSON_PIVOT_RATIO		1e-12
+#define ANDERSON_MIN_RATIO			0.2
+
+// Element kernel parameters
+#define ELEMENT_DUAL_VARIABLES		4
+
+// Tunneling quadrature parameters
+#define MAX_TUNNEL_QUAD_ORDER		32
+#define MAX_TUNNEL_QUAD_DEPTH		12
+
+// Parallel assembly parameters
+#define DEFAULT_ASSEMBLY_MIN_NODES	4000
+#define MAX_ASSEMBLY_BLOCKS			64
+
+// Partitioned solver parameters
+#define DEFAULT_PARTITION_MIN_NODES	0
+#define MIN_PARTITION_NODES			256
+#define MAX_BLOCK_PARTITIONS		64
+
+// Parallel node property parameters
+#define DEFAULT_PROPERTY_MIN_NODES	4000
+#define PROPERTY_CHUNK_ALIGNMENT	64				// bytes
+
+// Fermi integral batch parameters
+#define FERMI_BATCH_NODES			64
+
+// Bernoulli function parameters
+#define BERNOULLI_SERIES_LIMIT		0.2
+#define BERNOULLI_BATCH_ELEMENTS	64
+
+// Polylogarithm parameters
+#define DILOG_SERIES_LIMIT			0.125
+#define TRILOG_SERIES_LIMIT			0.25
+
+// Fermi integral table parameters
+#define FERMI_TABLE_ORDERS			8
+#define FERMI_TABLE_POINTS			401
+#define FERMI_TABLE_MIN				-10.0
+#define FERMI_TABLE_MAX				30.0
+#define FERMI_TABLE_STEP			0.1
+#define FERMI_TABLE_QUAD_ORDER		16
+#define FERMI_TABLE_QUAD_PANELS		48
+#define FERMI_TABLE_QUAD_TAIL		60.0
+
 // MARGIN parameters
 #define LEFT_MARGIN   70
 #define RIGHT_MARGIN  35
@@ -136,7 +225,8 @@ enum ValidatorType { INCLUSIVE, EXCLUSIVE };
 
 // SIM parameters.
 #define SIM_pi   		3.14159265358979323846
-#define SIM_trilog_1    1.20205690
+#define SIM_dilog_1     1.64493406684822643647
+#define SIM_trilog_1    1.20205690315959428540
 #define SIM_sqrtpi  	1.77245385091
 #define SIM_q    		1.6021892E-19					// C
 #define SIM_mo   		9.109534E-31					// kg
@@ -365,11 +455,15 @@ enum FlagCombo { COMBO_BAND, COMBO_RECOMB, COMBO_ELECTROSTATICS,
 #define ENV_SPEC_LEFT_INCIDENT		0x00000010L
 #define ENV_UNDO_SIMULATION			0x00000020L
 #define ENV_CLAMP_TEMPERATURE		0x00000040L
+#define ENV_COUPLED_THERMAL			0x00000080L
+#define ENV_COUPLED_PHOTONS			0x00000100L
+#define ENV_FERMI_TABLE				0x00000200L
 
 #define ENV_EFFECTS_ALL             ENV_OPTICAL_GEN	| ENV_INCIDENT_REFLECTION | ENV_CLAMP_POTENTIAL | \
 									ENV_SPEC_ENTIRE_DEVICE | ENV_SPEC_LEFT_INCIDENT | ENV_UNDO_SIMULATION | \
-									ENV_CLAMP_TEMPERATURE
-#define ENV_EFFECTS_MAX             ENV_CLAMP_TEMPERATURE
+									ENV_CLAMP_TEMPERATURE | ENV_COUPLED_THERMAL | ENV_COUPLED_PHOTONS | \
+									ENV_FERMI_TABLE
+#define ENV_EFFECTS_MAX             ENV_FERMI_TABLE
 
 //************************************* Value Flags ********************************************
 
@@ -1075,12 +1169,22 @@ enum FlagCombo { COMBO_BAND, COMBO_RECOMB, COMBO_ELECTROSTATICS,
 #define MAX_INNER_MODE_ITER		0x00010000L
 #define TEMP_CLAMP_VALUE		0x00020000L
 #define TEMP_RELAX_VALUE		0x00040000L
+#define NEWTON_REFACTOR_RATIO	0x00080000L
+#define MAX_LINE_SEARCH_ITER	0x00100000L
+#define ANDERSON_DEPTH			0x00200000L
+#define TUNNEL_QUAD_ORDER		0x00400000L
+#define TUNNEL_QUAD_TOLERANCE	0x00800000L
+#define ASSEMBLY_MIN_NODES		0x01000000L
+#define PARTITION_MIN_NODES		0x02000000L
+#define PROPERTY_MIN_NODES		0x04000000L
 
 #define ENVIRONMENT_ALL			POT_CLAMP_VALUE | EFFECTS | SPEC_START_POSITION | SPEC_END_POSITION | \
 								SPECTRUM_MULTIPLIER | TEMPERATURE | MAX_ELECTRICAL_ERROR | MAX_THERMAL_ERROR | \
 								MAX_OPTIC_ERROR | COARSE_MODE_ERROR | FINE_MODE_ERROR | RADIUS | \
 								MAX_INNER_ELECT_ITER | MAX_INNER_THERM_ITER | MAX_OUTER_OPTIC_ITER	| MAX_OUTER_THERM_ITER | \
-								MAX_INNER_MODE_ITER | TEMP_CLAMP_VALUE | TEMP_RELAX_VALUE
+								MAX_INNER_MODE_ITER | TEMP_CLAMP_VALUE | TEMP_RELAX_VALUE | NEWTON_REFACTOR_RATIO | \
+								MAX_LINE_SEARCH_ITER | ANDERSON_DEPTH | TUNNEL_QUAD_ORDER | TUNNEL_QUAD_TOLERANCE | \
+								ASSEMBLY_MIN_NODES | PARTITION_MIN_NODES | PROPERTY_MIN_NODES
 
 #define ENVIRONMENT_PLOT		VALUE_NONE
 
@@ -1088,11 +1192,13 @@ enum FlagCombo { COMBO_BAND, COMBO_RECOMB, COMBO_ELECTROSTATICS,
 								SPECTRUM_MULTIPLIER | TEMPERATURE | MAX_ELECTRICAL_ERROR | MAX_THERMAL_ERROR | \
 								MAX_OPTIC_ERROR | COARSE_MODE_ERROR | FINE_MODE_ERROR | RADIUS | \
 								MAX_INNER_ELECT_ITER | MAX_INNER_THERM_ITER | MAX_OUTER_OPTIC_ITER	| MAX_OUTER_THERM_ITER | \
-								MAX_INNER_MODE_ITER  | TEMP_CLAMP_VALUE | TEMP_RELAX_VALUE
+								MAX_INNER_MODE_ITER  | TEMP_CLAMP_VALUE | TEMP_RELAX_VALUE | NEWTON_REFACTOR_RATIO | \
+								MAX_LINE_SEARCH_ITER | ANDERSON_DEPTH | TUNNEL_QUAD_ORDER | TUNNEL_QUAD_TOLERANCE | \
+								ASSEMBLY_MIN_NODES | PARTITION_MIN_NODES | PROPERTY_MIN_NODES
 
 #define ENVIRONMENT_MACRO		VALUE_NONE
 
-#define ENVIRONMENT_MAX			TEMP_RELAX_VALUE
+#define ENVIRONMENT_MAX			PROPERTY_MIN_NODES
 
 // SPECTRAL Values
 #define INCIDENT_PHOTON_ENERGY		0x00000020L
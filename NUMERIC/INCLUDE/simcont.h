@@ -18,6 +18,7 @@
 
 class TContact {
 private:
+	TSimulationContext *context;
 	TNode *contact_node;
 	int contact_node_number;
 	TNode *second_node;
@@ -32,7 +33,7 @@ private:
     prec barrier_height;
 
 public:
-	TContact(TNode* contact_node_ptr, TNode* next_node_ptr);
+	TContact(TSimulationContext *new_context, TNode* contact_node_ptr, TNode* next_node_ptr);
 	void init(void);
 
 	void comp_built_pot(void);
@@ -0,0 +1,63 @@
+/*
+    SimWindows - 1D Semiconductor Device Simulator
+    Copyright (C) 2013 David W. Winston
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/*************************************************************************
+
+Simulation context - owns everything one simulation needs: the environment
+(and through it the device), the material parameters, the error handler
+and the normalization constants. The objects of a simulation keep a
+pointer to their context and pass it on to the objects they create, so
+independent devices can be solved on separate threads. current_context is
+the context of the user interface on each thread, the default context
+unless another one has been bound with TContextBinding. It is read by the
+drivers and by the value objects that are copied without a context (the
+material models, the device input and the user functions), and it is only
+bound where work enters a worker thread or a sweep chunk.
+Convergence output is only reported for contexts with report_progress set.
+The worker pool of the parallel assembly and of the partitioned solver is
+created with the first use and kept for the life of the context.
+
+**************************************************************************/
+
+class TSimulationContext {
+public:
+	TEnvironment environment;
+	TMaterialStorage material_parameters;
+	TErrorHandler error_handler;
+	NormalizeConstants normalization;
+	logical report_progress;
+private:
+	TWorkerPool *worker_pool;
+
+public:
+	TSimulationContext(void);
+	~TSimulationContext(void);
+	TWorkerPool *get_worker_pool(void);
+};
+
+extern TSimulationContext default_context;
+extern SIM_THREAD_LOCAL TSimulationContext *current_context;
+
+class TContextBinding {
+private:
+	TSimulationContext *previous_context;
+public:
+	TContextBinding(TSimulationContext *context)
+		{ assert(context); previous_context=current_context; current_context=context; }
+	~TContextBinding(void) { current_context=previous_context; }
+};
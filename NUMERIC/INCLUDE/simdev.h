@@ -34,6 +34,7 @@ private:
 	prec curr_therm_error;
 	short grid_points;
 	TNode **grid_ptr;
+	TObjectArena object_arena;
 	short quantum_wells;
 	TQuantumWell **qw_ptr;
 	short number_contacts;
@@ -42,11 +43,18 @@ private:
 	TSurface **surface_ptr;
 	TCavity *cavity_ptr;
 	TSolution *solution_ptr;
+	TSimulationContext *context;
+	TunnelQuadrature tunnel_quadrature;
+	FlagType grid_value_type;
+	flag grid_value_flag;
+	int grid_value_first;
+	int grid_value_last;
+	int grid_value_chunks;
 
 // Constructor/Destructor
 public:
-	TDevice(TDeviceFileInput new_device_input);
-	TDevice(FILE *file_ptr);
+	TDevice(TSimulationContext *new_context, TDeviceFileInput new_device_input);
+	TDevice(TSimulationContext *new_context, FILE *file_ptr);
 	~TDevice(void);
 
 // get_value/put_value functions.
@@ -78,6 +86,12 @@ public:
 					int start_object=-1, int end_object=-1);
 private:
 	void comp_grid_value(FlagType flag_type, flag flag_value, int start_object, int end_object);
+	static logical grid_value_serial(FlagType flag_type, flag flag_value);
+	static logical grid_value_batched(FlagType flag_type, flag flag_value);
+	static void grid_value_task(void *device, int chunk_number);
+	void comp_grid_value_chunk(int chunk_number);
+	int align_grid_node(int node);
+	void comp_grid_conc(FlagType flag_type, int start_object, int end_object);
 	void comp_current(void);
 	void comp_field(void);
 	void comp_optical_generation(int start_object, int end_object);
@@ -99,9 +113,17 @@ public:
 	void enable_modified(logical enable) { modified=enable; }
 	void solve(void);
 	void update_solution_param(void);
+	void update_temperature_param(void);
+	int get_solution_size(void);
+	void get_solution(prec *solution);
+	void put_solution(prec *solution);
+	void predict_solution(void);
+	TunnelQuadrature& get_tunnel_quadrature(void) { return(tunnel_quadrature); }
+	TSimulationContext *get_context(void) { return(context); }
 private:
 	void establish_grid(void);
 	void process_input_param(void);
+	void init_tunnel_quadrature(void);
 };
 
 
@@ -0,0 +1,202 @@
+/*
+    SimWindows - 1D Semiconductor Device Simulator
+    Copyright (C) 2013 David W. Winston
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/*************************************************************************
+
+Forward mode dual numbers for the electrical element kernels. A
+DualNumber<N> holds a value and its partial derivatives with respect to N
+independent variables, and the operators below carry the partials along by
+the chain rule. A kernel written once for a template type T gives only the
+value when it is instantiated with prec, and the value together with all
+its partials when it is instantiated with a DualNumber, so the residual and
+the Jacobian come from the same expressions.
+
+dual_seed() and dual_add_partial() set up the independent variables and
+dual_compose() applies a function whose value and derivative are already
+known, as with the Bernoulli functions stored by TElectricalServices. All
+three only copy the value when used on a prec. dual_value() gives the value
+of either type.
+
+The element currents use ELEMENT_DUAL_VARIABLES partials, ordered as in
+DualVariable: psi and the Planck potential of the carrier on the previous
+node, then the same two on the next node.
+
+**************************************************************************/
+
+template <int N> struct DualNumber {
+	prec value;
+	prec deriv[N];
+	DualNumber(void) {}
+	DualNumber(prec x) { int i; value=x; for (i=0;i<N;i++) deriv[i]=0.0; }
+};
+
+typedef DualNumber<ELEMENT_DUAL_VARIABLES> ElementDual;
+
+inline void dual_seed(prec& x, prec value, int /*variable*/, prec /*deriv*/) { x=value; }
+inline void dual_add_partial(prec& /*x*/, int /*variable*/, prec /*deriv*/) {}
+inline prec dual_compose(prec value, prec /*deriv*/, prec /*x*/) { return(value); }
+inline prec dual_value(prec x) { return(x); }
+
+template <int N> inline void dual_seed(DualNumber<N>& x, prec value, int variable, prec deriv)
+{
+	int i;
+
+	x.value=value;
+	for (i=0;i<N;i++) x.deriv[i]=0.0;
+	x.deriv[variable]=deriv;
+}
+
+template <int N> inline void dual_add_partial(DualNumber<N>& x, int variable, prec deriv)
+{
+	x.deriv[variable]+=deriv;
+}
+
+template <int N> inline prec dual_value(const DualNumber<N>& x)
+{
+	return(x.value);
+}
+
+template <int N> inline DualNumber<N> dual_compose(prec value, prec deriv, const DualNumber<N>& x)
+{
+	int i;
+	DualNumber<N> result;
+
+	result.value=value;
+	for (i=0;i<N;i++) result.deriv[i]=deriv*x.deriv[i];
+	return(result);
+}
+
+template <int N> inline DualNumber<N> operator-(const DualNumber<N>& x)
+{
+	int i;
+	DualNumber<N> result;
+
+	result.value=-x.value;
+	for (i=0;i<N;i++) result.deriv[i]=-x.deriv[i];
+	return(result);
+}
+
+template <int N> inline DualNumber<N> operator+(const DualNumber<N>& x, const DualNumber<N>& y)
+{
+	int i;
+	DualNumber<N> result;
+
+	result.value=x.value+y.value;
+	for (i=0;i<N;i++) result.deriv[i]=x.deriv[i]+y.deriv[i];
+	return(result);
+}
+
+template <int N> inline DualNumber<N> operator+(const DualNumber<N>& x, prec y)
+{
+	DualNumber<N> result=x;
+
+	result.value+=y;
+	return(result);
+}
+
+template <int N> inline DualNumber<N> operator+(prec x, const DualNumber<N>& y)
+{
+	DualNumber<N> result=y;
+
+	result.value=x+y.value;
+	return(result);
+}
+
+template <int N> inline DualNumber<N> operator-(const DualNumber<N>& x, const DualNumber<N>& y)
+{
+	int i;
+	DualNumber<N> result;
+
+	result.value=x.value-y.value;
+	for (i=0;i<N;i++) result.deriv[i]=x.deriv[i]-y.deriv[i];
+	return(result);
+}
+
+template <int N> inline DualNumber<N> operator-(const DualNumber<N>& x, prec y)
+{
+	DualNumber<N> result=x;
+
+	result.value-=y;
+	return(result);
+}
+
+template <int N> inline DualNumber<N> operator-(prec x, const DualNumber<N>& y)
+{
+	int i;
+	DualNumber<N> result;
+
+	result.value=x-y.value;
+	for (i=0;i<N;i++) result.deriv[i]=-y.deriv[i];
+	return(result);
+}
+
+template <int N> inline DualNumber<N> operator*(const DualNumber<N>& x, const DualNumber<N>& y)
+{
+	int i;
+	DualNumber<N> result;
+
+	result.value=x.value*y.value;
+	for (i=0;i<N;i++) result.deriv[i]=x.deriv[i]*y.value+x.value*y.deriv[i];
+	return(result);
+}
+
+template <int N> inline DualNumber<N> operator*(const DualNumber<N>& x, prec y)
+{
+	int i;
+	DualNumber<N> result;
+
+	result.value=x.value*y;
+	for (i=0;i<N;i++) result.deriv[i]=x.deriv[i]*y;
+	return(result);
+}
+
+template <int N> inline DualNumber<N> operator*(prec x, const DualNumber<N>& y)
+{
+	int i;
+	DualNumber<N> result;
+
+	result.value=x*y.value;
+	for (i=0;i<N;i++) result.deriv[i]=x*y.deriv[i];
+	return(result);
+}
+
+template <int N> inline DualNumber<N> operator/(const DualNumber<N>& x, prec y)
+{
+	int i;
+	DualNumber<N> result;
+
+	result.value=x.value/y;
+	for (i=0;i<N;i++) result.deriv[i]=x.deriv[i]/y;
+	return(result);
+}
+
+template <int N> inline DualNumber<N>& operator+=(DualNumber<N>& x, const DualNumber<N>& y)
+{
+	int i;
+
+	x.value+=y.value;
+	for (i=0;i<N;i++) x.deriv[i]+=y.deriv[i];
+	return(x);
+}
+
+template <int N> inline DualNumber<N> exp(const DualNumber<N>& x)
+{
+	prec value=exp(x.value);
+
+	return(dual_compose(value,value,x));
+}
@@ -17,9 +17,13 @@
 */
 
 class TElectricalElement: public TElement {
+protected:
+	ElementDual electron_current_dual;
+	ElementDual hole_current_dual;
+	long tunnel_evaluations;
 public:
 	TElectricalElement(RegionType region_type,TDevice *device, TNode* node_1, TNode* node_2)
-		: TElement(region_type,device,node_1,node_2) {}
+		: TElement(region_type,device,node_1,node_2) { tunnel_evaluations=0; }
 	virtual ~TElectricalElement(void) {}
 
 	virtual void update(FundamentalParam update);
@@ -34,15 +38,28 @@ public:
 	virtual prec comp_field(void)=0;
 	virtual FundamentalParam comp_deriv_field(NodeSide node, int return_flag)=0;
 	virtual prec comp_electron_current(void)=0;
-	virtual FundamentalParam comp_deriv_electron_current(NodeSide node,int return_flag)=0;
 	virtual prec comp_hole_current(void)=0;
-	virtual FundamentalParam comp_deriv_hole_current(NodeSide node,int return_flag)=0;
+	virtual void comp_fused_current(void)=0;
+	prec get_electron_current(void) { return(electron_current_dual.value); }
+	prec get_hole_current(void) { return(hole_current_dual.value); }
+	FundamentalParam comp_deriv_electron_current(NodeSide node,int return_flag);
+	FundamentalParam comp_deriv_hole_current(NodeSide node,int return_flag);
 	virtual prec comp_integral_charge(ElementSide side)=0;
 	virtual FundamentalParam comp_deriv_integral_charge(ElementSide side, NodeSide node,
 														int return_flag, SolveType solve)=0;
 	virtual prec comp_integral_recomb(ElementSide side)=0;
 	virtual FundamentalParam comp_deriv_integral_recomb(ElementSide side, NodeSide node,
 														int return_flag)=0;
+
+	long take_tunnel_evaluations(void)
+		{ long evaluations=tunnel_evaluations; tunnel_evaluations=0; return(evaluations); }
+
+	static long comp_range_values(TElectricalElement **element_ptr, ElementRange *range, int ranges,
+								  int first, int last, ElementValues *values,
+								  SolveType solve, logical fused_current);
+	static void comp_range_derivatives(TElectricalElement **element_ptr, ElementRange *range, int ranges,
+									   int first, int last, ElementDerivatives *derivatives,
+									   int return_flag, SolveType solve);
 };
 
 class TBulkElectricalElement: public TElectricalElement, public TElectricalServices {
@@ -58,17 +75,21 @@ public:
 
 	virtual void comp_dependent_param(SolveType solve);
 	virtual void comp_independent_param(void);
+	static void comp_grid_dependent_param(TElectricalElement **element_ptr, int elements,
+										  SolveType solve);
 
 private:
 	void comp_permit_length(void);
+	void comp_transport_param(void);
+	template <class T> T electron_current_kernel(void);
+	template <class T> T hole_current_kernel(void);
 
 public:
 	virtual prec comp_field(void);
 	virtual FundamentalParam comp_deriv_field(NodeSide node, int return_flag);
 	virtual prec comp_electron_current(void);
-	virtual FundamentalParam comp_deriv_electron_current(NodeSide node,int return_flag);
 	virtual prec comp_hole_current(void);
-	virtual FundamentalParam comp_deriv_hole_current(NodeSide node,int return_flag);
+	virtual void comp_fused_current(void);
 	virtual prec comp_integral_charge(ElementSide side);
 	virtual FundamentalParam comp_deriv_integral_charge(ElementSide side, NodeSide node,
 														int return_flag, SolveType solve);
@@ -107,14 +128,15 @@ private:
 	void comp_length_fraction(void);
 	void comp_cond_therm_emis_param(void);
 	void comp_val_therm_emis_param(void);
+	template <class T> T electron_current_kernel(void);
+	template <class T> T hole_current_kernel(void);
 
 public:
 	virtual prec comp_field(void);
 	virtual FundamentalParam comp_deriv_field(NodeSide node, int return_flag);
 	virtual prec comp_electron_current(void);
-	virtual FundamentalParam comp_deriv_electron_current(NodeSide node,int return_flag);
 	virtual prec comp_hole_current(void);
-	virtual FundamentalParam comp_deriv_hole_current(NodeSide node,int return_flag);
+	virtual void comp_fused_current(void);
 	virtual prec comp_integral_charge(ElementSide side);
 	virtual FundamentalParam comp_deriv_integral_charge(ElementSide side, NodeSide node,
 														int return_flag, SolveType solve);
@@ -155,14 +177,15 @@ private:
 	void comp_conduction_richardson(void);
 	void comp_valence_discont(void);
 	void comp_valence_richardson(void);
+	template <class T> T electron_current_kernel(void);
+	template <class T> T hole_current_kernel(void);
 
 public:
 	virtual prec comp_field(void);
 	virtual FundamentalParam comp_deriv_field(NodeSide node, int return_flag);
 	virtual prec comp_electron_current(void);
-	virtual FundamentalParam comp_deriv_electron_current(NodeSide node,int return_flag);
 	virtual prec comp_hole_current(void);
-	virtual FundamentalParam comp_deriv_hole_current(NodeSide node,int return_flag);
+	virtual void comp_fused_current(void);
 	virtual prec comp_integral_charge(ElementSide side) { return(0.0); }
 	virtual FundamentalParam comp_deriv_integral_charge(ElementSide side, NodeSide node,
 														int return_flag, SolveType solve);
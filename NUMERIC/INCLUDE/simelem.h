@@ -19,6 +19,7 @@
 class TElement {
 protected:
 	TDevice *device_ptr;
+	TSimulationContext *context;
 	RegionType type;
 	flag grid_effects;
 	flag device_effects;
@@ -27,12 +28,14 @@ protected:
 
 public:
 	TElement(RegionType region_type, TDevice *device, TNode* node_1, TNode* node_2);
+	RegionType get_region_type(void) { return(type); }
 	void get_effects(void);
 };
 
 class TElectricalServices {
 protected:
 	TDevice *device_ptr;
+	TSimulationContext *context;
 	TNode** grid_ptr;
 	TNode* prev_node;
 	TNode* next_node;
@@ -49,8 +52,11 @@ protected:
 	ElecDriftDiffParam ev;
 	ThermEmisParam ec_therm;
 	ThermEmisParam ev_therm;
+	TransmitCache ec_transmit;
+	TransmitCache ev_transmit;
 public:
 	TElectricalServices(TDevice* device, TNode** grid, TNode* node_1, TNode* node_2);
+	~TElectricalServices(void);
 
 	void comp_length(void);
 	void comp_elec_mobil_length(void);
@@ -67,10 +73,21 @@ public:
 	void comp_valence_discont(void);
 	void comp_valence_richardson(void);
 	prec comp_valence_transmission(prec energy);
+	void comp_conduction_transmit_cache(void);
+	void comp_valence_transmit_cache(void);
 	void comp_cond_drift_diff_param(flag grid_effects);
 	void comp_val_drift_diff_param(flag grid_effects);
 	void comp_cond_therm_emis_param(flag grid_effects);
 	void comp_val_therm_emis_param(flag grid_effects);
+	void get_bernoulli_arguments(prec *argument);
+	void put_bernoulli_values(const prec *bern_pos, const prec *bern_neg,
+							  const prec *deriv_pos, const prec *deriv_neg);
+	void comp_drift_diff_bernoulli(void);
+
+private:
+	void allocate_transmit_cache(TransmitCache& cache, int size);
+	void comp_transmit_min_band_edge(TransmitCache& cache);
+	prec comp_transmit_integral(TransmitCache& cache, prec energy);
 };
 
 
@@ -18,6 +18,7 @@
 
 class TEnvironment {
 private:
+	TSimulationContext *context;
 	logical undo_ready;
 	string undo_filepath;
     logical stop_solution;
@@ -39,6 +40,14 @@ private:
 	prec clamp_value;
 	prec temp_clamp_value;
 	prec temp_relax_value;
+	float newton_refactor_ratio;
+	short max_line_search_iter;
+	short anderson_depth;
+	short tunnel_quad_order;
+	prec tunnel_quad_tolerance;
+	long assembly_min_nodes;
+	long partition_min_nodes;
+	long property_min_nodes;
 	flag env_effects;
 	prec temperature;
 	prec radius;
@@ -48,7 +57,7 @@ private:
 
 // Constructor/Destructor
 public:
-	TEnvironment(void);
+	TEnvironment(TSimulationContext *new_context);
 	~TEnvironment(void) { delete_device(); delete_spectrum(); delete_undo_file(); }
 
 // Get/Put functions
@@ -74,6 +83,10 @@ public:
 // Comp. Functions
 	void comp_value(FlagType flag_type, flag flag_value, int start_object=-1, int end_object=-1);
 	void solve(void);
+	int get_solution_size(void);
+	void get_solution(prec *solution);
+	void put_solution(prec *solution);
+	void predict_solution(void);
 
 
 // Device functions
@@ -86,15 +99,18 @@ public:
     void set_stop_solution(logical stop) { stop_solution=stop; }
     logical do_stop_solution(void) { return(stop_solution); }
     logical is_solving(void) { return(solving); }
+	logical use_fermi_table(void) { return((env_effects & ENV_FERMI_TABLE)!=0); }
 
 // File functions
 public:
 	void load_file(const char *filename);
+	void load_state_file(FILE *file_ptr, const char *filename="");
 	void read_data_file(const char *filename);
 	void write_data_file(const char *filename, TValueFlag write_flags,
 						  FlagType ref_flag_type=(FlagType)NULL,
 						  flag ref_flag_value=(flag)NULL);
 	void write_state_file(const char *filename);
+	void write_state_file(FILE *file_ptr);
 private:
 	void read_state_file(FILE *file_ptr);
 	void delete_undo_file(void)
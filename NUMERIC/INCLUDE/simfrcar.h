@@ -18,6 +18,7 @@
 
 class TFreeElectron {
 protected:
+	TSimulationContext *context;
 	flag effects;
 	prec equil_dos;
 	prec non_equil_dos;
@@ -26,7 +27,7 @@ protected:
 	prec deriv_conc_eta_c;
 
 public:
-	TFreeElectron(void);
+	TFreeElectron(TSimulationContext *new_context);
 
 // Comp functions
 private:
@@ -40,6 +41,8 @@ public:
 	void comp_conc(prec planck_potential, prec temp=0.0,
 				   prec qw_energy_top=0.0, prec bound_dos=0.0);
 	void comp_deriv_conc(prec planck_potential, prec qw_energy_top=0.0);
+	void comp_fermi_conc(prec fermi_1_half) { concentration=non_equil_dos*fermi_1_half; }
+	void comp_fermi_deriv_conc(prec fermi_minus_1_half) { deriv_conc_eta_c=non_equil_dos*fermi_minus_1_half; }
 
 	prec get_value(flag flag_value, ScaleType scale=UNNORMALIZED);
 	void put_value(flag flag_value, prec value, ScaleType scale=UNNORMALIZED);
@@ -50,6 +53,7 @@ public:
 
 class TFreeHole {
 protected:
+	TSimulationContext *context;
 	flag effects;
 	prec equil_dos;
 	prec non_equil_dos;
@@ -58,7 +62,7 @@ protected:
 	prec deriv_conc_eta_v;
 
 public:
-	TFreeHole(void);
+	TFreeHole(TSimulationContext *new_context);
 
 // Comp functions
 private:
@@ -71,6 +75,8 @@ public:
 	void comp_conc(prec planck_potential, prec temp=0.0,
 				   prec qw_energy_top=0.0, prec bound_dos=0.0);
 	void comp_deriv_conc(prec planck_potential,prec qw_energy_top=0.0);
+	void comp_fermi_conc(prec fermi_1_half) { concentration=non_equil_dos*fermi_1_half; }
+	void comp_fermi_deriv_conc(prec fermi_minus_1_half) { deriv_conc_eta_v=non_equil_dos*fermi_minus_1_half; }
 
 	prec get_value(flag flag_value, ScaleType scale=UNNORMALIZED);
 	void put_value(flag flag_value, prec value, ScaleType scale=UNNORMALIZED);
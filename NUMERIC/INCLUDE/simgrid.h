@@ -18,6 +18,7 @@
 
 class TGrid {
 protected:
+	TSimulationContext *context;
 	int node_number;
 	prec position;
 	RegionType region_type;
@@ -50,19 +51,19 @@ protected:
 	prec group_velocity;
 
 public:
-	TGrid(int node_num, RegionType region, TQuantumWell *qw);
+	TGrid(TSimulationContext *new_context, int node_num, RegionType region, TQuantumWell *qw);
 
 	void comp_b_b_recomb_const(void);
 	void comp_band_gap(void);
 	void comp_deriv_thermal_conduct(void);
 	void comp_deriv_lateral_conduct(void);
 	void comp_electron_affinity(void);
-	void comp_field(int start_node_number, prec total_charge);
-	void comp_incident_optical_field(int start_node_number);
+	void comp_field(int start_node_number, prec total_charge, FieldSweep& sweep);
+	void comp_incident_optical_field(int start_node_number, OpticalFieldSweep& sweep);
 	void comp_incident_refractive_index(void);
 	void comp_incident_impedance(void);
 	void comp_incident_total_poynting(prec intensity_multiplier, int max_overflow_count);
-	void comp_mode_optical_field(int start_node_number);
+	void comp_mode_optical_field(int start_node_number, OpticalFieldSweep& sweep);
 	void comp_mode_refractive_index(void);
 	void comp_mode_impedance(void);
 	void comp_permitivity(void);
@@ -43,16 +43,17 @@ public:
 	TDeviceFileInput(const TDeviceFileInput& new_device_input)
 		{ clear_contents(); copy_contents(new_device_input); }
 	~TDeviceFileInput(void) { delete_contents(); }
-	void add_grid(GridInput new_grid);
-	void add_doping(DopingInput new_doping);
-	void add_material_param(MaterialParam param_number, MaterialParamInput new_param);
-	void add_structure(StructureInput new_structure);
-	void add_region(RegionInput new_region);
-	void add_cavity(CavityInput new_cavity);
-	void add_mirror(MirrorInput new_mirror);
+	void add_grid(TSimulationContext *context, GridInput new_grid);
+	void add_doping(TSimulationContext *context, DopingInput new_doping);
+	void add_material_param(TSimulationContext *context, MaterialParam param_number,
+							MaterialParamInput new_param);
+	void add_structure(TSimulationContext *context, StructureInput new_structure);
+	void add_region(TSimulationContext *context, RegionInput new_region);
+	void add_cavity(TSimulationContext *context, CavityInput new_cavity);
+	void add_mirror(TSimulationContext *context, MirrorInput new_mirror);
 	void add_radius(prec new_radius) { radius=new_radius; }
 	void apply_defaults(void);
-	void check_device(void);
+	void check_device(TSimulationContext *context);
 	void delete_contents(void);
 	RegionType get_region_type(prec position);
 	AlloyType get_alloy_type(prec position);
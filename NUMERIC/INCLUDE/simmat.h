@@ -40,6 +40,7 @@ private:
 	TMaterialParamModel *parameters[MAT_MAX_NUMBER_PARAMETERS];
 public:
 	TAlloy(string& alloy_name);
+	TAlloy(const TAlloy& new_alloy);
 	~TAlloy(void);
 	void add_model(MaterialParam param, TMaterialParamModel *new_model)
 		{ assert((param>=1) && (param<=MAT_MAX_NUMBER_PARAMETERS));
@@ -56,6 +57,7 @@ private:
 	TAlloy **alloys;
 public:
 	TMaterial(string& material_name) : name(material_name) { number_alloys=0; alloys=(TAlloy **)0; }
+	TMaterial(const TMaterial& new_material);
 	~TMaterial(void);
 	void add_alloy(string& alloy_name);
 	logical valid_alloy(string& alloy_name);
@@ -73,14 +75,16 @@ public:
 
 class TMaterialStorage {
 private:
+	TSimulationContext *context;
 	logical ready;
 	int number_materials;
 	TMaterial **materials;
 	TDeviceFileInput *device_file;
 public:
-	TMaterialStorage(void);
+	TMaterialStorage(TSimulationContext *new_context);
 	~TMaterialStorage(void) { clear(); }
 	void clear(void);
+	void copy(const TMaterialStorage& new_storage);
 	void add_material(string& material_name);
 	void add_alloy(string& material_name, string& alloy_name)
 		{ assert(valid_material(material_name));
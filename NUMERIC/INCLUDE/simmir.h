@@ -18,6 +18,7 @@
 
 class TMirror {
 private:
+	TSimulationContext *context;
 	TDevice *device_ptr;
 	MirrorType type;
 	prec position;
@@ -25,7 +26,7 @@ private:
 	prec reflectivity;
 	float output_power;
 public:
-	TMirror(TDevice *ptr);
+	TMirror(TSimulationContext *new_context, TDevice *ptr);
 	void init(void);
 
 	void comp_power(float photon_number, float photon_energy,
@@ -18,6 +18,7 @@
 
 class TMode {
 private:
+	TSimulationContext *context;
 	TNode** grid_ptr;
 	flag effects;
 	prec total_photons;
@@ -32,8 +33,9 @@ private:
 	prec mirror_loss;
 	prec waveguide_loss;
 	prec energy;
+	int error_sign;
 public:
-	TMode(TNode** grid);
+	TMode(TSimulationContext *new_context, TNode** grid);
 	void init(void);
 
 	void comp_group_velocity(int start_node, int end_node);
@@ -36,34 +36,41 @@ private:
 	RadiativeHeat radiative_heat;
 	prec total_heat;
 public:
-	TNode(int node_number, RegionType region_type, TQuantumWell *qw_ptr=NULL);
+	TNode(TSimulationContext *new_context, int node_number, RegionType region_type,
+		  TQuantumWell *qw_ptr=NULL);
 	void comp_charge(void)
 		{ total_charge=(THole::total_conc-TElectron::total_conc+
 						TElectron::ionized_doping_conc-THole::ionized_doping_conc); }
-	void comp_current(FlagType flag_type, int start_node_number);
+	void comp_current(FlagType flag_type, int start_node_number, CurrentSweep& sweep);
 	void comp_deriv_conc(void)
 		{ TElectron::comp_deriv_conc(); THole::comp_deriv_conc();
 		  TElectron::comp_deriv_ionized_doping(); THole::comp_deriv_ionized_doping(); }
+	void comp_deriv_ionized_doping(void)
+		{ TElectron::comp_deriv_ionized_doping(); THole::comp_deriv_ionized_doping(); }
+	static void comp_grid_conc(TNode **node_ptr, int nodes, FlagType flag_type);
+	static void comp_grid_deriv_conc(TNode **node_ptr, int nodes, FlagType flag_type);
+	static void comp_grid_hotcarriers(TNode **node_ptr, int nodes, FlagType flag_type, flag flag_value);
+	static void comp_grid_deriv_hotcarriers(TNode **node_ptr, int nodes, FlagType flag_type);
 	void comp_deriv_gain(void);
 	void comp_deriv_recomb(void);
-	void comp_deriv_electron_hotcarriers(void)
+	void comp_deriv_electron_hotcarriers(prec fermi_ratio=0.0)
 		{ TElectron::comp_deriv_hotcarriers(recombination,lattice_temp,intrinsic_conc,
 											TFreeHole::concentration,
-                                            THole::shr_lifetime, THole::auger_coefficient); }
-	void comp_deriv_hole_hotcarriers(void)
+                                            THole::shr_lifetime, THole::auger_coefficient, fermi_ratio); }
+	void comp_deriv_hole_hotcarriers(prec fermi_ratio=0.0)
 		{ THole::comp_deriv_hotcarriers(recombination,lattice_temp,intrinsic_conc,
         							    TFreeElectron::concentration,
-                                        TElectron::shr_lifetime, TElectron::auger_coefficient); }
+                                        TElectron::shr_lifetime, TElectron::auger_coefficient, fermi_ratio); }
 	void comp_deriv_thermal_conduct(void)
 		{ TGrid::comp_deriv_thermal_conduct(); TGrid::comp_deriv_lateral_conduct(); }
-	void comp_field(int start_node_number)
-		{ TGrid::comp_field(start_node_number,total_charge); }
-	void comp_incident_optical_field(int start_node_number)
-		{ TGrid::comp_incident_optical_field(start_node_number); }
+	void comp_field(int start_node_number, FieldSweep& sweep)
+		{ TGrid::comp_field(start_node_number,total_charge,sweep); }
+	void comp_incident_optical_field(int start_node_number, OpticalFieldSweep& sweep)
+		{ TGrid::comp_incident_optical_field(start_node_number,sweep); }
 	void comp_incident_total_poynting(prec intensity_multiplier, int max_overflow_count)
 		{ TGrid::comp_incident_total_poynting(intensity_multiplier, max_overflow_count); }
-	void comp_mode_optical_field(int start_node_number)
-		{ TGrid::comp_mode_optical_field(start_node_number); }
+	void comp_mode_optical_field(int start_node_number, OpticalFieldSweep& sweep)
+		{ TGrid::comp_mode_optical_field(start_node_number,sweep); }
 	void comp_intrinsic_conc(void);
 	void comp_gain(void);
 	void comp_optical_generation(void);
@@ -77,6 +84,7 @@ public:
 	void comp_radiative_heat(void);
 	void comp_heat(void);
 	void comp_reduced_dos_mass(void);
+	void comp_hotcarriers(FlagType flag_type, flag flag_value, prec fermi_ratio=0.0);
 	void comp_value(FlagType flag_type, flag flag_value);
 	void store_temperature(void) { TElectron::store_temperature();
 		THole::store_temperature(); TGrid::store_temperature(); }
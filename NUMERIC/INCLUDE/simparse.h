@@ -18,12 +18,13 @@
 
 class TParse {
 protected:
+	TSimulationContext *context;
 	int line_number;
 	ifstream input_file_stream;
 	int number_string;
 	string file_name;
 public:
-	TParse(const char *file);
+	TParse(TSimulationContext *new_context, const char *file);
 	~TParse(void) { input_file_stream.close(); }
 	void set_filename(const char *file);
 protected:
@@ -43,7 +44,8 @@ protected:
 
 class TParseMaterialParam: public TParse {
 public:
-	TParseMaterialParam(const char *file) : TParse(file) {}
+	TParseMaterialParam(TSimulationContext *new_context, const char *file)
+		: TParse(new_context,file) {}
 protected:
 	TMaterialParamModel *get_material_parameter(MaterialParam param,
 												string parameter_line,
@@ -64,7 +66,7 @@ private:
 	logical region_entered;
 	logical radius_entered;
 public:
-	TParseDevice(const char *file);
+	TParseDevice(TSimulationContext *new_context, const char *file);
 	~TParseDevice(void) {}
 	TDeviceFileInput parse_device(void);
 private:
@@ -86,12 +88,13 @@ private:
 	MaterialType current_material_type;
 	AlloyType current_alloy_type;
 public:
-	TParseMaterial(const char *file) : TParseMaterialParam(file)
+	TParseMaterial(TSimulationContext *new_context, const char *file)
+		: TParseMaterialParam(new_context,file)
 		{ current_material_type=(MaterialType)0; current_alloy_type=(AlloyType)0; }
 	void parse_material(void);
 private:
 	void process_material(string line_string);
 	void process_alloy(string line_string);
-	void init(void) { material_parameters.clear(); }
+	void init(void) { context->material_parameters.clear(); }
 };
 
@@ -0,0 +1,122 @@
+/*
+    SimWindows - 1D Semiconductor Device Simulator
+    Copyright (C) 2013 David W. Winston
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/*************************************************************************
+
+Portability layer - used in place of the Borland run-time headers
+(io.h, alloc.h, fstream.h, cstring.h, complex.h) when the numeric code
+is compiled with a standard C++ compiler, e.g. for the console driver.
+
+**************************************************************************/
+
+#include <ctype.h>
+#include <stdlib.h>
+#include <time.h>
+#include <string.h>
+#include <unistd.h>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <complex>
+
+using std::ifstream;
+using std::ofstream;
+using std::istream;
+using std::ostream;
+using std::ios;
+using std::streampos;
+
+typedef std::complex<double> complex;
+
+// Math error record passed to _matherr() by the Borland run-time library.
+struct exception {
+	int type;
+	char *name;
+	double arg1;
+	double arg2;
+	double retval;
+};
+
+#define NPOS std::string::npos
+
+inline void randomize(void) { srand((unsigned)time(NULL)); }
+
+inline char *strlwr(char *s)
+{
+	char *p;
+
+	for (p=s;*p;p++) *p=(char)tolower(*p);
+	return(s);
+}
+
+inline char *strupr(char *s)
+{
+	char *p;
+
+	for (p=s;*p;p++) *p=(char)toupper(*p);
+	return(s);
+}
+
+// Borland string class members used by the numeric code, built on std::string.
+class string: public std::string {
+public:
+	enum StripType { Leading, Trailing, Both };
+	string(void) {}
+	string(const char *s) : std::string(s) {}
+	string(const std::string& s) : std::string(s) {}
+	string(size_type n, char c) : std::string(n,c) {}
+	int is_null(void) const { return(empty()); }
+	int contains(const char *s) const { return(find(s)!=npos); }
+	char get_at(size_type pos) const { return(at(pos)); }
+	void put_at(size_type pos, char c) { at(pos)=c; }
+	string& remove(size_type pos) { erase(pos); return(*this); }
+	string& remove(size_type pos, size_type n) { erase(pos,n); return(*this); }
+	string& prepend(const string& s) { insert(0,s); return(*this); }
+	void to_upper(void)
+		{ for (iterator i=begin();i!=end();i++) *i=(char)toupper(*i); }
+	void to_lower(void)
+		{ for (iterator i=begin();i!=end();i++) *i=(char)tolower(*i); }
+	string strip(StripType type=Trailing, char c=' ') const;
+	istream& read_to_delim(istream& is, char delim='\n');
+};
+
+inline string string::strip(StripType type, char c) const
+{
+	size_type start=0, end=length();
+
+	if (type!=Trailing) while ((start<end) && ((*this)[start]==c)) start++;
+	if (type!=Leading) while ((end>start) && ((*this)[end-1]==c)) end--;
+	return(string(substr(start,end-start)));
+}
+
+// Lines of DOS text files keep their carriage return when read with getline().
+inline istream& string::read_to_delim(istream& is, char delim)
+{
+	std::getline(is,*this,delim);
+	if ((delim=='\n') && !empty() && ((*this)[length()-1]=='\r')) erase(length()-1);
+	return(is);
+}
+
+inline string operator+(const string& s1, const string& s2)
+	{ return(string((const std::string&)s1+(const std::string&)s2)); }
+inline string operator+(const string& s1, const char *s2)
+	{ return(string((const std::string&)s1+s2)); }
+inline string operator+(const char *s1, const string& s2)
+	{ return(string(s1+(const std::string&)s2)); }
+inline string operator+(const string& s1, char c)
+	{ return(string((const std::string&)s1+c)); }
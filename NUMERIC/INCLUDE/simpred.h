@@ -0,0 +1,53 @@
+/*
+    SimWindows - 1D Semiconductor Device Simulator
+    Copyright (C) 2013 David W. Winston
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/*************************************************************************
+
+Solution predictor - gives Newton a starting point for the next bias of a
+sweep. The converged solutions of the last MAX_PREDICTOR_POINTS biases are
+kept, newest first. PREDICT_LINEAR and PREDICT_QUADRATIC extrapolate the
+whole solution vector (see TDevice::get_solution) through the last two or
+three points. PREDICT_TANGENT takes one chord step with the jacobian of the
+last solution and extrapolates only the temperatures and the photons
+linearly. Fewer stored points lower the order of the extrapolation.
+
+**************************************************************************/
+
+class TSolutionPredictor {
+private:
+	TSimulationContext *context;
+	PredictorType predictor_type;
+	int solution_size;
+	int number_points;
+	prec bias[MAX_PREDICTOR_POINTS];
+	prec *solution[MAX_PREDICTOR_POINTS];
+	prec *predicted_solution;
+public:
+	TSolutionPredictor(TSimulationContext *new_context, PredictorType new_type=PREDICT_NONE);
+	~TSolutionPredictor(void) { delete_solutions(); }
+	void put_type(PredictorType new_type) { predictor_type=new_type; }
+	PredictorType get_type(void) { return(predictor_type); }
+	void clear(void) { number_points=0; }
+	void store(prec new_bias);
+	void predict(prec new_bias);
+private:
+	void create_solutions(int new_solution_size);
+	void delete_solutions(void);
+	void extrapolate(prec new_bias, int order, int start_value);
+};
+
@@ -0,0 +1,132 @@
+/*
+    SimWindows - 1D Semiconductor Device Simulator
+    Copyright (C) 2013 David W. Winston
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/*************************************************************************
+
+Quadrature of the tunneling current over energy. The integrand is any
+object F with T operator()(prec energy), where T is prec or a DualNumber,
+so the partials of the current are integrated with the same rule as the
+value. The integration energies never depend on the independent variables.
+
+gauss_legendre_integral() applies the Gauss-Legendre rule held by the
+TunnelQuadrature. gauss_kronrod_integral() applies the 15 point Kronrod
+rule and takes its difference from the embedded 7 point Gauss rule as the
+error. Intervals whose error is above their share of tolerance times the
+integral are halved, down to MAX_TUNNEL_QUAD_DEPTH levels. Only the value
+of a DualNumber decides the refinement. Every evaluation of the integrand
+is added to the evaluations count of the caller, so elements evaluated on
+separate threads never share the count. tunnel_integral() chooses between
+the two by the type of the TunnelQuadrature.
+
+**************************************************************************/
+
+static const prec kronrod_node[8]={
+	0.991455371120812639206854697526329, 0.949107912342758524526189684047851,
+	0.864864423359769072789712788640926, 0.741531185599394439863864773280788,
+	0.586087235467691130294144845693013, 0.405845151377397166906606412076961,
+	0.207784955007898467600689403773245, 0.0 };
+
+static const prec kronrod_weight[8]={
+	0.022935322010529224963732008058970, 0.063092092629978553290700663189204,
+	0.104790010322250183839876322541518, 0.140653259715525918745189590510238,
+	0.169004726639267902826583426598550, 0.190350578064785409913256402421014,
+	0.204432940075298892414161999234649, 0.209482141084727828012999174891714 };
+
+// Weights of the Gauss nodes, which are the odd Kronrod nodes
+static const prec kronrod_gauss_weight[4]={
+	0.129484966168869693270611432679082, 0.279705391489276667901467771423780,
+	0.381830050505118944950369775488975, 0.417959183673469387755102040816327 };
+
+template <class T, class F> T gauss_legendre_integral(F& integrand, prec start, prec end,
+													  const TunnelQuadrature& quadrature, long& evaluations)
+{
+	int i;
+	prec middle, half_width;
+	T result=0.0;
+
+	middle=(end+start)/2.0;
+	half_width=(end-start)/2.0;
+
+	for (i=0;i<quadrature.order;i++)
+		result+=quadrature.weight[i]*integrand(middle+half_width*quadrature.node[i]);
+	evaluations+=quadrature.order;
+
+	return(result*half_width);
+}
+
+template <class T, class F> T gauss_kronrod_rule(F& integrand, prec start, prec end,
+												 prec& error, long& evaluations)
+{
+	int i;
+	prec middle, half_width;
+	T center_value, pair_value;
+	T kronrod_sum, gauss_sum;
+
+	middle=(end+start)/2.0;
+	half_width=(end-start)/2.0;
+
+	center_value=integrand(middle);
+	kronrod_sum=kronrod_weight[7]*center_value;
+	gauss_sum=kronrod_gauss_weight[3]*center_value;
+
+	for (i=0;i<7;i++) {
+		pair_value=integrand(middle-half_width*kronrod_node[i])+integrand(middle+half_width*kronrod_node[i]);
+		kronrod_sum+=kronrod_weight[i]*pair_value;
+		if (i%2) gauss_sum+=kronrod_gauss_weight[i/2]*pair_value;
+	}
+	evaluations+=15;
+
+	error=fabs(dual_value(kronrod_sum-gauss_sum)*half_width);
+	return(kronrod_sum*half_width);
+}
+
+template <class T, class F> T gauss_kronrod_refine(F& integrand, prec start, prec end,
+												   const T& estimate, prec error, prec target,
+												   int depth, long& evaluations)
+{
+	prec middle, left_error, right_error;
+	T left_estimate, right_estimate;
+
+	if ((error<=target) || (depth>=MAX_TUNNEL_QUAD_DEPTH)) return(estimate);
+
+	middle=(end+start)/2.0;
+	left_estimate=gauss_kronrod_rule<T>(integrand,start,middle,left_error,evaluations);
+	right_estimate=gauss_kronrod_rule<T>(integrand,middle,end,right_error,evaluations);
+
+	return(gauss_kronrod_refine(integrand,start,middle,left_estimate,left_error,target/2.0,depth+1,evaluations)+
+		   gauss_kronrod_refine(integrand,middle,end,right_estimate,right_error,target/2.0,depth+1,evaluations));
+}
+
+template <class T, class F> T gauss_kronrod_integral(F& integrand, prec start, prec end,
+													 const TunnelQuadrature& quadrature, long& evaluations)
+{
+	prec error;
+	T estimate;
+
+	estimate=gauss_kronrod_rule<T>(integrand,start,end,error,evaluations);
+	return(gauss_kronrod_refine(integrand,start,end,estimate,error,
+								quadrature.tolerance*fabs(dual_value(estimate)),0,evaluations));
+}
+
+template <class T, class F> T tunnel_integral(F& integrand, prec start, prec end,
+											  const TunnelQuadrature& quadrature, long& evaluations)
+{
+	if (quadrature.type==QUAD_GAUSS_KRONROD)
+		return(gauss_kronrod_integral<T>(integrand,start,end,quadrature,evaluations));
+	else return(gauss_legendre_integral<T>(integrand,start,end,quadrature,evaluations));
+}
@@ -20,6 +20,7 @@ class TQuantumWell: protected T2DElectron, protected T2DHole {
 	friend TNode;
 	friend TGrid;
 private:
+	TSimulationContext *context;
 	TDevice *device_ptr;
 	TNode** grid_ptr;
 	QuantumWellNodes nodes;
@@ -41,7 +42,7 @@ private:
 	prec comp_absorption(prec energy);
 
 public:
-	TQuantumWell(TDevice *device, TNode** grid);
+	TQuantumWell(TSimulationContext *new_context, TDevice *device, TNode** grid);
 	void comp_auger_recombination(void);
 	void comp_band_gap(void);
 	void comp_b_b_recomb_const_2D(void);
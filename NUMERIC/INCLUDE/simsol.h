@@ -0,0 +1,161 @@
+/*
+    SimWindows - 1D Semiconductor Device Simulator
+    Copyright (C) 2013 David W. Winston
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+class TSolution {
+private:
+	TSimulationContext *context;
+	SolveType solve_type;
+	flag device_effects;
+	flag contact_flag_0;
+	flag contact_flag_1;
+	flag surface_flag_0;
+	flag surface_flag_1;
+	TDevice *device_ptr;
+	int quantum_wells;
+	TQuantumWell **qw_ptr;
+	int device_grid_points;
+	TNode **device_grid_ptr;
+	int solution_grid_points;
+	TNode **solution_grid_ptr;
+	int elements;
+	int electrical_start_node;
+	int electrical_end_node;
+	int thermal_start_node;
+	int thermal_end_node;
+	int electrical_unknown_nodes;
+	int thermal_unknown_nodes;
+	TElectricalElement **electrical_element_ptr;
+	TThermalElement **thermal_element_ptr;
+	TObjectArena electrical_arena;
+	TObjectArena thermal_arena;
+	ElementRange *element_range;
+	int element_ranges;
+	ElementValues *element_values;
+	ElementDerivatives *element_derivatives;
+	AssemblyPass assembly_pass;
+	logical assembly_fused_current;
+	int assembly_return_flag;
+	int assembly_first;
+	int assembly_last;
+	int assembly_blocks;
+	long assembly_evaluations[MAX_ASSEMBLY_BLOCKS];
+	TBlockJacobian electrical_jacobian;
+	prec *electrical_solution[3];
+	int number_elect_variables;
+	logical jacobian_factored;
+	prec previous_elect_error;
+	prec previous_elect_ratio;
+	prec *electrical_step[3];
+	TBlockJacobian thermal_jacobian;
+	prec *thermal_solution;
+	logical coupled_thermal;
+	int coupled_start_node;
+	int coupled_end_node;
+	int coupled_unknown_nodes;
+	TBlockJacobian coupled_jacobian;
+	prec *coupled_solution[COUPLED_VARIABLES];
+	prec *coupled_step;
+	logical coupled_photons;
+	prec *photon_column[3];
+	int anderson_depth;
+	int anderson_passes;
+	int anderson_history;
+	int anderson_columns;
+	prec anderson_error;
+	prec anderson_ratio;
+	prec anderson_relaxed_ratio;
+	prec *anderson_residual[MAX_ANDERSON_DEPTH+1];
+	prec *anderson_step[MAX_ANDERSON_DEPTH+1];
+	prec anderson_photons[MAX_ANDERSON_DEPTH+1];
+public:
+	TSolution(TSimulationContext *new_context, TDevice *device, TNode** grd_ptr,
+			  TQuantumWell **qwell_ptr);
+	~TSolution(void);
+	void apply_electrical_boundary(void);
+	void apply_thermal_boundary(void);
+	void comp_independent_param(void);
+	void comp_thermoelectric_param(void);
+	void comp_electrical_boundary(void);
+	void comp_thermal_boundary(void);
+	void store_temperature(void);
+	void set_solution(SolveType type);
+	void electrical_iterate(FundamentalParam& iteration_error);
+	void electrical_predict(void);
+	void comp_electrical_values(void);
+	void thermal_iterate(prec& iteration_error);
+	void outer_thermal_update_device(prec& outer_error);
+	logical is_coupled_thermal(void) { return(coupled_thermal); }
+	void coupled_iterate(FundamentalParam& elect_error, prec& therm_error);
+	logical is_coupled_photons(void) { return(coupled_photons); }
+	void photon_iterate(FundamentalParam& elect_error, prec& photon_error);
+private:
+	void establish_elements(void);
+	void comp_electrical_dep_param(SolveType solve);
+	void comp_thermal_dep_param(void);
+	void comp_deriv_recomb(void);
+	void comp_deriv_conc(void);
+	void comp_deriv_thermal_conduct(void);
+	void comp_deriv_electron_hotcarriers(void);
+	void comp_electrical_jacobian(void);
+	void comp_electrical_jacobian_rows(int first_node, int last_node);
+	void comp_electrical_solution(logical fused_current);
+	void comp_electrical_solution_rows(int first_node, int last_node);
+	void comp_thermal_jacobian(void);
+	void comp_thermal_jacobian_rows(int first_node, int last_node);
+	void comp_thermal_solution(void);
+	void comp_thermal_solution_rows(int first_node, int last_node);
+	void run_assembly(AssemblyPass pass, int first, int last);
+	static void assembly_task(void *solution, int block_number);
+	void assemble_block(int block_number);
+	void comp_coupled_thermal_solution(void);
+	void comp_coupled_jacobian(void);
+	void comp_coupled_column(int color, int variable, int start_node, int end_node,
+							 logical electrical_rows);
+	int comp_partitions(int unknown_nodes);
+	void factor_jacobian(TBlockJacobian& jacobian, int variables, int unknown_nodes);
+	void solve_electrical_jacobian(prec **solution);
+	void solve_thermal_jacobian(void);
+	void solve_coupled_jacobian(void);
+	void electrical_update_device(void);
+	void electrical_step_device(prec **step, prec step_factor);
+	void electrical_line_search(prec *initial_residual);
+	void clamp_electrical_step(void);
+	prec comp_trial_norm(void);
+	void comp_electrical_residual(prec *residual);
+	void put_total_photons(prec total_photons);
+	prec comp_photon_residual(prec total_photons, prec& photon_deriv);
+	prec comp_photon_deriv(prec **direction, prec total_photons, prec photon_residual);
+	void thermal_update_device(void);
+	void anderson_update_device(prec clamp_value, prec relaxation_value, prec& outer_error);
+	int comp_anderson_coefficients(int columns, prec *coefficient);
+	void electrical_update_sub_nodes(void);
+	void thermal_update_sub_nodes(void);
+	FundamentalParam comp_electrical_error(void);
+	prec comp_max_elect_error(FundamentalParam& error);
+	prec comp_chord_limit(prec refactor_ratio);
+	void store_elect_error(prec max_error);
+	prec comp_thermal_error(void);
+	FundamentalParam comp_deriv_poisson(int i, NodeSide node, int return_flag);
+	FundamentalParam comp_deriv_electron_rate(int i, NodeSide node, int return_flag);
+	FundamentalParam comp_deriv_hole_rate(int i, NodeSide node, int return_flag);
+	prec comp_deriv_heat_rate(int i, NodeSide node);
+	prec comp_deriv_rate_hotcarriers_electron(int i, NodeSide node);
+};
+
+
+
@@ -47,7 +47,6 @@ class TBoundaryThermalElement;
 class TSolution;
 
 class TEnvironment;
-extern TEnvironment environment;
 
 class TFlag;
 class TValueFlag;
@@ -78,10 +77,9 @@ class TAlloy;
 class TMaterial;
 
 class TMaterialStorage;
-extern TMaterialStorage material_parameters;
-
 class TErrorHandler;
-extern TErrorHandler error_handler;
+class TSimulationContext;
+class TWorkerPool;
 
 class TPreferences;
 extern TPreferences preferences;
@@ -187,7 +185,6 @@ struct NormalizeConstants {
 	prec current;
 	prec intensity;
 };
-extern NormalizeConstants normalization;
 
 struct FundamentalParam {
 	prec psi;
@@ -225,6 +222,54 @@ struct ThermEmisParam {
 	prec richardson_const;
 };
 
+struct TransmitCache {
+	int size;
+	int allocated;
+	prec wkb_factor;
+	prec *step;
+	prec *band_edge;
+	prec *mass;
+	prec *min_band_edge;
+};
+
+struct TunnelQuadrature {
+	QuadratureType type;
+	int order;
+	prec tolerance;
+	prec node[MAX_TUNNEL_QUAD_ORDER];
+	prec weight[MAX_TUNNEL_QUAD_ORDER];
+	long evaluations;
+};
+
+struct ElementRange {
+	RegionType type;
+	int start;
+	int count;
+};
+
+struct ElementValues {
+	prec field;
+	prec electron_current;
+	prec hole_current;
+	prec integral_charge_first;
+	prec integral_charge_second;
+	prec integral_recomb_first;
+	prec integral_recomb_second;
+};
+
+struct ElementDerivatives {
+	FundamentalParam field_prev;
+	FundamentalParam field_next;
+	FundamentalParam integral_charge_first_prev;
+	FundamentalParam integral_charge_first_next;
+	FundamentalParam integral_charge_second_prev;
+	FundamentalParam integral_charge_second_next;
+	FundamentalParam integral_recomb_first_prev;
+	FundamentalParam integral_recomb_first_next;
+	FundamentalParam integral_recomb_second_prev;
+	FundamentalParam integral_recomb_second_next;
+};
+
 struct OpticalComponent {
 	prec energy;
 	prec input_intensity;
@@ -260,6 +305,27 @@ struct OpticalField {
     int overflow_count;
 };
 
+// State carried from node to node while a quantity is integrated across the grid
+struct FieldSweep {
+	prec prev_position;
+	prec prev_displacement;
+	prec prev_charge;
+};
+
+struct CurrentSweep {
+	prec prev_position;
+	prec prev_current;
+	prec prev_recombination;
+};
+
+struct OpticalFieldSweep {
+	prec prev_position;
+	prec wave_vector;
+	complex prev_impedance;
+	OpticalField prev_field;
+	int overflow_count;
+};
+
 struct QuantumWellNodes {
 	TNode *prev_node_ptr;
 	TNode *curr_node_ptr;
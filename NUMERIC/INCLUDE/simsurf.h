@@ -18,6 +18,7 @@
 
 class TSurface {
 private:
+	TSimulationContext *context;
 	TNode *surface_node;
 	int surface_node_number;
 	TNode *second_node;
@@ -33,7 +34,7 @@ private:
 	OpticalField mode_field;
 
 public:
-	TSurface(TNode* surface_node_ptr, TNode* next_node_ptr);
+	TSurface(TSimulationContext *new_context, TNode* surface_node_ptr, TNode* next_node_ptr);
 	prec get_value(flag flag_value, ScaleType scale=UNNORMALIZED);
 	void put_value(flag flag_value, prec value, ScaleType scale=UNNORMALIZED);
 	void comp_incident_surface_field(void);
@@ -0,0 +1,129 @@
+/*
+    SimWindows - 1D Semiconductor Device Simulator
+    Copyright (C) 2013 David W. Winston
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/*************************************************************************
+
+Bias sweep - solves the bias points of one contact of the device in the
+context the sweep is created with and records a set of values at each
+point. The points are split into chunks of consecutive biases. A coarse
+pass with relaxed tolerances steps the device to the first bias of every
+chunk and each chunk is then solved by its own worker in its own
+simulation context, starting from a copy of the coarse solution. A chunk
+whose first bias cannot be reached by the coarse pass is solved by the
+worker of the chunk before it. With a single chunk the points are solved
+in the context of the sweep, one after another. Within a chunk each point
+starts from the solution given by a TSolutionPredictor.
+
+record_data[i][j] holds parameter i at bias point j, parameter 0 is the
+applied bias.
+
+In the adaptive step mode the increment is only the initial step. The
+points are solved one after another in the context of the sweep and the
+step follows the convergence of Newton and the shape of the contact current and,
+in a laser, of the photon number. The number of points is then only known
+at the end, so the values are kept by the sweep itself and read with
+get_record_value(). The biases still increase (or decrease) monotonically
+from the start bias to start_bias+(number_values-1)*increment.
+
+A function set with put_point_function() is called with the number of each
+solved point, in bias order, on the thread that called execute() and in
+the context of the sweep, so a program can show and save the points as
+they come in. A point is reported once it and all points before it are
+solved: while the calling thread solves its own chunk after each of its
+points, and the points that other workers solved later than that when the
+sweep ends. The values of the point are read with get_record_value().
+
+**************************************************************************/
+
+typedef void (*SweepPointFunction)(void *point_data, int value_number);
+
+struct SweepChunk {
+	int start_value;
+	int end_value;
+	int solved_values;
+	FILE *state_file;
+	TSimulationContext *context;
+};
+
+class TBiasSweep {
+private:
+	int contact_number;
+	prec start_bias;
+	prec increment;
+	int number_values;
+	int number_parameters;
+	FlagType *flag_type_array;
+	flag *flag_array;
+	int *object_array;
+	prec **record_data;
+	int number_chunks;
+	SweepChunk *chunks;
+	float coarse_error_factor;
+	float max_error[3];
+	PredictorType predictor_type;
+	logical adaptive_step;
+	int adaptive_size;
+	prec **adaptive_data;
+	logical *stop_flag;
+	TSimulationContext *master_context;
+	int solved_values;
+	SweepPointFunction point_function;
+	void *point_data;
+	int reported_values;
+	TWorkerLock progress_lock;
+public:
+	TBiasSweep(TSimulationContext *new_context, int new_contact_number, prec new_start_bias,
+			   prec new_increment, int new_number_values, int new_number_parameters,
+			   FlagType *new_flag_type_array, flag *new_flag_array, int *new_object_array,
+			   prec **new_record_data);
+	~TBiasSweep(void) { delete_chunks(); delete_adaptive_data(); }
+	void put_number_workers(int number_workers);
+	void put_coarse_error_factor(float factor) { coarse_error_factor=factor; }
+	void put_predictor(PredictorType new_type) { predictor_type=new_type; }
+	void put_adaptive_step(logical adaptive) { adaptive_step=adaptive; }
+	void put_stop_flag(logical *new_stop_flag) { stop_flag=new_stop_flag; }
+	void put_point_function(SweepPointFunction function, void *data)
+		{ point_function=function; point_data=data; }
+	int get_number_chunks(void) { return(number_chunks); }
+	int get_solved_values(void) { return(solved_values); }
+	prec get_record_value(int parameter, int value_number);
+	void execute(void);
+	void write_data_file(const char *filename);
+private:
+	void record_values(TSimulationContext *context, prec **data, int value_number);
+	void create_chunks(void);
+	void delete_chunks(void);
+	void put_tolerance(TSimulationContext *context, float factor);
+	FILE *save_state(TSimulationContext *context);
+	void restore_state(TSimulationContext *context, FILE *file_ptr);
+	logical coarse_solve(prec bias);
+	void coarse_pass(void);
+	void prepare_chunk(SweepChunk *chunk);
+	void solve_chunk(int chunk_number);
+	void merge_chunks(void);
+	void copy_chunk_state(SweepChunk *chunk);
+	static void chunk_task(void *sweep, int chunk_number);
+	void report_points(void);
+	void adaptive_pass(void);
+	void store_adaptive_values(prec bias);
+	void delete_adaptive_data(void);
+	int get_monitor_values(prec *values);
+	static prec comp_deviation(prec bias_0, prec value_0, prec bias_1, prec value_1,
+							   prec bias_2, prec value_2);
+};
+
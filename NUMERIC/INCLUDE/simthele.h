@@ -25,6 +25,8 @@ public:
 	virtual void update(prec update_lattice_temp, prec update_electron_temp,
 						prec update_hole_temp);
 	virtual void outer_update(prec clamp_value, prec relaxation_value);
+	virtual void comp_outer_residual(prec *residual);
+	virtual void outer_step(prec *step, prec clamp_value);
 	virtual void update_sub_nodes(void) {}
 
 	virtual void apply_boundary(void) {}
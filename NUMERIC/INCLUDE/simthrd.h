@@ -0,0 +1,70 @@
+/*
+    SimWindows - 1D Semiconductor Device Simulator
+    Copyright (C) 2013 David W. Winston
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/*************************************************************************
+
+Worker pool - a fixed set of threads that execute numbered tasks. The
+calling thread takes part in the work and run() returns when all tasks
+are done. Tasks execute in the simulation context the pool was created
+for. The thread handles and synchronization objects are kept in
+WorkerSync, defined with the platform code in wrkclass.cpp. TWorkerLock
+guards data that tasks share while they run.
+
+**************************************************************************/
+
+typedef void (*WorkerTask)(void *task_data, int task_number);
+
+struct WorkerSync;
+
+class TWorkerPool {
+private:
+	int number_threads;
+	WorkerSync *sync;
+	WorkerTask task;
+	void *task_data;
+	int number_tasks;
+	int next_task;
+	logical running;
+	logical shutdown;
+	TSimulationContext *context;
+public:
+	TWorkerPool(TSimulationContext *new_context, int number_workers=0);
+	~TWorkerPool(void);
+	int get_number_workers(void) { return(number_threads+1); }
+	void run(WorkerTask new_task, void *new_task_data, int new_number_tasks);
+private:
+	void execute_tasks(void);
+	logical get_next_task(int& task_number);
+	static void thread_main(TWorkerPool *pool);
+	friend struct WorkerSync;
+};
+
+struct WorkerMutex;
+
+class TWorkerLock {
+private:
+	WorkerMutex *mutex;
+public:
+	TWorkerLock(void);
+	~TWorkerLock(void);
+	void lock(void);
+	void unlock(void);
+};
+
+int get_number_processors(void);
+
@@ -1060,8 +1060,16 @@ char *environment_long_table[]= {
 	"Max Mode Iteration",
 	"Temperature Clamp Value",
 	"Temperature Relaxation Value",
+	"Newton Refactor Ratio",
+	"Max Line Search Iteration",
+	"Anderson Mixing Depth",
+	"Tunneling Quadrature Order",
+	"Tunneling Quadrature Tolerance",
+	"Parallel Assembly Min Nodes",
+	"Partitioned Solver Min Nodes",
+	"Parallel Property Min Nodes",
 #ifndef NDEBUG
-	"","","","","","","","","","","","","",
+	"","","","","",
 #endif
 };
 
@@ -1085,8 +1093,16 @@ char *environment_short_table[]= {
 	"Max Mode Iter",
 	"Temp Clamp Value",
 	"Temp Relax Value",
+	"Refactor Ratio",
+	"Max Line Search Iter",
+	"Anderson Depth",
+	"Tunnel Quad Order",
+	"Tunnel Quad Tolerance",
+	"Assembly Min Nodes",
+	"Partition Min Nodes",
+	"Property Min Nodes",
 #ifndef NDEBUG
-	"","","","","","","","","","","","","",
+	"","","","","",
 #endif
 };
 
@@ -27,6 +27,8 @@ void out_error_message(logical clear_error);
 void out_elect_convergence(short iterations, FundamentalParam error);
 void out_optic_convergence(short iterations, prec error);
 void out_therm_convergence(short iterations, prec error);
+void out_outer_therm_convergence(short iterations, prec error);
+void out_tunnel_evaluations(long evaluations);
 void out_coarse_mode_convergence(short iterations, prec error);
 void out_fine_mode_convergence(short iterations, prec error);
 void out_operating_condition(void);
@@ -0,0 +1,92 @@
+/*
+    SimWindows - 1D Semiconductor Device Simulator
+    Copyright (C) 2013 David W. Winston
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "comincl.h"
+
+//************************************* class TObjectArena ************************************
+/*
+class TObjectArena {
+private:
+	ArenaBlock *first_block;
+	char *next_free;
+	char *block_end;
+public:
+	TObjectArena(void) { first_block=(ArenaBlock *)0; next_free=block_end=(char *)0; }
+	~TObjectArena(void) { release(); }
+	static size_t object_size(size_t bytes)
+		{ return(((bytes+ARENA_ALIGNMENT-1)/ARENA_ALIGNMENT)*ARENA_ALIGNMENT); }
+	logical reserve(size_t bytes);
+	void *allocate(size_t bytes);
+	void release(void);
+private:
+	logical add_block(size_t bytes);
+};
+*/
+
+/*
+	Makes sure the next bytes of allocations fit in the current block, starting a new block
+	if they do not. The rest of the old block is left unused.
+*/
+logical TObjectArena::reserve(size_t bytes)
+{
+	if ((size_t)(block_end-next_free)>=bytes) return(TRUE);
+	return(add_block(bytes));
+}
+
+void *TObjectArena::allocate(size_t bytes)
+{
+	void *object;
+
+	bytes=object_size(bytes);
+	if (((size_t)(block_end-next_free)<bytes) && (!add_block(bytes))) return((void *)0);
+
+	object=next_free;
+	next_free+=bytes;
+	return(object);
+}
+
+void TObjectArena::release(void)
+{
+	ArenaBlock *block;
+
+	while (first_block) {
+		block=first_block;
+		first_block=first_block->next_block;
+		delete[] (char *)block;
+	}
+	next_free=block_end=(char *)0;
+}
+
+logical TObjectArena::add_block(size_t bytes)
+{
+	size_t header_bytes, block_bytes;
+	char *block;
+
+	header_bytes=object_size(sizeof(ArenaBlock));
+	block_bytes=ARENA_BLOCK_BYTES;
+	if (bytes+header_bytes>block_bytes) block_bytes=bytes+header_bytes;
+
+	block=new char[block_bytes];
+	if (!block) return(FALSE);
+
+	((ArenaBlock *)block)->next_block=first_block;
+	first_block=(ArenaBlock *)block;
+	next_free=block+header_bytes;
+	block_end=block+block_bytes;
+	return(TRUE);
+}
@@ -43,8 +43,9 @@ public:
 	void comp_equil_dos(void);
 	void comp_non_equil_dos(void);
 
-	prec get_value(flag flag_value, ScaleType scale=UNNORMALIZED);
-	void put_value(flag flag_value, prec value, ScaleType scale=UNNORMALIZED);
+	prec get_value(TSimulationContext *context, flag flag_value, ScaleType scale=UNNORMALIZED);
+	void put_value(TSimulationContext *context, flag flag_value, prec value,
+				   ScaleType scale=UNNORMALIZED);
 
 	void read_state_file(FILE *file_ptr);
 	void write_state_file(FILE *file_ptr);
@@ -64,25 +65,25 @@ TBoundElectron::TBoundElectron(TQuantumWell *qw)
 
 void TBoundElectron::comp_conc(void)
 {
-	concentration=qw_ptr->T2DElectron::conc*sq(wave_function);
+	concentration=((T2DElectron *)qw_ptr)->conc*sq(wave_function);
 }
 
 void TBoundElectron::comp_deriv_conc(void)
 {
-	deriv_conc_eta_c=qw_ptr->T2DElectron::deriv_conc_eta_c*sq(wave_function);
+	deriv_conc_eta_c=((T2DElectron *)qw_ptr)->deriv_conc_eta_c*sq(wave_function);
 }
 
 void TBoundElectron::comp_equil_dos(void)
 {
-	equil_dos=qw_ptr->T2DElectron::equil_dos/qw_ptr->T2DElectron::qw_length;
+	equil_dos=((T2DElectron *)qw_ptr)->equil_dos/((T2DElectron *)qw_ptr)->qw_length;
 }
 
 void TBoundElectron::comp_non_equil_dos(void)
 {
-	non_equil_dos=qw_ptr->T2DElectron::non_equil_dos/qw_ptr->T2DElectron::qw_length;
+	non_equil_dos=((T2DElectron *)qw_ptr)->non_equil_dos/((T2DElectron *)qw_ptr)->qw_length;
 }
 
-prec TBoundElectron::get_value(flag flag_value, ScaleType scale)
+prec TBoundElectron::get_value(TSimulationContext *context, flag flag_value, ScaleType scale)
 {
 	prec return_value;
 
@@ -94,13 +95,14 @@ prec TBoundElectron::get_value(flag flag_value, ScaleType scale)
 		case ENERGY_TOP: return_value=qw_energy_top; break;
 		default: assert(FALSE); return(0.0);
 	}
-	if (scale==UNNORMALIZED) return_value*=get_normalize_value(BOUND_ELECTRON,flag_value);
+	if (scale==UNNORMALIZED) return_value*=get_normalize_value(context,BOUND_ELECTRON,flag_value);
 	return(return_value);
 }
 
-void TBoundElectron::put_value(flag flag_value, prec value, ScaleType scale)
+void TBoundElectron::put_value(TSimulationContext *context, flag flag_value, prec value,
+								 ScaleType scale)
 {
-	if (scale==UNNORMALIZED) value/=get_normalize_value(BOUND_ELECTRON,flag_value);
+	if (scale==UNNORMALIZED) value/=get_normalize_value(context,BOUND_ELECTRON,flag_value);
 
 	switch(flag_value) {
 		case EQUIL_DOS: equil_dos=value; return;
@@ -152,8 +154,9 @@ public:
 	void comp_equil_dos(void);
 	void comp_non_equil_dos(void);
 
-	prec get_value(flag flag_value, ScaleType scale=UNNORMALIZED);
-	void put_value(flag flag_value, prec value, ScaleType scale=UNNORMALIZED);
+	prec get_value(TSimulationContext *context, flag flag_value, ScaleType scale=UNNORMALIZED);
+	void put_value(TSimulationContext *context, flag flag_value, prec value,
+				   ScaleType scale=UNNORMALIZED);
 
 	void read_state_file(FILE *file_ptr);
 	void write_state_file(FILE *file_ptr);
@@ -173,25 +176,25 @@ TBoundHole::TBoundHole(TQuantumWell *qw)
 
 void TBoundHole::comp_conc(void)
 {
-	concentration=qw_ptr->T2DHole::conc*sq(wave_function);
+	concentration=((T2DHole *)qw_ptr)->conc*sq(wave_function);
 }
 
 void TBoundHole::comp_deriv_conc(void)
 {
-	deriv_conc_eta_v=qw_ptr->T2DHole::deriv_conc_eta_v*sq(wave_function);
+	deriv_conc_eta_v=((T2DHole *)qw_ptr)->deriv_conc_eta_v*sq(wave_function);
 }
 
 void TBoundHole::comp_equil_dos(void)
 {
-	equil_dos=qw_ptr->T2DHole::equil_dos/qw_ptr->T2DHole::qw_length;
+	equil_dos=((T2DHole *)qw_ptr)->equil_dos/((T2DHole *)qw_ptr)->qw_length;
 }
 
 void TBoundHole::comp_non_equil_dos(void)
 {
-	non_equil_dos=qw_ptr->T2DHole::non_equil_dos/qw_ptr->T2DHole::qw_length;
+	non_equil_dos=((T2DHole *)qw_ptr)->non_equil_dos/((T2DHole *)qw_ptr)->qw_length;
 }
 
-prec TBoundHole::get_value(flag flag_value, ScaleType scale)
+prec TBoundHole::get_value(TSimulationContext *context, flag flag_value, ScaleType scale)
 {
 	prec return_value;
 
@@ -204,13 +207,14 @@ prec TBoundHole::get_value(flag flag_value, ScaleType scale)
 		default: assert(FALSE); return(0.0);
 	}
 
-	if (scale==UNNORMALIZED) return_value*=get_normalize_value(BOUND_HOLE,flag_value);
+	if (scale==UNNORMALIZED) return_value*=get_normalize_value(context,BOUND_HOLE,flag_value);
 	return(return_value);
 }
 
-void TBoundHole::put_value(flag flag_value, prec value, ScaleType scale)
+void TBoundHole::put_value(TSimulationContext *context, flag flag_value, prec value,
+								 ScaleType scale)
 {
-	if (scale==UNNORMALIZED) value/=get_normalize_value(BOUND_HOLE,flag_value);
+	if (scale==UNNORMALIZED) value/=get_normalize_value(context,BOUND_HOLE,flag_value);
 
 	switch(flag_value) {
 		case EQUIL_DOS: equil_dos=value; return;
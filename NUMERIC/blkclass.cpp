@@ -0,0 +1,191 @@
+/*
+    SimWindows - 1D Semiconductor Device Simulator
+    Copyright (C) 2013 David W. Winston
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "comincl.h"
+#include "simblock.h"
+
+//*********************************** class TBlockJacobian ************************************
+/*
+struct BlockJacobianView {
+	prec *data;
+	int variables;
+	prec *get_row(int row_number) { return(data+row_number*3*variables); }
+};
+
+struct BlockPartitionView {
+	prec *data;
+	int unknown_nodes;
+	int partitions;
+	prec *spike;
+	prec *reduced;
+	prec *reduced_solution;
+	prec *workspace;
+	prec **solution;
+};
+
+class TBlockJacobian {
+private:
+	prec *buffer;
+	prec *data;
+	int size;
+	prec *partition_buffer;
+	int partition_size;
+	int partitions;
+	TWorkerPool *partition_pool;
+public:
+	TBlockJacobian(void)
+		{ buffer=data=partition_buffer=(prec *)0; size=partition_size=partitions=0;
+		  partition_pool=(TWorkerPool *)0; }
+	~TBlockJacobian(void) { delete[] buffer; delete[] partition_buffer; }
+	logical allocate(int new_size);
+	BlockJacobianView get_view(int variables);
+	void factor(int variables, int unknown_nodes, int new_partitions, TWorkerPool *pool);
+	void solve(int variables, prec **solution, int unknown_nodes);
+private:
+	logical allocate_partitions(int variables, int unknown_nodes, int new_partitions);
+	BlockPartitionView get_partition_view(int variables, int unknown_nodes);
+};
+*/
+
+/*
+	Makes room for new_size values. The buffer is allocated with one extra alignment
+	block and data is moved up to the first aligned address.
+*/
+logical TBlockJacobian::allocate(int new_size)
+{
+	int align_values;
+
+	if (new_size<=size) return(TRUE);
+
+	delete[] buffer;
+	data=(prec *)0;
+	size=0;
+
+	align_values=JACOBIAN_ALIGNMENT/sizeof(prec);
+	buffer=new prec[new_size+align_values];
+	if (!buffer) return(FALSE);
+
+	data=(prec *)(((size_t)buffer+JACOBIAN_ALIGNMENT-1) & ~((size_t)JACOBIAN_ALIGNMENT-1));
+	size=new_size;
+	return(TRUE);
+}
+
+BlockJacobianView TBlockJacobian::get_view(int variables)
+{
+	BlockJacobianView view;
+
+	view.data=data;
+	view.variables=variables;
+	return(view);
+}
+
+
+/*
+	Factors the jacobian of unknown_nodes nodes. With more than one partition the
+	partitioned solver is used, unless there is no memory for its storage.
+*/
+void TBlockJacobian::factor(int variables, int unknown_nodes, int new_partitions, TWorkerPool *pool)
+{
+	BlockPartitionView view;
+
+	partitions=0;
+	if ((new_partitions>1) && allocate_partitions(variables,unknown_nodes,new_partitions)) {
+		partitions=new_partitions;
+		partition_pool=pool;
+		view=get_partition_view(variables,unknown_nodes);
+		switch(variables) {
+			case 1: partition_factor<1>(&view,pool); break;
+			case 2: partition_factor<2>(&view,pool); break;
+			case 3: partition_factor<3>(&view,pool); break;
+			case 4: partition_factor<4>(&view,pool); break;
+			default: assert(FALSE); break;
+		}
+		return;
+	}
+
+	switch(variables) {
+		case 1: block_factor<1>(data,unknown_nodes); break;
+		case 2: block_factor<2>(data,unknown_nodes); break;
+		case 3: block_factor<3>(data,unknown_nodes); break;
+		case 4: block_factor<4>(data,unknown_nodes); break;
+		default: assert(FALSE); break;
+	}
+}
+
+void TBlockJacobian::solve(int variables, prec **solution, int unknown_nodes)
+{
+	BlockPartitionView view;
+
+	if (partitions) {
+		view=get_partition_view(variables,unknown_nodes);
+		switch(variables) {
+			case 1: partition_solve<1>(&view,solution,partition_pool); break;
+			case 2: partition_solve<2>(&view,solution,partition_pool); break;
+			case 3: partition_solve<3>(&view,solution,partition_pool); break;
+			case 4: partition_solve<4>(&view,solution,partition_pool); break;
+			default: assert(FALSE); break;
+		}
+		return;
+	}
+
+	switch(variables) {
+		case 1: block_solve<1>(data,solution,unknown_nodes); break;
+		case 2: block_solve<2>(data,solution,unknown_nodes); break;
+		case 3: block_solve<3>(data,solution,unknown_nodes); break;
+		case 4: block_solve<4>(data,solution,unknown_nodes); break;
+		default: assert(FALSE); break;
+	}
+}
+
+/*
+	The spikes, the reduced system, its right hand side and the workspace share one
+	buffer, which like the jacobian only grows.
+*/
+logical TBlockJacobian::allocate_partitions(int variables, int unknown_nodes, int new_partitions)
+{
+	int new_size;
+
+	new_size=variables*variables*(4*new_partitions+3*(new_partitions-1))+
+			 variables*(new_partitions-1)+variables*unknown_nodes;
+	if (new_size<=partition_size) return(TRUE);
+
+	delete[] partition_buffer;
+	partition_size=0;
+
+	partition_buffer=new prec[new_size];
+	if (!partition_buffer) return(FALSE);
+
+	partition_size=new_size;
+	return(TRUE);
+}
+
+BlockPartitionView TBlockJacobian::get_partition_view(int variables, int unknown_nodes)
+{
+	BlockPartitionView view;
+
+	view.data=data;
+	view.unknown_nodes=unknown_nodes;
+	view.partitions=partitions;
+	view.spike=partition_buffer;
+	view.reduced=view.spike+4*variables*variables*partitions;
+	view.reduced_solution=view.reduced+3*variables*variables*(partitions-1);
+	view.workspace=view.reduced_solution+variables*(partitions-1);
+	view.solution=(prec **)0;
+	return(view);
+}
+
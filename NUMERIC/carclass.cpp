@@ -53,18 +53,18 @@ protected:
 	long collision_factor;
 
 public:
-	TElectron(RegionType region, TQuantumWell *qw_ptr);
+	TElectron(TSimulationContext *new_context, RegionType region, TQuantumWell *qw_ptr);
 
 // Comp functions
 	void comp_auger_coefficient(MaterialSpecification material, prec position);
 	void comp_auger_hotcarriers(prec intrinsic_conc, prec hole_conc,
-    						    prec hole_auger_coeff, prec rec_auger);
-	void comp_b_b_hotcarriers(prec rec_b_b);
+    						    prec hole_auger_coeff, prec rec_auger, prec fermi_ratio=0.0);
+	void comp_b_b_hotcarriers(prec rec_b_b, prec fermi_ratio=0.0);
 	void comp_kin_optical_generation_hotcarriers(prec rec_opt_gen, prec inc_pho_ene,
 												 prec band_gap, prec r_dos_mass);
 	void comp_ref_optical_generation_hotcarriers(prec rec_opt_gen);
 	void comp_stim_hotcarriers(prec rec_stim, prec r_dos_mass, prec band_gap, prec inc_pho_ene);
-	void comp_relax_hotcarriers(prec lat_temp);
+	void comp_relax_hotcarriers(prec lat_temp, prec fermi_ratio=0.0);
 	void comp_shr_hotcarriers(prec intrinsic_conc, prec lattice_temp, prec hole_conc,
 							  prec hole_shr_lifetime, prec shr_recomb);
 	void comp_total_hotcarriers(void);
@@ -72,12 +72,18 @@ public:
 	void comp_cond_mass(MaterialSpecification material, prec position);
 	void comp_collision_factor(MaterialSpecification material, prec position);
 	void comp_current(int start_node_number, int node_number,
-					  float position, prec recombination_total);
+					  float position, prec recombination_total, CurrentSweep& sweep);
 	void comp_deriv_conc(void);
+	void comp_fermi_conc(prec fermi_1_half)
+		{ TFreeElectron::comp_fermi_conc(fermi_1_half); total_conc=TFreeElectron::concentration; }
+	void comp_fermi_deriv_conc(prec fermi_minus_1_half)
+		{ TFreeElectron::comp_fermi_deriv_conc(fermi_minus_1_half);
+		  total_deriv_conc_eta_c=TFreeElectron::deriv_conc_eta_c; }
 	void comp_deriv_ionized_doping(void);
 	void comp_deriv_hotcarriers(Recombination recombination, prec lat_temp,
 								prec intrinsic_conc, prec hole_conc,
-                                prec hole_shr_lifetime, prec hole_auger_coeff);
+                                prec hole_shr_lifetime, prec hole_auger_coeff, prec fermi_ratio=0.0);
+	prec fermi_energy_ratio(prec fermi_ratio);
 	void comp_dos_mass(MaterialSpecification material, prec position);
 	void comp_equil_dos(prec lat_temp);
 	void comp_non_equil_dos(void);
@@ -92,6 +98,7 @@ public:
 								prec band_gap);
 	void comp_ionized_doping(void);
 	void store_temperature(void) { stored_temperature=temperature; }
+	logical bulk_fermi_dirac(void) { return(!qw_ptr && (effects & GRID_FERMI_DIRAC)); }
 
 	//Init functions
 	void init_conc(void);
@@ -107,8 +114,8 @@ public:
 };
 */
 
-TElectron::TElectron(RegionType region, TQuantumWell *qw_ptr)
-	: TFreeElectron(), TBoundElectron(qw_ptr)
+TElectron::TElectron(TSimulationContext *new_context, RegionType region, TQuantumWell *qw_ptr)
+	: TFreeElectron(new_context), TBoundElectron(qw_ptr)
 {
 	region_type=region;
 	temperature=0.0;
@@ -144,14 +151,26 @@ TElectron::TElectron(RegionType region, TQuantumWell *qw_ptr)
 
 void TElectron::comp_auger_coefficient(MaterialSpecification material, prec position)
 {
+	NormalizeConstants& normalization=context->normalization;
 	prec values[]= { material.alloy_conc, position*normalization.length/1e-4 };
 
-	auger_coefficient=material_parameters.evaluate(MAT_ELECTRON_AUGER_COEFFICIENT,material.material_type,
-												   material.alloy_type,values)*sq(normalization.conc)*normalization.time;
+	auger_coefficient=context->material_parameters.evaluate(MAT_ELECTRON_AUGER_COEFFICIENT,material.material_type,
+															material.alloy_type,values)*sq(normalization.conc)*normalization.time;
+}
+
+/*
+	F3/2/F1/2 at the Planck potential, the mean kinetic energy of a free carrier with Fermi-Dirac
+	statistics in units of 3/2 kT. The full grid passes of TNode take it from the array forms of
+	the fermi integrals and pass it as fermi_ratio; zero has it computed here.
+*/
+prec TElectron::fermi_energy_ratio(prec fermi_ratio)
+{
+	if (fermi_ratio!=0.0) return(fermi_ratio);
+	return(fermi_integral_3_half(context,planck_potential)/fermi_integral_1_half(context,planck_potential));
 }
 
 void TElectron::comp_auger_hotcarriers(prec intrinsic_conc, prec hole_conc,
-									   prec hole_auger_coeff, prec rec_auger)
+									   prec hole_auger_coeff, prec rec_auger, prec fermi_ratio)
 {
 	prec n=TFreeElectron::concentration;
 	prec p=hole_conc;
@@ -163,7 +182,7 @@ void TElectron::comp_auger_hotcarriers(prec intrinsic_conc, prec hole_conc,
 		}
 		else {
 			if (effects & GRID_FERMI_DIRAC)
-				hotcarriers.auger=((3.0/2.0)*(fermi_integral_3_half(planck_potential)/fermi_integral_1_half(planck_potential))*
+				hotcarriers.auger=((3.0/2.0)*fermi_energy_ratio(fermi_ratio)*
 								  temperature+band_edge)*hole_auger_coeff*p*(n*p-sq(ni));
 			else hotcarriers.auger=((3.0/2.0)*(temperature)+band_edge)*hole_auger_coeff*p*(n*p-sq(ni));
 		}
@@ -171,7 +190,7 @@ void TElectron::comp_auger_hotcarriers(prec intrinsic_conc, prec hole_conc,
     else hotcarriers.auger=0.0;
 }
 
-void TElectron::comp_b_b_hotcarriers(prec rec_b_b)
+void TElectron::comp_b_b_hotcarriers(prec rec_b_b, prec fermi_ratio)
 {
 	if (effects & GRID_RECOMB_B_B) {
 		if (qw_ptr){
@@ -179,7 +198,7 @@ void TElectron::comp_b_b_hotcarriers(prec rec_b_b)
 		}
 		else {
 			if (effects & GRID_FERMI_DIRAC)
-				hotcarriers.b_b=((3.0/2.0)*(fermi_integral_3_half(planck_potential)/fermi_integral_1_half(planck_potential))*
+				hotcarriers.b_b=((3.0/2.0)*fermi_energy_ratio(fermi_ratio)*
 								  temperature+band_edge)*rec_b_b;
 			else hotcarriers.b_b=((3.0/2.0)*(temperature)+band_edge)*rec_b_b;
 		}
@@ -228,7 +247,7 @@ void TElectron::comp_shr_hotcarriers(prec intrinsic_conc, prec lattice_temp, pre
 	else hotcarriers.shr=0.0;
 }
 
-void TElectron::comp_relax_hotcarriers(prec lat_temp)
+void TElectron::comp_relax_hotcarriers(prec lat_temp, prec fermi_ratio)
 {
 	if (effects & GRID_RELAX) {
 		if (fabs(temperature-lat_temp)<=1e-5) hotcarriers.relax=0.0;
@@ -240,7 +259,7 @@ void TElectron::comp_relax_hotcarriers(prec lat_temp)
 			else {
 				if (effects & GRID_FERMI_DIRAC)
 					hotcarriers.relax=(3./2.)*total_conc*
-									   fermi_integral_3_half(planck_potential)/fermi_integral_1_half(planck_potential)*
+									   fermi_energy_ratio(fermi_ratio)*
 									   (temperature - lat_temp)/energy_lifetime;
 				else
 					hotcarriers.relax=(3./2.)*total_conc*(temperature - lat_temp)/energy_lifetime;
@@ -252,7 +271,7 @@ void TElectron::comp_relax_hotcarriers(prec lat_temp)
 
 void TElectron::comp_deriv_hotcarriers(Recombination recombination, prec lat_temp,
 									   prec intrinsic_conc, prec hole_conc,
-                                       prec hole_shr_lifetime, prec hole_auger_coeff)
+                                       prec hole_shr_lifetime, prec hole_auger_coeff, prec fermi_ratio)
 {
 	prec n=TFreeElectron::concentration;
 	prec p=hole_conc;
@@ -266,7 +285,7 @@ void TElectron::comp_deriv_hotcarriers(Recombination recombination, prec lat_tem
 		}
 		else {
 			if (effects & GRID_FERMI_DIRAC)
-				total_deriv_hotcarriers+=fermi_integral_3_half(planck_potential)/fermi_integral_1_half(planck_potential)*
+				total_deriv_hotcarriers+=fermi_energy_ratio(fermi_ratio)*
 										(1.5*recombination.b_b);
 			else
 				total_deriv_hotcarriers+=1.5*recombination.b_b;
@@ -289,7 +308,7 @@ void TElectron::comp_deriv_hotcarriers(Recombination recombination, prec lat_tem
 		}
 		else {
 			if (effects & GRID_FERMI_DIRAC)
-				total_deriv_hotcarriers+=(3.0/2.0)*(fermi_integral_3_half(planck_potential)/fermi_integral_1_half(planck_potential))*
+				total_deriv_hotcarriers+=(3.0/2.0)*fermi_energy_ratio(fermi_ratio)*
                 						  hole_auger_coeff*p*(n*p-sq(ni));
 			else total_deriv_hotcarriers+=(3.0/2.0)*hole_auger_coeff*p*(n*p-sq(ni));
 		}
@@ -303,7 +322,7 @@ void TElectron::comp_deriv_hotcarriers(Recombination recombination, prec lat_tem
 			}
 			else {
 				if (effects & GRID_FERMI_DIRAC)
-					total_deriv_hotcarriers+=(fermi_integral_3_half(planck_potential)/fermi_integral_1_half(planck_potential))*
+					total_deriv_hotcarriers+=fermi_energy_ratio(fermi_ratio)*
 											 (3./2.)*(total_conc/energy_lifetime);
 				else
 					total_deriv_hotcarriers+=(3./2.)*(total_conc/energy_lifetime);
@@ -337,32 +356,30 @@ void TElectron::comp_conc(void)
 
 void TElectron::comp_cond_mass(MaterialSpecification material, prec position)
 {
-	prec values[]= { material.alloy_conc, position*normalization.length/1e-4 };
+	prec values[]= { material.alloy_conc, position*context->normalization.length/1e-4 };
 
-	cond_mass=material_parameters.evaluate(MAT_ELECTRON_COND_MASS,material.material_type,
-										   material.alloy_type,values);
+	cond_mass=context->material_parameters.evaluate(MAT_ELECTRON_COND_MASS,material.material_type,
+													material.alloy_type,values);
 }
 
 void TElectron::comp_collision_factor(MaterialSpecification material, prec position)
 {
-	prec values[]= { material.alloy_conc, position*normalization.length/1e-4 };
+	prec values[]= { material.alloy_conc, position*context->normalization.length/1e-4 };
 
-	collision_factor=(long) (material_parameters.evaluate(MAT_ELECTRON_COLLISION_FACTOR,material.material_type,
-														  material.alloy_type,values)*2.0);
+	collision_factor=(long) (context->material_parameters.evaluate(MAT_ELECTRON_COLLISION_FACTOR,material.material_type,
+																   material.alloy_type,values)*2.0);
 }
 
 void TElectron::comp_current(int start_node_number, int node_number,
-							 float position, prec recombination_total)
+							 float position, prec recombination_total, CurrentSweep& sweep)
 {
-	static prec prev_position, prev_current, prev_recombination;
-
 	if (start_node_number!=node_number) {
-		current=prev_current+((recombination_total+prev_recombination)/2.0)*
-							 (position-prev_position);
+		current=sweep.prev_current+((recombination_total+sweep.prev_recombination)/2.0)*
+								   (position-sweep.prev_position);
 	}
-	prev_position=position;
-	prev_current=current;
-	prev_recombination=recombination_total;
+	sweep.prev_position=position;
+	sweep.prev_current=current;
+	sweep.prev_recombination=recombination_total;
 }
 
 void TElectron::comp_deriv_conc(void)
@@ -390,9 +407,9 @@ void TElectron::comp_deriv_ionized_doping(void)
 
 void TElectron::comp_dos_mass(MaterialSpecification material, prec position)
 {
-	prec values[]= { material.alloy_conc, position*normalization.length/1e-4 };
+	prec values[]= { material.alloy_conc, position*context->normalization.length/1e-4 };
 
-	dos_mass=material_parameters.evaluate(MAT_ELECTRON_DOS_MASS,material.material_type,
+	dos_mass=context->material_parameters.evaluate(MAT_ELECTRON_DOS_MASS,material.material_type,
 										   material.alloy_type,values);
 }
 
@@ -420,13 +437,14 @@ void TElectron::comp_equil_planck_potential(prec acceptor_conc, prec hole_equil_
 	prec conc_function, deriv_conc_function;
 	prec doping_average;
 	prec concentration;
-	static prec old_donor_conc=0.0, old_acceptor_conc=0.0;
-	static prec old_electron_equil_dos=0.0, old_hole_equil_dos=0.0;
-	static long old_donor_degeneracy=0, old_acceptor_degeneracy=0;
-	static prec old_donor_level=0.0, old_acceptor_level=0.0;
-	static prec old_band_gap=0.0, old_lattice_temp=0.0;
-	static logical old_fermi_method=FALSE, old_ionized_doping_method=FALSE;
-	static prec old_result=0.0;
+	static SIM_THREAD_LOCAL prec old_donor_conc=0.0, old_acceptor_conc=0.0;
+	static SIM_THREAD_LOCAL prec old_electron_equil_dos=0.0, old_hole_equil_dos=0.0;
+	static SIM_THREAD_LOCAL long old_donor_degeneracy=0, old_acceptor_degeneracy=0;
+	static SIM_THREAD_LOCAL prec old_donor_level=0.0, old_acceptor_level=0.0;
+	static SIM_THREAD_LOCAL prec old_band_gap=0.0, old_lattice_temp=0.0;
+	static SIM_THREAD_LOCAL int old_fermi_method=0;
+	static SIM_THREAD_LOCAL logical old_ionized_doping_method=FALSE;
+	static SIM_THREAD_LOCAL prec old_result=0.0;
 	logical same_values=FALSE;
 
 	if (qw_ptr) {
@@ -441,7 +459,7 @@ void TElectron::comp_equil_planck_potential(prec acceptor_conc, prec hole_equil_
 
 		if ((effects & GRID_FERMI_DIRAC) || (effects & GRID_INCOMPLETE_IONIZATION)) {
 			if ( same_values &&
-				 (((effects & GRID_FERMI_DIRAC)!=0)==old_fermi_method) &&
+				 (fermi_method(context,effects)==old_fermi_method) &&
 				 (((effects & GRID_INCOMPLETE_IONIZATION)!=0)==old_ionized_doping_method) )
 				 equil_planck_potential=old_result;
 			else {
@@ -449,11 +467,11 @@ void TElectron::comp_equil_planck_potential(prec acceptor_conc, prec hole_equil_
 
 				do {
 					if (effects & GRID_FERMI_DIRAC) {
-						conc_difference=TFreeElectron::equil_dos*fermi_integral_1_half(new_planck_potential)-
-										hole_equil_dos*fermi_integral_1_half(-new_planck_potential-band_gap/lattice_temp);
+						conc_difference=TFreeElectron::equil_dos*fermi_integral_1_half(context,new_planck_potential)-
+										hole_equil_dos*fermi_integral_1_half(context,-new_planck_potential-band_gap/lattice_temp);
 
-						deriv_conc_difference=TFreeElectron::equil_dos*fermi_integral_minus_1_half(new_planck_potential)+
-											  hole_equil_dos*fermi_integral_minus_1_half(-new_planck_potential-
+						deriv_conc_difference=TFreeElectron::equil_dos*fermi_integral_minus_1_half(context,new_planck_potential)+
+											  hole_equil_dos*fermi_integral_minus_1_half(context,-new_planck_potential-
 																						  band_gap/lattice_temp);
 					}
 					else {
@@ -505,7 +523,7 @@ void TElectron::comp_equil_planck_potential(prec acceptor_conc, prec hole_equil_
 				old_band_gap=band_gap;
 				old_lattice_temp=lattice_temp;
 
-				old_fermi_method=((effects & GRID_FERMI_DIRAC)!=0);
+				old_fermi_method=fermi_method(context,effects);
 				old_ionized_doping_method=((effects & GRID_INCOMPLETE_IONIZATION)!=0);
 
 				old_result=equil_planck_potential;
@@ -531,7 +549,7 @@ void TElectron::comp_equil_planck_potential(prec acceptor_conc, prec hole_equil_
 				old_band_gap=band_gap;
 				old_lattice_temp=lattice_temp;
 
-				old_fermi_method=FALSE;
+				old_fermi_method=0;
 				old_ionized_doping_method=FALSE;
 
 				old_result=equil_planck_potential;
@@ -548,18 +566,18 @@ void TElectron::comp_equil_planck_potential(prec hole_equil_planck_pot, prec ban
 
 void TElectron::comp_shr_lifetime(MaterialSpecification material, prec position)
 {
-	prec values[]= { material.alloy_conc, position*normalization.length/1e-4 };
+	prec values[]= { material.alloy_conc, position*context->normalization.length/1e-4 };
 
-	shr_lifetime=material_parameters.evaluate(MAT_ELECTRON_SHR_LIFETIME,material.material_type,
-											  material.alloy_type,values)/normalization.time;
+	shr_lifetime=context->material_parameters.evaluate(MAT_ELECTRON_SHR_LIFETIME,material.material_type,
+													   material.alloy_type,values)/context->normalization.time;
 }
 
 void TElectron::comp_energy_lifetime(MaterialSpecification material, prec position)
 {
-	prec values[]= { material.alloy_conc, position*normalization.length/1e-4 };
+	prec values[]= { material.alloy_conc, position*context->normalization.length/1e-4 };
 
-	energy_lifetime=material_parameters.evaluate(MAT_ELECTRON_ENERGY_LIFETIME,material.material_type,
-												 material.alloy_type,values)/normalization.time;
+	energy_lifetime=context->material_parameters.evaluate(MAT_ELECTRON_ENERGY_LIFETIME,material.material_type,
+														  material.alloy_type,values)/context->normalization.time;
 }
 
 void TElectron::comp_stimulated_factor(float reduced_mass, prec mode_energy,
@@ -581,7 +599,7 @@ void TElectron::comp_ionized_doping(void)
 void TElectron::init_conc(void)
 {
 	if (effects & GRID_FERMI_DIRAC)
-		total_conc=TFreeElectron::equil_dos*fermi_integral_1_half(equil_planck_potential);
+		total_conc=TFreeElectron::equil_dos*fermi_integral_1_half(context,equil_planck_potential);
 	else
 		total_conc=TFreeElectron::equil_dos*exp(equil_planck_potential);
 	TFreeElectron::concentration=total_conc;
@@ -593,7 +611,7 @@ prec TElectron::get_value(FlagType flag_type, flag flag_value, ScaleType scale)
 	prec return_value;
 
 	switch(flag_type) {
-		case BOUND_ELECTRON: return(TBoundElectron::get_value(flag_value,scale));
+		case BOUND_ELECTRON: return(TBoundElectron::get_value(context,flag_value,scale));
 		case FREE_ELECTRON: return(TFreeElectron::get_value(flag_value,scale));
 		case ELECTRON:
 			switch(flag_value) {
@@ -626,7 +644,7 @@ prec TElectron::get_value(FlagType flag_type, flag flag_value, ScaleType scale)
 				case COLLISION_FACTOR: return_value=(prec)collision_factor/2.0; break;
 				default: assert(FALSE); return(0.0);
 			}
-			if (scale==UNNORMALIZED) return_value*=get_normalize_value(ELECTRON,flag_value);
+			if (scale==UNNORMALIZED) return_value*=get_normalize_value(context,ELECTRON,flag_value);
 			return(return_value);
 		default: assert(FALSE); return(0.0);
 	}
@@ -636,10 +654,10 @@ void TElectron::put_value(FlagType flag_type, flag flag_value,
 						  prec value, ScaleType scale)
 {
 	switch(flag_type) {
-		case BOUND_ELECTRON: TBoundElectron::put_value(flag_value,value,scale); return;
+		case BOUND_ELECTRON: TBoundElectron::put_value(context,flag_value,value,scale); return;
 		case FREE_ELECTRON: TFreeElectron::put_value(flag_value,value,scale); return;
 		case ELECTRON:
-			if (scale==UNNORMALIZED) value/=get_normalize_value(ELECTRON,flag_value);
+			if (scale==UNNORMALIZED) value/=get_normalize_value(context,ELECTRON,flag_value);
 			switch(flag_value) {
 				case TEMPERATURE: temperature=value; return;
 				case DOS_MASS: dos_mass=value; return;
@@ -753,18 +771,18 @@ protected:
 	long collision_factor;
 
 public:
-	THole(RegionType region, TQuantumWell *qw_ptr);
+	THole(TSimulationContext *new_context, RegionType region, TQuantumWell *qw_ptr);
 
 // Comp functions
 	void comp_auger_coefficient(MaterialSpecification material, prec position);
 	void comp_auger_hotcarriers(prec intrinsic_conc, prec electron_conc,
-    							prec electron_auger_coeff, prec rec_auger);
-	void comp_b_b_hotcarriers(prec rec_b_b);
+    							prec electron_auger_coeff, prec rec_auger, prec fermi_ratio=0.0);
+	void comp_b_b_hotcarriers(prec rec_b_b, prec fermi_ratio=0.0);
 	void comp_kin_optical_generation_hotcarriers(prec rec_opt_gen, prec inc_pho_ene,
 											 prec band_gap, prec r_dos_mass);
 	void comp_ref_optical_generation_hotcarriers(prec rec_opt_gen);
 	void comp_stim_hotcarriers(prec rec_stim, prec r_dos_mass, prec band_gap, prec inc_pho_ene);
-	void comp_relax_hotcarriers(prec lat_temp);
+	void comp_relax_hotcarriers(prec lat_temp, prec fermi_ratio=0.0);
 	void comp_shr_hotcarriers(prec intrinsic_conc, prec lattice_temp, prec electron_conc,
 							  prec electron_shr_lifetime, prec shr_recomb);
 	void comp_total_hotcarriers(void);
@@ -772,12 +790,18 @@ public:
 	void comp_cond_mass(MaterialSpecification material, prec position);
 	void comp_collision_factor(MaterialSpecification material, prec position);
 	void comp_current(int start_node_number, int node_number,
-					  float position, prec recombination_total);
+					  float position, prec recombination_total, CurrentSweep& sweep);
 	void comp_deriv_conc(void);
+	void comp_fermi_conc(prec fermi_1_half)
+		{ TFreeHole::comp_fermi_conc(fermi_1_half); total_conc=TFreeHole::concentration; }
+	void comp_fermi_deriv_conc(prec fermi_minus_1_half)
+		{ TFreeHole::comp_fermi_deriv_conc(fermi_minus_1_half);
+		  total_deriv_conc_eta_v=TFreeHole::deriv_conc_eta_v; }
 	void comp_deriv_ionized_doping(void);
 	void comp_deriv_hotcarriers(Recombination recombination, prec lat_temp,
     							prec intrinsic_conc, prec electron_conc,
-                                prec electron_shr_lifetime, prec electron_auger_coeff);
+                                prec electron_shr_lifetime, prec electron_auger_coeff, prec fermi_ratio=0.0);
+	prec fermi_energy_ratio(prec fermi_ratio);
 	void comp_dos_mass(MaterialSpecification material, prec position);
 	void comp_equil_dos(prec lat_temp);
 	void comp_non_equil_dos(void);
@@ -792,6 +816,7 @@ public:
 								prec band_gap);
 	void comp_ionized_doping(void);
 	void store_temperature(void) { stored_temperature=temperature; }
+	logical bulk_fermi_dirac(void) { return(!qw_ptr && (effects & GRID_FERMI_DIRAC)); }
 
 // Init functions
 	void init_conc(void);
@@ -807,8 +832,8 @@ public:
 };
 */
 
-THole::THole(RegionType region, TQuantumWell *qw_ptr)
-	: TFreeHole(), TBoundHole(qw_ptr)
+THole::THole(TSimulationContext *new_context, RegionType region, TQuantumWell *qw_ptr)
+	: TFreeHole(new_context), TBoundHole(qw_ptr)
 {
 	region_type=region;
 	temperature=0.0;
@@ -844,14 +869,21 @@ THole::THole(RegionType region, TQuantumWell *qw_ptr)
 
 void THole::comp_auger_coefficient(MaterialSpecification material, prec position)
 {
+	NormalizeConstants& normalization=context->normalization;
 	prec values[]= { material.alloy_conc, position*normalization.length/1e-4 };
 
-	auger_coefficient=material_parameters.evaluate(MAT_HOLE_AUGER_COEFFICIENT,material.material_type,
-												   material.alloy_type,values)*sq(normalization.conc)*normalization.time;
+	auger_coefficient=context->material_parameters.evaluate(MAT_HOLE_AUGER_COEFFICIENT,material.material_type,
+															material.alloy_type,values)*sq(normalization.conc)*normalization.time;
+}
+
+prec THole::fermi_energy_ratio(prec fermi_ratio)
+{
+	if (fermi_ratio!=0.0) return(fermi_ratio);
+	return(fermi_integral_3_half(context,planck_potential)/fermi_integral_1_half(context,planck_potential));
 }
 
 void THole::comp_auger_hotcarriers(prec intrinsic_conc, prec electron_conc,
-								   prec electron_auger_coeff, prec rec_auger)
+								   prec electron_auger_coeff, prec rec_auger, prec fermi_ratio)
 {
 	prec n=electron_conc;
 	prec p=TFreeHole::concentration;
@@ -863,7 +895,7 @@ void THole::comp_auger_hotcarriers(prec intrinsic_conc, prec electron_conc,
 		}
 		else {
 			if (effects & GRID_FERMI_DIRAC)
-				hotcarriers.auger=((3.0/2.0)*(fermi_integral_3_half(planck_potential)/fermi_integral_1_half(planck_potential))*
+				hotcarriers.auger=((3.0/2.0)*fermi_energy_ratio(fermi_ratio)*
 								  temperature+band_edge)*electron_auger_coeff*n*(n*p-sq(ni));
 			else hotcarriers.auger=((3.0/2.0)*(temperature)+band_edge)*electron_auger_coeff*n*(n*p-sq(ni));
 		}
@@ -871,7 +903,7 @@ void THole::comp_auger_hotcarriers(prec intrinsic_conc, prec electron_conc,
     else hotcarriers.auger=0.0;
 }
 
-void THole::comp_b_b_hotcarriers(prec rec_b_b)
+void THole::comp_b_b_hotcarriers(prec rec_b_b, prec fermi_ratio)
 {
 	if (effects & GRID_RECOMB_B_B) {
 		if (qw_ptr){
@@ -879,7 +911,7 @@ void THole::comp_b_b_hotcarriers(prec rec_b_b)
 		}
 		else {
 			if (effects & GRID_FERMI_DIRAC)
-				hotcarriers.b_b=((3.0/2.0)*(fermi_integral_3_half(planck_potential)/fermi_integral_1_half(planck_potential))*
+				hotcarriers.b_b=((3.0/2.0)*fermi_energy_ratio(fermi_ratio)*
 								  temperature+band_edge)*rec_b_b;
 			else hotcarriers.b_b=((3.0/2.0)*(temperature)+band_edge)*rec_b_b;
 		}
@@ -926,7 +958,7 @@ void THole::comp_shr_hotcarriers(prec intrinsic_conc, prec lattice_temp, prec el
     else hotcarriers.shr=0.0;
 }
 
-void THole::comp_relax_hotcarriers(prec lat_temp)
+void THole::comp_relax_hotcarriers(prec lat_temp, prec fermi_ratio)
 {
 	if (effects & GRID_RELAX) {
 		if (fabs(temperature-lat_temp)<=1e-5) hotcarriers.relax=0.0;
@@ -938,7 +970,7 @@ void THole::comp_relax_hotcarriers(prec lat_temp)
 			else {
 				if (effects & GRID_FERMI_DIRAC)
 					hotcarriers.relax=(3./2.)*total_conc*
-									   fermi_integral_3_half(planck_potential)/fermi_integral_1_half(planck_potential)*
+									   fermi_energy_ratio(fermi_ratio)*
 									   (temperature - lat_temp)/energy_lifetime;
 				else
 					hotcarriers.relax=(3./2.)*total_conc*(temperature - lat_temp)/energy_lifetime;
@@ -950,7 +982,7 @@ void THole::comp_relax_hotcarriers(prec lat_temp)
 
 void THole::comp_deriv_hotcarriers(Recombination recombination, prec lat_temp,
 								   prec intrinsic_conc, prec electron_conc,
-                                   prec electron_shr_lifetime, prec electron_auger_coeff)
+                                   prec electron_shr_lifetime, prec electron_auger_coeff, prec fermi_ratio)
 {
 	prec n=electron_conc;
 	prec p=TFreeHole::concentration;
@@ -964,7 +996,7 @@ void THole::comp_deriv_hotcarriers(Recombination recombination, prec lat_temp,
 		}
 		else {
 			if (effects & GRID_FERMI_DIRAC)
-				total_deriv_hotcarriers+=fermi_integral_3_half(planck_potential)/fermi_integral_1_half(planck_potential)*
+				total_deriv_hotcarriers+=fermi_energy_ratio(fermi_ratio)*
 										(1.5*recombination.b_b);
 			else
 				total_deriv_hotcarriers+=1.5*recombination.b_b;
@@ -987,7 +1019,7 @@ void THole::comp_deriv_hotcarriers(Recombination recombination, prec lat_temp,
 		}
 		else {
 			if (effects & GRID_FERMI_DIRAC)
-				total_deriv_hotcarriers+=(3.0/2.0)*(fermi_integral_3_half(planck_potential)/fermi_integral_1_half(planck_potential))*
+				total_deriv_hotcarriers+=(3.0/2.0)*fermi_energy_ratio(fermi_ratio)*
                 						  electron_auger_coeff*n*(n*p-sq(ni));
 			else total_deriv_hotcarriers+=(3.0/2.0)*electron_auger_coeff*n*(n*p-sq(ni));
 		}
@@ -1001,7 +1033,7 @@ void THole::comp_deriv_hotcarriers(Recombination recombination, prec lat_temp,
 			}
 			else {
 				if (effects & GRID_FERMI_DIRAC)
-					total_deriv_hotcarriers+=(fermi_integral_3_half(planck_potential)/fermi_integral_1_half(planck_potential))*
+					total_deriv_hotcarriers+=fermi_energy_ratio(fermi_ratio)*
 											 (3./2.)*(total_conc/energy_lifetime);
 				else
 					total_deriv_hotcarriers+=(3./2.)*(total_conc/energy_lifetime);
@@ -1035,18 +1067,18 @@ void THole::comp_conc(void)
 
 void THole::comp_cond_mass(MaterialSpecification material, prec position)
 {
-	prec values[]= { material.alloy_conc, position*normalization.length/1e-4 };
+	prec values[]= { material.alloy_conc, position*context->normalization.length/1e-4 };
 
-	cond_mass=material_parameters.evaluate(MAT_HOLE_COND_MASS,material.material_type,
-										   material.alloy_type,values);
+	cond_mass=context->material_parameters.evaluate(MAT_HOLE_COND_MASS,material.material_type,
+													material.alloy_type,values);
 }
 
 void THole::comp_collision_factor(MaterialSpecification material, prec position)
 {
-	prec values[]= { material.alloy_conc, position*normalization.length/1e-4 };
+	prec values[]= { material.alloy_conc, position*context->normalization.length/1e-4 };
 
-	collision_factor=(long) (material_parameters.evaluate(MAT_HOLE_COLLISION_FACTOR,material.material_type,
-														  material.alloy_type,values)*2.0);
+	collision_factor=(long) (context->material_parameters.evaluate(MAT_HOLE_COLLISION_FACTOR,material.material_type,
+																   material.alloy_type,values)*2.0);
 }
 
 void THole::comp_deriv_conc(void)
@@ -1073,25 +1105,23 @@ void THole::comp_deriv_ionized_doping(void)
 }
 
 void THole::comp_current(int start_node_number, int node_number,
-						 float position, prec recombination_total)
+						 float position, prec recombination_total, CurrentSweep& sweep)
 {
-	static prec prev_position, prev_current, prev_recombination;
-
 	if (start_node_number!=node_number) {
-		current=prev_current-((recombination_total+prev_recombination)/2.0)*
-							 (position-prev_position);
+		current=sweep.prev_current-((recombination_total+sweep.prev_recombination)/2.0)*
+								   (position-sweep.prev_position);
 	}
 
-	prev_position=position;
-	prev_current=current;
-	prev_recombination=recombination_total;
+	sweep.prev_position=position;
+	sweep.prev_current=current;
+	sweep.prev_recombination=recombination_total;
 }
 
 void THole::comp_dos_mass(MaterialSpecification material, prec position)
 {
-	prec values[]= { material.alloy_conc, position*normalization.length/1e-4 };
+	prec values[]= { material.alloy_conc, position*context->normalization.length/1e-4 };
 
-	dos_mass=material_parameters.evaluate(MAT_HOLE_DOS_MASS,material.material_type,
+	dos_mass=context->material_parameters.evaluate(MAT_HOLE_DOS_MASS,material.material_type,
 										   material.alloy_type,values);
 }
 
@@ -1119,13 +1149,14 @@ void THole::comp_equil_planck_potential(prec donor_conc, prec electron_equil_dos
 	prec conc_function, deriv_conc_function;
 	prec doping_average;
 	prec concentration;
-	static prec old_donor_conc=0.0, old_acceptor_conc=0.0;
-	static prec old_electron_equil_dos=0.0, old_hole_equil_dos=0.0;
-	static long old_donor_degeneracy=0, old_acceptor_degeneracy=0;
-	static prec old_donor_level=0.0, old_acceptor_level=0.0;
-	static prec old_band_gap=0.0, old_lattice_temp=0.0;
-	static logical old_fermi_method=FALSE, old_ionized_doping_method=FALSE;
-	static prec old_result=0.0;
+	static SIM_THREAD_LOCAL prec old_donor_conc=0.0, old_acceptor_conc=0.0;
+	static SIM_THREAD_LOCAL prec old_electron_equil_dos=0.0, old_hole_equil_dos=0.0;
+	static SIM_THREAD_LOCAL long old_donor_degeneracy=0, old_acceptor_degeneracy=0;
+	static SIM_THREAD_LOCAL prec old_donor_level=0.0, old_acceptor_level=0.0;
+	static SIM_THREAD_LOCAL prec old_band_gap=0.0, old_lattice_temp=0.0;
+	static SIM_THREAD_LOCAL int old_fermi_method=0;
+	static SIM_THREAD_LOCAL logical old_ionized_doping_method=FALSE;
+	static SIM_THREAD_LOCAL prec old_result=0.0;
 	logical same_values=FALSE;
 
 	if ((donor_conc==old_donor_conc) && (doping_conc==old_acceptor_conc) &&
@@ -1136,7 +1167,7 @@ void THole::comp_equil_planck_potential(prec donor_conc, prec electron_equil_dos
 
 	if ((effects & GRID_FERMI_DIRAC) || (effects & GRID_INCOMPLETE_IONIZATION)) {
 		if ( same_values &&
-			 (((effects & GRID_FERMI_DIRAC)!=0)==old_fermi_method) &&
+			 (fermi_method(context,effects)==old_fermi_method) &&
 			 (((effects & GRID_INCOMPLETE_IONIZATION)!=0)==old_ionized_doping_method) )
 			 equil_planck_potential=old_result;
 		else {
@@ -1144,12 +1175,12 @@ void THole::comp_equil_planck_potential(prec donor_conc, prec electron_equil_dos
 
 			do {
 				if (effects & GRID_FERMI_DIRAC) {
-					conc_difference=electron_equil_dos*fermi_integral_1_half(-new_planck_potential-band_gap/lattice_temp)-
-									TFreeHole::equil_dos*fermi_integral_1_half(new_planck_potential);
+					conc_difference=electron_equil_dos*fermi_integral_1_half(context,-new_planck_potential-band_gap/lattice_temp)-
+									TFreeHole::equil_dos*fermi_integral_1_half(context,new_planck_potential);
 
-					deriv_conc_difference=-electron_equil_dos*fermi_integral_minus_1_half(-new_planck_potential-
+					deriv_conc_difference=-electron_equil_dos*fermi_integral_minus_1_half(context,-new_planck_potential-
 																						   band_gap/lattice_temp)-
-										   TFreeHole::equil_dos*fermi_integral_minus_1_half(new_planck_potential);
+										   TFreeHole::equil_dos*fermi_integral_minus_1_half(context,new_planck_potential);
 				}
 				else {
 					conc_difference=electron_equil_dos*exp(-new_planck_potential-band_gap/lattice_temp)-
@@ -1203,7 +1234,7 @@ void THole::comp_equil_planck_potential(prec donor_conc, prec electron_equil_dos
 			old_band_gap=band_gap;
 			old_lattice_temp=lattice_temp;
 
-			old_fermi_method=((effects & GRID_FERMI_DIRAC)!=0);
+			old_fermi_method=fermi_method(context,effects);
 			old_ionized_doping_method=((effects & GRID_INCOMPLETE_IONIZATION)!=0);
 
 			old_result=equil_planck_potential;
@@ -1229,7 +1260,7 @@ void THole::comp_equil_planck_potential(prec donor_conc, prec electron_equil_dos
 			old_band_gap=band_gap;
 			old_lattice_temp=lattice_temp;
 
-			old_fermi_method=FALSE;
+			old_fermi_method=0;
 			old_ionized_doping_method=FALSE;
 
 			old_result=equil_planck_potential;
@@ -1245,18 +1276,18 @@ void THole::comp_equil_planck_potential(prec electron_equil_planck_pot, prec ban
 
 void THole::comp_shr_lifetime(MaterialSpecification material, prec position)
 {
-	prec values[]= { material.alloy_conc, position*normalization.length/1e-4 };
+	prec values[]= { material.alloy_conc, position*context->normalization.length/1e-4 };
 
-	shr_lifetime=material_parameters.evaluate(MAT_HOLE_SHR_LIFETIME,material.material_type,
-											  material.alloy_type,values)/normalization.time;
+	shr_lifetime=context->material_parameters.evaluate(MAT_HOLE_SHR_LIFETIME,material.material_type,
+													   material.alloy_type,values)/context->normalization.time;
 }
 
 void THole::comp_energy_lifetime(MaterialSpecification material, prec position)
 {
-	prec values[]= { material.alloy_conc, position*normalization.length/1e-4 };
+	prec values[]= { material.alloy_conc, position*context->normalization.length/1e-4 };
 
-	energy_lifetime=material_parameters.evaluate(MAT_HOLE_ENERGY_LIFETIME,material.material_type,
-												 material.alloy_type,values)/normalization.time;
+	energy_lifetime=context->material_parameters.evaluate(MAT_HOLE_ENERGY_LIFETIME,material.material_type,
+														  material.alloy_type,values)/context->normalization.time;
 }
 
 void THole::comp_stimulated_factor(float reduced_mass, prec mode_energy,
@@ -1278,7 +1309,7 @@ void THole::comp_ionized_doping(void)
 void THole::init_conc(void)
 {
 	if (effects & GRID_FERMI_DIRAC)
-		total_conc=TFreeHole::equil_dos*fermi_integral_1_half(equil_planck_potential);
+		total_conc=TFreeHole::equil_dos*fermi_integral_1_half(context,equil_planck_potential);
 	else
 		total_conc=TFreeHole::equil_dos*exp(equil_planck_potential);
 	TFreeHole::concentration=total_conc;
@@ -1290,7 +1321,7 @@ prec THole::get_value(FlagType flag_type, flag flag_value, ScaleType scale)
 	prec return_value;
 
 	switch(flag_type) {
-		case BOUND_HOLE: return(TBoundHole::get_value(flag_value,scale));
+		case BOUND_HOLE: return(TBoundHole::get_value(context,flag_value,scale));
 		case FREE_HOLE: return(TFreeHole::get_value(flag_value,scale));
 		case HOLE:
 			switch(flag_value) {
@@ -1323,7 +1354,7 @@ prec THole::get_value(FlagType flag_type, flag flag_value, ScaleType scale)
 				case COLLISION_FACTOR:return_value=(prec)collision_factor/2.0; break;
 				default: assert(FALSE); return(0.0);
 			}
-			if (scale==UNNORMALIZED) return_value*=get_normalize_value(HOLE,flag_value);
+			if (scale==UNNORMALIZED) return_value*=get_normalize_value(context,HOLE,flag_value);
 			return(return_value);
 		default: assert(FALSE); return(0.0);
 	}
@@ -1333,10 +1364,10 @@ void THole::put_value(FlagType flag_type, flag flag_value,
 						  prec value, ScaleType scale)
 {
 	switch(flag_type) {
-		case BOUND_HOLE: TBoundHole::put_value(flag_value,value,scale); return;
+		case BOUND_HOLE: TBoundHole::put_value(context,flag_value,value,scale); return;
 		case FREE_HOLE: TFreeHole::put_value(flag_value,value,scale); return;
 		case HOLE:
-			if (scale==UNNORMALIZED) value/=get_normalize_value(HOLE,flag_value);
+			if (scale==UNNORMALIZED) value/=get_normalize_value(context,HOLE,flag_value);
 			switch(flag_value) {
 				case TEMPERATURE: temperature=value; return;
 				case DOS_MASS: dos_mass=value; return;
@@ -25,6 +25,7 @@
 
 class TCavity {
 private:
+	TSimulationContext *context;
 	CavityType type;
 	prec area;
 	prec length;
@@ -32,7 +33,7 @@ private:
 	TMirror mirror_0;
 	TMirror mirror_1;
 public:
-	TCavity(TDevice *ptr, TNode** grid);
+	TCavity(TSimulationContext *new_context, TDevice *ptr, TNode** grid);
 	void init(void);
 
 	error field_iterate(prec& iteration_error, prec initial_error, int iteration_number);
@@ -51,9 +52,10 @@ public:
 };
 */
 
-TCavity::TCavity(TDevice *ptr, TNode** grid)
-	: mirror_0(ptr), mirror_1(ptr), mode(grid)
+TCavity::TCavity(TSimulationContext *new_context, TDevice *ptr, TNode** grid)
+	: mirror_0(new_context, ptr), mirror_1(new_context, ptr), mode(new_context, grid)
 {
+	context=new_context;
 	type=(CavityType)0;
 	area=0.0;
 }
@@ -99,7 +101,7 @@ prec TCavity::get_value(FlagType flag_type, flag flag_value, int object,
 		default: assert(FALSE); return(0.0);
 	}
 
-	if (scale==UNNORMALIZED) return_value*=get_normalize_value(CAVITY,flag_value);
+	if (scale==UNNORMALIZED) return_value*=get_normalize_value(context,CAVITY,flag_value);
 	return(return_value);
 }
 
@@ -115,19 +117,19 @@ void TCavity::put_value(FlagType flag_type, flag flag_value, int object,
 				default: assert(FALSE); return;
 			}
 		case CAVITY:
-			if (scale==UNNORMALIZED) value/=get_normalize_value(CAVITY,flag_value);
+			if (scale==UNNORMALIZED) value/=get_normalize_value(context,CAVITY,flag_value);
 			switch(flag_value) {
 				case TYPE: type=(CavityType)value; return;
 				case AREA:
 					if (area!=value) {
 						area=value;
-						environment.set_update_flags(CAVITY,AREA);
+						context->environment.set_update_flags(CAVITY,AREA);
 					}
 					return;
 				case LENGTH:
 					if (length!=value) {
 						length=value;
-						environment.set_update_flags(CAVITY,LENGTH);
+						context->environment.set_update_flags(CAVITY,LENGTH);
 					}
                     return;
 				default: assert(FALSE); return;
@@ -28,6 +28,7 @@
 
 class TContact {
 private:
+	TSimulationContext *context;
 	TNode *contact_node;
 	int contact_node_number;
 	TNode *second_node;
@@ -42,7 +43,7 @@ private:
     prec barrier_height;
 
 public:
-	TContact(TNode* contact_node_ptr, TNode* next_node_ptr);
+	TContact(TSimulationContext *new_context, TNode* contact_node_ptr, TNode* next_node_ptr);
 	void init(void);
 
 	void comp_built_pot(void);
@@ -59,8 +60,9 @@ public:
 };
 */
 
-TContact::TContact(TNode* contact_node_ptr, TNode* next_node_ptr)
+TContact::TContact(TSimulationContext *new_context, TNode* contact_node_ptr, TNode* next_node_ptr)
 {
+	context=new_context;
 	contact_node=contact_node_ptr;
 	contact_node_number=contact_node->get_value(GRID_ELECTRICAL,NODE_NUMBER);
 	second_node=next_node_ptr;
@@ -82,6 +84,7 @@ void TContact::init(void)
 
 void TContact::comp_built_pot(void)
 {
+	TEnvironment& environment=context->environment;
 	prec reference_quasi_fermi, current_quasi_fermi;
 
     reference_quasi_fermi=environment.get_value(ELECTRON,EQUIL_QUASI_FERMI,0,NORMALIZED);
@@ -141,25 +144,25 @@ void TContact::comp_electron_current(void)
 	collision_factor=(long)(prev_node->get_value(ELECTRON,COLLISION_FACTOR,NORMALIZED)*2.0);
 
 	if (grid_effects & GRID_FERMI_DIRAC) {
-		fermi_ratio_1_half_minus_1_half=fermi_integral_1_half(planck_potential)/
-										fermi_integral_minus_1_half(planck_potential);
+		fermi_ratio_1_half_minus_1_half=fermi_integral_1_half(context,planck_potential)/
+										fermi_integral_minus_1_half(context,planck_potential);
 
 		switch(collision_factor) {
 			case -1:
-				fermi_ratio_3_half_1_half_col=fermi_integral_2_half(planck_potential)/
+				fermi_ratio_3_half_1_half_col=fermi_integral_2_half(context,planck_potential)/
 											  fermi_integral_0_half(planck_potential);
 				break;
 			case 0:
-				fermi_ratio_3_half_1_half_col=fermi_integral_3_half(planck_potential)/
-											  fermi_integral_1_half(planck_potential);
+				fermi_ratio_3_half_1_half_col=fermi_integral_3_half(context,planck_potential)/
+											  fermi_integral_1_half(context,planck_potential);
 				break;
 			case 1:
-				fermi_ratio_3_half_1_half_col=fermi_integral_4_half(planck_potential)/
-											  fermi_integral_2_half(planck_potential);
+				fermi_ratio_3_half_1_half_col=fermi_integral_4_half(context,planck_potential)/
+											  fermi_integral_2_half(context,planck_potential);
 				break;
 			case 3:
-				fermi_ratio_3_half_1_half_col=fermi_integral_6_half(planck_potential)/
-											  fermi_integral_4_half(planck_potential);
+				fermi_ratio_3_half_1_half_col=fermi_integral_6_half(context,planck_potential)/
+											  fermi_integral_4_half(context,planck_potential);
 				break;
 			default: assert(FALSE); break;
 		}
@@ -195,7 +198,7 @@ void TContact::comp_equil_electron_conc(void)
 	prec equil_planck_potential=contact_node->get_value(ELECTRON,EQUIL_PLANCK_POT,NORMALIZED);
 
 	if (grid_effects & GRID_FERMI_DIRAC)
-		equil_electron_conc=equil_dos*fermi_integral_1_half(equil_planck_potential);
+		equil_electron_conc=equil_dos*fermi_integral_1_half(context,equil_planck_potential);
 	else
 		equil_electron_conc=equil_dos*exp(equil_planck_potential);
 }
@@ -244,25 +247,25 @@ void TContact::comp_hole_current(void)
 	collision_factor=(long)(prev_node->get_value(HOLE,COLLISION_FACTOR,NORMALIZED)*2.0);
 
 	if (grid_effects & GRID_FERMI_DIRAC) {
-		fermi_ratio_1_half_minus_1_half=fermi_integral_1_half(planck_potential)/
-										fermi_integral_minus_1_half(planck_potential);
+		fermi_ratio_1_half_minus_1_half=fermi_integral_1_half(context,planck_potential)/
+										fermi_integral_minus_1_half(context,planck_potential);
 
 		switch(collision_factor) {
 			case -1:
-				fermi_ratio_3_half_1_half_col=fermi_integral_2_half(planck_potential)/
+				fermi_ratio_3_half_1_half_col=fermi_integral_2_half(context,planck_potential)/
 											  fermi_integral_0_half(planck_potential);
 				break;
 			case 0:
-				fermi_ratio_3_half_1_half_col=fermi_integral_3_half(planck_potential)/
-											  fermi_integral_1_half(planck_potential);
+				fermi_ratio_3_half_1_half_col=fermi_integral_3_half(context,planck_potential)/
+											  fermi_integral_1_half(context,planck_potential);
 				break;
 			case 1:
-				fermi_ratio_3_half_1_half_col=fermi_integral_4_half(planck_potential)/
-											  fermi_integral_2_half(planck_potential);
+				fermi_ratio_3_half_1_half_col=fermi_integral_4_half(context,planck_potential)/
+											  fermi_integral_2_half(context,planck_potential);
 				break;
 			case 3:
-				fermi_ratio_3_half_1_half_col=fermi_integral_6_half(planck_potential)/
-											  fermi_integral_4_half(planck_potential);
+				fermi_ratio_3_half_1_half_col=fermi_integral_6_half(context,planck_potential)/
+											  fermi_integral_4_half(context,planck_potential);
 				break;
 			default: assert(FALSE); break;
 		}
@@ -298,7 +301,7 @@ void TContact::comp_equil_hole_conc(void)
 	prec equil_planck_potential=contact_node->get_value(HOLE,EQUIL_PLANCK_POT,NORMALIZED);
 
 	if (grid_effects & GRID_FERMI_DIRAC)
-		equil_hole_conc=equil_dos*fermi_integral_1_half(equil_planck_potential);
+		equil_hole_conc=equil_dos*fermi_integral_1_half(context,equil_planck_potential);
 	else
 		equil_hole_conc=equil_dos*exp(equil_planck_potential);
 }
@@ -361,18 +364,18 @@ prec TContact::get_value(flag flag_value, ScaleType scale)
 		default: assert(FALSE); return(0.0);
 	}
 
-	if (scale==UNNORMALIZED) return_value*=get_normalize_value(CONTACT,flag_value);
+	if (scale==UNNORMALIZED) return_value*=get_normalize_value(context,CONTACT,flag_value);
 	return(return_value);
 }
 
 void TContact::put_value(flag flag_value, prec value, ScaleType scale)
 {
 	prec prev_value;
-	if (scale==UNNORMALIZED) value/=get_normalize_value(CONTACT,flag_value);
+	if (scale==UNNORMALIZED) value/=get_normalize_value(context,CONTACT,flag_value);
 
 	switch(flag_value) {
 		case EFFECTS:
-			environment.set_effects_change_flags(CONTACT,effects^(flag)value);
+			context->environment.set_effects_change_flags(CONTACT,effects^(flag)value);
 			effects=(flag)value;
 			return;
 		case APPLIED_BIAS: bias=(float)value; return;
@@ -387,7 +390,7 @@ void TContact::put_value(flag flag_value, prec value, ScaleType scale)
         case BARRIER_HEIGHT:
         	prev_value=barrier_height;
         	barrier_height=value;
-            if (prev_value!=value) environment.set_update_flags(CONTACT,BARRIER_HEIGHT);
+            if (prev_value!=value) context->environment.set_update_flags(CONTACT,BARRIER_HEIGHT);
             return;
 		default: assert(FALSE); return;
 	}
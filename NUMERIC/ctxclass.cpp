@@ -0,0 +1,63 @@
+/*
+    SimWindows - 1D Semiconductor Device Simulator
+    Copyright (C) 2013 David W. Winston
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "comincl.h"
+
+/*********************************** class TSimulationContext *********************************
+
+class TSimulationContext {
+public:
+	TEnvironment environment;
+	TMaterialStorage material_parameters;
+	TErrorHandler error_handler;
+	NormalizeConstants normalization;
+	logical report_progress;
+private:
+	TWorkerPool *worker_pool;
+
+public:
+	TSimulationContext(void);
+	~TSimulationContext(void);
+	TWorkerPool *get_worker_pool(void);
+};
+*/
+
+TSimulationContext default_context;
+SIM_THREAD_LOCAL TSimulationContext *current_context=&default_context;
+
+TSimulationContext::TSimulationContext(void)
+	: environment(this), material_parameters(this)
+{
+	memset(&normalization,0,sizeof(NormalizeConstants));
+	report_progress=TRUE;
+	worker_pool=(TWorkerPool *)0;
+}
+
+TSimulationContext::~TSimulationContext(void)
+{
+	environment.delete_device();
+	environment.delete_spectrum();
+	material_parameters.clear();
+	delete worker_pool;
+}
+
+TWorkerPool *TSimulationContext::get_worker_pool(void)
+{
+	if (!worker_pool) worker_pool=new TWorkerPool(this);
+	return(worker_pool);
+}
@@ -24,6 +24,7 @@
 #include "simnode.h"
 #include "sim2dcar.h"
 #include "simqw.h"
+#include "simblock.h"
 #include "simsol.h"
 #include "simsurf.h"
 #include "simcont.h"
@@ -52,6 +53,7 @@ private:
 	prec curr_therm_error;
 	short grid_points;
 	TNode **grid_ptr;
+	TObjectArena object_arena;
 	short quantum_wells;
 	TQuantumWell **qw_ptr;
 	short number_contacts;
@@ -60,11 +62,18 @@ private:
 	TSurface **surface_ptr;
 	TCavity *cavity_ptr;
 	TSolution *solution_ptr;
+	TSimulationContext *context;
+	TunnelQuadrature tunnel_quadrature;
+	FlagType grid_value_type;
+	flag grid_value_flag;
+	int grid_value_first;
+	int grid_value_last;
+	int grid_value_chunks;
 
 // Constructor/Destructor
 public:
-	TDevice(TDeviceFileInput new_device_input);
-	TDevice(FILE *file_ptr);
+	TDevice(TSimulationContext *new_context, TDeviceFileInput new_device_input);
+	TDevice(TSimulationContext *new_context, FILE *file_ptr);
 	~TDevice(void);
 
 // get_value/put_value functions.
@@ -96,6 +105,12 @@ public:
 					int start_object=-1, int end_object=-1);
 private:
 	void comp_grid_value(FlagType flag_type, flag flag_value, int start_object, int end_object);
+	static logical grid_value_serial(FlagType flag_type, flag flag_value);
+	static logical grid_value_batched(FlagType flag_type, flag flag_value);
+	static void grid_value_task(void *device, int chunk_number);
+	void comp_grid_value_chunk(int chunk_number);
+	int align_grid_node(int node);
+	void comp_grid_conc(FlagType flag_type, int start_object, int end_object);
 	void comp_current(void);
 	void comp_field(void);
 	void comp_optical_generation(int start_object, int end_object);
@@ -117,44 +132,54 @@ public:
 	void enable_modified(logical enable) { modified=enable; }
 	void solve(void);
 	void update_solution_param(void);
+	void update_temperature_param(void);
+	int get_solution_size(void);
+	void get_solution(prec *solution);
+	void put_solution(prec *solution);
+	void predict_solution(void);
+	TunnelQuadrature& get_tunnel_quadrature(void) { return(tunnel_quadrature); }
+	TSimulationContext *get_context(void) { return(context); }
 private:
 	void establish_grid(void);
 	void process_input_param(void);
+	void init_tunnel_quadrature(void);
 };
 
 */
 
 
-TDevice::TDevice(TDeviceFileInput new_device_input)
+TDevice::TDevice(TSimulationContext *new_context, TDeviceFileInput new_device_input)
 	: device_input(new_device_input)
 {
+	context=new_context;
 	init_device_param();
 	number_contacts=2;
 	number_surfaces=2;
 
-	material_parameters.put_device_file(&device_input);
-	material_parameters.set_normalization(device_input.get_material_type(0));
+	context->material_parameters.put_device_file(&device_input);
+	context->material_parameters.set_normalization(device_input.get_material_type(0));
 
 	establish_grid();
-	if (error_handler.fail()) return;
+	if (context->error_handler.fail()) return;
 	process_input_param();
 
-	solution_ptr=new TSolution(this,grid_ptr,qw_ptr);
+	solution_ptr=new TSolution(context,this,grid_ptr,qw_ptr);
 }
 
-TDevice::TDevice(FILE *file_ptr)
+TDevice::TDevice(TSimulationContext *new_context, FILE *file_ptr)
 {
 	int i;
 
+	context=new_context;
 	init_device_param();
 	number_contacts=2;
 	number_surfaces=2;
 
 	read_state_file(file_ptr);
-	material_parameters.put_device_file(&device_input);
+	context->material_parameters.put_device_file(&device_input);
 
 	establish_grid();
-	if (error_handler.fail()) return;
+	if (context->error_handler.fail()) return;
 
 	for (i=0;i<grid_points;i++)
 		(*(grid_ptr+i))->read_state_file(file_ptr);
@@ -176,8 +201,8 @@ TDevice::TDevice(FILE *file_ptr)
 
 	if (cavity_ptr) cavity_ptr->read_state_file(file_ptr);
 
-	solution_ptr=new TSolution(this,grid_ptr,qw_ptr);
-	if (error_handler.fail()) return;
+	solution_ptr=new TSolution(context,this,grid_ptr,qw_ptr);
+	if (context->error_handler.fail()) return;
 	solution_ptr->comp_independent_param();
 }
 
@@ -185,23 +210,28 @@ TDevice::~TDevice(void)
 {
 	int i;
 
-	for (i=0;i<grid_points;i++) delete grid_ptr[i];
+	if (solution_ptr) delete solution_ptr;
+
+// Nodes, quantum wells, contacts and surfaces live in object_arena, which frees them all at once
+	for (i=0;i<grid_points;i++) grid_ptr[i]->~TNode();
 	if (grid_ptr) delete[] grid_ptr;
 
-	for (i=0;i<quantum_wells;i++) delete qw_ptr[i];
+	for (i=0;i<quantum_wells;i++) qw_ptr[i]->~TQuantumWell();
 	if (qw_ptr) delete[] qw_ptr;
 
-	for (i=0;i<number_contacts;i++) delete contact_ptr[i];
-	if (contact_ptr) delete[] contact_ptr;
+	if (contact_ptr) {
+		for (i=0;i<number_contacts;i++) if (contact_ptr[i]) contact_ptr[i]->~TContact();
+		delete[] contact_ptr;
+	}
 
-	for (i=0;i<number_surfaces;i++) delete surface_ptr[i];
-	if (surface_ptr) delete[] surface_ptr;
+	if (surface_ptr) {
+		for (i=0;i<number_surfaces;i++) if (surface_ptr[i]) surface_ptr[i]->~TSurface();
+		delete[] surface_ptr;
+	}
 
 	if (cavity_ptr) delete cavity_ptr;
 
-	if (solution_ptr) delete solution_ptr;
-
-    material_parameters.put_device_file(NULL);
+    context->material_parameters.put_device_file(NULL);
 }
 
 int TDevice::get_number_objects(FlagType flag_type)
@@ -353,7 +383,7 @@ void TDevice::put_value(FlagType flag_type, flag flag_value, prec value,
 		case DEVICE:
 			switch(flag_value) {
 				case EFFECTS:
-					environment.set_effects_change_flags(DEVICE,device_effects^(flag)value);
+					context->environment.set_effects_change_flags(DEVICE,device_effects^(flag)value);
 					device_effects=(flag)value;
 					return;
 				default: assert(FALSE); return;
@@ -368,7 +398,7 @@ short TDevice::get_node(prec position, short start_node, short end_node, ScaleTy
 	prec test_position;
 	prec start_position, end_position;
 
-	if (scale==UNNORMALIZED) position/=get_normalize_value(GRID_ELECTRICAL,POSITION);
+	if (scale==UNNORMALIZED) position/=get_normalize_value(context,GRID_ELECTRICAL,POSITION);
 
 	if (start_node==-1) start_node=0;
 	if (end_node==-1) end_node=(short)(grid_points-1);
@@ -391,6 +421,7 @@ short TDevice::get_node(prec position, short start_node, short end_node, ScaleTy
 
 void TDevice::init_device(void)
 {
+	TEnvironment& environment=context->environment;
 	int i;
 	SolveType previous_solution;
 
@@ -510,6 +541,39 @@ void TDevice::init_device_param(void)
 	surface_ptr=(TSurface **)0;
 	cavity_ptr=(TCavity *)0;
 	solution_ptr=(TSolution *)0;
+	tunnel_quadrature.type=QUAD_TRAPEZOID;
+	tunnel_quadrature.order=0;
+	tunnel_quadrature.tolerance=0.0;
+	tunnel_quadrature.evaluations=0;
+	grid_value_type=(FlagType)0;
+	grid_value_flag=0;
+	grid_value_first=grid_value_last=0;
+	grid_value_chunks=0;
+}
+
+/*
+	Takes the tunneling quadrature from the environment. A tolerance above zero selects
+	adaptive Gauss-Kronrod, otherwise an order above zero selects a Gauss-Legendre rule whose
+	nodes are only computed again when the order changes.
+*/
+void TDevice::init_tunnel_quadrature(void)
+{
+	int order;
+
+	order=(int)context->environment.get_value(ENVIRONMENT,TUNNEL_QUAD_ORDER);
+	tunnel_quadrature.tolerance=context->environment.get_value(ENVIRONMENT,TUNNEL_QUAD_TOLERANCE);
+
+	if (tunnel_quadrature.tolerance>0.0) tunnel_quadrature.type=QUAD_GAUSS_KRONROD;
+	else {
+		if (order>0) {
+			tunnel_quadrature.type=QUAD_GAUSS_LEGENDRE;
+			if (order!=tunnel_quadrature.order) {
+				gauss_legendre(order,tunnel_quadrature.node,tunnel_quadrature.weight);
+				tunnel_quadrature.order=order;
+			}
+		}
+		else tunnel_quadrature.type=QUAD_TRAPEZOID;
+	}
 }
 
 void TDevice::comp_value(FlagType flag_type, flag flag_value,
@@ -551,7 +615,7 @@ void TDevice::comp_value(FlagType flag_type, flag flag_value,
 							comp_value(QW_ELECTRON,ENERGY_TOP);
 							comp_value(QW_ELECTRON,CONCENTRATION);
 						}
-						comp_grid_value(ELECTRON,CONCENTRATION,start_object,end_object);
+						comp_grid_conc(ELECTRON,start_object,end_object);
 					}
 					break;
 				case CURRENT:
@@ -621,7 +685,7 @@ void TDevice::comp_value(FlagType flag_type, flag flag_value,
 							comp_value(QW_HOLE,ENERGY_TOP);
 							comp_value(QW_HOLE,CONCENTRATION);
 						}
-						comp_grid_value(HOLE,CONCENTRATION,start_object,end_object);
+						comp_grid_conc(HOLE,start_object,end_object);
 					}
 					break;
 				case CURRENT:
@@ -859,13 +923,52 @@ void TDevice::comp_value(FlagType flag_type, flag flag_value,
 	}
 }
 
+/*
+	Applies TNode::comp_value() to the nodes start_object to end_object. A range of at least
+	PROPERTY_MIN_NODES nodes is split into one contiguous chunk per worker of the worker pool
+	of the context, as in the parallel assembly, unless the quantity is one of those of
+	grid_value_serial(). Each node only writes its own values, so the result does not depend
+	on the chunks. The quantities of grid_value_batched() go through
+	TNode::comp_grid_hotcarriers() over the whole range or chunk.
+*/
 void TDevice::comp_grid_value(FlagType flag_type, flag flag_value, int start_object, int end_object)
 {
+	long min_nodes;
 	TNode **temp_grid_ptr;
+	TWorkerPool *pool;
 
 	assert((start_object>=0) && (start_object<grid_points));
 	assert((end_object>=0) && (end_object<grid_points));
 
+	if (start_object<=end_object) {
+		grid_value_first=start_object;
+		grid_value_last=end_object;
+	}
+	else {
+		grid_value_first=end_object;
+		grid_value_last=start_object;
+	}
+
+	min_nodes=(long)context->environment.get_value(ENVIRONMENT,PROPERTY_MIN_NODES);
+	if (min_nodes && (grid_value_last-grid_value_first+1>=min_nodes) &&
+		(!grid_value_serial(flag_type,flag_value))) {
+		pool=context->get_worker_pool();
+		grid_value_chunks=pool->get_number_workers();
+		if (grid_value_chunks>MAX_ASSEMBLY_BLOCKS) grid_value_chunks=MAX_ASSEMBLY_BLOCKS;
+		if (grid_value_chunks>1) {
+			grid_value_type=flag_type;
+			grid_value_flag=flag_value;
+			pool->run(grid_value_task,this,grid_value_chunks);
+			return;
+		}
+	}
+
+	if (grid_value_batched(flag_type,flag_value)) {
+		TNode::comp_grid_hotcarriers(grid_ptr+grid_value_first,grid_value_last-grid_value_first+1,
+									 flag_type,flag_value);
+		return;
+	}
+
 	if (start_object<=end_object) {
 		for (temp_grid_ptr=grid_ptr+start_object;
 			 temp_grid_ptr<=grid_ptr+end_object;
@@ -880,9 +983,114 @@ void TDevice::comp_grid_value(FlagType flag_type, flag flag_value, int start_obj
 	}
 }
 
+/*
+	Quantities computed in a sweep along the grid, where each node takes its value from the
+	node before it, and the optical generation, which adds to the value of each node. These
+	are always computed by the serial loop of comp_grid_value().
+*/
+logical TDevice::grid_value_serial(FlagType flag_type, flag flag_value)
+{
+	switch(flag_type) {
+		case ELECTRON:
+		case HOLE:
+			return(flag_value==CURRENT);
+		case GRID_ELECTRICAL:
+			return(flag_value==FIELD);
+		case GRID_OPTICAL:
+			return((flag_value & (INCIDENT_TOTAL_POYNTING | MODE_TOTAL_POYNTING |
+								  INCIDENT_TOTAL_FIELD_MAG | MODE_TOTAL_FIELD_MAG |
+								  INCIDENT_FORWARD_FIELD_REAL | INCIDENT_FORWARD_FIELD_IMAG |
+								  INCIDENT_FORWARD_POYNTING | INCIDENT_REVERSE_FIELD_REAL |
+								  INCIDENT_REVERSE_FIELD_IMAG | INCIDENT_REVERSE_POYNTING |
+								  MODE_FORWARD_FIELD_REAL | MODE_FORWARD_FIELD_IMAG |
+								  MODE_REVERSE_FIELD_REAL | MODE_REVERSE_FIELD_IMAG))!=0);
+		case NODE:
+			return(flag_value==OPTICAL_GENERATION);
+		default: return(FALSE);
+	}
+}
+
+/*
+	Hot carrier heat terms that take F3/2/F1/2 of the bulk Fermi-Dirac nodes from the array forms
+	of the fermi integrals.
+*/
+logical TDevice::grid_value_batched(FlagType flag_type, flag flag_value)
+{
+	switch(flag_type) {
+		case ELECTRON:
+		case HOLE:
+			return((flag_value==B_B_HEAT) || (flag_value==RELAX_HEAT) || (flag_value==AUGER_HEAT));
+		default: return(FALSE);
+	}
+}
+
+void TDevice::grid_value_task(void *device, int chunk_number)
+{
+	((TDevice *)device)->comp_grid_value_chunk(chunk_number);
+}
+
+/*
+	Evaluates one of grid_value_chunks equal runs of nodes. Inner chunk boundaries are moved to
+	nodes that start a cache line, so two workers never write to the same line.
+*/
+void TDevice::comp_grid_value_chunk(int chunk_number)
+{
+	int first, last, count;
+	TNode **temp_grid_ptr;
+
+	count=grid_value_last-grid_value_first+1;
+	first=grid_value_first+(int)(((long)count*chunk_number)/grid_value_chunks);
+	last=grid_value_first+(int)(((long)count*(chunk_number+1))/grid_value_chunks)-1;
+	if (chunk_number>0) first=align_grid_node(first);
+	if (chunk_number<grid_value_chunks-1) last=align_grid_node(last+1)-1;
+
+	if (grid_value_batched(grid_value_type,grid_value_flag)) {
+		TNode::comp_grid_hotcarriers(grid_ptr+first,last-first+1,grid_value_type,grid_value_flag);
+		return;
+	}
+
+	for (temp_grid_ptr=grid_ptr+first;
+		 temp_grid_ptr<=grid_ptr+last;
+		 temp_grid_ptr++)
+		 (*temp_grid_ptr)->comp_value(grid_value_type,grid_value_flag);
+}
+
+/*
+	First node from node on that starts a PROPERTY_CHUNK_ALIGNMENT line, or node itself if there
+	is none. The nodes are laid out in grid order in object_arena, one every
+	TObjectArena::object_size(sizeof(TNode)) bytes, so such a node comes within the few nodes
+	that span a whole number of lines.
+*/
+int TDevice::align_grid_node(int node)
+{
+	int i, line_nodes;
+	size_t node_bytes;
+
+	node_bytes=TObjectArena::object_size(sizeof(TNode));
+	line_nodes=1;
+	while ((node_bytes*line_nodes)%PROPERTY_CHUNK_ALIGNMENT) line_nodes++;
+
+	for (i=node;(i<node+line_nodes) && (i<=grid_value_last);i++) {
+		if (!((size_t)(*(grid_ptr+i))%PROPERTY_CHUNK_ALIGNMENT)) return(i);
+	}
+	return(node);
+}
+
+void TDevice::comp_grid_conc(FlagType flag_type, int start_object, int end_object)
+{
+	assert((start_object>=0) && (start_object<grid_points));
+	assert((end_object>=0) && (end_object<grid_points));
+
+	if (start_object<=end_object)
+		TNode::comp_grid_conc(grid_ptr+start_object,end_object-start_object+1,flag_type);
+	else
+		TNode::comp_grid_conc(grid_ptr+end_object,start_object-end_object+1,flag_type);
+}
+
 void TDevice::comp_current(void)
 {
 	TNode **temp_grid_ptr;
+	CurrentSweep sweep;
 
 	if (get_value(ELECTRON,CONCENTRATION,get_value(CONTACT,NODE_NUMBER,0)) <=
 		get_value(ELECTRON,CONCENTRATION,get_value(CONTACT,NODE_NUMBER,1))) {
@@ -892,7 +1100,7 @@ void TDevice::comp_current(void)
 		for (temp_grid_ptr=grid_ptr;
 			 temp_grid_ptr<grid_ptr+grid_points;
 			 temp_grid_ptr++) {
-			(*temp_grid_ptr)->comp_current(ELECTRON,(*contact_ptr)->get_value(NODE_NUMBER));
+			(*temp_grid_ptr)->comp_current(ELECTRON,(*contact_ptr)->get_value(NODE_NUMBER),sweep);
 		}
 
 		put_value(CONTACT,ELECTRON_CURRENT,get_value(ELECTRON,CURRENT,grid_points-1),1);
@@ -901,7 +1109,7 @@ void TDevice::comp_current(void)
 		for (temp_grid_ptr=grid_ptr+grid_points-1;
 			 temp_grid_ptr>=grid_ptr;
 			 temp_grid_ptr--) {
-			(*temp_grid_ptr)->comp_current(HOLE,(*(contact_ptr+1))->get_value(NODE_NUMBER));
+			(*temp_grid_ptr)->comp_current(HOLE,(*(contact_ptr+1))->get_value(NODE_NUMBER),sweep);
 		}
 
 		put_value(CONTACT,HOLE_CURRENT,get_value(HOLE,CURRENT,0),0);
@@ -912,7 +1120,7 @@ void TDevice::comp_current(void)
 		for (temp_grid_ptr=grid_ptr+grid_points-1;
 			 temp_grid_ptr>=grid_ptr;
 			 temp_grid_ptr--) {
-			(*temp_grid_ptr)->comp_current(ELECTRON,(*(contact_ptr+1))->get_value(NODE_NUMBER));
+			(*temp_grid_ptr)->comp_current(ELECTRON,(*(contact_ptr+1))->get_value(NODE_NUMBER),sweep);
 		}
 
 		put_value(CONTACT,ELECTRON_CURRENT,get_value(ELECTRON,CURRENT,0),0);
@@ -921,7 +1129,7 @@ void TDevice::comp_current(void)
 		for (temp_grid_ptr=grid_ptr;
 			 temp_grid_ptr<grid_ptr+grid_points;
 			 temp_grid_ptr++) {
-			(*temp_grid_ptr)->comp_current(HOLE,(*contact_ptr)->get_value(NODE_NUMBER));
+			(*temp_grid_ptr)->comp_current(HOLE,(*contact_ptr)->get_value(NODE_NUMBER),sweep);
 		}
 
 		put_value(CONTACT,HOLE_CURRENT,get_value(HOLE,CURRENT,grid_points-1),1);
@@ -931,13 +1139,14 @@ void TDevice::comp_current(void)
 void TDevice::comp_field(void)
 {
 	TNode **temp_grid_ptr;
+	FieldSweep sweep;
 
 	comp_value(CONTACT,FIELD,0);
 
 	for (temp_grid_ptr=grid_ptr;
 		 temp_grid_ptr<grid_ptr+grid_points;
 		 temp_grid_ptr++) {
-		(*temp_grid_ptr)->comp_field((*contact_ptr)->get_value(NODE_NUMBER));
+		(*temp_grid_ptr)->comp_field((*contact_ptr)->get_value(NODE_NUMBER),sweep);
 	}
 
 	put_value(CONTACT,FIELD,get_value(GRID_ELECTRICAL,FIELD,grid_points-1),1);
@@ -945,11 +1154,13 @@ void TDevice::comp_field(void)
 
 void TDevice::comp_optical_generation(int start_object, int end_object)
 {
+	TEnvironment& environment=context->environment;
 	int j,number_wavelengths;
 	prec intensity_multiplier;
 	TNode** temp_grid_ptr;
 	prec spectrum_multiplier;
     int max_overflow_count;
+	OpticalFieldSweep sweep;
 
 	spectrum_multiplier=environment.get_value(ENVIRONMENT,SPECTRUM_MULTIPLIER);
 
@@ -987,7 +1198,7 @@ void TDevice::comp_optical_generation(int start_object, int end_object)
 			for (temp_grid_ptr=grid_ptr+end_object;
 				 temp_grid_ptr>=grid_ptr+start_object;
 				 temp_grid_ptr--) {
-				(*temp_grid_ptr)->comp_incident_optical_field(end_object);
+				(*temp_grid_ptr)->comp_incident_optical_field(end_object,sweep);
 			}
 			comp_value(SURFACE,INCIDENT_SURFACE_FIELD,0);
 
@@ -1009,7 +1220,7 @@ void TDevice::comp_optical_generation(int start_object, int end_object)
 			for (temp_grid_ptr=grid_ptr+end_object;
 				 temp_grid_ptr<=grid_ptr+start_object;
 				 temp_grid_ptr++) {
-				(*temp_grid_ptr)->comp_incident_optical_field(end_object);
+				(*temp_grid_ptr)->comp_incident_optical_field(end_object,sweep);
 			}
 			comp_value(SURFACE,INCIDENT_SURFACE_FIELD,1);
 
@@ -1040,7 +1251,7 @@ void TDevice::read_data_file(const char *filename)
 
 	file_ptr=fopen(filename,"r");
 	if (!file_ptr) {
-		error_handler.set_error(ERROR_FILE_NOT_OPEN,0,"",filename);
+		context->error_handler.set_error(ERROR_FILE_NOT_OPEN,0,"",filename);
 		return;
 	}
 	fgets(header_string,200,file_ptr);
@@ -1050,7 +1261,7 @@ void TDevice::read_data_file(const char *filename)
 
 	while(token) {
 		short_string_to_flag(token,flag_type_array[columns],flag_array[columns]);
-		if (columns>0) environment.set_update_flags(flag_type_array[columns],flag_array[columns]);
+		if (columns>0) context->environment.set_update_flags(flag_type_array[columns],flag_array[columns]);
 		columns++;
 
 		token=strtok(NULL,",");
@@ -1400,7 +1611,7 @@ void TDevice::write_data_file(ofstream& output_file, TValueFlag write_flags,
 									}
 
 									if (test_flag==ALLOY_TYPE) {
-										output_file << ',' << material_parameters.get_alloy_name(
+										output_file << ',' << context->material_parameters.get_alloy_name(
 																		(MaterialType)get_value(GRID_ELECTRICAL,MATERIAL,i),
 																		(AlloyType)get_value(GRID_ELECTRICAL,ALLOY_TYPE,i));
 										test_flag<<=1;
@@ -1415,7 +1626,7 @@ void TDevice::write_data_file(ofstream& output_file, TValueFlag write_flags,
 									}
 
 									if (test_flag==MATERIAL) {
-										output_file << ',' << material_parameters.get_material_name(
+										output_file << ',' << context->material_parameters.get_material_name(
 																		(MaterialType)get_value(GRID_ELECTRICAL,MATERIAL,i));
 										test_flag<<=1;
 										continue;
@@ -1526,9 +1737,11 @@ void TDevice::write_state_file(FILE *file_ptr)
 
 void TDevice::solve(void)
 {
+	TEnvironment& environment=context->environment;
+	TErrorHandler& error_handler=context->error_handler;
 	prec max_elect_error, max_optic_error, max_therm_error;
 	prec coarse_mode_error, fine_mode_error;
-	prec curr_max_elect_error;
+	prec curr_max_elect_error, outer_therm_error;
 	SolveType solve_type, prev_solve_type;
 	prec temp_bias_0,temp_bias_1;
 	prec temp_temp_0,temp_temp_1;
@@ -1537,6 +1750,11 @@ void TDevice::solve(void)
 	flag temp_dev_effects, temp_env_effects, grid_effects, mode_effects;
 	int max_inner_elect_iter, max_inner_therm_iter, max_inner_mode_iter;
 	int max_outer_optic_iter, max_outer_therm_iter;
+	logical coupled_thermal, coupled_photons, photon_newton, repeat_optic;
+	long start_evaluations;
+
+	init_tunnel_quadrature();
+	start_evaluations=tunnel_quadrature.evaluations;
 
 	temp_bias_0=get_value(CONTACT,APPLIED_BIAS,0);
 	temp_bias_1=get_value(CONTACT,APPLIED_BIAS,1);
@@ -1621,25 +1839,44 @@ void TDevice::solve(void)
 
 	curr_outer_therm_iter=0;
 	do {
+// A coupled solution starts with one pass at fixed temperature, far from the solution the
+// temperature updates of the coupled iteration are not reliable
+		coupled_thermal=solution_ptr->is_coupled_thermal() && (curr_outer_therm_iter>0);
+// The photon number is only coupled to the electrical iteration, the coupled electro-thermal
+// iteration keeps the outer photon loop
+		coupled_photons=solution_ptr->is_coupled_photons() && (!coupled_thermal);
 		solution_ptr->store_temperature();
 		solution_ptr->comp_electrical_boundary();
 		solution_ptr->apply_electrical_boundary();
 		curr_outer_optic_iter=0;
 		do {
+// The first optical pass of a solution is solved at a fixed photon number, far from the
+// solution the photon updates of the coupled iteration are not reliable
+			photon_newton=coupled_photons && ((curr_outer_optic_iter>0) || (curr_outer_therm_iter>0));
 			curr_inner_elect_iter=0;
 			do {
 				assert(!error_handler.fail());
-				solution_ptr->electrical_iterate(curr_elect_error);
+				if (coupled_thermal) solution_ptr->coupled_iterate(curr_elect_error,curr_therm_error);
+				else {
+					if (photon_newton) solution_ptr->photon_iterate(curr_elect_error,curr_optic_error);
+					else solution_ptr->electrical_iterate(curr_elect_error);
+				}
 				curr_inner_elect_iter++;
 				if (error_handler.fail()) return;
 
-				out_elect_convergence(curr_inner_elect_iter,curr_elect_error);
+				if (context->report_progress) {
+					out_elect_convergence(curr_inner_elect_iter,curr_elect_error);
+					if (coupled_thermal) out_therm_convergence(curr_inner_elect_iter,curr_therm_error);
+					if (photon_newton) out_optic_convergence(curr_inner_elect_iter,curr_optic_error);
+				}
 
 				if (curr_elect_error.psi>curr_elect_error.eta_c) curr_max_elect_error=curr_elect_error.psi;
 				else curr_max_elect_error=curr_elect_error.eta_c;
 				if (curr_elect_error.eta_v>curr_max_elect_error) curr_max_elect_error=curr_elect_error.eta_v;
 			}
-			while ((curr_max_elect_error>=max_elect_error) &&
+			while (((curr_max_elect_error>=max_elect_error) ||
+					(coupled_thermal && (curr_therm_error>max_therm_error)) ||
+					(photon_newton && (curr_optic_error>=max_optic_error))) &&
             	   (curr_inner_elect_iter <= max_inner_elect_iter-1) &&
                    (!environment.do_stop_solution()));
 
@@ -1683,7 +1920,8 @@ void TDevice::solve(void)
 							cavity_ptr->field_iterate(curr_mode_error,coarse_mode_error,curr_inner_mode_iter);
 							curr_inner_mode_iter++;
 							if (error_handler.fail()) return;
-							out_coarse_mode_convergence(curr_inner_mode_iter,curr_mode_error);
+							if (context->report_progress)
+								out_coarse_mode_convergence(curr_inner_mode_iter,curr_mode_error);
 						}
 						while ((curr_mode_error!=0.0) && (curr_inner_mode_iter<=max_inner_mode_iter) &&
         	                   (!environment.do_stop_solution()));
@@ -1695,34 +1933,46 @@ void TDevice::solve(void)
 							cavity_ptr->field_iterate(curr_mode_error,fine_mode_error,curr_inner_mode_iter);
 							curr_inner_mode_iter++;
 							if (error_handler.fail()) return;
-							out_fine_mode_convergence(curr_inner_mode_iter,curr_mode_error);
+							if (context->report_progress)
+								out_fine_mode_convergence(curr_inner_mode_iter,curr_mode_error);
 						}
 						while ((curr_mode_error!=0.0) && (curr_inner_mode_iter<=max_inner_mode_iter) &&
                         	   (!environment.do_stop_solution()));
                     }
 				}
 
-                if (!environment.do_stop_solution()) {
-					assert(!error_handler.fail());
-					cavity_ptr->photon_iterate(curr_optic_error);
+				if (coupled_photons) {
+// The photons are solved with the electrical equations, after the first pass another pass is
+// only needed if the solution has not converged or the mode search has moved it
+					repeat_optic=(!photon_newton) ||
+								 (curr_optic_error>=max_optic_error) || (curr_max_elect_error>=max_elect_error) ||
+								 ((mode_effects & MODE_SEARCH_WAVELENGTH) && (curr_inner_elect_iter>1));
 					curr_outer_optic_iter++;
-					if (error_handler.fail()) return;
-					out_optic_convergence(curr_outer_optic_iter,curr_optic_error);
-                }
+				}
+				else {
+					if (!environment.do_stop_solution()) {
+						assert(!error_handler.fail());
+						cavity_ptr->photon_iterate(curr_optic_error);
+						curr_outer_optic_iter++;
+						if (error_handler.fail()) return;
+						if (context->report_progress)
+							out_optic_convergence(curr_outer_optic_iter,curr_optic_error);
+					}
+					repeat_optic=(curr_optic_error>=max_optic_error) || (curr_outer_optic_iter <2) ||
+								 (curr_max_elect_error>=max_elect_error);
+				}
 			}
 			else {
 				curr_optic_error=0.0;
 				curr_outer_optic_iter=2;
+				repeat_optic=FALSE;
 			}
 		}
-		while ((!environment.do_stop_solution()) &&
-        	   (device_effects & DEVICE_LASER) && (solve_type!=EQUILIBRIUM) &&
-			   (((curr_optic_error>=max_optic_error) || (curr_outer_optic_iter <2) ||
-				 (curr_max_elect_error>=max_elect_error)) &&
-				(curr_outer_optic_iter <= max_outer_optic_iter-1)));
+		while ((!environment.do_stop_solution()) && repeat_optic &&
+			   (curr_outer_optic_iter <= max_outer_optic_iter-1));
 
 		if ((device_effects & DEVICE_NON_ISOTHERMAL) && (solve_type!=EQUILIBRIUM) &&
-        	(!environment.do_stop_solution())) {
+        	(!coupled_thermal) && (!environment.do_stop_solution())) {
 			solution_ptr->comp_thermoelectric_param();
 			curr_inner_therm_iter=0;
 			do {
@@ -1733,22 +1983,22 @@ void TDevice::solve(void)
 
 				if (grid_effects & GRID_TEMP_THERMAL_COND) comp_value(GRID_ELECTRICAL,THERMAL_CONDUCT);
 
-				out_therm_convergence(curr_inner_therm_iter,curr_therm_error);
+				if (context->report_progress)
+					out_therm_convergence(curr_inner_therm_iter,curr_therm_error);
 			}
 			while ((curr_therm_error>max_therm_error) && (curr_inner_therm_iter<=max_inner_therm_iter-1) &&
                    (!environment.do_stop_solution()));
-			solution_ptr->outer_thermal_update_device();
-
-			if (device_effects & (DEVICE_SINGLE_TEMP | DEVICE_VARY_LATTICE_TEMP))
-				environment.set_update_flags(GRID_ELECTRICAL,TEMPERATURE);
-			if (device_effects & (DEVICE_SINGLE_TEMP | DEVICE_VARY_ELECTRON_TEMP))
-				environment.set_update_flags(ELECTRON,TEMPERATURE);
-			if (device_effects & (DEVICE_SINGLE_TEMP | DEVICE_VARY_HOLE_TEMP))
-				environment.set_update_flags(HOLE,TEMPERATURE);
-			environment.process_recompute_flags();
+			solution_ptr->outer_thermal_update_device(outer_therm_error);
+			update_temperature_param();
 			if (error_handler.fail()) return;
+
+			if (context->report_progress)
+				out_outer_therm_convergence(curr_outer_therm_iter+1,outer_therm_error);
+		}
+		else {
+			if (coupled_thermal) curr_inner_therm_iter=0;
+			else curr_therm_error=0.0;
 		}
-		else curr_therm_error=0.0;
 
 		curr_outer_therm_iter++;
 	}
@@ -1769,10 +2019,14 @@ void TDevice::solve(void)
 		comp_value(MODE,MODE_GAIN);
 		if (solve_type==STEADY_STATE) comp_value(MIRROR,POWER);
 	}
+
+	if (context->report_progress && (tunnel_quadrature.evaluations>start_evaluations))
+		out_tunnel_evaluations(tunnel_quadrature.evaluations-start_evaluations);
 }
 
 void TDevice::establish_grid(void)
 {
+	TErrorHandler& error_handler=context->error_handler;
 	int i,j, qw_count;
 	int required_nodes;
 	prec total_length, point_size, grid_length, grid_position;
@@ -1789,6 +2043,15 @@ void TDevice::establish_grid(void)
 		return;
 	}
 
+// One arena block for the quantum wells, the nodes in grid order, the contacts and the surfaces
+	if (!object_arena.reserve(device_input.number_qw*TObjectArena::object_size(sizeof(TQuantumWell))+
+							  required_nodes*TObjectArena::object_size(sizeof(TNode))+
+							  number_contacts*TObjectArena::object_size(sizeof(TContact))+
+							  number_surfaces*TObjectArena::object_size(sizeof(TSurface)))) {
+		error_handler.set_error(ERROR_MEM_DEVICE_GRID,0,"","");
+		return;
+	}
+
 // Establish qw_ptr and create qw objects.
 	if (device_input.number_qw) {
 		qw_ptr= new TQuantumWell*[device_input.number_qw];
@@ -1797,7 +2060,7 @@ void TDevice::establish_grid(void)
 			return;
 		}
 		for (i=0;i<device_input.number_qw;i++) {
-			*(qw_ptr+quantum_wells)=new TQuantumWell(this,grid_ptr);
+			*(qw_ptr+quantum_wells)=new(object_arena) TQuantumWell(context,this,grid_ptr);
 			if (!(*(qw_ptr+quantum_wells)))	{
 				error_handler.set_error(ERROR_MEM_QW,0,"","");
 				return;
@@ -1820,7 +2083,7 @@ void TDevice::establish_grid(void)
 			region_type=device_input.get_region_type(grid_position);
 			switch(region_type) {
 				case BULK:
-					(*temp_ptr)=new TNode(grid_points,BULK);
+					(*temp_ptr)=new(object_arena) TNode(context,grid_points,BULK);
 					if (previous_region_type==QW) {
 						(*(qw_ptr+qw_count))->put_node(NEXT_NODE,grid_points);
 						qw_count++;
@@ -1828,7 +2091,7 @@ void TDevice::establish_grid(void)
 					previous_region_type=BULK;
 					break;
 				case QW:
-					(*temp_ptr)=new TNode(grid_points,QW,*(qw_ptr+qw_count));
+					(*temp_ptr)=new(object_arena) TNode(context,grid_points,QW,*(qw_ptr+qw_count));
 					if (previous_region_type==BULK)
 						(*(qw_ptr+qw_count))->put_node(PREVIOUS_NODE,grid_points-1);
 					previous_region_type=QW;
@@ -1846,7 +2109,7 @@ void TDevice::establish_grid(void)
 		}
 		total_length+=grid_length;
 	}
-	(*temp_ptr)=new TNode(grid_points,BULK);
+	(*temp_ptr)=new(object_arena) TNode(context,grid_points,BULK);
 	if (!(*temp_ptr)) {
 		error_handler.set_error(ERROR_MEM_DEVICE_GRID,0,"","");
 		return;
@@ -1860,8 +2123,8 @@ void TDevice::establish_grid(void)
 		return;
 	}
 
-	*contact_ptr= new TContact(*(grid_ptr),*(grid_ptr+1));
-	*(contact_ptr+1)= new TContact(*(grid_ptr+grid_points-1),*(grid_ptr+grid_points-2));
+	*contact_ptr= new(object_arena) TContact(context,*(grid_ptr),*(grid_ptr+1));
+	*(contact_ptr+1)= new(object_arena) TContact(context,*(grid_ptr+grid_points-1),*(grid_ptr+grid_points-2));
 
 	if ((!(*(contact_ptr))) || (!(*(contact_ptr+1)))) {
 		error_handler.set_error(ERROR_MEM_CONTACT,0,"","");
@@ -1875,8 +2138,8 @@ void TDevice::establish_grid(void)
 		return;
 	}
 
-	*surface_ptr= new TSurface(*(grid_ptr),*(grid_ptr+1));
-	*(surface_ptr+1)= new TSurface(*(grid_ptr+grid_points-1),*(grid_ptr+grid_points-2));
+	*surface_ptr= new(object_arena) TSurface(context,*(grid_ptr),*(grid_ptr+1));
+	*(surface_ptr+1)= new(object_arena) TSurface(context,*(grid_ptr+grid_points-1),*(grid_ptr+grid_points-2));
 
 	if ((!(*(surface_ptr))) || (!(*(surface_ptr+1)))) {
 		error_handler.set_error(ERROR_MEM_SURFACE,0,"","");
@@ -1885,7 +2148,7 @@ void TDevice::establish_grid(void)
 
 // Create Cavity if one is present
 	if (device_input.number_cavity) {
-		cavity_ptr=new TCavity(this, grid_ptr);
+		cavity_ptr=new TCavity(context,this,grid_ptr);
 		if (!cavity_ptr) {
 			error_handler.set_error(ERROR_MEM_CAVITY,0,"","");
 			return;
@@ -1895,6 +2158,7 @@ void TDevice::establish_grid(void)
 
 void TDevice::process_input_param(void)
 {
+	TEnvironment& environment=context->environment;
 	int i,j, grid_count, qw_count;
 	prec total_length, point_size, grid_length, grid_position;
 	flag grid_effects, qw_effects, env_effects, mode_effects;
@@ -1995,3 +2259,96 @@ void TDevice::update_solution_param(void)
 {
 	if (solution_ptr) solution_ptr->comp_independent_param();
 }
+
+/*
+	Recomputes the values that depend on the temperatures of the nodes after they have been
+	changed by the solution.
+*/
+void TDevice::update_temperature_param(void)
+{
+	TEnvironment& environment=context->environment;
+	if (device_effects & (DEVICE_SINGLE_TEMP | DEVICE_VARY_LATTICE_TEMP))
+		environment.set_update_flags(GRID_ELECTRICAL,TEMPERATURE);
+	if (device_effects & (DEVICE_SINGLE_TEMP | DEVICE_VARY_ELECTRON_TEMP))
+		environment.set_update_flags(ELECTRON,TEMPERATURE);
+	if (device_effects & (DEVICE_SINGLE_TEMP | DEVICE_VARY_HOLE_TEMP))
+		environment.set_update_flags(HOLE,TEMPERATURE);
+	environment.process_recompute_flags();
+}
+
+/*
+	The solution vector holds the normalized potential, electron and hole planck potentials,
+	lattice, electron and hole temperatures of every node, one block of grid_points values
+	for each, followed by the total photons of the mode in a laser.
+*/
+int TDevice::get_solution_size(void)
+{
+	if (device_effects & DEVICE_LASER) return(6*grid_points+1);
+	else return(6*grid_points);
+}
+
+void TDevice::get_solution(prec *solution)
+{
+	int i;
+	TNode *node_ptr;
+
+	for (i=0;i<grid_points;i++) {
+		node_ptr=*(grid_ptr+i);
+		*(solution+i)=node_ptr->get_value(GRID_ELECTRICAL,POTENTIAL,NORMALIZED);
+		*(solution+grid_points+i)=node_ptr->get_value(ELECTRON,PLANCK_POT,NORMALIZED);
+		*(solution+2*grid_points+i)=node_ptr->get_value(HOLE,PLANCK_POT,NORMALIZED);
+		*(solution+3*grid_points+i)=node_ptr->get_value(GRID_ELECTRICAL,TEMPERATURE,NORMALIZED);
+		*(solution+4*grid_points+i)=node_ptr->get_value(ELECTRON,TEMPERATURE,NORMALIZED);
+		*(solution+5*grid_points+i)=node_ptr->get_value(HOLE,TEMPERATURE,NORMALIZED);
+	}
+
+	if (device_effects & DEVICE_LASER)
+		*(solution+6*grid_points)=get_value(MODE,MODE_TOTAL_PHOTONS,0,NORMALIZED);
+}
+
+/*
+	Replaces the solution with a new vector and recomputes the values that depend on it.
+	The temperatures are only taken in a non-isothermal device.
+*/
+void TDevice::put_solution(prec *solution)
+{
+	int i;
+	TNode *node_ptr;
+	prec total_photons;
+
+	if ((!solution_ptr) || (current_solution==CHARGE_NEUTRAL)) return;
+
+	for (i=0;i<grid_points;i++) {
+		node_ptr=*(grid_ptr+i);
+		node_ptr->put_value(GRID_ELECTRICAL,POTENTIAL,*(solution+i),NORMALIZED);
+		node_ptr->put_value(ELECTRON,PLANCK_POT,*(solution+grid_points+i),NORMALIZED);
+		node_ptr->put_value(HOLE,PLANCK_POT,*(solution+2*grid_points+i),NORMALIZED);
+		if (device_effects & DEVICE_NON_ISOTHERMAL) {
+			node_ptr->put_value(GRID_ELECTRICAL,TEMPERATURE,*(solution+3*grid_points+i),NORMALIZED);
+			node_ptr->put_value(ELECTRON,TEMPERATURE,*(solution+4*grid_points+i),NORMALIZED);
+			node_ptr->put_value(HOLE,TEMPERATURE,*(solution+5*grid_points+i),NORMALIZED);
+		}
+	}
+
+	if (device_effects & DEVICE_NON_ISOTHERMAL) {
+		update_temperature_param();
+		if (context->error_handler.fail()) return;
+	}
+
+	if (device_effects & DEVICE_LASER) {
+		total_photons=*(solution+6*grid_points);
+		put_value(MODE,MODE_TOTAL_PHOTONS,total_photons,0,0,NORMALIZED);
+		put_value(GRID_OPTICAL,MODE_TOTAL_PHOTONS,total_photons,-1,-1,NORMALIZED);
+	}
+
+	solution_ptr->comp_electrical_values();
+}
+
+/*
+	Steps the solution toward the present contact biases along the tangent of the last
+	steady state solution.
+*/
+void TDevice::predict_solution(void)
+{
+	if (solution_ptr && (current_solution==STEADY_STATE)) solution_ptr->electrical_predict();
+}
@@ -24,14 +24,78 @@
 #include "simnode.h"
 #include "simelem.h"
 #include "simdev.h"
+#include "simdual.h"
+#include "simquad.h"
 #include "simecele.h"
 
+/*
+	Thermionic emission integral 0.5*ln(1+exp(x))^2+dilog(1/(1+exp(-x))) and ln(1+exp(x)).
+	The dual versions use the derivatives ln(1+exp(x)) and 1/(1+exp(-x)) directly, which stay
+	finite where the chain rule through dilog would not.
+*/
+static prec fermi_emission(prec x)
+{
+	return(0.5*pow(log_1_x(exp(x)),2.0)+dilog(1.0/(1.0+exp(-x))));
+}
+
+template <int N> static DualNumber<N> fermi_emission(const DualNumber<N>& x)
+{
+	return(dual_compose(fermi_emission(x.value),log_1_x(exp(x.value)),x));
+}
+
+static prec log_1_exp(prec x)
+{
+	return(log_1_x(exp(x)));
+}
+
+template <int N> static DualNumber<N> log_1_exp(const DualNumber<N>& x)
+{
+	return(dual_compose(log_1_exp(x.value),1.0/(1.0+exp(-x.value)),x));
+}
+
+/*
+	Tunneling integrand of a bulk element, the transmission at an energy times the difference
+	of the supply functions of the two nodes. sign is 1.0 for electrons, which tunnel above
+	the conduction band edge, and -1.0 for holes, which tunnel below the valence band edge.
+*/
+template <class T> struct TunnelIntegrand {
+	TElectricalServices *services;
+	flag grid_effects;
+	prec sign;
+	prec band_edge_prev, band_edge_next;
+	prec temp_prev, temp_next;
+	T planck_prev, planck_next;
+
+	T operator()(prec energy);
+};
+
+template <class T> T TunnelIntegrand<T>::operator()(prec energy)
+{
+	prec transmission;
+	T x_prev, x_next;
+
+	if (sign>0) transmission=services->comp_conduction_transmission(energy);
+	else transmission=services->comp_valence_transmission(energy);
+
+	x_prev=planck_prev-sign*(energy-band_edge_prev)/temp_prev;
+	x_next=planck_next-sign*(energy-band_edge_next)/temp_next;
+
+	if (grid_effects & GRID_FERMI_DIRAC)
+		return(sign*transmission*(-temp_prev*log_1_exp(x_prev)+temp_next*log_1_exp(x_next)));
+	else
+		return(sign*transmission*(-temp_prev*exp(x_prev)+temp_next*exp(x_next)));
+}
+
 /*********************************** class TElectricalElement ********************************
 
 class TElectricalElement: public TElement {
+protected:
+	ElementDual electron_current_dual;
+	ElementDual hole_current_dual;
+	long tunnel_evaluations;
 public:
 	TElectricalElement(RegionType region_type,TDevice *device, TNode* node_1, TNode* node_2)
-		: TElement(region_type,device,node_1,node_2) {}
+		: TElement(region_type,device,node_1,node_2) { tunnel_evaluations=0; }
 	virtual ~TElectricalElement(void) {}
 
 	virtual void update(FundamentalParam update);
@@ -46,15 +110,28 @@ public:
 	virtual prec comp_field(void)=0;
 	virtual FundamentalParam comp_deriv_field(NodeSide node, int return_flag)=0;
 	virtual prec comp_electron_current(void)=0;
-	virtual FundamentalParam comp_deriv_electron_current(NodeSide node,int return_flag)=0;
 	virtual prec comp_hole_current(void)=0;
-	virtual FundamentalParam comp_deriv_hole_current(NodeSide node,int return_flag)=0;
+	virtual void comp_fused_current(void)=0;
+	prec get_electron_current(void) { return(electron_current_dual.value); }
+	prec get_hole_current(void) { return(hole_current_dual.value); }
+	FundamentalParam comp_deriv_electron_current(NodeSide node,int return_flag);
+	FundamentalParam comp_deriv_hole_current(NodeSide node,int return_flag);
 	virtual prec comp_integral_charge(ElementSide side)=0;
 	virtual FundamentalParam comp_deriv_integral_charge(ElementSide side, NodeSide node,
 														int return_flag, SolveType solve)=0;
 	virtual prec comp_integral_recomb(ElementSide side)=0;
 	virtual FundamentalParam comp_deriv_integral_recomb(ElementSide side, NodeSide node,
 														int return_flag)=0;
+
+	long take_tunnel_evaluations(void)
+		{ long evaluations=tunnel_evaluations; tunnel_evaluations=0; return(evaluations); }
+
+	static long comp_range_values(TElectricalElement **element_ptr, ElementRange *range, int ranges,
+								  int first, int last, ElementValues *values,
+								  SolveType solve, logical fused_current);
+	static void comp_range_derivatives(TElectricalElement **element_ptr, ElementRange *range, int ranges,
+									   int first, int last, ElementDerivatives *derivatives,
+									   int return_flag, SolveType solve);
 };
 */
 
@@ -66,6 +143,53 @@ void TElectricalElement::update(FundamentalParam update)
 	if (update.eta_v) next_node->THole::planck_potential-=update.eta_v;
 }
 
+/*
+	Partials of the current kept by the last comp_fused_current(). TSolution only builds the
+	Jacobian after comp_electrical_solution(TRUE), which calls comp_fused_current() for every
+	element in the solution range.
+*/
+FundamentalParam TElectricalElement::comp_deriv_electron_current(NodeSide node, int return_flag)
+{
+	FundamentalParam return_value;
+
+	return_value.psi=return_value.eta_c=return_value.eta_v=0.0;
+
+	switch(node) {
+		case PREVIOUS_NODE:
+			if (return_flag & D_PSI) return_value.psi=electron_current_dual.deriv[DUAL_PREV_PSI];
+			if (return_flag & D_ETA_C) return_value.eta_c=electron_current_dual.deriv[DUAL_PREV_ETA];
+			break;
+		case NEXT_NODE:
+			if (return_flag & D_PSI) return_value.psi=electron_current_dual.deriv[DUAL_NEXT_PSI];
+			if (return_flag & D_ETA_C) return_value.eta_c=electron_current_dual.deriv[DUAL_NEXT_ETA];
+			break;
+		default: assert(FALSE); break;
+	}
+
+	return(return_value);
+}
+
+FundamentalParam TElectricalElement::comp_deriv_hole_current(NodeSide node, int return_flag)
+{
+	FundamentalParam return_value;
+
+	return_value.psi=return_value.eta_c=return_value.eta_v=0.0;
+
+	switch(node) {
+		case PREVIOUS_NODE:
+			if (return_flag & D_PSI) return_value.psi=hole_current_dual.deriv[DUAL_PREV_PSI];
+			if (return_flag & D_ETA_V) return_value.eta_v=hole_current_dual.deriv[DUAL_PREV_ETA];
+			break;
+		case NEXT_NODE:
+			if (return_flag & D_PSI) return_value.psi=hole_current_dual.deriv[DUAL_NEXT_PSI];
+			if (return_flag & D_ETA_V) return_value.eta_v=hole_current_dual.deriv[DUAL_NEXT_ETA];
+			break;
+		default: assert(FALSE); break;
+	}
+
+	return(return_value);
+}
+
 /******************************  class TBulkElectricalElement ********************************
 
 class TBulkElectricalElement: public TElectricalElement, public TElectricalServices {
@@ -81,17 +205,21 @@ public:
 
 	virtual void comp_dependent_param(SolveType solve);
 	virtual void comp_independent_param(void);
+	static void comp_grid_dependent_param(TElectricalElement **element_ptr, int elements,
+										  SolveType solve);
 
 private:
 	void comp_permit_length(void);
+	void comp_transport_param(void);
+	template <class T> T electron_current_kernel(void);
+	template <class T> T hole_current_kernel(void);
 
 public:
 	virtual prec comp_field(void);
 	virtual FundamentalParam comp_deriv_field(NodeSide node, int return_flag);
 	virtual prec comp_electron_current(void);
-	virtual FundamentalParam comp_deriv_electron_current(NodeSide node,int return_flag);
 	virtual prec comp_hole_current(void);
-	virtual FundamentalParam comp_deriv_hole_current(NodeSide node,int return_flag);
+	virtual void comp_fused_current(void);
 	virtual prec comp_integral_charge(ElementSide side);
 	virtual FundamentalParam comp_deriv_integral_charge(ElementSide side, NodeSide node,
 														int return_flag, SolveType solve);
@@ -102,41 +230,83 @@ public:
 */
 
 void TBulkElectricalElement::comp_dependent_param(SolveType solve)
+{
+	if (solve==STEADY_STATE) {
+		comp_transport_param();
+		comp_drift_diff_bernoulli();
+	}
+}
+
+/*
+	Full pass over the electrical elements of a solution. The bulk elements are gathered in
+	blocks of BERNOULLI_BATCH_ELEMENTS and the Bernoulli functions of each block are taken with
+	one call to the array form of bernoulli_pair(). The other elements compute their dependent
+	parameters one at a time as before.
+*/
+void TBulkElectricalElement::comp_grid_dependent_param(TElectricalElement **element_ptr, int elements,
+													   SolveType solve)
+{
+	int i, j, batch_elements;
+	TBulkElectricalElement *bulk_element;
+	TBulkElectricalElement *batch_element[BERNOULLI_BATCH_ELEMENTS];
+	prec argument[4*BERNOULLI_BATCH_ELEMENTS];
+	prec bern_pos[4*BERNOULLI_BATCH_ELEMENTS], bern_neg[4*BERNOULLI_BATCH_ELEMENTS];
+	prec deriv_pos[4*BERNOULLI_BATCH_ELEMENTS], deriv_neg[4*BERNOULLI_BATCH_ELEMENTS];
+
+	batch_elements=0;
+	for (i=0;i<elements;i++) {
+		if ((solve==STEADY_STATE) && (element_ptr[i]->get_region_type()==BULK)) {
+			bulk_element=(TBulkElectricalElement *)element_ptr[i];
+			bulk_element->comp_transport_param();
+			bulk_element->get_bernoulli_arguments(argument+4*batch_elements);
+			batch_element[batch_elements++]=bulk_element;
+		}
+		else element_ptr[i]->comp_dependent_param(solve);
+
+		if ((batch_elements==BERNOULLI_BATCH_ELEMENTS) || ((i==elements-1) && batch_elements)) {
+			bernoulli_pair(argument,bern_pos,bern_neg,deriv_pos,deriv_neg,4*batch_elements);
+			for (j=0;j<batch_elements;j++)
+				batch_element[j]->put_bernoulli_values(bern_pos+4*j,bern_neg+4*j,
+													   deriv_pos+4*j,deriv_neg+4*j);
+			batch_elements=0;
+		}
+	}
+}
+
+void TBulkElectricalElement::comp_transport_param(void)
 {
 	prec test_length;
 
-	if (solve==STEADY_STATE) {
-		elec_therm_emis_current=FALSE;
-		hole_therm_emis_current=FALSE;
+	elec_therm_emis_current=FALSE;
+	hole_therm_emis_current=FALSE;
 
-		if ((ec_therm.band_discont != 0) && ((grid_effects & GRID_THERMIONIC) || (grid_effects & GRID_TUNNELING))) {
-			if (grid_effects & GRID_ABRUPT_MATERIALS) elec_therm_emis_current=TRUE;
-			else {
-				comp_elec_scat_length();
-				test_length=(prev_node->TElectron::temperature+next_node->TElectron::temperature)*length/fabs(ec_therm.band_discont);
-				if (test_length<elec_scat_length) {
-					elec_therm_emis_current=TRUE;
-				}
+	if ((ec_therm.band_discont != 0) && ((grid_effects & GRID_THERMIONIC) || (grid_effects & GRID_TUNNELING))) {
+		if (grid_effects & GRID_ABRUPT_MATERIALS) elec_therm_emis_current=TRUE;
+		else {
+			comp_elec_scat_length();
+			test_length=(prev_node->TElectron::temperature+next_node->TElectron::temperature)*length/fabs(ec_therm.band_discont);
+			if (test_length<elec_scat_length) {
+				elec_therm_emis_current=TRUE;
 			}
 		}
+	}
 
-		if ((ev_therm.band_discont != 0) && ((grid_effects & GRID_THERMIONIC) || (grid_effects & GRID_TUNNELING))) {
-			if (grid_effects & GRID_ABRUPT_MATERIALS) hole_therm_emis_current=TRUE;
-			else {
-				comp_hole_scat_length();
-				test_length=(prev_node->THole::temperature+next_node->THole::temperature)*length/fabs(ev_therm.band_discont);
-				if (test_length<hole_scat_length) {
-					hole_therm_emis_current=TRUE;
-				}
+	if ((ev_therm.band_discont != 0) && ((grid_effects & GRID_THERMIONIC) || (grid_effects & GRID_TUNNELING))) {
+		if (grid_effects & GRID_ABRUPT_MATERIALS) hole_therm_emis_current=TRUE;
+		else {
+			comp_hole_scat_length();
+			test_length=(prev_node->THole::temperature+next_node->THole::temperature)*length/fabs(ev_therm.band_discont);
+			if (test_length<hole_scat_length) {
+				hole_therm_emis_current=TRUE;
 			}
 		}
+	}
 
-		if (elec_therm_emis_current) comp_cond_therm_emis_param(grid_effects);
-		else comp_cond_drift_diff_param(grid_effects);
+	if (elec_therm_emis_current) comp_cond_therm_emis_param(grid_effects);
+	else comp_cond_drift_diff_param(grid_effects);
 
-		if (hole_therm_emis_current) comp_val_therm_emis_param(grid_effects);
-		else comp_val_drift_diff_param(grid_effects);
-	}
+	if (hole_therm_emis_current) comp_val_therm_emis_param(grid_effects);
+	else comp_val_drift_diff_param(grid_effects);
 }
 
 void TBulkElectricalElement::comp_independent_param(void)
@@ -185,537 +355,255 @@ FundamentalParam TBulkElectricalElement::comp_deriv_field(NodeSide node,int retu
 	return(result);
 }
 
-prec TBulkElectricalElement::comp_electron_current(void)
+/*
+	The current kernels are written once for a template type T. comp_electron_current()
+	and comp_hole_current() evaluate them with prec for the residual, comp_fused_current()
+	evaluates them with ElementDual and keeps the values and the partials with respect to
+	both nodes for the Jacobian.
+
+	Only the dependence on psi and on the Planck potentials is followed. The temperatures,
+	the Fermi integral ratio, the tunneling transmission and the tunneling energy range are
+	held fixed in the partials. The tunneling energy integral takes the 25 step trapezoid
+	rule unless the device has a Gauss quadrature selected, see simquad.h.
+*/
+template <class T> T TBulkElectricalElement::electron_current_kernel(void)
 {
 	prec temp_next, temp_prev;
-	prec n_next, n_prev;
-	prec prev_transmit_value, next_transmit_value;
+	prec stored_temp_next, stored_temp_prev;
 	prec start_value, end_value;
-	prec transmit_energy;
-	prec planck_next, planck_prev;
-	prec current=0.0;
+	prec top_value, transmit_energy;
+	T n_next, n_prev;
+	T planck_next, planck_prev;
+	T barrier_next, barrier_prev;
+	T bernoulli_param;
+	T prev_transmit_value, next_transmit_value;
+	TunnelIntegrand<T> integrand;
+	const TunnelQuadrature *quadrature;
+	T current=0.0;
 
 	temp_next=next_node->TElectron::temperature;
 	temp_prev=prev_node->TElectron::temperature;
 
 	if (elec_therm_emis_current) {
 
-		planck_next=next_node->TElectron::planck_potential;
-		planck_prev=prev_node->TElectron::planck_potential;
+		dual_seed(planck_next,next_node->TElectron::planck_potential,DUAL_NEXT_ETA,1.0);
+		dual_seed(planck_prev,prev_node->TElectron::planck_potential,DUAL_PREV_ETA,1.0);
 
 		if (grid_effects & GRID_THERMIONIC) {
-			if (grid_effects & GRID_FERMI_DIRAC) {
-				current=-ec_therm.richardson_const*sq(temp_prev)*(0.5*pow(log_1_x(exp(planck_prev-ec_therm.barrier_prev)),2.0)
-																		   +dilog(1.0/(1.0+exp(ec_therm.barrier_prev-planck_prev))))
-						+ec_therm.richardson_const*sq(temp_next)*(0.5*pow(log_1_x(exp(planck_next-ec_therm.barrier_next)),2.0)
-																		   +dilog(1.0/(1.0+exp(ec_therm.barrier_next-planck_next))));
-			}
-			else {
-				current=-ec_therm.richardson_const*sq(temp_prev)*exp(planck_prev-ec_therm.barrier_prev)
-						+ec_therm.richardson_const*sq(temp_next)*exp(planck_next-ec_therm.barrier_next);
-			}
-		}
+			stored_temp_next=next_node->TElectron::stored_temperature;
+			stored_temp_prev=prev_node->TElectron::stored_temperature;
 
-		if ((grid_effects & GRID_TUNNELING) && ec_therm.min_transmit_energy) {
-			if (grid_effects & GRID_FERMI_DIRAC) {
-				prev_transmit_value=-temp_prev*log_1_x(exp(planck_prev-ec_therm.barrier_prev))
-									+temp_next*log_1_x(exp(planck_next-ec_therm.barrier_next));
-				start_value=prev_node->TElectron::band_edge+ec_therm.barrier_prev*temp_prev+ec_therm.min_transmit_energy/25.0;
-				end_value=prev_node->TElectron::band_edge+ec_therm.barrier_prev*temp_prev+ec_therm.min_transmit_energy;
-				for (transmit_energy=start_value; transmit_energy>=end_value;
-					 transmit_energy+=ec_therm.min_transmit_energy/25.0) {
-					next_transmit_value=comp_conduction_transmission(transmit_energy)*
-									   (-temp_prev*(log_1_x(exp(planck_prev-(transmit_energy-prev_node->TElectron::band_edge)/temp_prev)))
-										+temp_next*(log_1_x(exp(planck_next-(transmit_energy-next_node->TElectron::band_edge)/temp_next))));
-					current+=ec_therm.richardson_const*(next_transmit_value+prev_transmit_value)/2.0*
-													   (-ec_therm.min_transmit_energy/25.0);
-					prev_transmit_value=next_transmit_value;
-				}
-			}
-			else {
-				prev_transmit_value=-temp_prev*exp(planck_prev-ec_therm.barrier_prev)
-									+temp_next*exp(planck_next-ec_therm.barrier_next);
-				start_value=prev_node->TElectron::band_edge+ec_therm.barrier_prev*temp_prev+ec_therm.min_transmit_energy/25.0;
-				end_value=prev_node->TElectron::band_edge+ec_therm.barrier_prev*temp_prev+ec_therm.min_transmit_energy;
-				for (transmit_energy=start_value; transmit_energy>=end_value;
-					 transmit_energy+=ec_therm.min_transmit_energy/25.0) {
-					next_transmit_value=comp_conduction_transmission(transmit_energy)*
-									   (-temp_prev*(exp(planck_prev-(transmit_energy-prev_node->TElectron::band_edge)/temp_prev))
-										+temp_next*(exp(planck_next-(transmit_energy-next_node->TElectron::band_edge)/temp_next)));
-					current+=ec_therm.richardson_const*(next_transmit_value+prev_transmit_value)/2.0*
-													   (-ec_therm.min_transmit_energy/25.0);
-					prev_transmit_value=next_transmit_value;
-				}
-			}
-		}
-	}
-	else {
-		n_next=next_node->TElectron::total_conc;
-		n_prev=prev_node->TElectron::total_conc;
-
-		current=electron_mobility_length*ec.fermi_ratio_1_half_minus_1_half*
-				(n_next*temp_next*ec.bernoulli_grad_temp_next
-				-n_prev*temp_prev*ec.bernoulli_grad_temp_prev);
-	}
-
-	return(current);
-}
-
-FundamentalParam TBulkElectricalElement::comp_deriv_electron_current(NodeSide node,
-																	  int return_flag)
-{
-	prec n_next, n_prev;
-	prec temp_next, temp_prev;
-	FundamentalParam return_value;
-	prec deriv_n_eta_c_next, deriv_n_eta_c_prev;
-	prec planck_next,planck_prev;
-	prec prev_transmit_value,next_transmit_value;
-	prec transmit_energy;
-	prec start_value,end_value;
-
-	temp_next=next_node->TElectron::temperature;
-	temp_prev=prev_node->TElectron::temperature;
-
-	return_value.psi=return_value.eta_c=return_value.eta_v=0.0;
-
-	if (elec_therm_emis_current) {
-
-		planck_next=next_node->TElectron::planck_potential;
-		planck_prev=prev_node->TElectron::planck_potential;
+			dual_seed(barrier_prev,ec_therm.barrier_prev,DUAL_PREV_PSI,0.5/stored_temp_prev);
+			dual_add_partial(barrier_prev,DUAL_NEXT_PSI,-0.5/stored_temp_prev);
+			dual_seed(barrier_next,ec_therm.barrier_next,DUAL_PREV_PSI,-0.5/stored_temp_next);
+			dual_add_partial(barrier_next,DUAL_NEXT_PSI,0.5/stored_temp_next);
 
-		if (grid_effects & GRID_THERMIONIC) {
 			if (grid_effects & GRID_FERMI_DIRAC) {
-				switch(node) {
-					case PREVIOUS_NODE:
-						if (return_flag & D_PSI)
-							return_value.psi=0.5*ec_therm.richardson_const*
-												  (temp_prev*log_1_x(exp(planck_prev-ec_therm.barrier_prev))+
-												   temp_next*log_1_x(exp(planck_next-ec_therm.barrier_next)));
-
-						if (return_flag & D_ETA_C)
-							return_value.eta_c=-ec_therm.richardson_const*sq(temp_prev)*
-												 log_1_x(exp(planck_prev-ec_therm.barrier_prev));
-
-						break;
-
-					case NEXT_NODE:
-						if (return_flag & D_PSI)
-							return_value.psi=-0.5*ec_therm.richardson_const*
-												  (temp_prev*log_1_x(exp(planck_prev-ec_therm.barrier_prev))+
-												   temp_next*log_1_x(exp(planck_next-ec_therm.barrier_next)));
-
-						if (return_flag & D_ETA_C)
-							return_value.eta_c=ec_therm.richardson_const*sq(temp_next)*
-												 log_1_x(exp(planck_next-ec_therm.barrier_next));
-
-						break;
-				}
+				current=-ec_therm.richardson_const*sq(temp_prev)*fermi_emission(planck_prev-barrier_prev)
+						+ec_therm.richardson_const*sq(temp_next)*fermi_emission(planck_next-barrier_next);
 			}
 			else {
-				switch(node) {
-					case PREVIOUS_NODE:
-						if (return_flag & D_PSI)
-							return_value.psi=0.5*ec_therm.richardson_const*
-												  (temp_prev*exp(planck_prev-ec_therm.barrier_prev)+
-												   temp_next*exp(planck_next-ec_therm.barrier_next));
-
-						if (return_flag & D_ETA_C)
-							return_value.eta_c=-ec_therm.richardson_const*sq(temp_prev)*
-												 exp(planck_prev-ec_therm.barrier_prev);
-
-
-						break;
-
-					case NEXT_NODE:
-						if (return_flag & D_PSI)
-							return_value.psi=-0.5*ec_therm.richardson_const*
-												  (temp_prev*exp(planck_prev-ec_therm.barrier_prev)+
-												   temp_next*exp(planck_next-ec_therm.barrier_next));
-
-						if (return_flag & D_ETA_C)
-							return_value.eta_c=ec_therm.richardson_const*sq(temp_next)*
-												 exp(planck_next-ec_therm.barrier_next);
-
-						break;
-				}
+				current=-ec_therm.richardson_const*sq(temp_prev)*exp(planck_prev-barrier_prev)
+						+ec_therm.richardson_const*sq(temp_next)*exp(planck_next-barrier_next);
 			}
 		}
 
 		if ((grid_effects & GRID_TUNNELING) && ec_therm.min_transmit_energy) {
-			if (grid_effects & GRID_FERMI_DIRAC) {
-				switch(node) {
-					case PREVIOUS_NODE:
-						if (return_flag & D_ETA_C) {
-							prev_transmit_value=-temp_prev/(1.0+exp(-planck_prev+ec_therm.barrier_prev));
-							start_value=prev_node->TElectron::band_edge+ec_therm.barrier_prev*temp_prev+ec_therm.min_transmit_energy/25.0;
-							end_value=prev_node->TElectron::band_edge+ec_therm.barrier_prev*temp_prev+ec_therm.min_transmit_energy;
-							for (transmit_energy=start_value; transmit_energy>=end_value;
-								 transmit_energy+=ec_therm.min_transmit_energy/25.0) {
-								next_transmit_value=comp_conduction_transmission(transmit_energy)*
-												   (-temp_prev/(1.0+exp(-planck_prev+(transmit_energy-prev_node->TElectron::band_edge)/temp_prev)));
-								return_value.eta_c+=ec_therm.richardson_const*(next_transmit_value+prev_transmit_value)/2.0*
-																			  (-ec_therm.min_transmit_energy/25.0);
-								prev_transmit_value=next_transmit_value;
-							}
-						}
-
-						break;
-
-					case NEXT_NODE:
-						if (return_flag & D_ETA_C) {
-							prev_transmit_value=temp_next/(1.0+exp(-planck_next+ec_therm.barrier_next));
-							start_value=prev_node->TElectron::band_edge+ec_therm.barrier_prev*temp_prev+ec_therm.min_transmit_energy/25.0;
-							end_value=prev_node->TElectron::band_edge+ec_therm.barrier_prev*temp_prev+ec_therm.min_transmit_energy;
-							for (transmit_energy=start_value; transmit_energy>=end_value;
-								 transmit_energy+=ec_therm.min_transmit_energy/25.0) {
-								next_transmit_value=comp_conduction_transmission(transmit_energy)*
-												   (temp_next/(1.0+exp(-planck_next+(transmit_energy-next_node->TElectron::band_edge)/temp_next)));
-								return_value.eta_c+=ec_therm.richardson_const*(next_transmit_value+prev_transmit_value)/2.0*
-																			  (-ec_therm.min_transmit_energy/25.0);
-								prev_transmit_value=next_transmit_value;
-							}
-						}
-
-						break;
-				}
+			quadrature=&TElectricalServices::device_ptr->get_tunnel_quadrature();
+			top_value=prev_node->TElectron::band_edge+ec_therm.barrier_prev*temp_prev;
+
+			if (quadrature->type!=QUAD_TRAPEZOID) {
+				integrand.services=this;
+				integrand.grid_effects=grid_effects;
+				integrand.sign=1.0;
+				integrand.band_edge_prev=prev_node->TElectron::band_edge;
+				integrand.band_edge_next=next_node->TElectron::band_edge;
+				integrand.temp_prev=temp_prev;
+				integrand.temp_next=temp_next;
+				integrand.planck_prev=planck_prev;
+				integrand.planck_next=planck_next;
+				current+=-ec_therm.richardson_const*
+						 tunnel_integral<T>(integrand,top_value,top_value+ec_therm.min_transmit_energy,*quadrature,
+											tunnel_evaluations);
 			}
 			else {
-				switch(node) {
-					case PREVIOUS_NODE:
-						if (return_flag & D_ETA_C) {
-							prev_transmit_value=-temp_prev*exp(planck_prev-ec_therm.barrier_prev);
-							start_value=prev_node->TElectron::band_edge+ec_therm.barrier_prev*temp_prev+ec_therm.min_transmit_energy/25.0;
-							end_value=prev_node->TElectron::band_edge+ec_therm.barrier_prev*temp_prev+ec_therm.min_transmit_energy;
-							for (transmit_energy=start_value; transmit_energy>=end_value;
-								 transmit_energy+=ec_therm.min_transmit_energy/25.0) {
-								next_transmit_value=comp_conduction_transmission(transmit_energy)*
-												   (-temp_prev*(exp(planck_prev-(transmit_energy-prev_node->TElectron::band_edge)/temp_prev)));
-								return_value.eta_c+=ec_therm.richardson_const*(next_transmit_value+prev_transmit_value)/2.0*
-																			  (-ec_therm.min_transmit_energy/25.0);
-								prev_transmit_value=next_transmit_value;
-							}
-						}
-						break;
-
-					case NEXT_NODE:
-						if (return_flag & D_ETA_C) {
-							prev_transmit_value=temp_next*exp(planck_next-ec_therm.barrier_next);
-							start_value=prev_node->TElectron::band_edge+ec_therm.barrier_prev*temp_prev+ec_therm.min_transmit_energy/25.0;
-							end_value=prev_node->TElectron::band_edge+ec_therm.barrier_prev*temp_prev+ec_therm.min_transmit_energy;
-							for (transmit_energy=start_value; transmit_energy>=end_value;
-								 transmit_energy+=ec_therm.min_transmit_energy/25.0) {
-								next_transmit_value=comp_conduction_transmission(transmit_energy)*
-												   (temp_next*(exp(planck_next-(transmit_energy-next_node->TElectron::band_edge)/temp_next)));
-								return_value.eta_c+=ec_therm.richardson_const*(next_transmit_value+prev_transmit_value)/2.0*
-																			  (-ec_therm.min_transmit_energy/25.0);
-								prev_transmit_value=next_transmit_value;
-							}
-						}
-						break;
+				start_value=top_value+ec_therm.min_transmit_energy/25.0;
+				end_value=top_value+ec_therm.min_transmit_energy;
+
+				if (grid_effects & GRID_FERMI_DIRAC) {
+					prev_transmit_value=-temp_prev*log_1_exp(planck_prev-ec_therm.barrier_prev)
+										+temp_next*log_1_exp(planck_next-ec_therm.barrier_next);
+					for (transmit_energy=start_value; transmit_energy>=end_value;
+						 transmit_energy+=ec_therm.min_transmit_energy/25.0) {
+						next_transmit_value=comp_conduction_transmission(transmit_energy)*
+										   (-temp_prev*(log_1_exp(planck_prev-(transmit_energy-prev_node->TElectron::band_edge)/temp_prev))
+											+temp_next*(log_1_exp(planck_next-(transmit_energy-next_node->TElectron::band_edge)/temp_next)));
+						current+=ec_therm.richardson_const*(next_transmit_value+prev_transmit_value)/2.0*
+														   (-ec_therm.min_transmit_energy/25.0);
+						prev_transmit_value=next_transmit_value;
+						tunnel_evaluations++;
+					}
+				}
+				else {
+					prev_transmit_value=-temp_prev*exp(planck_prev-ec_therm.barrier_prev)
+										+temp_next*exp(planck_next-ec_therm.barrier_next);
+					for (transmit_energy=start_value; transmit_energy>=end_value;
+						 transmit_energy+=ec_therm.min_transmit_energy/25.0) {
+						next_transmit_value=comp_conduction_transmission(transmit_energy)*
+										   (-temp_prev*(exp(planck_prev-(transmit_energy-prev_node->TElectron::band_edge)/temp_prev))
+											+temp_next*(exp(planck_next-(transmit_energy-next_node->TElectron::band_edge)/temp_next)));
+						current+=ec_therm.richardson_const*(next_transmit_value+prev_transmit_value)/2.0*
+														   (-ec_therm.min_transmit_energy/25.0);
+						prev_transmit_value=next_transmit_value;
+						tunnel_evaluations++;
+					}
 				}
 			}
 		}
 	}
 	else {
+		dual_seed(n_next,next_node->TElectron::total_conc,DUAL_NEXT_ETA,next_node->TElectron::total_deriv_conc_eta_c);
+		dual_seed(n_prev,prev_node->TElectron::total_conc,DUAL_PREV_ETA,prev_node->TElectron::total_deriv_conc_eta_c);
 
-		n_next=next_node->TElectron::total_conc;
-		n_prev=prev_node->TElectron::total_conc;
-
-		deriv_n_eta_c_next=next_node->TElectron::total_deriv_conc_eta_c;
-		deriv_n_eta_c_prev=prev_node->TElectron::total_deriv_conc_eta_c;
-
-		switch(node) {
-			case PREVIOUS_NODE:
-				if (return_flag & D_PSI)
-					return_value.psi=-electron_mobility_length*
-									  (n_next*ec.deriv_bern_grad_temp_next+
-									   n_prev*ec.deriv_bern_grad_temp_prev);
-
-				if (return_flag & D_ETA_C)
-					return_value.eta_c=-electron_mobility_length*ec.fermi_ratio_1_half_minus_1_half*
-										deriv_n_eta_c_prev*temp_prev*ec.bernoulli_grad_temp_prev;
-
-				break;
-
-			case NEXT_NODE:
-				if (return_flag & D_PSI)
-					return_value.psi=electron_mobility_length*
-									 (n_next*ec.deriv_bern_grad_temp_next+
-									  n_prev*ec.deriv_bern_grad_temp_prev);
+		// The band edges follow -psi, so psi enters the Bernoulli argument through the band edge gradient
+		dual_seed(bernoulli_param,ec.bernoulli_param,DUAL_PREV_PSI,-1.0/ec.fermi_ratio_1_half_minus_1_half);
+		dual_add_partial(bernoulli_param,DUAL_NEXT_PSI,1.0/ec.fermi_ratio_1_half_minus_1_half);
 
-				if (return_flag & D_ETA_C)
-					return_value.eta_c=electron_mobility_length*ec.fermi_ratio_1_half_minus_1_half*
-									   deriv_n_eta_c_next*temp_next*ec.bernoulli_grad_temp_next;
-
-				break;
-		}
+		current=electron_mobility_length*ec.fermi_ratio_1_half_minus_1_half*
+				(n_next*temp_next*dual_compose(ec.bernoulli_grad_temp_next,ec.deriv_bern_grad_temp_next,
+											   bernoulli_param/temp_next)
+				-n_prev*temp_prev*dual_compose(ec.bernoulli_grad_temp_prev,ec.deriv_bern_grad_temp_prev,
+											   -bernoulli_param/temp_prev));
 	}
 
-	return(return_value);
+	return(current);
 }
 
-prec TBulkElectricalElement::comp_hole_current(void)
+template <class T> T TBulkElectricalElement::hole_current_kernel(void)
 {
 	prec temp_next, temp_prev;
-	prec p_next, p_prev;
-	prec planck_next, planck_prev;
-	prec prev_transmit_value, next_transmit_value;
+	prec stored_temp_next, stored_temp_prev;
 	prec start_value, end_value;
-	prec transmit_energy;
-	prec current=0.0;
+	prec top_value, transmit_energy;
+	T p_next, p_prev;
+	T planck_next, planck_prev;
+	T barrier_next, barrier_prev;
+	T bernoulli_param;
+	T prev_transmit_value, next_transmit_value;
+	TunnelIntegrand<T> integrand;
+	const TunnelQuadrature *quadrature;
+	T current=0.0;
 
 	temp_next=next_node->THole::temperature;
 	temp_prev=prev_node->THole::temperature;
 
 	if (hole_therm_emis_current) {
 
-		planck_next=next_node->THole::planck_potential;
-		planck_prev=prev_node->THole::planck_potential;
+		dual_seed(planck_next,next_node->THole::planck_potential,DUAL_NEXT_ETA,1.0);
+		dual_seed(planck_prev,prev_node->THole::planck_potential,DUAL_PREV_ETA,1.0);
 
 		if (grid_effects & GRID_THERMIONIC) {
+			stored_temp_next=next_node->THole::stored_temperature;
+			stored_temp_prev=prev_node->THole::stored_temperature;
+
+			dual_seed(barrier_prev,ev_therm.barrier_prev,DUAL_PREV_PSI,-0.5/stored_temp_prev);
+			dual_add_partial(barrier_prev,DUAL_NEXT_PSI,0.5/stored_temp_prev);
+			dual_seed(barrier_next,ev_therm.barrier_next,DUAL_PREV_PSI,0.5/stored_temp_next);
+			dual_add_partial(barrier_next,DUAL_NEXT_PSI,-0.5/stored_temp_next);
+
 			if (grid_effects & GRID_FERMI_DIRAC) {
-				current=ev_therm.richardson_const*sq(temp_prev)*(0.5*pow(log_1_x(exp(planck_prev-ev_therm.barrier_prev)),2.0)
-																  +dilog(1.0/(1.0+exp(ev_therm.barrier_prev-planck_prev))))
-					   -ev_therm.richardson_const*sq(temp_next)*(0.5*pow(log_1_x(exp(planck_next-ev_therm.barrier_next)),2.0)
-																  +dilog(1.0/(1.0+exp(ev_therm.barrier_next-planck_next))));
+				current=ev_therm.richardson_const*sq(temp_prev)*fermi_emission(planck_prev-barrier_prev)
+					   -ev_therm.richardson_const*sq(temp_next)*fermi_emission(planck_next-barrier_next);
 			}
 			else {
-				current=ev_therm.richardson_const*sq(temp_prev)*exp(planck_prev-ev_therm.barrier_prev)
-					   -ev_therm.richardson_const*sq(temp_next)*exp(planck_next-ev_therm.barrier_next);
+				current=ev_therm.richardson_const*sq(temp_prev)*exp(planck_prev-barrier_prev)
+					   -ev_therm.richardson_const*sq(temp_next)*exp(planck_next-barrier_next);
 			}
 		}
 
 		if ((grid_effects & GRID_TUNNELING) && ev_therm.min_transmit_energy) {
-			if (grid_effects & GRID_FERMI_DIRAC) {
-				prev_transmit_value=temp_prev*log_1_x(exp(planck_prev-ev_therm.barrier_prev))
-								   -temp_next*log_1_x(exp(planck_next-ev_therm.barrier_next));
-				start_value=prev_node->THole::band_edge-ev_therm.barrier_prev*temp_prev-ev_therm.min_transmit_energy/25.0;
-				end_value=prev_node->THole::band_edge-ev_therm.barrier_prev*temp_prev-ev_therm.min_transmit_energy;
-				for (transmit_energy=start_value; transmit_energy<=end_value;
-					 transmit_energy-=ev_therm.min_transmit_energy/25.0) {
-					next_transmit_value=comp_valence_transmission(transmit_energy)*
-									   (temp_prev*(log_1_x(exp(planck_prev-(prev_node->THole::band_edge-transmit_energy)/temp_prev)))
-									   -temp_next*(log_1_x(exp(planck_next-(next_node->THole::band_edge-transmit_energy)/temp_next))));
-					current+=ev_therm.richardson_const*(next_transmit_value+prev_transmit_value)/2.0*
-													   (-ev_therm.min_transmit_energy/25.0);
-					prev_transmit_value=next_transmit_value;
-				}
+			quadrature=&TElectricalServices::device_ptr->get_tunnel_quadrature();
+			top_value=prev_node->THole::band_edge-ev_therm.barrier_prev*temp_prev;
+
+			if (quadrature->type!=QUAD_TRAPEZOID) {
+				integrand.services=this;
+				integrand.grid_effects=grid_effects;
+				integrand.sign=-1.0;
+				integrand.band_edge_prev=prev_node->THole::band_edge;
+				integrand.band_edge_next=next_node->THole::band_edge;
+				integrand.temp_prev=temp_prev;
+				integrand.temp_next=temp_next;
+				integrand.planck_prev=planck_prev;
+				integrand.planck_next=planck_next;
+				current+=ev_therm.richardson_const*
+						 tunnel_integral<T>(integrand,top_value,top_value-ev_therm.min_transmit_energy,*quadrature,
+											tunnel_evaluations);
 			}
 			else {
-				prev_transmit_value=temp_prev*exp(planck_prev-ev_therm.barrier_prev)
-								   -temp_next*exp(planck_next-ev_therm.barrier_next);
-				start_value=prev_node->THole::band_edge-ev_therm.barrier_prev*temp_prev-ev_therm.min_transmit_energy/25.0;
-				end_value=prev_node->THole::band_edge-ev_therm.barrier_prev*temp_prev-ev_therm.min_transmit_energy;
-				for (transmit_energy=start_value; transmit_energy<=end_value;
-					 transmit_energy-=ev_therm.min_transmit_energy/25.0) {
-					next_transmit_value=comp_valence_transmission(transmit_energy)*
-									   (temp_prev*(exp(planck_prev-(prev_node->THole::band_edge-transmit_energy)/temp_prev))
-									   -temp_next*(exp(planck_next-(next_node->THole::band_edge-transmit_energy)/temp_next)));
-					current+=ev_therm.richardson_const*(next_transmit_value+prev_transmit_value)/2.0*
-													   (-ev_therm.min_transmit_energy/25.0);
-					prev_transmit_value=next_transmit_value;
+				start_value=top_value-ev_therm.min_transmit_energy/25.0;
+				end_value=top_value-ev_therm.min_transmit_energy;
+
+				if (grid_effects & GRID_FERMI_DIRAC) {
+					prev_transmit_value=temp_prev*log_1_exp(planck_prev-ev_therm.barrier_prev)
+									   -temp_next*log_1_exp(planck_next-ev_therm.barrier_next);
+					for (transmit_energy=start_value; transmit_energy<=end_value;
+						 transmit_energy-=ev_therm.min_transmit_energy/25.0) {
+						next_transmit_value=comp_valence_transmission(transmit_energy)*
+										   (temp_prev*(log_1_exp(planck_prev-(prev_node->THole::band_edge-transmit_energy)/temp_prev))
+										   -temp_next*(log_1_exp(planck_next-(next_node->THole::band_edge-transmit_energy)/temp_next)));
+						current+=ev_therm.richardson_const*(next_transmit_value+prev_transmit_value)/2.0*
+														   (-ev_therm.min_transmit_energy/25.0);
+						prev_transmit_value=next_transmit_value;
+						tunnel_evaluations++;
+					}
+				}
+				else {
+					prev_transmit_value=temp_prev*exp(planck_prev-ev_therm.barrier_prev)
+									   -temp_next*exp(planck_next-ev_therm.barrier_next);
+					for (transmit_energy=start_value; transmit_energy<=end_value;
+						 transmit_energy-=ev_therm.min_transmit_energy/25.0) {
+						next_transmit_value=comp_valence_transmission(transmit_energy)*
+										   (temp_prev*(exp(planck_prev-(prev_node->THole::band_edge-transmit_energy)/temp_prev))
+										   -temp_next*(exp(planck_next-(next_node->THole::band_edge-transmit_energy)/temp_next)));
+						current+=ev_therm.richardson_const*(next_transmit_value+prev_transmit_value)/2.0*
+														   (-ev_therm.min_transmit_energy/25.0);
+						prev_transmit_value=next_transmit_value;
+						tunnel_evaluations++;
+					}
 				}
 			}
 		}
 	}
 	else {
-		p_next=next_node->THole::total_conc;
-		p_prev=prev_node->THole::total_conc;
+		dual_seed(p_next,next_node->THole::total_conc,DUAL_NEXT_ETA,next_node->THole::total_deriv_conc_eta_v);
+		dual_seed(p_prev,prev_node->THole::total_conc,DUAL_PREV_ETA,prev_node->THole::total_deriv_conc_eta_v);
+
+		dual_seed(bernoulli_param,ev.bernoulli_param,DUAL_PREV_PSI,1.0/ev.fermi_ratio_1_half_minus_1_half);
+		dual_add_partial(bernoulli_param,DUAL_NEXT_PSI,-1.0/ev.fermi_ratio_1_half_minus_1_half);
 
 		current=-hole_mobility_length*ev.fermi_ratio_1_half_minus_1_half*
-				 (p_next*temp_next*ev.bernoulli_grad_temp_next
-				 -p_prev*temp_prev*ev.bernoulli_grad_temp_prev);
+				 (p_next*temp_next*dual_compose(ev.bernoulli_grad_temp_next,ev.deriv_bern_grad_temp_next,
+												bernoulli_param/temp_next)
+				 -p_prev*temp_prev*dual_compose(ev.bernoulli_grad_temp_prev,ev.deriv_bern_grad_temp_prev,
+												-bernoulli_param/temp_prev));
 	}
 	return(current);
 }
 
-FundamentalParam TBulkElectricalElement::comp_deriv_hole_current(NodeSide node,
-																  int return_flag)
+prec TBulkElectricalElement::comp_electron_current(void)
 {
-	prec p_next, p_prev;
-	prec temp_next, temp_prev;
-	FundamentalParam return_value;
-	prec deriv_p_eta_v_next, deriv_p_eta_v_prev;
-	prec prev_transmit_value, next_transmit_value;
-	prec start_value, end_value;
-	prec transmit_energy;
-	prec planck_next,planck_prev;
-
-	temp_next=next_node->THole::temperature;
-	temp_prev=prev_node->THole::temperature;
-
-	return_value.psi=return_value.eta_c=return_value.eta_v=0.0;
-
-	if (hole_therm_emis_current) {
-
-		planck_next=next_node->THole::planck_potential;
-		planck_prev=prev_node->THole::planck_potential;
-
-		if (grid_effects & GRID_THERMIONIC) {
-			if (grid_effects & GRID_FERMI_DIRAC) {
-				switch(node) {
-					case PREVIOUS_NODE:
-						if (return_flag & D_PSI)
-							return_value.psi=0.5*ev_therm.richardson_const*
-												  (temp_prev*log_1_x(exp(planck_prev-ev_therm.barrier_prev))+
-												   temp_next*log_1_x(exp(planck_next-ev_therm.barrier_next)));
-
-						if (return_flag & D_ETA_V)
-							return_value.eta_v=ev_therm.richardson_const*sq(temp_prev)*
-												 log_1_x(exp(planck_prev-ev_therm.barrier_prev));
-
-						break;
-
-					case NEXT_NODE:
-						if (return_flag & D_PSI)
-							return_value.psi=-0.5*ev_therm.richardson_const*
-												  (temp_prev*log_1_x(exp(planck_prev-ev_therm.barrier_prev))+
-												   temp_next*log_1_x(exp(planck_next-ev_therm.barrier_next)));
-
-						if (return_flag & D_ETA_V)
-							return_value.eta_v=-ev_therm.richardson_const*sq(temp_next)*
-												 log_1_x(exp(planck_next-ev_therm.barrier_next));
-
-						break;
-				}
-			}
-			else {
-				switch(node) {
-					case PREVIOUS_NODE:
-						if (return_flag & D_PSI)
-							return_value.psi=0.5*ev_therm.richardson_const*
-												  (temp_prev*exp(planck_prev-ev_therm.barrier_prev)+
-												   temp_next*exp(planck_next-ev_therm.barrier_next));
-
-						if (return_flag & D_ETA_V)
-							return_value.eta_v=ev_therm.richardson_const*sq(temp_prev)*
-												 exp(planck_prev-ev_therm.barrier_prev);
-
-						break;
-
-					case NEXT_NODE:
-						if (return_flag & D_PSI)
-							return_value.psi=-0.5*ev_therm.richardson_const*
-												  (temp_prev*exp(planck_prev-ev_therm.barrier_prev)+
-												   temp_next*exp(planck_next-ev_therm.barrier_next));
-
-						if (return_flag & D_ETA_V)
-							return_value.eta_v=-ev_therm.richardson_const*sq(temp_next)*
-												 exp(planck_next-ev_therm.barrier_next);
-
-						break;
-				}
-			}
-		}
-
-		if ((grid_effects & GRID_TUNNELING) && ev_therm.min_transmit_energy) {
-			if (grid_effects & GRID_FERMI_DIRAC) {
-				switch(node) {
-					case PREVIOUS_NODE:
-						if (return_flag & D_ETA_V) {
-							prev_transmit_value=temp_prev/(1.0+exp(-planck_prev+ev_therm.barrier_prev));
-							start_value=prev_node->THole::band_edge-ev_therm.barrier_prev*temp_prev-ev_therm.min_transmit_energy/25.0;
-							end_value=prev_node->THole::band_edge-ev_therm.barrier_prev*temp_prev-ev_therm.min_transmit_energy;
-							for (transmit_energy=start_value; transmit_energy<=end_value;
-								 transmit_energy-=ev_therm.min_transmit_energy/25.0) {
-								next_transmit_value=comp_valence_transmission(transmit_energy)*
-													temp_prev/(1.0+exp(-planck_prev+(prev_node->THole::band_edge-transmit_energy)/temp_prev));
-								return_value.eta_v+=ev_therm.richardson_const*(next_transmit_value+prev_transmit_value)/2.0*
-																			  (-ev_therm.min_transmit_energy/25.0);
-								prev_transmit_value=next_transmit_value;
-							}
-						}
-						break;
-
-					case NEXT_NODE:
-						if (return_flag & D_ETA_V) {
-							prev_transmit_value=-temp_next/(1.0+exp(-planck_next+ev_therm.barrier_next));
-							start_value=prev_node->THole::band_edge-ev_therm.barrier_prev*temp_prev-ev_therm.min_transmit_energy/25.0;
-							end_value=prev_node->THole::band_edge-ev_therm.barrier_prev*temp_prev-ev_therm.min_transmit_energy;
-							for (transmit_energy=start_value; transmit_energy<=end_value;
-								 transmit_energy-=ev_therm.min_transmit_energy/25.0) {
-								next_transmit_value=comp_valence_transmission(transmit_energy)*
-													(-temp_next/(1.0+exp(-planck_next+(next_node->THole::band_edge-transmit_energy)/temp_next)));
-								return_value.eta_v+=ev_therm.richardson_const*(next_transmit_value+prev_transmit_value)/2.0*
-																			  (-ev_therm.min_transmit_energy/25.0);
-								prev_transmit_value=next_transmit_value;
-							}
-						}
-						break;
-				}
-			}
-			else {
-				switch(node) {
-					case PREVIOUS_NODE:
-						if (return_flag & D_ETA_V) {
-							prev_transmit_value=temp_prev*exp(planck_prev-ev_therm.barrier_prev);
-							start_value=prev_node->THole::band_edge-ev_therm.barrier_prev*temp_prev-ev_therm.min_transmit_energy/25.0;
-							end_value=prev_node->THole::band_edge-ev_therm.barrier_prev*temp_prev-ev_therm.min_transmit_energy;
-							for (transmit_energy=start_value; transmit_energy<=end_value;
-								 transmit_energy-=ev_therm.min_transmit_energy/25.0) {
-								next_transmit_value=comp_valence_transmission(transmit_energy)*
-													temp_prev*(exp(planck_prev-(prev_node->THole::band_edge-transmit_energy)/temp_prev));
-								return_value.eta_v+=ev_therm.richardson_const*(next_transmit_value+prev_transmit_value)/2.0*
-																			  (-ev_therm.min_transmit_energy/25.0);
-								prev_transmit_value=next_transmit_value;
-							}
-						}
-						break;
-
-					case NEXT_NODE:
-						if (return_flag & D_ETA_V) {
-							prev_transmit_value=-temp_next*exp(planck_next-ev_therm.barrier_next);
-							start_value=prev_node->THole::band_edge-ev_therm.barrier_prev*temp_prev-ev_therm.min_transmit_energy/25.0;
-							end_value=prev_node->THole::band_edge-ev_therm.barrier_prev*temp_prev-ev_therm.min_transmit_energy;
-							for (transmit_energy=start_value; transmit_energy<=end_value;
-								 transmit_energy-=ev_therm.min_transmit_energy/25.0) {
-								next_transmit_value=comp_valence_transmission(transmit_energy)*
-													(-temp_next*(exp(planck_next-(next_node->THole::band_edge-transmit_energy)/temp_next)));
-								return_value.eta_v+=ev_therm.richardson_const*(next_transmit_value+prev_transmit_value)/2.0*
-																			  (-ev_therm.min_transmit_energy/25.0);
-								prev_transmit_value=next_transmit_value;
-							}
-						}
-						break;
-				}
-			}
-		}
-	}
-	else {
-		p_next=next_node->THole::total_conc;
-		p_prev=prev_node->THole::total_conc;
-
-		deriv_p_eta_v_next=next_node->THole::total_deriv_conc_eta_v;
-		deriv_p_eta_v_prev=prev_node->THole::total_deriv_conc_eta_v;
-
-		switch(node) {
-			case PREVIOUS_NODE:
-				if (return_flag & D_PSI)
-					return_value.psi=-hole_mobility_length*
-									  (p_next*ev.deriv_bern_grad_temp_next
-									  +p_prev*ev.deriv_bern_grad_temp_prev);
-
-				if (return_flag & D_ETA_V)
-					return_value.eta_v=hole_mobility_length*ev.fermi_ratio_1_half_minus_1_half*
-									   deriv_p_eta_v_prev*temp_prev*ev.bernoulli_grad_temp_prev;
-
-				break;
-
-			case NEXT_NODE:
-				if (return_flag & D_PSI)
-					return_value.psi=hole_mobility_length*
-									 (p_next*ev.deriv_bern_grad_temp_next
-									 +p_prev*ev.deriv_bern_grad_temp_prev);
-
-				if (return_flag & D_ETA_V)
-					return_value.eta_v=-hole_mobility_length*ev.fermi_ratio_1_half_minus_1_half*
-										deriv_p_eta_v_next*temp_next*ev.bernoulli_grad_temp_next;
+	return(electron_current_kernel<prec>());
+}
 
-				break;
-		}
-	}
+prec TBulkElectricalElement::comp_hole_current(void)
+{
+	return(hole_current_kernel<prec>());
+}
 
-	return(return_value);
+void TBulkElectricalElement::comp_fused_current(void)
+{
+	electron_current_dual=electron_current_kernel<ElementDual>();
+	hole_current_dual=hole_current_kernel<ElementDual>();
 }
 
 prec TBulkElectricalElement::comp_integral_charge(ElementSide side)
@@ -841,14 +729,15 @@ private:
 	void comp_length_fraction(void);
 	void comp_cond_therm_emis_param(void);
 	void comp_val_therm_emis_param(void);
+	template <class T> T electron_current_kernel(void);
+	template <class T> T hole_current_kernel(void);
 
 public:
 	virtual prec comp_field(void);
 	virtual FundamentalParam comp_deriv_field(NodeSide node, int return_flag);
 	virtual prec comp_electron_current(void);
-	virtual FundamentalParam comp_deriv_electron_current(NodeSide node,int return_flag);
 	virtual prec comp_hole_current(void);
-	virtual FundamentalParam comp_deriv_hole_current(NodeSide node,int return_flag);
+	virtual void comp_fused_current(void);
 	virtual prec comp_integral_charge(ElementSide side);
 	virtual FundamentalParam comp_deriv_integral_charge(ElementSide side, NodeSide node,
 														int return_flag, SolveType solve);
@@ -1065,251 +954,101 @@ FundamentalParam TQWElectricalElement::comp_deriv_field(NodeSide node,int return
 	return(result);
 }
 
-prec TQWElectricalElement::comp_electron_current(void)
+template <class T> T TQWElectricalElement::electron_current_kernel(void)
 {
 	prec temp_next, temp_prev;
-	prec planck_next, planck_prev;
-	prec current;
+	prec fraction_next, fraction_prev;
+	T planck_next, planck_prev;
+	T barrier_next, barrier_prev;
+	T current;
 
 	temp_next=next_node->TElectron::temperature;
 	temp_prev=prev_node->TElectron::temperature;
 
-	planck_next=next_node->TElectron::planck_potential;
-	planck_prev=prev_node->TElectron::planck_potential;
+	dual_seed(planck_next,next_node->TElectron::planck_potential,DUAL_NEXT_ETA,1.0);
+	dual_seed(planck_prev,prev_node->TElectron::planck_potential,DUAL_PREV_ETA,1.0);
 
-	if (grid_effects & GRID_FERMI_DIRAC) {
-		current=+ec_therm.richardson_const*sq(temp_next)*(0.5*pow(log_1_x(exp(planck_next-ec_therm.barrier_next)),2.0)
-														  +dilog(1.0/(1.0+exp(ec_therm.barrier_next-planck_next))))
-				-ec_therm.richardson_const*sq(temp_prev)*(0.5*pow(log_1_x(exp(planck_prev-ec_therm.barrier_prev)),2.0)
-														  +dilog(1.0/(1.0+exp(ec_therm.barrier_prev-planck_prev))));
+	if (ec_therm.band_discont<0) {
+		fraction_prev=length_fraction;
+		fraction_next=1.0-length_fraction;
 	}
 	else {
-
-		current=+ec_therm.richardson_const*sq(temp_next)*exp(planck_next-ec_therm.barrier_next)
-				-ec_therm.richardson_const*sq(temp_prev)*exp(planck_prev-ec_therm.barrier_prev);
+		fraction_prev=1.0-length_fraction;
+		fraction_next=length_fraction;
 	}
 
-	return(current);
-}
-
-FundamentalParam TQWElectricalElement::comp_deriv_electron_current(NodeSide node,
-																	int return_flag)
-{
-	prec temp_next, temp_prev;
-	FundamentalParam return_value;
-	prec planck_next,planck_prev;
-
-	return_value.psi=return_value.eta_c=return_value.eta_v=0.0;
-
-	temp_next=next_node->TElectron::temperature;
-	temp_prev=prev_node->TElectron::temperature;
-
-	planck_next=next_node->TElectron::planck_potential;
-	planck_prev=prev_node->TElectron::planck_potential;
+	dual_seed(barrier_prev,ec_therm.barrier_prev,DUAL_PREV_PSI,fraction_prev/temp_prev);
+	dual_add_partial(barrier_prev,DUAL_NEXT_PSI,-fraction_prev/temp_prev);
+	dual_seed(barrier_next,ec_therm.barrier_next,DUAL_PREV_PSI,-fraction_next/temp_next);
+	dual_add_partial(barrier_next,DUAL_NEXT_PSI,fraction_next/temp_next);
 
 	if (grid_effects & GRID_FERMI_DIRAC) {
-		switch(node) {
-			case PREVIOUS_NODE:
-				if (return_flag & D_PSI) {
-					if (ec_therm.band_discont<0)
-						return_value.psi=ec_therm.richardson_const*
-										 (length_fraction*temp_prev*log_1_x(exp(planck_prev-ec_therm.barrier_prev))+
-										  (1.0-length_fraction)*temp_next*log_1_x(exp(planck_next-ec_therm.barrier_next)));
-					else
-						return_value.psi=ec_therm.richardson_const*
-										 ((1.0-length_fraction)*temp_prev*log_1_x(exp(planck_prev-ec_therm.barrier_prev))+
-										  length_fraction*temp_next*log_1_x(exp(planck_next-ec_therm.barrier_next)));
-				}
-
-				if (return_flag & D_ETA_C)
-					return_value.eta_c=-ec_therm.richardson_const*sq(temp_prev)*
-										log_1_x(exp(planck_prev-ec_therm.barrier_prev));
-
-				break;
-
-			case NEXT_NODE:
-				if (return_flag & D_PSI) {
-					if (ec_therm.band_discont<0)
-						return_value.psi=-ec_therm.richardson_const*
-										   (length_fraction*temp_prev*log_1_x(exp(planck_prev-ec_therm.barrier_prev))+
-											(1.0-length_fraction)*temp_next*log_1_x(exp(planck_next-ec_therm.barrier_next)));
-					else
-						return_value.psi=-ec_therm.richardson_const*
-										   ((1.0-length_fraction)*temp_prev*log_1_x(exp(planck_prev-ec_therm.barrier_prev))+
-											length_fraction*temp_next*log_1_x(exp(planck_next-ec_therm.barrier_next)));
-				}
-
-				if (return_flag & D_ETA_C)
-					return_value.eta_c=ec_therm.richardson_const*sq(temp_next)*
-									   log_1_x(exp(planck_next-ec_therm.barrier_next));
-
-				break;
-		}
+		current=+ec_therm.richardson_const*sq(temp_next)*fermi_emission(planck_next-barrier_next)
+				-ec_therm.richardson_const*sq(temp_prev)*fermi_emission(planck_prev-barrier_prev);
 	}
 	else {
-		switch(node) {
-			case PREVIOUS_NODE:
-				if (return_flag & D_PSI) {
-					if (ec_therm.band_discont<0)
-						return_value.psi=ec_therm.richardson_const*
-										 (length_fraction*temp_prev*exp(planck_prev-ec_therm.barrier_prev)+
-										  (1.0-length_fraction)*temp_next*exp(planck_next-ec_therm.barrier_next));
-					else
-						return_value.psi=ec_therm.richardson_const*
-										 ((1.0-length_fraction)*temp_prev*exp(planck_prev-ec_therm.barrier_prev)+
-										  length_fraction*temp_next*exp(planck_next-ec_therm.barrier_next));
-				}
-
-				if (return_flag & D_ETA_C)
-					return_value.eta_c=-ec_therm.richardson_const*sq(temp_prev)*
-										 exp(planck_prev-ec_therm.barrier_prev);
-
-				break;
 
-			case NEXT_NODE:
-				if (return_flag & D_PSI) {
-					if (ec_therm.band_discont<0)
-						return_value.psi=-ec_therm.richardson_const*
-										   (length_fraction*temp_prev*exp(planck_prev-ec_therm.barrier_prev)+
-											(1.0-length_fraction)*temp_next*exp(planck_next-ec_therm.barrier_next));
-					else
-						return_value.psi=-ec_therm.richardson_const*
-										   ((1.0-length_fraction)*temp_prev*exp(planck_prev-ec_therm.barrier_prev)+
-											length_fraction*temp_next*exp(planck_next-ec_therm.barrier_next));
-				}
-
-				if (return_flag & D_ETA_C)
-					return_value.eta_c=ec_therm.richardson_const*sq(temp_next)*
-									   exp(planck_next-ec_therm.barrier_next);
-
-				break;
-		}
+		current=+ec_therm.richardson_const*sq(temp_next)*exp(planck_next-barrier_next)
+				-ec_therm.richardson_const*sq(temp_prev)*exp(planck_prev-barrier_prev);
 	}
 
-	return(return_value);
+	return(current);
 }
 
-prec TQWElectricalElement::comp_hole_current(void)
+template <class T> T TQWElectricalElement::hole_current_kernel(void)
 {
 	prec temp_next, temp_prev;
-	prec planck_next, planck_prev;
-	prec current;
+	prec fraction_next, fraction_prev;
+	T planck_next, planck_prev;
+	T barrier_next, barrier_prev;
+	T current;
 
 	temp_next=next_node->THole::temperature;
 	temp_prev=prev_node->THole::temperature;
 
-	planck_next=next_node->THole::planck_potential;
-	planck_prev=prev_node->THole::planck_potential;
+	dual_seed(planck_next,next_node->THole::planck_potential,DUAL_NEXT_ETA,1.0);
+	dual_seed(planck_prev,prev_node->THole::planck_potential,DUAL_PREV_ETA,1.0);
 
-	if (grid_effects & GRID_FERMI_DIRAC) {
-		current=ev_therm.richardson_const*sq(temp_prev)*(0.5*pow(log_1_x(exp(planck_prev-ev_therm.barrier_prev)),2.0)
-														  +dilog(1.0/(1.0+exp(ev_therm.barrier_prev-planck_prev))))
-			   -ev_therm.richardson_const*sq(temp_next)*(0.5*pow(log_1_x(exp(planck_next-ev_therm.barrier_next)),2.0)
-														  +dilog(1.0/(1.0+exp(ev_therm.barrier_next-planck_next))));
+	if (ev_therm.band_discont<0) {
+		fraction_prev=1.0-length_fraction;
+		fraction_next=length_fraction;
 	}
 	else {
-		current=ev_therm.richardson_const*sq(temp_prev)*exp(planck_prev-ev_therm.barrier_prev)
-			   -ev_therm.richardson_const*sq(temp_next)*exp(planck_next-ev_therm.barrier_next);
+		fraction_prev=length_fraction;
+		fraction_next=1.0-length_fraction;
 	}
 
-	return(current);
-}
-
-FundamentalParam TQWElectricalElement::comp_deriv_hole_current(NodeSide node,
-																int return_flag)
-{
-	prec temp_next, temp_prev;
-	FundamentalParam return_value;
-	prec planck_next,planck_prev;
-
-	return_value.psi=return_value.eta_c=return_value.eta_v=0.0;
-
-	temp_next=next_node->THole::temperature;
-	temp_prev=prev_node->THole::temperature;
-
-	planck_next=next_node->THole::planck_potential;
-	planck_prev=prev_node->THole::planck_potential;
+	dual_seed(barrier_prev,ev_therm.barrier_prev,DUAL_PREV_PSI,-fraction_prev/temp_prev);
+	dual_add_partial(barrier_prev,DUAL_NEXT_PSI,fraction_prev/temp_prev);
+	dual_seed(barrier_next,ev_therm.barrier_next,DUAL_PREV_PSI,fraction_next/temp_next);
+	dual_add_partial(barrier_next,DUAL_NEXT_PSI,-fraction_next/temp_next);
 
 	if (grid_effects & GRID_FERMI_DIRAC) {
-		switch(node) {
-			case PREVIOUS_NODE:
-				if (return_flag & D_PSI) {
-					if (ev_therm.band_discont<0)
-						return_value.psi=ev_therm.richardson_const*
-										   ((1.0-length_fraction)*temp_prev*log_1_x(exp(planck_prev-ev_therm.barrier_prev))+
-											length_fraction*temp_next*log_1_x(exp(planck_next-ev_therm.barrier_next)));
-					else
-						return_value.psi=ev_therm.richardson_const*
-										   (length_fraction*temp_prev*log_1_x(exp(planck_prev-ev_therm.barrier_prev))+
-											(1.0-length_fraction)*temp_next*log_1_x(exp(planck_next-ev_therm.barrier_next)));
-				}
-
-				if (return_flag & D_ETA_V)
-					return_value.eta_v=ev_therm.richardson_const*sq(temp_prev)*
-									   log_1_x(exp(planck_prev-ev_therm.barrier_prev));
-
-				break;
-
-			case NEXT_NODE:
-				if (return_flag & D_PSI) {
-					if (ev_therm.band_discont<0)
-						return_value.psi=-ev_therm.richardson_const*
-											((1.0-length_fraction)*temp_prev*log_1_x(exp(planck_prev-ev_therm.barrier_prev))+
-											 length_fraction*temp_next*log_1_x(exp(planck_next-ev_therm.barrier_next)));
-					else
-						return_value.psi=-ev_therm.richardson_const*
-											(length_fraction*temp_prev*log_1_x(exp(planck_prev-ev_therm.barrier_prev))+
-											 (1.0-length_fraction)*temp_next*log_1_x(exp(planck_next-ev_therm.barrier_next)));
-				}
-
-				if (return_flag & D_ETA_V)
-					return_value.eta_v=-ev_therm.richardson_const*sq(temp_next)*
-										log_1_x(exp(planck_next-ev_therm.barrier_next));
-
-				break;
-		}
+		current=ev_therm.richardson_const*sq(temp_prev)*fermi_emission(planck_prev-barrier_prev)
+			   -ev_therm.richardson_const*sq(temp_next)*fermi_emission(planck_next-barrier_next);
 	}
 	else {
-		switch(node) {
-			case PREVIOUS_NODE:
-				if (return_flag & D_PSI) {
-					if (ev_therm.band_discont<0)
-						return_value.psi=ev_therm.richardson_const*
-										   ((1.0-length_fraction)*temp_prev*exp(planck_prev-ev_therm.barrier_prev)+
-											length_fraction*temp_next*exp(planck_next-ev_therm.barrier_next));
-					else
-						return_value.psi=ev_therm.richardson_const*
-										   (length_fraction*temp_prev*exp(planck_prev-ev_therm.barrier_prev)+
-											(1.0-length_fraction)*temp_next*exp(planck_next-ev_therm.barrier_next));
-				}
-
-				if (return_flag & D_ETA_V)
-					return_value.eta_v=ev_therm.richardson_const*sq(temp_prev)*
-										 exp(planck_prev-ev_therm.barrier_prev);
-
-				break;
+		current=ev_therm.richardson_const*sq(temp_prev)*exp(planck_prev-barrier_prev)
+			   -ev_therm.richardson_const*sq(temp_next)*exp(planck_next-barrier_next);
+	}
 
-			case NEXT_NODE:
-				if (return_flag & D_PSI) {
-					if (ev_therm.band_discont<0)
-						return_value.psi=-ev_therm.richardson_const*
-											((1.0-length_fraction)*temp_prev*exp(planck_prev-ev_therm.barrier_prev)+
-											 length_fraction*temp_next*exp(planck_next-ev_therm.barrier_next));
-					else
-						return_value.psi=-ev_therm.richardson_const*
-											(length_fraction*temp_prev*exp(planck_prev-ev_therm.barrier_prev)+
-											 (1.0-length_fraction)*temp_next*exp(planck_next-ev_therm.barrier_next));
-				}
+	return(current);
+}
 
-				if (return_flag & D_ETA_V)
-					return_value.eta_v=-ev_therm.richardson_const*sq(temp_next)*
-										 exp(planck_next-ev_therm.barrier_next);
+prec TQWElectricalElement::comp_electron_current(void)
+{
+	return(electron_current_kernel<prec>());
+}
 
-				break;
-		}
-	}
+prec TQWElectricalElement::comp_hole_current(void)
+{
+	return(hole_current_kernel<prec>());
+}
 
-	return(return_value);
+void TQWElectricalElement::comp_fused_current(void)
+{
+	electron_current_dual=electron_current_kernel<ElementDual>();
+	hole_current_dual=hole_current_kernel<ElementDual>();
 }
 
 prec TQWElectricalElement::comp_integral_charge(ElementSide side)
@@ -1846,14 +1585,15 @@ private:
 	void comp_conduction_richardson(void);
 	void comp_valence_discont(void);
 	void comp_valence_richardson(void);
+	template <class T> T electron_current_kernel(void);
+	template <class T> T hole_current_kernel(void);
 
 public:
 	virtual prec comp_field(void);
 	virtual FundamentalParam comp_deriv_field(NodeSide node, int return_flag);
 	virtual prec comp_electron_current(void);
-	virtual FundamentalParam comp_deriv_electron_current(NodeSide node,int return_flag);
 	virtual prec comp_hole_current(void);
-	virtual FundamentalParam comp_deriv_hole_current(NodeSide node,int return_flag);
+	virtual void comp_fused_current(void);
 	virtual prec comp_integral_charge(ElementSide side) { return(0.0); }
 	virtual FundamentalParam comp_deriv_integral_charge(ElementSide side, NodeSide node,
 														int return_flag, SolveType solve);
@@ -1926,8 +1666,8 @@ void TOhmicBoundaryElement::comp_conduction_richardson(void)
     if (next_node) mass=next_node->TElectron::dos_mass;
     else mass=prev_node->TElectron::dos_mass;
 
-	electron_richardson_const=(SIM_q*SIM_mo*mass*sq(SIM_k)/(2.0*sq(SIM_pi)*sq(SIM_hb)*SIM_hb*1e4))*sq(normalization.temp)
-							  /normalization.current;
+	electron_richardson_const=(SIM_q*SIM_mo*mass*sq(SIM_k)/(2.0*sq(SIM_pi)*sq(SIM_hb)*SIM_hb*1e4))*sq(context->normalization.temp)
+							  /context->normalization.current;
 }
 
 void TOhmicBoundaryElement::comp_valence_discont(void)
@@ -1953,8 +1693,8 @@ void TOhmicBoundaryElement::comp_valence_richardson(void)
 	if (next_node) mass=next_node->THole::dos_mass;
     else mass=prev_node->THole::dos_mass;
 
-	hole_richardson_const=(SIM_q*SIM_mo*mass*sq(SIM_k)/(2.0*sq(SIM_pi)*sq(SIM_hb)*SIM_hb*1e4))*sq(normalization.temp)
-							   /normalization.current;
+	hole_richardson_const=(SIM_q*SIM_mo*mass*sq(SIM_k)/(2.0*sq(SIM_pi)*sq(SIM_hb)*SIM_hb*1e4))*sq(context->normalization.temp)
+							   /context->normalization.current;
 }
 
 prec TOhmicBoundaryElement::comp_field(void)
@@ -1968,213 +1708,118 @@ FundamentalParam TOhmicBoundaryElement::comp_deriv_field(NodeSide /*node*/, int
 	return(result);
 }
 
-prec TOhmicBoundaryElement::comp_electron_current(void)
+template <class T> T TOhmicBoundaryElement::electron_current_kernel(void)
 {
-	prec current;
-    prec planck_prev, planck_next;
-    prec temp;
+	T current;
+	T n_prev, n_next;
+	T planck_prev, planck_next;
+	prec temp;
 
 	if (prev_node) {
-    	if (contact_flags & CONTACT_FINITERECOMB)
-	    	current=-electron_recomb_vel*(prev_node->TElectron::total_conc-equil_electron_conc);
-    	else {
-			planck_prev=prev_node->TElectron::planck_potential;
-            temp=prev_node->TElectron::temperature;
+		if (contact_flags & CONTACT_FINITERECOMB) {
+			dual_seed(n_prev,prev_node->TElectron::total_conc,DUAL_PREV_ETA,prev_node->TElectron::total_deriv_conc_eta_c);
+			current=-electron_recomb_vel*(n_prev-equil_electron_conc);
+		}
+		else {
+			dual_seed(planck_prev,prev_node->TElectron::planck_potential,DUAL_PREV_ETA,1.0);
+			temp=prev_node->TElectron::temperature;
 
 			if (grid_effects & GRID_FERMI_DIRAC) {
-				current=-electron_richardson_const*sq(temp)*(0.5*pow(log_1_x(exp(planck_prev)),2.0)
-																		   +dilog(1.0/(1.0+exp(-planck_prev))))
-						+electron_richardson_const*sq(temp)*(0.5*pow(log_1_x(exp(-electron_barrier)),2.0)
-																		   +dilog(1.0/(1.0+exp(electron_barrier))));
+				current=-electron_richardson_const*sq(temp)*fermi_emission(planck_prev)
+						+electron_richardson_const*sq(temp)*fermi_emission(-electron_barrier);
 			}
 			else {
 				current=-electron_richardson_const*sq(temp)*exp(planck_prev)
 						+electron_richardson_const*sq(temp)*exp(-electron_barrier);
 			}
-        }
-    }
-    else {
-    	if (contact_flags & CONTACT_FINITERECOMB)
-		   	current=electron_recomb_vel*(next_node->TElectron::total_conc-equil_electron_conc);
+		}
+	}
+	else {
+		if (contact_flags & CONTACT_FINITERECOMB) {
+			dual_seed(n_next,next_node->TElectron::total_conc,DUAL_NEXT_ETA,next_node->TElectron::total_deriv_conc_eta_c);
+			current=electron_recomb_vel*(n_next-equil_electron_conc);
+		}
 		else {
-			planck_next=next_node->TElectron::planck_potential;
-            temp=next_node->TElectron::temperature;
+			dual_seed(planck_next,next_node->TElectron::planck_potential,DUAL_NEXT_ETA,1.0);
+			temp=next_node->TElectron::temperature;
 
 			if (grid_effects & GRID_FERMI_DIRAC) {
-				current=-electron_richardson_const*sq(temp)*(0.5*pow(log_1_x(exp(-electron_barrier)),2.0)
-																		   +dilog(1.0/(1.0+exp(electron_barrier))))
-						+electron_richardson_const*sq(temp)*(0.5*pow(log_1_x(exp(planck_next)),2.0)
-																		   +dilog(1.0/(1.0+exp(-planck_next))));
+				current=-electron_richardson_const*sq(temp)*fermi_emission(-electron_barrier)
+						+electron_richardson_const*sq(temp)*fermi_emission(planck_next);
 			}
 			else {
 				current=-electron_richardson_const*sq(temp)*exp(-electron_barrier)
 						+electron_richardson_const*sq(temp)*exp(planck_next);
 			}
-        }
-    }
-
-    return(current);
-}
-
-FundamentalParam TOhmicBoundaryElement::comp_deriv_electron_current(NodeSide node,
-																	int return_flag)
-{
-	FundamentalParam return_value;
-    prec planck_prev, planck_next;
-    prec temp;
-
-	return_value.psi=return_value.eta_c=return_value.eta_v=0.0;
-
-    if (prev_node && (node==PREVIOUS_NODE)) {
-    	if (contact_flags & CONTACT_FINITERECOMB) {
-        	if (return_flag & D_ETA_C)
-            	return_value.eta_c=-electron_recomb_vel*prev_node->TElectron::total_deriv_conc_eta_c;
-        }
-        else {
-			planck_prev=prev_node->TElectron::planck_potential;
-            temp=prev_node->TElectron::temperature;
-
-        	if (grid_effects & GRID_FERMI_DIRAC) {
-	            if (return_flag & D_ETA_C)
-    	        	return_value.eta_c=-electron_richardson_const*sq(temp)*
-        	        						log_1_x(exp(planck_prev));
-            }
-            else {
-                if (return_flag & D_ETA_C)
-                	return_value.eta_c=-electron_richardson_const*sq(temp)*
-                    						exp(planck_prev);
-
-            }
-        }
-    }
-
-    if (next_node && (node==NEXT_NODE)) {
-    	if (contact_flags & CONTACT_FINITERECOMB) {
-			if (return_flag & D_ETA_C)
-				return_value.eta_c=electron_recomb_vel*next_node->TElectron::total_deriv_conc_eta_c;
-        }
-        else {
-			planck_next=next_node->TElectron::planck_potential;
-            temp=next_node->TElectron::temperature;
-
-			if (grid_effects & GRID_FERMI_DIRAC) {
-                if (return_flag & D_ETA_C)
-            		return_value.eta_c=electron_richardson_const*sq(temp)*
-                    						log_1_x(exp(planck_next));
-            }
-            else {
-                if (return_flag & D_ETA_C)
-            		return_value.eta_c=electron_richardson_const*sq(temp)*
-                    						exp(planck_next);
-            }
-        }
-    }
+		}
+	}
 
-	return(return_value);
+	return(current);
 }
 
-prec TOhmicBoundaryElement::comp_hole_current(void)
+template <class T> T TOhmicBoundaryElement::hole_current_kernel(void)
 {
-	prec current;
-    prec planck_prev, planck_next;
-    prec temp;
+	T current;
+	T p_prev, p_next;
+	T planck_prev, planck_next;
+	prec temp;
 
 	if (prev_node) {
-    	if (contact_flags & CONTACT_FINITERECOMB)
-			current=hole_recomb_vel*(prev_node->THole::total_conc-equil_hole_conc);
-    	else {
-			planck_prev=prev_node->THole::planck_potential;
-            temp=prev_node->THole::temperature;
+		if (contact_flags & CONTACT_FINITERECOMB) {
+			dual_seed(p_prev,prev_node->THole::total_conc,DUAL_PREV_ETA,prev_node->THole::total_deriv_conc_eta_v);
+			current=hole_recomb_vel*(p_prev-equil_hole_conc);
+		}
+		else {
+			dual_seed(planck_prev,prev_node->THole::planck_potential,DUAL_PREV_ETA,1.0);
+			temp=prev_node->THole::temperature;
 
 			if (grid_effects & GRID_FERMI_DIRAC) {
-				current=hole_richardson_const*sq(temp)*(0.5*pow(log_1_x(exp(planck_prev)),2.0)
-																  +dilog(1.0/(1.0+exp(-planck_prev))))
-					   -hole_richardson_const*sq(temp)*(0.5*pow(log_1_x(exp(-hole_barrier)),2.0)
-																  +dilog(1.0/(1.0+exp(hole_barrier))));
+				current=hole_richardson_const*sq(temp)*fermi_emission(planck_prev)
+					   -hole_richardson_const*sq(temp)*fermi_emission(-hole_barrier);
 			}
 			else {
 				current=hole_richardson_const*sq(temp)*exp(planck_prev)
 					   -hole_richardson_const*sq(temp)*exp(-hole_barrier);
 			}
-        }
-    }
-    else {
-    	if (contact_flags & CONTACT_FINITERECOMB)
-			current=-hole_recomb_vel*(next_node->THole::total_conc-equil_hole_conc);
+		}
+	}
+	else {
+		if (contact_flags & CONTACT_FINITERECOMB) {
+			dual_seed(p_next,next_node->THole::total_conc,DUAL_NEXT_ETA,next_node->THole::total_deriv_conc_eta_v);
+			current=-hole_recomb_vel*(p_next-equil_hole_conc);
+		}
 		else {
-			planck_next=next_node->THole::planck_potential;
-            temp=next_node->THole::temperature;
+			dual_seed(planck_next,next_node->THole::planck_potential,DUAL_NEXT_ETA,1.0);
+			temp=next_node->THole::temperature;
 
 			if (grid_effects & GRID_FERMI_DIRAC) {
-				current=hole_richardson_const*sq(temp)*(0.5*pow(log_1_x(exp(-hole_barrier)),2.0)
-																  +dilog(1.0/(1.0+exp(hole_barrier))))
-					   -hole_richardson_const*sq(temp)*(0.5*pow(log_1_x(exp(planck_next)),2.0)
-																  +dilog(1.0/(1.0+exp(-planck_next))));
+				current=hole_richardson_const*sq(temp)*fermi_emission(-hole_barrier)
+					   -hole_richardson_const*sq(temp)*fermi_emission(planck_next);
 			}
 			else {
 				current=hole_richardson_const*sq(temp)*exp(-hole_barrier)
 					   -hole_richardson_const*sq(temp)*exp(planck_next);
 			}
-        }
-    }
+		}
+	}
 
-    return(current);
+	return(current);
 }
 
-FundamentalParam TOhmicBoundaryElement::comp_deriv_hole_current(NodeSide node,
-																int return_flag)
+prec TOhmicBoundaryElement::comp_electron_current(void)
 {
-	FundamentalParam return_value;
-    prec planck_prev, planck_next;
-    prec temp;
-
-	return_value.psi=return_value.eta_c=return_value.eta_v=0.0;
-
-    if (prev_node && (node==PREVIOUS_NODE)) {
-    	if (contact_flags & CONTACT_FINITERECOMB) {
-        	if (return_flag & D_ETA_V)
-				return_value.eta_v=hole_recomb_vel*prev_node->THole::total_deriv_conc_eta_v;
-        }
-        else {
-			planck_prev=prev_node->THole::planck_potential;
-            temp=prev_node->THole::temperature;
-
-			if (grid_effects & GRID_FERMI_DIRAC) {
-                if (return_flag & D_ETA_V)
-                	return_value.eta_v=hole_richardson_const*sq(temp)*
-                    					log_1_x(exp(planck_prev));
-            }
-            else {
-                if (return_flag & D_ETA_V)
-                	return_value.eta_v=hole_richardson_const*sq(temp)*
-                    					exp(planck_prev);
-            }
-        }
-    }
+	return(electron_current_kernel<prec>());
+}
 
-    if (next_node && (node==NEXT_NODE)) {
-    	if (contact_flags & CONTACT_FINITERECOMB) {
-			if (return_flag & D_ETA_V)
-				return_value.eta_v=-hole_recomb_vel*next_node->THole::total_deriv_conc_eta_v;
-        }
-        else {
-			planck_next=next_node->THole::planck_potential;
-            temp=next_node->THole::temperature;
-
-            if (grid_effects & GRID_FERMI_DIRAC) {
-                if (return_flag & D_ETA_V)
-                	return_value.eta_v=-hole_richardson_const*sq(temp)*
-                    						log_1_x(exp(planck_next));
-        	}
-            else {
-                if (return_flag & D_ETA_V)
-                	return_value.eta_v=-hole_richardson_const*sq(temp)*
-                    						exp(planck_next);
-            }
-        }
-    }
+prec TOhmicBoundaryElement::comp_hole_current(void)
+{
+	return(hole_current_kernel<prec>());
+}
 
-	return(return_value);
+void TOhmicBoundaryElement::comp_fused_current(void)
+{
+	electron_current_dual=electron_current_kernel<ElementDual>();
+	hole_current_dual=hole_current_kernel<ElementDual>();
 }
 
 FundamentalParam TOhmicBoundaryElement::comp_deriv_integral_charge(ElementSide /*side*/,
@@ -2194,3 +1839,146 @@ FundamentalParam TOhmicBoundaryElement::comp_deriv_integral_recomb(ElementSide /
 	return(result);
 }
 
+
+/*
+	Type batched evaluation of the electrical elements. TSolution keeps the elements in runs
+	of one concrete type, see TSolution::establish_elements(), and each run is handed to a
+	kernel instantiated for that type. The kernels call the element functions with a
+	qualified name, so the calls are direct and can be inlined instead of going through the
+	virtual table for every element. Only the elements first to last are evaluated and
+	values and derivatives are indexed by element number.
+
+	The elements count their tunneling transmission evaluations themselves, so the elements
+	of separate blocks can be evaluated on separate threads. comp_range_values() returns the
+	count of the elements it evaluated.
+*/
+template <class E> static long comp_typed_values(TElectricalElement **element_ptr, int count,
+												 ElementValues *values, SolveType solve,
+												 logical fused_current)
+{
+	int i;
+	E *element;
+	long evaluations=0;
+
+	for (i=0;i<count;i++) {
+		element=(E *)element_ptr[i];
+
+		values[i].field=element->E::comp_field();
+		values[i].integral_charge_first=element->E::comp_integral_charge(FIRSTHALF);
+		values[i].integral_charge_second=element->E::comp_integral_charge(SECONDHALF);
+
+		if (solve==STEADY_STATE) {
+			if (fused_current) {
+				element->E::comp_fused_current();
+				values[i].electron_current=element->get_electron_current();
+				values[i].hole_current=element->get_hole_current();
+			}
+			else {
+				values[i].electron_current=element->E::comp_electron_current();
+				values[i].hole_current=element->E::comp_hole_current();
+			}
+			values[i].integral_recomb_first=element->E::comp_integral_recomb(FIRSTHALF);
+			values[i].integral_recomb_second=element->E::comp_integral_recomb(SECONDHALF);
+		}
+		evaluations+=element->take_tunnel_evaluations();
+	}
+	return(evaluations);
+}
+
+template <class E> static void comp_typed_derivatives(TElectricalElement **element_ptr, int count,
+													  ElementDerivatives *derivatives,
+													  int return_flag, SolveType solve)
+{
+	int i;
+	E *element;
+
+	for (i=0;i<count;i++) {
+		element=(E *)element_ptr[i];
+
+		derivatives[i].field_prev=element->E::comp_deriv_field(PREVIOUS_NODE,return_flag);
+		derivatives[i].field_next=element->E::comp_deriv_field(NEXT_NODE,return_flag);
+		derivatives[i].integral_charge_first_prev=
+			element->E::comp_deriv_integral_charge(FIRSTHALF,PREVIOUS_NODE,return_flag,solve);
+		derivatives[i].integral_charge_first_next=
+			element->E::comp_deriv_integral_charge(FIRSTHALF,NEXT_NODE,return_flag,solve);
+		derivatives[i].integral_charge_second_prev=
+			element->E::comp_deriv_integral_charge(SECONDHALF,PREVIOUS_NODE,return_flag,solve);
+		derivatives[i].integral_charge_second_next=
+			element->E::comp_deriv_integral_charge(SECONDHALF,NEXT_NODE,return_flag,solve);
+
+		if (solve==STEADY_STATE) {
+			derivatives[i].integral_recomb_first_prev=
+				element->E::comp_deriv_integral_recomb(FIRSTHALF,PREVIOUS_NODE,return_flag);
+			derivatives[i].integral_recomb_first_next=
+				element->E::comp_deriv_integral_recomb(FIRSTHALF,NEXT_NODE,return_flag);
+			derivatives[i].integral_recomb_second_prev=
+				element->E::comp_deriv_integral_recomb(SECONDHALF,PREVIOUS_NODE,return_flag);
+			derivatives[i].integral_recomb_second_next=
+				element->E::comp_deriv_integral_recomb(SECONDHALF,NEXT_NODE,return_flag);
+		}
+	}
+}
+
+long TElectricalElement::comp_range_values(TElectricalElement **element_ptr, ElementRange *range, int ranges,
+										   int first, int last, ElementValues *values,
+										   SolveType solve, logical fused_current)
+{
+	int i, start, end;
+	long evaluations=0;
+
+	for (i=0;i<ranges;i++) {
+		start=range[i].start;
+		end=range[i].start+range[i].count-1;
+		if (start<first) start=first;
+		if (end>last) end=last;
+		if (start>end) continue;
+
+		switch(range[i].type) {
+			case BULK:
+				evaluations+=comp_typed_values<TBulkElectricalElement>(element_ptr+start,end-start+1,
+																	   values+start,solve,fused_current);
+				break;
+			case QW:
+				evaluations+=comp_typed_values<TQWElectricalElement>(element_ptr+start,end-start+1,
+																	 values+start,solve,fused_current);
+				break;
+			case BOUNDARY:
+				evaluations+=comp_typed_values<TOhmicBoundaryElement>(element_ptr+start,end-start+1,
+																	  values+start,solve,fused_current);
+				break;
+			default: assert(FALSE); break;
+		}
+	}
+	return(evaluations);
+}
+
+void TElectricalElement::comp_range_derivatives(TElectricalElement **element_ptr, ElementRange *range, int ranges,
+												int first, int last, ElementDerivatives *derivatives,
+												int return_flag, SolveType solve)
+{
+	int i, start, end;
+
+	for (i=0;i<ranges;i++) {
+		start=range[i].start;
+		end=range[i].start+range[i].count-1;
+		if (start<first) start=first;
+		if (end>last) end=last;
+		if (start>end) continue;
+
+		switch(range[i].type) {
+			case BULK:
+				comp_typed_derivatives<TBulkElectricalElement>(element_ptr+start,end-start+1,
+															   derivatives+start,return_flag,solve);
+				break;
+			case QW:
+				comp_typed_derivatives<TQWElectricalElement>(element_ptr+start,end-start+1,
+															 derivatives+start,return_flag,solve);
+				break;
+			case BOUNDARY:
+				comp_typed_derivatives<TOhmicBoundaryElement>(element_ptr+start,end-start+1,
+															  derivatives+start,return_flag,solve);
+				break;
+			default: assert(FALSE); break;
+		}
+	}
+}
@@ -30,6 +30,7 @@
 class TElement {
 protected:
 	TDevice *device_ptr;
+	TSimulationContext *context;
 	RegionType type;
 	flag grid_effects;
 	flag device_effects;
@@ -38,6 +39,7 @@ protected:
 
 public:
 	TElement(RegionType region_type, TDevice *device, TNode* node_1, TNode* node_2);
+	RegionType get_region_type(void) { return(type); }
 	void get_effects(void);
 };
 */
@@ -45,6 +47,7 @@ public:
 TElement::TElement(RegionType region_type,TDevice *device, TNode* node_1, TNode* node_2)
 {
 	device_ptr=device;
+	context=device->get_context();
 	prev_node=node_1;
 	next_node=node_2;
 
@@ -68,6 +71,7 @@ void TElement::get_effects(void)
 class TElectricalServices {
 protected:
 	TDevice *device_ptr;
+	TSimulationContext *context;
 	TNode** grid_ptr;
 	TNode* prev_node;
 	TNode* next_node;
@@ -84,8 +88,11 @@ protected:
 	ElecDriftDiffParam ev;
 	ThermEmisParam ec_therm;
 	ThermEmisParam ev_therm;
+	TransmitCache ec_transmit;
+	TransmitCache ev_transmit;
 public:
 	TElectricalServices(TDevice* device, TNode** grid, TNode* node_1, TNode* node_2);
+	~TElectricalServices(void);
 
 	void comp_length(void);
 	void comp_elec_mobil_length(void);
@@ -102,20 +109,49 @@ public:
 	void comp_valence_discont(void);
 	void comp_valence_richardson(void);
 	prec comp_valence_transmission(prec energy);
+	void comp_conduction_transmit_cache(void);
+	void comp_valence_transmit_cache(void);
 	void comp_cond_drift_diff_param(flag grid_effects);
 	void comp_val_drift_diff_param(flag grid_effects);
 	void comp_cond_therm_emis_param(flag grid_effects);
 	void comp_val_therm_emis_param(flag grid_effects);
+	void get_bernoulli_arguments(prec *argument);
+	void put_bernoulli_values(const prec *bern_pos, const prec *bern_neg,
+							  const prec *deriv_pos, const prec *deriv_neg);
+	void comp_drift_diff_bernoulli(void);
+
+private:
+	void allocate_transmit_cache(TransmitCache& cache, int size);
+	void comp_transmit_min_band_edge(TransmitCache& cache);
+	prec comp_transmit_integral(TransmitCache& cache, prec energy);
 };
 */
 
 TElectricalServices::TElectricalServices(TDevice* device, TNode** grid, TNode* node_1, TNode* node_2)
 {
 	device_ptr=device;
+	context=device->get_context();
 	grid_ptr=grid;
 	prev_node=node_1;
 	next_node=node_2;
 	comp_length();
+
+	ec_transmit.size=ec_transmit.allocated=0;
+	ec_transmit.step=ec_transmit.band_edge=ec_transmit.mass=ec_transmit.min_band_edge=(prec *)0;
+	ev_transmit.size=ev_transmit.allocated=0;
+	ev_transmit.step=ev_transmit.band_edge=ev_transmit.mass=ev_transmit.min_band_edge=(prec *)0;
+}
+
+TElectricalServices::~TElectricalServices(void)
+{
+	delete[] ec_transmit.step;
+	delete[] ec_transmit.band_edge;
+	delete[] ec_transmit.mass;
+	delete[] ec_transmit.min_band_edge;
+	delete[] ev_transmit.step;
+	delete[] ev_transmit.band_edge;
+	delete[] ev_transmit.mass;
+	delete[] ev_transmit.min_band_edge;
 }
 
 void TElectricalServices::comp_length(void)
@@ -137,6 +173,7 @@ void TElectricalServices::comp_hole_mobil_length(void)
 
 void TElectricalServices::comp_elec_scat_length(void)
 {
+	NormalizeConstants& normalization=context->normalization;
 	prec temp,mass;
 
 	temp=(next_node->TElectron::temperature+prev_node->TElectron::temperature)*normalization.temp/2.0;
@@ -150,6 +187,7 @@ void TElectricalServices::comp_elec_scat_length(void)
 
 void TElectricalServices::comp_hole_scat_length(void)
 {
+	NormalizeConstants& normalization=context->normalization;
 	prec temp,mass;
 
 	temp=(next_node->THole::temperature+prev_node->THole::temperature)*normalization.temp/2.0;
@@ -164,10 +202,10 @@ void TElectricalServices::comp_hole_scat_length(void)
 void TElectricalServices::comp_elec_transmit_max_node(void)
 {
 	if (ec_therm.band_discont>0) elec_transmit_max_node=device_ptr->get_node(prev_node->position-0.02/
-																			 get_normalize_value(GRID_ELECTRICAL,POSITION),
+																			 get_normalize_value(context,GRID_ELECTRICAL,POSITION),
 																			 -1,-1,NORMALIZED);
 	else elec_transmit_max_node=device_ptr->get_node(prev_node->position+0.02/
-													 get_normalize_value(GRID_ELECTRICAL,POSITION),
+													 get_normalize_value(context,GRID_ELECTRICAL,POSITION),
 													 -1,-1,NORMALIZED);
 
 }
@@ -175,10 +213,10 @@ void TElectricalServices::comp_elec_transmit_max_node(void)
 void TElectricalServices::comp_hole_transmit_max_node(void)
 {
 	if (ev_therm.band_discont>0) hole_transmit_max_node=device_ptr->get_node(prev_node->position+0.02/
-																			 get_normalize_value(GRID_ELECTRICAL,POSITION),
+																			 get_normalize_value(context,GRID_ELECTRICAL,POSITION),
 																			 -1,-1,NORMALIZED);
 	else hole_transmit_max_node=device_ptr->get_node(prev_node->position-0.02/
-													 get_normalize_value(GRID_ELECTRICAL,POSITION),
+													 get_normalize_value(context,GRID_ELECTRICAL,POSITION),
 													 -1,-1,NORMALIZED);
 
 }
@@ -266,64 +304,136 @@ void TElectricalServices::comp_conduction_richardson(void)
 	if (mass_next<mass_prev) light_mass=(prec) mass_next;
 	else light_mass=(prec)mass_prev;
 
-	ec_therm.richardson_const=(SIM_q*SIM_mo*light_mass*sq(SIM_k)/(2.0*sq(SIM_pi)*sq(SIM_hb)*SIM_hb*1e4))*sq(normalization.temp)
-							  /normalization.current;
+	ec_therm.richardson_const=(SIM_q*SIM_mo*light_mass*sq(SIM_k)/(2.0*sq(SIM_pi)*sq(SIM_hb)*SIM_hb*1e4))*sq(context->normalization.temp)
+							  /context->normalization.current;
 }
 
-prec TElectricalServices::comp_conduction_transmission(prec energy)
+/*
+	Tunneling profile of an element, built once per update of the dependent parameters so
+	the transmission at each energy of the current integral does not walk the grid again.
+	Point 0 is the top of the barrier at the middle of the element, points 1 to size-2 are
+	the nodes up to the transmission limit and point size-1 is the node just past it. step[i]
+	is the distance from point i-1 to point i and min_band_edge[i] is the lowest band edge of
+	points 1 to i, so the classical turning point of an energy is found by bisection. For
+	holes the band edges are stored with the opposite sign, so both carriers see a barrier
+	above the energy.
+*/
+void TElectricalServices::allocate_transmit_cache(TransmitCache& cache, int size)
 {
-	TNode** temp_ptr;
+	if (size>cache.allocated) {
+		delete[] cache.step;
+		delete[] cache.band_edge;
+		delete[] cache.mass;
+		delete[] cache.min_band_edge;
+		cache.step=new prec[size];
+		cache.band_edge=new prec[size];
+		cache.mass=new prec[size];
+		cache.min_band_edge=new prec[size];
+		cache.allocated=size;
+	}
+	cache.size=size;
+}
+
+void TElectricalServices::comp_transmit_min_band_edge(TransmitCache& cache)
+{
+	int i;
+
+	cache.min_band_edge[1]=cache.band_edge[1];
+	for (i=2;i<cache.size-1;i++) {
+		if (cache.band_edge[i]<cache.min_band_edge[i-1]) cache.min_band_edge[i]=cache.band_edge[i];
+		else cache.min_band_edge[i]=cache.min_band_edge[i-1];
+	}
+}
+
+/*
+	Trapezoid integral of sqrt(mass*(band edge-energy)) from the middle of the element to the
+	classical turning point, with the last partial interval interpolated linearly.
+*/
+prec TElectricalServices::comp_transmit_integral(TransmitCache& cache, prec energy)
+{
+	int i,low,high,middle;
 	prec prev_k_value,next_k_value;
-	prec prev_position,next_position;
-	prec prev_band_edge, next_band_edge;
 	prec integral=0;
-	prec result;
 
-	if (elec_transmit_max_node<=prev_node->node_number) {
-		prev_position=(prev_node->position+next_node->position)/2.0;
-		prev_band_edge=prev_node->TElectron::band_edge+ec_therm.barrier_prev*prev_node->TElectron::stored_temperature;
-		prev_k_value=sqrt(prev_node->TElectron::dos_mass*(prev_band_edge-energy));
-		temp_ptr=grid_ptr+prev_node->node_number;
-		while (((*temp_ptr)->TElectron::band_edge>=energy) && ((*temp_ptr)->node_number>=elec_transmit_max_node)) {
-			next_position=(*temp_ptr)->position;
-			next_band_edge=(*temp_ptr)->TElectron::band_edge;
-			next_k_value=sqrt((*temp_ptr)->TElectron::dos_mass*(next_band_edge-energy));
-			integral+=(next_k_value+prev_k_value)*(prev_position-next_position)/2.0;
-			prev_band_edge=next_band_edge;
-			prev_position=next_position;
-			prev_k_value=next_k_value;
-			temp_ptr--;
-		}
+// First point below the energy, or the point past the limit if there is none
+	low=1;
+	high=cache.size-1;
+	while (low<high) {
+		middle=(low+high)/2;
+		if (cache.min_band_edge[middle]<energy) high=middle;
+		else low=middle+1;
+	}
 
-		if ((*temp_ptr)->TElectron::band_edge<energy)
-			integral+=0.5*prev_k_value*(prev_band_edge-energy)/(prev_band_edge-(*temp_ptr)->TElectron::band_edge)*
-					  (prev_position-(*temp_ptr)->position);
+	prev_k_value=sqrt(cache.mass[0]*(cache.band_edge[0]-energy));
+	for (i=1;i<high;i++) {
+		next_k_value=sqrt(cache.mass[i]*(cache.band_edge[i]-energy));
+		integral+=(next_k_value+prev_k_value)*cache.step[i]/2.0;
+		prev_k_value=next_k_value;
+	}
+
+	if (cache.band_edge[high]<energy)
+		integral+=0.5*prev_k_value*(cache.band_edge[high-1]-energy)/(cache.band_edge[high-1]-cache.band_edge[high])*
+				  cache.step[high];
 
+	return(integral);
+}
+
+void TElectricalServices::comp_conduction_transmit_cache(void)
+{
+	int i, number_nodes, direction, last_node;
+	TNode** temp_ptr;
+	prec prev_position;
+
+	if (elec_transmit_max_node<=prev_node->node_number) {
+		number_nodes=prev_node->node_number-elec_transmit_max_node+1;
+		direction=-1;
+		temp_ptr=grid_ptr+prev_node->node_number;
+		allocate_transmit_cache(ec_transmit,number_nodes+2);
+		ec_transmit.mass[0]=prev_node->TElectron::dos_mass;
 	}
 	else {
-		prev_position=(prev_node->position+next_node->position)/2.0;
-		prev_band_edge=prev_node->TElectron::band_edge+ec_therm.barrier_prev*prev_node->TElectron::stored_temperature;
-		prev_k_value=sqrt(next_node->TElectron::dos_mass*(prev_band_edge-energy));
+		number_nodes=elec_transmit_max_node-next_node->node_number+1;
+		direction=1;
 		temp_ptr=grid_ptr+next_node->node_number;
-		while (((*temp_ptr)->TElectron::band_edge>=energy) && ((*temp_ptr)->node_number<=elec_transmit_max_node)) {
-			next_position=(*temp_ptr)->position;
-			next_band_edge=(*temp_ptr)->TElectron::band_edge;
-			next_k_value=sqrt((*temp_ptr)->TElectron::dos_mass*(next_band_edge-energy));
-			integral+=(next_k_value+prev_k_value)*(next_position-prev_position)/2.0;
-			prev_position=next_position;
-			prev_band_edge=next_band_edge;
-			prev_k_value=next_k_value;
-			temp_ptr++;
-		}
+		allocate_transmit_cache(ec_transmit,number_nodes+2);
+		ec_transmit.mass[0]=next_node->TElectron::dos_mass;
+	}
 
-		if ((*temp_ptr)->TElectron::band_edge<energy)
-			integral+=0.5*prev_k_value*(prev_band_edge-energy)/(prev_band_edge-(*temp_ptr)->TElectron::band_edge)*
-					  ((*temp_ptr)->position-prev_position);
+	ec_transmit.band_edge[0]=prev_node->TElectron::band_edge+ec_therm.barrier_prev*prev_node->TElectron::stored_temperature;
+	ec_transmit.step[0]=0.0;
+	prev_position=(prev_node->position+next_node->position)/2.0;
+
+	last_node=number_nodes;
+	if ((elec_transmit_max_node+direction>=0) &&
+		(elec_transmit_max_node+direction<device_ptr->get_number_objects(NODE))) last_node++;
+
+	for (i=1;i<=last_node;i++) {
+		ec_transmit.band_edge[i]=(*temp_ptr)->TElectron::band_edge;
+		ec_transmit.mass[i]=(*temp_ptr)->TElectron::dos_mass;
+		if (direction<0) ec_transmit.step[i]=prev_position-(*temp_ptr)->position;
+		else ec_transmit.step[i]=(*temp_ptr)->position-prev_position;
+		prev_position=(*temp_ptr)->position;
+		temp_ptr+=direction;
+	}
 
+// Without a node past the limit the integral simply stops at the last node
+	if (last_node==number_nodes) {
+		ec_transmit.band_edge[last_node+1]=ec_transmit.band_edge[last_node];
+		ec_transmit.mass[last_node+1]=ec_transmit.mass[last_node];
+		ec_transmit.step[last_node+1]=0.0;
 	}
 
-	result=exp(-2.0*integral*sqrt(2.0*SIM_mo*SIM_q*get_normalize_value(ELECTRON,BAND_EDGE))*
-								  get_normalize_value(GRID_ELECTRICAL,POSITION)*1e-6/SIM_hb);
+	comp_transmit_min_band_edge(ec_transmit);
+
+	ec_transmit.wkb_factor=2.0*sqrt(2.0*SIM_mo*SIM_q*get_normalize_value(context,ELECTRON,BAND_EDGE))*
+						   get_normalize_value(context,GRID_ELECTRICAL,POSITION)*1e-6/SIM_hb;
+}
+
+prec TElectricalServices::comp_conduction_transmission(prec energy)
+{
+	prec result;
+
+	result=exp(-comp_transmit_integral(ec_transmit,energy)*ec_transmit.wkb_factor);
 	assert((result<=1.0) && (result>=0.0));
 
 	return(result);
@@ -345,62 +455,66 @@ void TElectricalServices::comp_valence_richardson(void)
 	if (mass_next<mass_prev) light_mass=(prec) mass_next;
 	else light_mass=(prec)mass_prev;
 
-	ev_therm.richardson_const=(SIM_q*SIM_mo*light_mass*sq(SIM_k)/(2.0*sq(SIM_pi)*sq(SIM_hb)*SIM_hb*1e4))*sq(normalization.temp)
-							   /normalization.current;
+	ev_therm.richardson_const=(SIM_q*SIM_mo*light_mass*sq(SIM_k)/(2.0*sq(SIM_pi)*sq(SIM_hb)*SIM_hb*1e4))*sq(context->normalization.temp)
+							   /context->normalization.current;
 }
 
-prec TElectricalServices::comp_valence_transmission(prec energy)
+void TElectricalServices::comp_valence_transmit_cache(void)
 {
+	int i, number_nodes, direction, last_node;
 	TNode** temp_ptr;
-	prec prev_k_value,next_k_value;
-	prec prev_band_edge, next_band_edge;
-	prec prev_position,next_position;
-	prec integral=0;
-	prec result;
+	prec prev_position;
 
 	if (hole_transmit_max_node<=prev_node->node_number) {
-		prev_position=(prev_node->position+next_node->position)/2.0;
-		prev_band_edge=prev_node->THole::band_edge-ev_therm.barrier_prev*prev_node->THole::stored_temperature;
-		prev_k_value=sqrt(prev_node->THole::dos_mass*(energy-prev_band_edge));
+		number_nodes=prev_node->node_number-hole_transmit_max_node+1;
+		direction=-1;
 		temp_ptr=grid_ptr+prev_node->node_number;
-		while (((*temp_ptr)->THole::band_edge<=energy) && ((*temp_ptr)->node_number>=hole_transmit_max_node)) {
-			next_position=(*temp_ptr)->position;
-			next_band_edge=(*temp_ptr)->THole::band_edge;
-			next_k_value=sqrt((*temp_ptr)->THole::dos_mass*(energy-next_band_edge));
-			integral+=(next_k_value+prev_k_value)*(prev_position-next_position)/2.0;
-			prev_position=next_position;
-			prev_band_edge=next_band_edge;
-			prev_k_value=next_k_value;
-			temp_ptr--;
-		}
-
-		if ((*temp_ptr)->THole::band_edge>energy)
-			integral+=0.5*prev_k_value*(energy-prev_band_edge)/((*temp_ptr)->THole::band_edge-prev_band_edge)*
-					  (prev_position-(*temp_ptr)->position);
+		allocate_transmit_cache(ev_transmit,number_nodes+2);
+		ev_transmit.band_edge[0]=-(prev_node->THole::band_edge-ev_therm.barrier_prev*prev_node->THole::stored_temperature);
+		ev_transmit.mass[0]=prev_node->THole::dos_mass;
 	}
 	else {
-		prev_position=(prev_node->position+next_node->position)/2.0;
-		prev_band_edge=next_node->THole::band_edge-ev_therm.barrier_next*next_node->THole::stored_temperature;
-		prev_k_value=sqrt(next_node->THole::dos_mass*(energy-prev_band_edge));
+		number_nodes=hole_transmit_max_node-next_node->node_number+1;
+		direction=1;
 		temp_ptr=grid_ptr+next_node->node_number;
-		while (((*temp_ptr)->THole::band_edge<=energy) && ((*temp_ptr)->node_number<=hole_transmit_max_node)) {
-			next_position=(*temp_ptr)->position;
-			next_band_edge=(*temp_ptr)->THole::band_edge;
-			next_k_value=sqrt((*temp_ptr)->THole::dos_mass*(energy-next_band_edge));
-			integral+=(next_k_value+prev_k_value)*(next_position-prev_position)/2.0;
-			prev_position=next_position;
-			prev_band_edge=next_band_edge;
-			prev_k_value=next_k_value;
-			temp_ptr++;
-		}
+		allocate_transmit_cache(ev_transmit,number_nodes+2);
+		ev_transmit.band_edge[0]=-(next_node->THole::band_edge-ev_therm.barrier_next*next_node->THole::stored_temperature);
+		ev_transmit.mass[0]=next_node->THole::dos_mass;
+	}
 
-		if ((*temp_ptr)->THole::band_edge>energy)
-			integral+=0.5*prev_k_value*(energy-prev_band_edge)/((*temp_ptr)->THole::band_edge-prev_band_edge)*
-					  ((*temp_ptr)->position-prev_position);
+	ev_transmit.step[0]=0.0;
+	prev_position=(prev_node->position+next_node->position)/2.0;
+
+	last_node=number_nodes;
+	if ((hole_transmit_max_node+direction>=0) &&
+		(hole_transmit_max_node+direction<device_ptr->get_number_objects(NODE))) last_node++;
+
+	for (i=1;i<=last_node;i++) {
+		ev_transmit.band_edge[i]=-(*temp_ptr)->THole::band_edge;
+		ev_transmit.mass[i]=(*temp_ptr)->THole::dos_mass;
+		if (direction<0) ev_transmit.step[i]=prev_position-(*temp_ptr)->position;
+		else ev_transmit.step[i]=(*temp_ptr)->position-prev_position;
+		prev_position=(*temp_ptr)->position;
+		temp_ptr+=direction;
+	}
+
+	if (last_node==number_nodes) {
+		ev_transmit.band_edge[last_node+1]=ev_transmit.band_edge[last_node];
+		ev_transmit.mass[last_node+1]=ev_transmit.mass[last_node];
+		ev_transmit.step[last_node+1]=0.0;
 	}
 
-	result=exp(-2.0*integral*sqrt(2.0*SIM_mo*SIM_q*get_normalize_value(HOLE,BAND_EDGE))*
-							 get_normalize_value(GRID_ELECTRICAL,POSITION)*1e-6/SIM_hb);
+	comp_transmit_min_band_edge(ev_transmit);
+
+	ev_transmit.wkb_factor=2.0*sqrt(2.0*SIM_mo*SIM_q*get_normalize_value(context,HOLE,BAND_EDGE))*
+						   get_normalize_value(context,GRID_ELECTRICAL,POSITION)*1e-6/SIM_hb;
+}
+
+prec TElectricalServices::comp_valence_transmission(prec energy)
+{
+	prec result;
+
+	result=exp(-comp_transmit_integral(ev_transmit,-energy)*ev_transmit.wkb_factor);
 	assert((result<=1.0) && (result>=0.0));
 
 	return(result);
@@ -417,25 +531,25 @@ void TElectricalServices::comp_cond_drift_diff_param(flag grid_effects)
 	long collision_factor=prev_node->TElectron::collision_factor;
 
 	if (grid_effects & GRID_FERMI_DIRAC) {
-		ec.fermi_ratio_1_half_minus_1_half=fermi_integral_1_half(planck_potential)/
-										   fermi_integral_minus_1_half(planck_potential);
+		ec.fermi_ratio_1_half_minus_1_half=fermi_integral_1_half(context,planck_potential)/
+										   fermi_integral_minus_1_half(context,planck_potential);
 
 		switch(collision_factor) {
 			case -1:
-				ec.fermi_ratio_3_half_1_half_col=fermi_integral_2_half(planck_potential)/
+				ec.fermi_ratio_3_half_1_half_col=fermi_integral_2_half(context,planck_potential)/
 												 fermi_integral_0_half(planck_potential);
 				break;
 			case 0:
-				ec.fermi_ratio_3_half_1_half_col=fermi_integral_3_half(planck_potential)/
-												 fermi_integral_1_half(planck_potential);
+				ec.fermi_ratio_3_half_1_half_col=fermi_integral_3_half(context,planck_potential)/
+												 fermi_integral_1_half(context,planck_potential);
 				break;
 			case 1:
-				ec.fermi_ratio_3_half_1_half_col=fermi_integral_4_half(planck_potential)/
-												 fermi_integral_2_half(planck_potential);
+				ec.fermi_ratio_3_half_1_half_col=fermi_integral_4_half(context,planck_potential)/
+												 fermi_integral_2_half(context,planck_potential);
 				break;
 			case 3:
-				ec.fermi_ratio_3_half_1_half_col=fermi_integral_6_half(planck_potential)/
-												 fermi_integral_4_half(planck_potential);
+				ec.fermi_ratio_3_half_1_half_col=fermi_integral_6_half(context,planck_potential)/
+												 fermi_integral_4_half(context,planck_potential);
 				break;
 			default: assert(FALSE); break;
 		}
@@ -453,12 +567,6 @@ void TElectricalServices::comp_cond_drift_diff_param(flag grid_effects)
 	grad_mass=1.5*(temp_next+temp_prev)*((mass_next-mass_prev)/(mass_next+mass_prev));
 
 	ec.bernoulli_param=-grad_temp-grad_ec+grad_mass;
-
-	ec.bernoulli_grad_temp_next=bernoulli(ec.bernoulli_param/temp_next);
-	ec.bernoulli_grad_temp_prev=bernoulli(-ec.bernoulli_param/temp_prev);
-
-	ec.deriv_bern_grad_temp_next=deriv_bernoulli(ec.bernoulli_param/temp_next);
-	ec.deriv_bern_grad_temp_prev=deriv_bernoulli(-ec.bernoulli_param/temp_prev);
 }
 
 void TElectricalServices::comp_val_drift_diff_param(flag grid_effects)
@@ -472,25 +580,25 @@ void TElectricalServices::comp_val_drift_diff_param(flag grid_effects)
 	long collision_factor=prev_node->THole::collision_factor;
 
 	if (grid_effects & GRID_FERMI_DIRAC) {
-		ev.fermi_ratio_1_half_minus_1_half=fermi_integral_1_half(planck_potential)/
-										   fermi_integral_minus_1_half(planck_potential);
+		ev.fermi_ratio_1_half_minus_1_half=fermi_integral_1_half(context,planck_potential)/
+										   fermi_integral_minus_1_half(context,planck_potential);
 
 		switch(collision_factor) {
 			case -1:
-				ev.fermi_ratio_3_half_1_half_col=fermi_integral_2_half(planck_potential)/
+				ev.fermi_ratio_3_half_1_half_col=fermi_integral_2_half(context,planck_potential)/
 												 fermi_integral_0_half(planck_potential);
 				break;
 			case 0:
-				ev.fermi_ratio_3_half_1_half_col=fermi_integral_3_half(planck_potential)/
-												 fermi_integral_1_half(planck_potential);
+				ev.fermi_ratio_3_half_1_half_col=fermi_integral_3_half(context,planck_potential)/
+												 fermi_integral_1_half(context,planck_potential);
 				break;
 			case 1:
-				ev.fermi_ratio_3_half_1_half_col=fermi_integral_4_half(planck_potential)/
-												 fermi_integral_2_half(planck_potential);
+				ev.fermi_ratio_3_half_1_half_col=fermi_integral_4_half(context,planck_potential)/
+												 fermi_integral_2_half(context,planck_potential);
 				break;
 			case 3:
-				ev.fermi_ratio_3_half_1_half_col=fermi_integral_6_half(planck_potential)/
-												 fermi_integral_4_half(planck_potential);
+				ev.fermi_ratio_3_half_1_half_col=fermi_integral_6_half(context,planck_potential)/
+												 fermi_integral_4_half(context,planck_potential);
 				break;
 			default: assert(FALSE); break;
 		}
@@ -508,12 +616,59 @@ void TElectricalServices::comp_val_drift_diff_param(flag grid_effects)
 	grad_mass=1.5*(temp_next+temp_prev)*((mass_next-mass_prev)/(mass_next+mass_prev));
 
 	ev.bernoulli_param=-grad_temp+grad_ev+grad_mass;
+}
+
+/*
+	The Bernoulli functions of the drift-diffusion currents are B(bernoulli_param/temp_next)
+	and B(-bernoulli_param/temp_prev) for each carrier, with their derivatives. The four
+	arguments of an element are bernoulli_param/temp_next and bernoulli_param/temp_prev for
+	electrons and then for holes, and each goes through bernoulli_pair(), which gives the
+	function and its derivative at both signs of the argument from one exponential. The next
+	node takes the positive side and the previous node the negative side. A carrier that flows
+	by thermionic emission does not use these values, so its arguments are set to zero.
+*/
+void TElectricalServices::get_bernoulli_arguments(prec *argument)
+{
+	if (elec_therm_emis_current) argument[0]=argument[1]=0.0;
+	else {
+		argument[0]=ec.bernoulli_param/next_node->TElectron::temperature;
+		argument[1]=ec.bernoulli_param/prev_node->TElectron::temperature;
+	}
+
+	if (hole_therm_emis_current) argument[2]=argument[3]=0.0;
+	else {
+		argument[2]=ev.bernoulli_param/next_node->THole::temperature;
+		argument[3]=ev.bernoulli_param/prev_node->THole::temperature;
+	}
+}
 
-	ev.bernoulli_grad_temp_next=bernoulli(ev.bernoulli_param/temp_next);
-	ev.bernoulli_grad_temp_prev=bernoulli(-ev.bernoulli_param/temp_prev);
+void TElectricalServices::put_bernoulli_values(const prec *bern_pos, const prec *bern_neg,
+											   const prec *deriv_pos, const prec *deriv_neg)
+{
+	if (!elec_therm_emis_current) {
+		ec.bernoulli_grad_temp_next=bern_pos[0];
+		ec.bernoulli_grad_temp_prev=bern_neg[1];
+		ec.deriv_bern_grad_temp_next=deriv_pos[0];
+		ec.deriv_bern_grad_temp_prev=deriv_neg[1];
+	}
 
-	ev.deriv_bern_grad_temp_next=deriv_bernoulli(ev.bernoulli_param/temp_next);
-	ev.deriv_bern_grad_temp_prev=deriv_bernoulli(-ev.bernoulli_param/temp_prev);
+	if (!hole_therm_emis_current) {
+		ev.bernoulli_grad_temp_next=bern_pos[2];
+		ev.bernoulli_grad_temp_prev=bern_neg[3];
+		ev.deriv_bern_grad_temp_next=deriv_pos[2];
+		ev.deriv_bern_grad_temp_prev=deriv_neg[3];
+	}
+}
+
+void TElectricalServices::comp_drift_diff_bernoulli(void)
+{
+	prec argument[4];
+	prec bern_pos[4], bern_neg[4];
+	prec deriv_pos[4], deriv_neg[4];
+
+	get_bernoulli_arguments(argument);
+	bernoulli_pair(argument,bern_pos,bern_neg,deriv_pos,deriv_neg,4);
+	put_bernoulli_values(bern_pos,bern_neg,deriv_pos,deriv_neg);
 }
 
 void TElectricalServices::comp_cond_therm_emis_param(flag grid_effects)
@@ -533,7 +688,10 @@ void TElectricalServices::comp_cond_therm_emis_param(flag grid_effects)
 	ec_therm.barrier_prev/=prev_node->TElectron::stored_temperature;
 	ec_therm.barrier_next/=next_node->TElectron::stored_temperature;
 
-	if (grid_effects & GRID_TUNNELING) ec_therm.min_transmit_energy=comp_elec_transmit_min_energy();
+	if (grid_effects & GRID_TUNNELING) {
+		ec_therm.min_transmit_energy=comp_elec_transmit_min_energy();
+		comp_conduction_transmit_cache();
+	}
 }
 
 void TElectricalServices::comp_val_therm_emis_param(flag grid_effects)
@@ -553,7 +711,10 @@ void TElectricalServices::comp_val_therm_emis_param(flag grid_effects)
 	ev_therm.barrier_prev/=prev_node->THole::stored_temperature;
 	ev_therm.barrier_next/=next_node->THole::stored_temperature;
 
-	if (grid_effects & GRID_TUNNELING) ev_therm.min_transmit_energy=comp_hole_transmit_min_energy();
+	if (grid_effects & GRID_TUNNELING) {
+		ev_therm.min_transmit_energy=comp_hole_transmit_min_energy();
+		comp_valence_transmit_cache();
+	}
 }
 
 
@@ -24,6 +24,7 @@
 
 class TEnvironment {
 private:
+	TSimulationContext *context;
 	logical undo_ready;
 	string undo_filepath;
     logical stop_solution;
@@ -45,6 +46,14 @@ private:
 	prec clamp_value;
 	prec temp_clamp_value;
 	prec temp_relax_value;
+	float newton_refactor_ratio;
+	short max_line_search_iter;
+	short anderson_depth;
+	short tunnel_quad_order;
+	prec tunnel_quad_tolerance;
+	long assembly_min_nodes;
+	long partition_min_nodes;
+	long property_min_nodes;
 	flag env_effects;
 	prec temperature;
 	prec radius;
@@ -54,7 +63,7 @@ private:
 
 // Constructor/Destructor
 public:
-	TEnvironment(void);
+	TEnvironment(TSimulationContext *new_context);
 	~TEnvironment(void) { delete_device(); delete_spectrum(); delete_undo_file(); }
 
 // Get/Put functions
@@ -80,6 +89,10 @@ public:
 // Comp. Functions
 	void comp_value(FlagType flag_type, flag flag_value, int start_object=-1, int end_object=-1);
 	void solve(void);
+	int get_solution_size(void);
+	void get_solution(prec *solution);
+	void put_solution(prec *solution);
+	void predict_solution(void);
 
 
 // Device functions
@@ -92,10 +105,12 @@ public:
     void set_stop_solution(logical stop) { stop_solution=stop; }
     logical do_stop_solution(void) { return(stop_solution); }
     logical is_solving(void) { return(solving); }
+	logical use_fermi_table(void) { return((env_effects & ENV_FERMI_TABLE)!=0); }
 
 // File functions
 public:
 	void load_file(const char *filename);
+	void load_state_file(FILE *file_ptr, const char *filename="");
 	void read_data_file(const char *filename);
 	void write_data_file(const char *filename, TValueFlag write_flags,
 						  FlagType ref_flag_type=(FlagType)NULL,
@@ -137,8 +152,9 @@ public:
 
 */
 
-TEnvironment::TEnvironment(void)
+TEnvironment::TEnvironment(TSimulationContext *new_context)
 {
+	context=new_context;
 	device_ptr=(TDevice *)0;
 	temperature=300.0;
 	radius=100.0;
@@ -146,8 +162,8 @@ TEnvironment::TEnvironment(void)
 	optical_param.number_wavelengths=0;
 	optical_param.start_pos=0.0;
 	optical_param.end_pos=0.0;
-	optical_spectrum.first_wavelength=(OpticalParam *)0;
-	optical_spectrum.last_wavelength=(OpticalParam *)0;
+	optical_spectrum.first_wavelength=(OpticalComponent *)0;
+	optical_spectrum.last_wavelength=(OpticalComponent *)0;
 	env_effects=ENV_SPEC_ENTIRE_DEVICE | ENV_SPEC_LEFT_INCIDENT | ENV_CLAMP_POTENTIAL;
 	undo_ready=FALSE;
 	undo_filepath="";
@@ -167,6 +183,14 @@ TEnvironment::TEnvironment(void)
 	clamp_value=6.0;
 	temp_clamp_value=6.0;
 	temp_relax_value=1.0;
+	newton_refactor_ratio=0.0;
+	max_line_search_iter=0;
+	anderson_depth=0;
+	tunnel_quad_order=0;
+	tunnel_quad_tolerance=0.0;
+	assembly_min_nodes=DEFAULT_ASSEMBLY_MIN_NODES;
+	partition_min_nodes=DEFAULT_PARTITION_MIN_NODES;
+	property_min_nodes=DEFAULT_PROPERTY_MIN_NODES;
 }
 
 prec TEnvironment::get_value(FlagType flag_type, flag flag_value,
@@ -195,6 +219,14 @@ prec TEnvironment::get_value(FlagType flag_type, flag flag_value,
 				case POT_CLAMP_VALUE: return_value=clamp_value; break;
 				case TEMP_CLAMP_VALUE: return_value=temp_clamp_value; break;
 				case TEMP_RELAX_VALUE: return_value=temp_relax_value; break;
+				case NEWTON_REFACTOR_RATIO: return_value=(prec) newton_refactor_ratio; break;
+				case MAX_LINE_SEARCH_ITER: return_value=(prec) max_line_search_iter; break;
+				case ANDERSON_DEPTH: return_value=(prec) anderson_depth; break;
+				case TUNNEL_QUAD_ORDER: return_value=(prec) tunnel_quad_order; break;
+				case TUNNEL_QUAD_TOLERANCE: return_value=tunnel_quad_tolerance; break;
+				case ASSEMBLY_MIN_NODES: return_value=(prec) assembly_min_nodes; break;
+				case PARTITION_MIN_NODES: return_value=(prec) partition_min_nodes; break;
+				case PROPERTY_MIN_NODES: return_value=(prec) property_min_nodes; break;
 				case SPEC_START_POSITION: return_value=optical_param.start_pos; break;
 				case SPEC_END_POSITION: return_value=optical_param.end_pos; break;
 				case SPECTRUM_MULTIPLIER: return_value=spectrum_multiplier; break;
@@ -228,7 +260,7 @@ prec TEnvironment::get_value(FlagType flag_type, flag flag_value,
 	}
 
 	if (scale==UNNORMALIZED) return(return_value);
-	else return(return_value/get_normalize_value(flag_type,flag_value));
+	else return(return_value/get_normalize_value(context,flag_type,flag_value));
 }
 
 void TEnvironment::put_value(FlagType flag_type, flag flag_value, prec value,
@@ -240,7 +272,7 @@ void TEnvironment::put_value(FlagType flag_type, flag flag_value, prec value,
 
 	switch(flag_type) {
 		case ENVIRONMENT:
-			if (scale==NORMALIZED) value*=get_normalize_value(ENVIRONMENT,flag_value);
+			if (scale==NORMALIZED) value*=get_normalize_value(context,ENVIRONMENT,flag_value);
 			switch(flag_value) {
 				case TEMPERATURE:
 					prev_value=temperature;
@@ -255,6 +287,7 @@ void TEnvironment::put_value(FlagType flag_type, flag flag_value, prec value,
 				case EFFECTS:
 					set_effects_change_flags(ENVIRONMENT,env_effects^(flag)value);
 					env_effects=(flag)value;
+					if (env_effects & ENV_FERMI_TABLE) init_fermi_tables();
 					return;
 				case MAX_ELECTRICAL_ERROR: max_electrical_error=(float)value; return;
 				case MAX_THERMAL_ERROR: max_thermal_error=(float)value; return;
@@ -269,6 +302,29 @@ void TEnvironment::put_value(FlagType flag_type, flag flag_value, prec value,
 				case POT_CLAMP_VALUE: clamp_value=value; return;
 				case TEMP_CLAMP_VALUE: temp_clamp_value=value; return;
 				case TEMP_RELAX_VALUE: temp_relax_value=value; return;
+				case NEWTON_REFACTOR_RATIO: newton_refactor_ratio=(float)value; return;
+				case MAX_LINE_SEARCH_ITER: max_line_search_iter=(short)value; return;
+				case ANDERSON_DEPTH:
+					if (value>MAX_ANDERSON_DEPTH) anderson_depth=MAX_ANDERSON_DEPTH;
+					else anderson_depth=(short)value;
+					return;
+				case TUNNEL_QUAD_ORDER:
+					if (value>MAX_TUNNEL_QUAD_ORDER) tunnel_quad_order=MAX_TUNNEL_QUAD_ORDER;
+					else tunnel_quad_order=(short)value;
+					return;
+				case TUNNEL_QUAD_TOLERANCE: tunnel_quad_tolerance=value; return;
+				case ASSEMBLY_MIN_NODES:
+					if (value<0.0) assembly_min_nodes=0;
+					else assembly_min_nodes=(long)value;
+					return;
+				case PARTITION_MIN_NODES:
+					if (value<0.0) partition_min_nodes=0;
+					else partition_min_nodes=(long)value;
+					return;
+				case PROPERTY_MIN_NODES:
+					if (value<0.0) property_min_nodes=0;
+					else property_min_nodes=(long)value;
+					return;
 				case SPEC_START_POSITION:
 					prev_value=optical_param.start_pos;
 					optical_param.start_pos=value;
@@ -290,7 +346,7 @@ void TEnvironment::put_value(FlagType flag_type, flag flag_value, prec value,
 				default: assert(FALSE); return;
 			}
 		case SPECTRUM:
-			if (scale==NORMALIZED) value*=get_normalize_value(SPECTRUM,flag_value);
+			if (scale==NORMALIZED) value*=get_normalize_value(context,SPECTRUM,flag_value);
 
 			if (end_object==-1) {
 				if (start_object==-1) {
@@ -371,7 +427,7 @@ int TEnvironment::get_spectral_comp(prec wavelength, int start_comp, int end_com
 
 	if (optical_param.number_wavelengths<=1) return(0);
 
-	if (scale==NORMALIZED) wavelength*=get_normalize_value(SPECTRUM,INCIDENT_PHOTON_WAVELENGTH);
+	if (scale==NORMALIZED) wavelength*=get_normalize_value(context,SPECTRUM,INCIDENT_PHOTON_WAVELENGTH);
 
 	if (start_comp==-1) start_comp=0;
 	if (end_comp==-1) end_comp=optical_param.number_wavelengths-1;
@@ -458,6 +514,30 @@ void TEnvironment::solve(void)
 	}
 }
 
+int TEnvironment::get_solution_size(void)
+{
+	if (device()) return(device_ptr->get_solution_size());
+	else return(0);
+}
+
+void TEnvironment::get_solution(prec *solution)
+{
+	assert(device());
+	device_ptr->get_solution(solution);
+}
+
+void TEnvironment::put_solution(prec *solution)
+{
+	assert(device());
+	device_ptr->put_solution(solution);
+}
+
+void TEnvironment::predict_solution(void)
+{
+	assert(device());
+	device_ptr->predict_solution();
+}
+
 void TEnvironment::delete_device(void)
 {
 	int i;
@@ -503,11 +583,12 @@ void TEnvironment::undo(void)
 
 void TEnvironment::load_file(const char *filename)
 {
+	TErrorHandler& error_handler=context->error_handler;
 	FileType file_type;
 	FILE *file_ptr;
-	extern char state_string[], state_version_string[];
-	extern int state_string_size, state_version_string_size;
-	char new_state_string[40], new_state_version_string[40];
+	extern char state_string[];
+	extern int state_string_size;
+	char new_state_string[40];
 	TParseDevice *device_parser;
 	TDeviceFileInput device_input;
 	prec contact_pos_0, contact_pos_1;
@@ -523,25 +604,19 @@ void TEnvironment::load_file(const char *filename)
 	fread(new_state_string,state_string_size,1,file_ptr);
 	if (!strncmp(new_state_string,state_string,state_string_size)) {
 		file_type=STATE_FILE;
-		fread(new_state_version_string,state_version_string_size,1,file_ptr);
-		if (!strncmp(new_state_version_string,state_version_string,state_version_string_size))
-			read_state_file(file_ptr);
-		else {
-			error_handler.set_error(ERROR_FILE_OLD_STATE,0,"",filename);
-			fclose(file_ptr);
-			return;
-		}
+		rewind(file_ptr);
+		load_state_file(file_ptr,filename);
 		fclose(file_ptr);
 	}
 	else {
 		fclose(file_ptr);
 		file_type=INPUT_FILE;
-		device_parser=new TParseDevice(filename);
+		device_parser=new TParseDevice(context,filename);
 		if (!error_handler.fail()) device_input=device_parser->parse_device();
 		delete device_parser;
-		if (!error_handler.fail()) device_input.check_device();
+		if (!error_handler.fail()) device_input.check_device(context);
 		if (!error_handler.fail())
-			device_ptr = new TDevice(device_input);
+			device_ptr = new TDevice(context,device_input);
 	}
 
 	if (error_handler.fail()) {
@@ -567,6 +642,28 @@ void TEnvironment::load_file(const char *filename)
 	}
 }
 
+/*
+	Loads a state file from an open file, positioned at the start of the state.
+	The file is left open, e.g. for temporary files holding a copy of a device.
+*/
+void TEnvironment::load_state_file(FILE *file_ptr, const char *filename)
+{
+	extern char state_string[], state_version_string[];
+	extern int state_string_size, state_version_string_size;
+	char new_state_string[40], new_state_version_string[40];
+
+	delete_device();
+
+	fread(new_state_string,state_string_size,1,file_ptr);
+	fread(new_state_version_string,state_version_string_size,1,file_ptr);
+	if (strncmp(new_state_string,state_string,state_string_size) ||
+		strncmp(new_state_version_string,state_version_string,state_version_string_size)) {
+		context->error_handler.set_error(ERROR_FILE_OLD_STATE,0,"",filename);
+		return;
+	}
+	read_state_file(file_ptr);
+}
+
 void TEnvironment::read_data_file(const char *filename)
 {
 	if (device()) device_ptr->read_data_file(filename);
@@ -584,7 +681,7 @@ void TEnvironment::write_data_file(const char *filename, TValueFlag write_flags,
 	ofstream output_file(filename);
 
 	if (!output_file) {
-		error_handler.set_error(ERROR_FILE_NOT_OPEN,0,"",filename);
+		context->error_handler.set_error(ERROR_FILE_NOT_OPEN,0,"",filename);
 		return;
 	}
 
@@ -649,22 +746,30 @@ void TEnvironment::write_data_file(const char *filename, TValueFlag write_flags,
 
 void TEnvironment::write_state_file(const char *filename)
 {
-	int i;
-	extern char state_string[], state_version_string[];
-	extern int state_string_size, state_version_string_size;
 	FILE *file_ptr;
-	prec energy,intensity_in,intensity_out;
 
 	file_ptr=fopen(filename,"wb");
 	if (!file_ptr) {
-		error_handler.set_error(ERROR_FILE_NOT_OPEN,0,"",filename);
+		context->error_handler.set_error(ERROR_FILE_NOT_OPEN,0,"",filename);
 		return;
 	}
 
+	write_state_file(file_ptr);
+
+	fclose(file_ptr);
+}
+
+void TEnvironment::write_state_file(FILE *file_ptr)
+{
+	int i;
+	extern char state_string[], state_version_string[];
+	extern int state_string_size, state_version_string_size;
+	prec energy,intensity_in,intensity_out;
+
 	fwrite(state_string,state_string_size,1,file_ptr);
 	fwrite(state_version_string,state_version_string_size,1,file_ptr);
 
-	fwrite(&normalization,sizeof(normalization),1,file_ptr);
+	fwrite(&context->normalization,sizeof(context->normalization),1,file_ptr);
 
 	fwrite(&max_electrical_error,sizeof(max_electrical_error),1,file_ptr);
 	fwrite(&max_thermal_error,sizeof(max_thermal_error),1,file_ptr);
@@ -696,8 +801,6 @@ void TEnvironment::write_state_file(const char *filename)
 	}
 
 	if (device()) device_ptr->write_state_file(file_ptr);
-
-	fclose(file_ptr);
 }
 
 void TEnvironment::read_state_file(FILE *file_ptr)
@@ -706,7 +809,7 @@ void TEnvironment::read_state_file(FILE *file_ptr)
 	prec energy, input_intensity, output_intensity;
 	int number_wavelengths;
 
-	fread(&normalization,sizeof(normalization),1,file_ptr);
+	fread(&context->normalization,sizeof(context->normalization),1,file_ptr);
 
 	fread(&max_electrical_error,sizeof(max_electrical_error),1,file_ptr);
 	fread(&max_thermal_error,sizeof(max_thermal_error),1,file_ptr);
@@ -746,10 +849,9 @@ void TEnvironment::read_state_file(FILE *file_ptr)
 
 	if (char_test!=EOF) {
 		ungetc(char_test,file_ptr);
-		device_ptr = new TDevice(file_ptr);
+		device_ptr = new TDevice(context,file_ptr);
 	}
 
-	fclose(file_ptr);
 	effects_change_flags.clear_all();
 	update_flags.clear_all();
 	recompute_flags.clear_all();
@@ -760,7 +862,7 @@ void TEnvironment::add_spectral_comp(void)
 	if (optical_param.number_wavelengths) {
 		optical_spectrum.last_wavelength->next_wavelength=new OpticalComponent;
 		if (!optical_spectrum.last_wavelength->next_wavelength) {
-			error_handler.set_error(ERROR_MEM_SPECTRAL_COMP,0,"","");
+			context->error_handler.set_error(ERROR_MEM_SPECTRAL_COMP,0,"","");
 			return;
 		}
 		optical_spectrum.last_wavelength=optical_spectrum.last_wavelength->next_wavelength;
@@ -768,7 +870,7 @@ void TEnvironment::add_spectral_comp(void)
 	else {
 		optical_spectrum.first_wavelength=new OpticalComponent;
 		if (!optical_spectrum.first_wavelength) {
-			error_handler.set_error(ERROR_MEM_SPECTRAL_COMP,0,"","");
+			context->error_handler.set_error(ERROR_MEM_SPECTRAL_COMP,0,"","");
 			return;
 		}
 		optical_spectrum.last_wavelength=optical_spectrum.first_wavelength;
@@ -792,7 +894,7 @@ void TEnvironment::load_spectrum(const char *filename)
 	file_ptr=fopen(filename,"r");
 
 	if (!file_ptr) {
-		error_handler.set_error(ERROR_FILE_NOT_OPEN,0,"",filename);
+		context->error_handler.set_error(ERROR_FILE_NOT_OPEN,0,"",filename);
 		return;
 	}
 
@@ -803,7 +905,7 @@ void TEnvironment::load_spectrum(const char *filename)
 
 		if (!feof(file_ptr)) {
 			add_spectral_comp();
-			if (error_handler.fail()) return;
+			if (context->error_handler.fail()) return;
 			put_value(SPECTRUM,INCIDENT_PHOTON_WAVELENGTH,wave_length,number_wavelengths);
 			put_value(SPECTRUM,INCIDENT_INPUT_INTENSITY,intensity,number_wavelengths);
 			put_value(SPECTRUM,INCIDENT_EMITTED_INTENSITY,intensity,number_wavelengths);
@@ -831,7 +933,7 @@ void TEnvironment::delete_spectrum(void)
 		}
 
 		optical_param.number_wavelengths=0;
-		optical_spectrum.first_wavelength=(OpticalParam *)0;
+		optical_spectrum.first_wavelength=(OpticalComponent *)0;
 
 		set_update_flags(SPECTRUM,INCIDENT_INPUT_INTENSITY);
 	}
@@ -900,8 +1002,8 @@ void TEnvironment::effects_change_to_compute_flags(void)
 		if (effects_change_flags.is_set(ENVIRONMENT,ENV_SPEC_ENTIRE_DEVICE) ||
 			effects_change_flags.is_set(ENVIRONMENT,ENV_SPEC_LEFT_INCIDENT)) {
 			if (env_effects & ENV_SPEC_ENTIRE_DEVICE) {
-				contact_pos_0=environment.get_value(CONTACT,POSITION,0);
-				contact_pos_1=environment.get_value(CONTACT,POSITION,1);
+				contact_pos_0=get_value(CONTACT,POSITION,0);
+				contact_pos_1=get_value(CONTACT,POSITION,1);
 				if (env_effects & ENV_SPEC_LEFT_INCIDENT) {
 					put_value(ENVIRONMENT,SPEC_START_POSITION,contact_pos_0);
 					put_value(ENVIRONMENT,SPEC_END_POSITION,contact_pos_1);
@@ -916,6 +1018,23 @@ void TEnvironment::effects_change_to_compute_flags(void)
 #endif
 		}
 
+//ENV_FERMI_TABLE
+		if (effects_change_flags.is_set(ENVIRONMENT,ENV_FERMI_TABLE)) {
+			recompute_flags.set(ELECTRON, EQUIL_PLANCK_POT);
+			update_flags.set(ELECTRON,EQUIL_PLANCK_POT);
+			recompute_flags.set(HOLE,EQUIL_PLANCK_POT);
+			update_flags.set(HOLE,EQUIL_PLANCK_POT);
+			recompute_flags.set(ELECTRON,CONCENTRATION);
+			update_flags.set(ELECTRON,CONCENTRATION);
+			recompute_flags.set(HOLE,CONCENTRATION);
+			update_flags.set(HOLE,CONCENTRATION);
+			recompute_flags.set(CONTACT,BUILT_IN_POT);
+			update_flags.set(CONTACT,BUILT_IN_POT);
+#ifndef NDEBUG
+			effects_change_flags.clear(ENVIRONMENT,ENV_FERMI_TABLE);
+#endif
+		}
+
 //Device effect flags
 
 //DEVICE_NON_ISOTHERMAL
@@ -1209,6 +1328,12 @@ void TEnvironment::effects_change_to_compute_flags(void)
 //ENV_CLAMP_TEMPERATURE
 		effects_change_flags.clear(ENVIRONMENT,ENV_CLAMP_TEMPERATURE);
 
+//ENV_COUPLED_THERMAL
+		effects_change_flags.clear(ENVIRONMENT,ENV_COUPLED_THERMAL);
+
+//ENV_COUPLED_PHOTONS
+		effects_change_flags.clear(ENVIRONMENT,ENV_COUPLED_PHOTONS);
+
 //DEVICE_LASER
 //		No code required - flag can not be changed when a device is loaded
 
@@ -23,6 +23,7 @@
 
 class TFreeElectron {
 protected:
+	TSimulationContext *context;
 	flag effects;
 	prec equil_dos;
 	prec non_equil_dos;
@@ -31,7 +32,7 @@ protected:
 	prec deriv_conc_eta_c;
 
 public:
-	TFreeElectron(void);
+	TFreeElectron(TSimulationContext *new_context);
 
 // Comp functions
 private:
@@ -45,6 +46,8 @@ public:
 	void comp_conc(prec planck_potential, prec temp=0.0,
 				   prec qw_energy_top=0.0, prec bound_dos=0.0);
 	void comp_deriv_conc(prec planck_potential, prec qw_energy_top=0.0);
+	void comp_fermi_conc(prec fermi_1_half) { concentration=non_equil_dos*fermi_1_half; }
+	void comp_fermi_deriv_conc(prec fermi_minus_1_half) { deriv_conc_eta_c=non_equil_dos*fermi_minus_1_half; }
 
 	prec get_value(flag flag_value, ScaleType scale=UNNORMALIZED);
 	void put_value(flag flag_value, prec value, ScaleType scale=UNNORMALIZED);
@@ -54,8 +57,9 @@ public:
 };
 */
 
-TFreeElectron::TFreeElectron(void)
+TFreeElectron::TFreeElectron(TSimulationContext *new_context)
 {
+	context=new_context;
 	effects=0;
 	equil_dos=0.0;
 	non_equil_dos=0.0;
@@ -66,13 +70,14 @@ TFreeElectron::TFreeElectron(void)
 
 prec TFreeElectron::comp_dos(prec dos_mass, prec temp)
 {
-	return(2.0*pow((double) 2.0*SIM_pi*dos_mass*SIM_mo*SIM_k*temp*normalization.temp/sq(SIM_h),
-				   (double) 1.5)/(1E6*normalization.conc));
+	return(2.0*pow((double) 2.0*SIM_pi*dos_mass*SIM_mo*SIM_k*temp*context->normalization.temp/sq(SIM_h),
+				   (double) 1.5)/(1E6*context->normalization.conc));
 }
 
 void TFreeElectron::comp_mobility(MaterialSpecification material, prec position, prec lat_temp,
 								  prec car_temp, prec donors, prec acceptors)
 {
+	NormalizeConstants& normalization=context->normalization;
 	prec compute_lat_temp, compute_car_temp;
 	prec compute_donors, compute_acceptors;
 
@@ -97,8 +102,8 @@ void TFreeElectron::comp_mobility(MaterialSpecification material, prec position,
 	prec values[]= { material.alloy_conc, compute_lat_temp, compute_car_temp, compute_donors,
 					 compute_acceptors, position*normalization.length/1e-4 };
 
-	mobility=material_parameters.evaluate(MAT_ELECTRON_MOBILITY,material.material_type,material.alloy_type,
-										  values)/normalization.mobility;
+	mobility=context->material_parameters.evaluate(MAT_ELECTRON_MOBILITY,material.material_type,material.alloy_type,
+												   values)/normalization.mobility;
 }
 
 void TFreeElectron::comp_conc(prec planck_potential, prec temp,
@@ -113,7 +118,7 @@ void TFreeElectron::comp_conc(prec planck_potential, prec temp,
 			concentration=0.0;
 	}
 	else {
-		if (effects & GRID_FERMI_DIRAC) concentration=non_equil_dos*fermi_integral_1_half(planck_potential);
+		if (effects & GRID_FERMI_DIRAC) concentration=non_equil_dos*fermi_integral_1_half(context,planck_potential);
 		else concentration=exp(planck_potential)*non_equil_dos;
 	}
 }
@@ -122,7 +127,7 @@ void TFreeElectron::comp_deriv_conc(prec planck_potential, prec qw_energy_top)
 {
 	if (qw_energy_top>0.0) deriv_conc_eta_c=concentration;
 	else {
-		if (effects & GRID_FERMI_DIRAC) deriv_conc_eta_c=non_equil_dos*fermi_integral_minus_1_half(planck_potential);
+		if (effects & GRID_FERMI_DIRAC) deriv_conc_eta_c=non_equil_dos*fermi_integral_minus_1_half(context,planck_potential);
 		else deriv_conc_eta_c=concentration;
 	}
 }
@@ -139,13 +144,13 @@ prec TFreeElectron::get_value(flag flag_value, ScaleType scale)
 		default: assert(FALSE); return(0.0);
 	}
 
-	if (scale==UNNORMALIZED) return_value*=get_normalize_value(FREE_ELECTRON,flag_value);
+	if (scale==UNNORMALIZED) return_value*=get_normalize_value(context,FREE_ELECTRON,flag_value);
 	return(return_value);
 }
 
 void TFreeElectron::put_value(flag flag_value, prec value, ScaleType scale)
 {
-	if (scale==UNNORMALIZED) value/=get_normalize_value(FREE_ELECTRON,flag_value);
+	if (scale==UNNORMALIZED) value/=get_normalize_value(context,FREE_ELECTRON,flag_value);
 
 	switch(flag_value) {
 		case EQUIL_DOS: equil_dos=value; return;
@@ -178,6 +183,7 @@ void TFreeElectron::write_state_file(FILE *file_ptr)
 
 class TFreeHole {
 protected:
+	TSimulationContext *context;
 	flag effects;
 	prec equil_dos;
 	prec non_equil_dos;
@@ -186,7 +192,7 @@ protected:
 	prec deriv_conc_eta_v;
 
 public:
-	TFreeHole(void);
+	TFreeHole(TSimulationContext *new_context);
 
 // Comp functions
 private:
@@ -199,6 +205,8 @@ public:
 	void comp_conc(prec planck_potential, prec temp=0.0,
 				   prec qw_energy_top=0.0, prec bound_dos=0.0);
 	void comp_deriv_conc(prec planck_potential,prec qw_energy_top=0.0);
+	void comp_fermi_conc(prec fermi_1_half) { concentration=non_equil_dos*fermi_1_half; }
+	void comp_fermi_deriv_conc(prec fermi_minus_1_half) { deriv_conc_eta_v=non_equil_dos*fermi_minus_1_half; }
 
 	prec get_value(flag flag_value, ScaleType scale=UNNORMALIZED);
 	void put_value(flag flag_value, prec value, ScaleType scale=UNNORMALIZED);
@@ -208,8 +216,9 @@ public:
 };
 */
 
-TFreeHole::TFreeHole(void)
+TFreeHole::TFreeHole(TSimulationContext *new_context)
 {
+	context=new_context;
 	effects=0;
 	equil_dos=0.0;
 	non_equil_dos=0.0;
@@ -220,13 +229,14 @@ TFreeHole::TFreeHole(void)
 
 prec TFreeHole::comp_dos(prec dos_mass, prec temp)
 {
-	return(2.0*pow((double) 2.0*SIM_pi*dos_mass*SIM_mo*SIM_k*temp*normalization.temp/sq(SIM_h),
-				   (double) 1.5)/(1E6*normalization.conc));
+	return(2.0*pow((double) 2.0*SIM_pi*dos_mass*SIM_mo*SIM_k*temp*context->normalization.temp/sq(SIM_h),
+				   (double) 1.5)/(1E6*context->normalization.conc));
 }
 
 void TFreeHole::comp_mobility(MaterialSpecification material, prec position, prec lat_temp,
 							  prec car_temp, prec donors, prec acceptors)
 {
+	NormalizeConstants& normalization=context->normalization;
 	prec compute_car_temp, compute_lat_temp;
 	prec compute_donors, compute_acceptors;
 
@@ -251,8 +261,8 @@ void TFreeHole::comp_mobility(MaterialSpecification material, prec position, pre
 	prec values[]= { material.alloy_conc, compute_lat_temp, compute_car_temp, compute_donors,
 					 compute_acceptors, position*normalization.length/1e-4 };
 
-	mobility=material_parameters.evaluate(MAT_HOLE_MOBILITY,material.material_type,
-										  material.alloy_type,values)/normalization.mobility;
+	mobility=context->material_parameters.evaluate(MAT_HOLE_MOBILITY,material.material_type,
+												   material.alloy_type,values)/normalization.mobility;
 }
 
 void TFreeHole::comp_conc(prec planck_potential, prec temp,
@@ -267,7 +277,7 @@ void TFreeHole::comp_conc(prec planck_potential, prec temp,
 			concentration=0.0;
 	}
 	else {
-		if (effects & GRID_FERMI_DIRAC) concentration=non_equil_dos*fermi_integral_1_half(planck_potential);
+		if (effects & GRID_FERMI_DIRAC) concentration=non_equil_dos*fermi_integral_1_half(context,planck_potential);
 		else concentration=exp(planck_potential)*non_equil_dos;
 	}
 }
@@ -276,7 +286,7 @@ void TFreeHole::comp_deriv_conc(prec planck_potential,prec qw_energy_top)
 {
 	if (qw_energy_top<0.0) deriv_conc_eta_v=concentration;
 	else {
-		if (effects & GRID_FERMI_DIRAC) deriv_conc_eta_v=non_equil_dos*fermi_integral_minus_1_half(planck_potential);
+		if (effects & GRID_FERMI_DIRAC) deriv_conc_eta_v=non_equil_dos*fermi_integral_minus_1_half(context,planck_potential);
 		else deriv_conc_eta_v=concentration;
 	}
 }
@@ -293,13 +303,13 @@ prec TFreeHole::get_value(flag flag_value, ScaleType scale)
 		default: assert(FALSE); return(0.0);
 	}
 
-	if (scale==UNNORMALIZED) return_value*=get_normalize_value(FREE_HOLE,flag_value);
+	if (scale==UNNORMALIZED) return_value*=get_normalize_value(context,FREE_HOLE,flag_value);
 	return(return_value);
 }
 
 void TFreeHole::put_value(flag flag_value, prec value, ScaleType scale)
 {
-	if (scale==UNNORMALIZED) value/=get_normalize_value(FREE_HOLE,flag_value);
+	if (scale==UNNORMALIZED) value/=get_normalize_value(context,FREE_HOLE,flag_value);
 
 	switch(flag_value) {
 		case EQUIL_DOS: equil_dos=value; return;
@@ -168,6 +168,10 @@ TUserFunction::TUserFunction(const TUserFunction& new_user_function)
 	if (fnot_empty(new_user_function.function)) translate();
 }
 
+/*
+	Functions do not belong to a context and are also translated when they are copied or
+	read, so an invalid function is reported to current_context.
+*/
 void TUserFunction::translate(void)
 {
 	int length;
@@ -176,7 +180,7 @@ void TUserFunction::translate(void)
 	function_fix_up();
 	function=::translate(function_string,variable_string,&length,&translate_error);
 	if (translate_error!=-1) {
-		error_handler.set_error(ERROR_FUNCTION_TRANSLATE,0,"","");
+		current_context->error_handler.set_error(ERROR_FUNCTION_TRANSLATE,0,"","");
 		return;
 	}
 }
@@ -513,24 +517,21 @@ float TModelAlGaAsPermitivity::Phi_values[]= {
 	-0.70131, 2.01631, -1.32069, -0.21253,
 };
 
+/*
+	The permitivity is not cached in the model. The same model is evaluated for different
+	nodes at the same time when node properties are computed on the worker pool.
+*/
 complex TModelAlGaAsPermitivity::comp_permitivity(prec *values)
 {
 	int i;
-	static complex previous_result(0.0,0.0);
-	static prec previous_values[]={ 0.0, 0.0, 0.0, 0.0, 0.0 };
-	logical compute_new_result=FALSE;
+	complex result;
 	prec e_value, gamma_value, a_value, phi_value;
 	float *e_ptr, *gamma_ptr, *a_ptr, *phi_ptr;
 	prec alloy_conc=values[0];
 	prec photon_energy=values[2];
 	prec evaluation_energy;
 
-	for (i=0;i<5;i++) compute_new_result|=(previous_values[i]!=values[i]);
-	if (!compute_new_result) return(previous_result);
-
-	for (i=0;i<5;i++) previous_values[i]=values[i];
-
-	previous_result=complex(0.0,0.0);
+	result=complex(0.0,0.0);
 
 	evaluation_energy=photon_energy+(values[4]-values[3]);
 
@@ -557,17 +558,17 @@ complex TModelAlGaAsPermitivity::comp_permitivity(prec *values)
 				  (*(phi_ptr+2))*sq(alloy_conc)+
 				  (*(phi_ptr+3))*sq(alloy_conc)*alloy_conc;
 
-		previous_result+=a_value*exp(complex(0,phi_value))*((1.0/complex(evaluation_energy+e_value,gamma_value))-
-															(1.0/complex(evaluation_energy-e_value,gamma_value)));
+		result+=a_value*exp(complex(0,phi_value))*((1.0/complex(evaluation_energy+e_value,gamma_value))-
+												   (1.0/complex(evaluation_energy-e_value,gamma_value)));
 
 		e_ptr+=4;
 		gamma_ptr+=4;
 		a_ptr+=4;
 		phi_ptr+=4;
 	}
-	previous_result+=0.99;
+	result+=0.99;
 
-	return(previous_result);
+	return(result);
 }
 
 /******************************* class TModelAlGaAsRefractiveIndex *****************************
@@ -29,6 +29,7 @@
 
 class TGrid {
 protected:
+	TSimulationContext *context;
 	int node_number;
 	prec position;
 	RegionType region_type;
@@ -61,19 +62,19 @@ protected:
 	prec group_velocity;
 
 public:
-	TGrid(int node_num, RegionType region, TQuantumWell *qw);
+	TGrid(TSimulationContext *new_context, int node_num, RegionType region, TQuantumWell *qw);
 
 	void comp_b_b_recomb_const(void);
 	void comp_band_gap(void);
 	void comp_deriv_thermal_conduct(void);
 	void comp_deriv_lateral_conduct(void);
 	void comp_electron_affinity(void);
-	void comp_field(int start_node_number, prec total_charge);
-	void comp_incident_optical_field(int start_node_number);
+	void comp_field(int start_node_number, prec total_charge, FieldSweep& sweep);
+	void comp_incident_optical_field(int start_node_number, OpticalFieldSweep& sweep);
 	void comp_incident_refractive_index(void);
 	void comp_incident_impedance(void);
 	void comp_incident_total_poynting(prec intensity_multiplier, int max_overflow_count);
-	void comp_mode_optical_field(int start_node_number);
+	void comp_mode_optical_field(int start_node_number, OpticalFieldSweep& sweep);
 	void comp_mode_refractive_index(void);
 	void comp_mode_impedance(void);
 	void comp_permitivity(void);
@@ -89,8 +90,9 @@ public:
 };
 */
 
-TGrid::TGrid(int node_num, RegionType region, TQuantumWell *qw)
+TGrid::TGrid(TSimulationContext *new_context, int node_num, RegionType region, TQuantumWell *qw)
 {
+	context=new_context;
 	node_number=node_num;
 	position=0.0;
 	region_type=region;
@@ -134,14 +136,16 @@ TGrid::TGrid(int node_num, RegionType region, TQuantumWell *qw)
 
 void TGrid::comp_b_b_recomb_const(void)
 {
+	NormalizeConstants& normalization=context->normalization;
 	prec values[]={ material.alloy_conc,position*normalization.length/1e-4 };
 
-	b_b_recomb_const=material_parameters.evaluate(MAT_B_B_RECOMB_CONSTANT, material.material_type,
-												  material.alloy_type,values)*normalization.conc*normalization.time;
+	b_b_recomb_const=context->material_parameters.evaluate(MAT_B_B_RECOMB_CONSTANT, material.material_type,
+														   material.alloy_type,values)*normalization.conc*normalization.time;
 }
 
 void TGrid::comp_band_gap(void)
 {
+	NormalizeConstants& normalization=context->normalization;
 	prec evaluation_temp;
 
 	if (effects & GRID_BAND_NARROWING) evaluation_temp=lattice_temp*normalization.temp;
@@ -149,41 +153,43 @@ void TGrid::comp_band_gap(void)
 
 	prec values[]= { material.alloy_conc, evaluation_temp, position*normalization.length/1e-4 };
 
-	band_gap=material_parameters.evaluate(MAT_BAND_GAP,material.material_type,material.alloy_type,
-										  values)/normalization.pot;
+	band_gap=context->material_parameters.evaluate(MAT_BAND_GAP,material.material_type,material.alloy_type,
+												   values)/normalization.pot;
 }
 
 void TGrid::comp_deriv_thermal_conduct(void)
 {
+	NormalizeConstants& normalization=context->normalization;
 	if (effects & GRID_TEMP_THERMAL_COND) {
 		prec values[]= { material.alloy_conc, lattice_temp*normalization.temp,
 						 position*normalization.length/1e-4 };
 
-		deriv_therm_cond_temp=material_parameters.evaluate(MAT_DERIV_THERMAL_CONDUCT,
-														   material.material_type,
-														   material.alloy_type,
-														   values)*normalization.temp/normalization.therm_cond;
+		deriv_therm_cond_temp=context->material_parameters.evaluate(MAT_DERIV_THERMAL_CONDUCT,
+																	material.material_type,
+																	material.alloy_type,
+																	values)*normalization.temp/normalization.therm_cond;
 	}
 	else deriv_therm_cond_temp=0.0;
 }
 
 void TGrid::comp_deriv_lateral_conduct(void)
 {
+	NormalizeConstants& normalization=context->normalization;
 	prec env_radius, env_temp;
 	prec new_deriv_therm_cond;
 
 	if (effects & GRID_TEMP_THERMAL_COND) {
-		env_radius=environment.get_value(ENVIRONMENT,RADIUS,0,NORMALIZED);
-		env_temp=environment.get_value(ENVIRONMENT,TEMPERATURE,0,NORMALIZED);
+		env_radius=context->environment.get_value(ENVIRONMENT,RADIUS,0,NORMALIZED);
+		env_temp=context->environment.get_value(ENVIRONMENT,TEMPERATURE,0,NORMALIZED);
 
 		prec values[]= { material.alloy_conc,
 						(lattice_temp+env_temp)*normalization.temp/2.0,
 						 position*normalization.length/1e-4 };
 
-		new_deriv_therm_cond=material_parameters.evaluate(MAT_DERIV_THERMAL_CONDUCT,
-														  material.material_type,
-														  material.alloy_type,
-														  values)*normalization.temp/normalization.therm_cond;
+		new_deriv_therm_cond=context->material_parameters.evaluate(MAT_DERIV_THERMAL_CONDUCT,
+																   material.material_type,
+																   material.alloy_type,
+																   values)*normalization.temp/normalization.therm_cond;
 		deriv_lateral_cond_temp=2.0*new_deriv_therm_cond/(sq(radius)*log(env_radius/radius));
 	}
 	else deriv_lateral_cond_temp=0.0;
@@ -191,6 +197,7 @@ void TGrid::comp_deriv_lateral_conduct(void)
 
 void TGrid::comp_electron_affinity(void)
 {
+	NormalizeConstants& normalization=context->normalization;
 	prec evaluation_temp;
 
 	if (effects & GRID_TEMP_ELECTRON_AFFINITY) evaluation_temp=lattice_temp*normalization.temp;
@@ -198,36 +205,30 @@ void TGrid::comp_electron_affinity(void)
 
 	prec values[]= { material.alloy_conc, evaluation_temp, position*normalization.length/1e-4 };
 
-	electron_affinity=material_parameters.evaluate(MAT_ELECTRON_AFFINITY,material.material_type,material.alloy_type,
-												   values)/normalization.pot;
+	electron_affinity=context->material_parameters.evaluate(MAT_ELECTRON_AFFINITY,material.material_type,material.alloy_type,
+															values)/normalization.pot;
 }
 
-void TGrid::comp_field(int start_node_number, prec total_charge)
+void TGrid::comp_field(int start_node_number, prec total_charge, FieldSweep& sweep)
 {
-	static prec prev_position;
-	static prec displacement,prev_displacement;
-	static prec prev_charge;
+	prec displacement;
 
 	if (node_number==start_node_number) {
-		prev_displacement=field*permitivity;
+		sweep.prev_displacement=field*permitivity;
 	}
 	else {
-		displacement=prev_displacement+(total_charge+prev_charge)*
-									   (position-prev_position)/2.0;
+		displacement=sweep.prev_displacement+(total_charge+sweep.prev_charge)*
+											 (position-sweep.prev_position)/2.0;
 		field=displacement/permitivity;
-		prev_displacement=displacement;
+		sweep.prev_displacement=displacement;
 	}
-	prev_position=position;
-	prev_charge=total_charge;
+	sweep.prev_position=position;
+	sweep.prev_charge=total_charge;
 }
 
-void TGrid::comp_incident_optical_field(int start_node_number)
+void TGrid::comp_incident_optical_field(int start_node_number, OpticalFieldSweep& sweep)
 {
-	static complex i(0,1);
-	static prec prev_position, wave_vector;
-	static complex prev_impedance;
-	static OpticalField prev_incident_field;
-    static int overflow_count;
+	complex i(0,1);
     prec real_exponent, imag_exponent;
     complex exponent;
 	complex forward_propag_param, reverse_propag_param;
@@ -235,33 +236,33 @@ void TGrid::comp_incident_optical_field(int start_node_number)
 	complex temp_forward_field, temp_reverse_field;
 
 	if (node_number==start_node_number) {
-		wave_vector=2.0*SIM_pi/get_value(GRID_OPTICAL,INCIDENT_PHOTON_WAVELENGTH,NORMALIZED);
-        overflow_count=0;
+		sweep.wave_vector=2.0*SIM_pi/get_value(GRID_OPTICAL,INCIDENT_PHOTON_WAVELENGTH,NORMALIZED);
+        sweep.overflow_count=0;
 	}
 	else {
-		exponent=wave_vector*(position-prev_position)/prev_impedance;
+		exponent=sweep.wave_vector*(position-sweep.prev_position)/sweep.prev_impedance;
         real_exponent=real(exponent);
         imag_exponent=exp(imag(exponent));
 
 		forward_propag_param=exp(-i*real_exponent)*imag_exponent;
 		reverse_propag_param=exp(i*real_exponent)/imag_exponent;
 
-        if ((fabs(real(prev_incident_field.forward_field))>=1e150/imag_exponent) ||
-            (fabs(imag(prev_incident_field.forward_field))>=1e150/imag_exponent)) {
-        	incident_field.forward_field=prev_incident_field.forward_field/1e150;
-            incident_field.reverse_field=prev_incident_field.reverse_field*1e150;
-            overflow_count++;
+        if ((fabs(real(sweep.prev_field.forward_field))>=1e150/imag_exponent) ||
+            (fabs(imag(sweep.prev_field.forward_field))>=1e150/imag_exponent)) {
+        	incident_field.forward_field=sweep.prev_field.forward_field/1e150;
+            incident_field.reverse_field=sweep.prev_field.reverse_field*1e150;
+            sweep.overflow_count++;
         }
         else {
-	        if ((fabs(real(prev_incident_field.reverse_field))>=1e150*imag_exponent) ||
-    	        (fabs(imag(prev_incident_field.reverse_field))>=1e150*imag_exponent)) {
-        	    incident_field.forward_field=prev_incident_field.forward_field*1e150;
-            	incident_field.reverse_field=prev_incident_field.reverse_field/1e150;
-            	overflow_count++;
+	        if ((fabs(real(sweep.prev_field.reverse_field))>=1e150*imag_exponent) ||
+    	        (fabs(imag(sweep.prev_field.reverse_field))>=1e150*imag_exponent)) {
+        	    incident_field.forward_field=sweep.prev_field.forward_field*1e150;
+            	incident_field.reverse_field=sweep.prev_field.reverse_field/1e150;
+            	sweep.overflow_count++;
 	        }
     	    else {
-        		incident_field.forward_field=prev_incident_field.forward_field;
-            	incident_field.reverse_field=prev_incident_field.reverse_field;
+        		incident_field.forward_field=sweep.prev_field.forward_field;
+            	incident_field.reverse_field=sweep.prev_field.reverse_field;
             }
         }
 
@@ -269,16 +270,16 @@ void TGrid::comp_incident_optical_field(int start_node_number)
 		incident_field.reverse_field*=reverse_propag_param;
 
 		if (effects & GRID_INCIDENT_REFLECTION) {
-			impedance_sum=prev_impedance+incident_impedance;
-			impedance_diff=prev_impedance-incident_impedance;
+			impedance_sum=sweep.prev_impedance+incident_impedance;
+			impedance_diff=sweep.prev_impedance-incident_impedance;
 
 			temp_forward_field=incident_field.forward_field;
 			temp_reverse_field=incident_field.reverse_field;
 
 			incident_field.forward_field=(temp_forward_field*impedance_sum+
-										  temp_reverse_field*impedance_diff)/(2.0*prev_impedance);
+										  temp_reverse_field*impedance_diff)/(2.0*sweep.prev_impedance);
 			incident_field.reverse_field=(temp_forward_field*impedance_diff+
-										  temp_reverse_field*impedance_sum)/(2.0*prev_impedance);
+										  temp_reverse_field*impedance_sum)/(2.0*sweep.prev_impedance);
 		}
 	}
 
@@ -293,21 +294,23 @@ void TGrid::comp_incident_optical_field(int start_node_number)
 		incident_field.reverse_poynting=0.5*norm(incident_field.reverse_field);
 	}
 
-    incident_field.overflow_count=overflow_count;
+    incident_field.overflow_count=sweep.overflow_count;
 
-	prev_position=position;
-	prev_impedance=incident_impedance;
-	prev_incident_field.forward_field=incident_field.forward_field;
-	prev_incident_field.reverse_field=incident_field.reverse_field;
+	sweep.prev_position=position;
+	sweep.prev_impedance=incident_impedance;
+	sweep.prev_field.forward_field=incident_field.forward_field;
+	sweep.prev_field.reverse_field=incident_field.reverse_field;
 }
 
 void TGrid::comp_incident_refractive_index(void)
 {
+	TMaterialStorage& material_parameters=context->material_parameters;
+	NormalizeConstants& normalization=context->normalization;
 	prec equil_band_gap;
 	prec band_gap_values[]= { material.alloy_conc, 300.0, position*normalization.length/1e-4 };
 
 	equil_band_gap=material_parameters.evaluate(MAT_BAND_GAP,material.material_type,material.alloy_type,
-												band_gap_values);
+														 band_gap_values);
 
 	prec values[]= { material.alloy_conc,
 					 lattice_temp*normalization.temp,
@@ -320,10 +323,10 @@ void TGrid::comp_incident_refractive_index(void)
 //		incident_refractive_index.absorption=qw_ptr->incident_absorption/qw_ptr->qw_length;
 //	else
 		incident_refractive_index.absorption=material_parameters.evaluate(MAT_ABSORPTION,material.material_type,
-																		  material.alloy_type,values)*normalization.length;
+																				   material.alloy_type,values)*normalization.length;
 
 	incident_refractive_index.real_part=material_parameters.evaluate(MAT_REFRACTIVE_INDEX,material.material_type,
-																	 material.alloy_type,values);
+																			  material.alloy_type,values);
 }
 
 void TGrid::comp_incident_impedance(void)
@@ -338,7 +341,7 @@ void TGrid::comp_incident_impedance(void)
 
 void TGrid::comp_incident_total_poynting(prec intensity_multiplier, int max_overflow_count)
 {
-	static complex i(0,1.0);
+	complex i(0,1.0);
 
     if (max_overflow_count==incident_field.overflow_count) {
 		incident_field.forward_poynting*=intensity_multiplier;
@@ -377,50 +380,49 @@ void TGrid::comp_incident_total_poynting(prec intensity_multiplier, int max_over
 	incident_field.total_magnitude=sqrt(norm(incident_field.forward_field+incident_field.reverse_field));
 }
 
-void TGrid::comp_mode_optical_field(int start_node_number)
+void TGrid::comp_mode_optical_field(int start_node_number, OpticalFieldSweep& sweep)
 {
 	complex i(0,1);
-	static prec prev_position, wave_vector;
-	static complex prev_impedance;
-	static OpticalField prev_mode_field;
 	complex forward_propag_param, reverse_propag_param;
 	complex impedance_sum, impedance_diff;
 	complex temp_forward_field, temp_reverse_field;
 
 	if (node_number==start_node_number) {
-		wave_vector=2.0*SIM_pi/get_value(GRID_OPTICAL,MODE_PHOTON_WAVELENGTH,NORMALIZED);
+		sweep.wave_vector=2.0*SIM_pi/get_value(GRID_OPTICAL,MODE_PHOTON_WAVELENGTH,NORMALIZED);
 	}
 	else {
-		forward_propag_param=exp(-i*wave_vector*(position-prev_position)/prev_impedance);
-		reverse_propag_param=exp(i*wave_vector*(position-prev_position)/prev_impedance);
+		forward_propag_param=exp(-i*sweep.wave_vector*(position-sweep.prev_position)/sweep.prev_impedance);
+		reverse_propag_param=exp(i*sweep.wave_vector*(position-sweep.prev_position)/sweep.prev_impedance);
 
-		temp_forward_field=prev_mode_field.forward_field*forward_propag_param;
-		temp_reverse_field=prev_mode_field.reverse_field*reverse_propag_param;
+		temp_forward_field=sweep.prev_field.forward_field*forward_propag_param;
+		temp_reverse_field=sweep.prev_field.reverse_field*reverse_propag_param;
 
-		impedance_sum=prev_impedance+mode_impedance;
-		impedance_diff=prev_impedance-mode_impedance;
+		impedance_sum=sweep.prev_impedance+mode_impedance;
+		impedance_diff=sweep.prev_impedance-mode_impedance;
 
 		mode_field.forward_field=(temp_forward_field*impedance_sum+
-								  temp_reverse_field*impedance_diff)/(2.0*prev_impedance);
+								  temp_reverse_field*impedance_diff)/(2.0*sweep.prev_impedance);
 		mode_field.reverse_field=(temp_forward_field*impedance_diff+
-								  temp_reverse_field*impedance_sum)/(2.0*prev_impedance);
+								  temp_reverse_field*impedance_sum)/(2.0*sweep.prev_impedance);
 	}
 
 	mode_field.total_magnitude=sqrt(norm(mode_field.forward_field+mode_field.reverse_field));
 
-	prev_position=position;
-	prev_impedance=mode_impedance;
-	prev_mode_field.forward_field=mode_field.forward_field;
-	prev_mode_field.reverse_field=mode_field.reverse_field;
+	sweep.prev_position=position;
+	sweep.prev_impedance=mode_impedance;
+	sweep.prev_field.forward_field=mode_field.forward_field;
+	sweep.prev_field.reverse_field=mode_field.reverse_field;
 }
 
 void TGrid::comp_mode_refractive_index(void)
 {
+	TMaterialStorage& material_parameters=context->material_parameters;
+	NormalizeConstants& normalization=context->normalization;
 	prec equil_band_gap;
 	prec band_gap_values[]= { material.alloy_conc, 300.0, position*normalization.length/1e-4 };
 
 	equil_band_gap=material_parameters.evaluate(MAT_BAND_GAP,material.material_type,material.alloy_type,
-										        band_gap_values);
+														 band_gap_values);
 
 	prec values[]= { material.alloy_conc,
 					 lattice_temp*normalization.temp,
@@ -451,13 +453,14 @@ void TGrid::comp_mode_impedance(void)
 
 void TGrid::comp_permitivity(void)
 {
-	prec values[]= { material.alloy_conc, position*normalization.length/1e-4 };
+	prec values[]= { material.alloy_conc, position*context->normalization.length/1e-4 };
 
-	permitivity=material_parameters.evaluate(MAT_PERMITIVITY,material.material_type,material.alloy_type,values);
+	permitivity=context->material_parameters.evaluate(MAT_PERMITIVITY,material.material_type,material.alloy_type,values);
 }
 
 void TGrid::comp_thermal_conductivity(void)
 {
+	NormalizeConstants& normalization=context->normalization;
 	prec evaluation_temp;
 
 	if (effects & GRID_TEMP_THERMAL_COND) evaluation_temp=lattice_temp*normalization.temp;
@@ -465,33 +468,35 @@ void TGrid::comp_thermal_conductivity(void)
 
 	prec values[]= { material.alloy_conc, evaluation_temp, position*normalization.length/1e-4 };
 
-	thermal_conduct=material_parameters.evaluate(MAT_THERMAL_CONDUCTIVITY,material.material_type,material.alloy_type,
-												 values)/normalization.therm_cond;
+	thermal_conduct=context->material_parameters.evaluate(MAT_THERMAL_CONDUCTIVITY,material.material_type,material.alloy_type,
+														  values)/normalization.therm_cond;
 }
 
 void TGrid::comp_lateral_thermal_conduct(void)
 {
+	NormalizeConstants& normalization=context->normalization;
 	prec env_radius, env_temp,new_conduct;
 	prec evaluation_temp;
 
-	env_radius=environment.get_value(ENVIRONMENT,RADIUS,0,NORMALIZED);
+	env_radius=context->environment.get_value(ENVIRONMENT,RADIUS,0,NORMALIZED);
 
 	if (effects & GRID_TEMP_THERMAL_COND) {
-		env_temp=environment.get_value(ENVIRONMENT,TEMPERATURE,0,NORMALIZED);
+		env_temp=context->environment.get_value(ENVIRONMENT,TEMPERATURE,0,NORMALIZED);
 		evaluation_temp=(lattice_temp+env_temp)*normalization.temp/2.0;
 	}
 	else evaluation_temp=300.0;
 
 	prec values[]= { material.alloy_conc, evaluation_temp, position*normalization.length/1e-4 };
 
-	new_conduct=material_parameters.evaluate(MAT_THERMAL_CONDUCTIVITY,material.material_type,material.alloy_type,
-											 values)/normalization.therm_cond;
+	new_conduct=context->material_parameters.evaluate(MAT_THERMAL_CONDUCTIVITY,material.material_type,material.alloy_type,
+													  values)/normalization.therm_cond;
 
 	lateral_thermal_conduct=2.0*new_conduct/(sq(radius)*log(env_radius/radius));
 }
 
 prec TGrid::get_value(FlagType flag_type, flag flag_value, ScaleType scale)
 {
+	NormalizeConstants& normalization=context->normalization;
 	prec return_value;
 
 	switch(flag_type) {
@@ -558,14 +563,15 @@ prec TGrid::get_value(FlagType flag_type, flag flag_value, ScaleType scale)
 			break;
 	}
 
-	if (scale==UNNORMALIZED) return_value*=get_normalize_value(flag_type, flag_value);
+	if (scale==UNNORMALIZED) return_value*=get_normalize_value(context,flag_type, flag_value);
 	return(return_value);
 }
 
 void TGrid::put_value(FlagType flag_type, flag flag_value, prec value,
 					  ScaleType scale)
 {
-	if (scale==UNNORMALIZED) value/=get_normalize_value(flag_type, flag_value);
+	NormalizeConstants& normalization=context->normalization;
+	if (scale==UNNORMALIZED) value/=get_normalize_value(context,flag_type, flag_value);
 
 	switch(flag_type) {
 		case GRID_ELECTRICAL:
@@ -47,16 +47,17 @@ public:
 	TDeviceFileInput(const TDeviceFileInput& new_device_input)
 		{ clear_contents(); copy_contents(new_device_input); }
 	~TDeviceFileInput(void) { delete_contents(); }
-	void add_grid(GridInput new_grid);
-	void add_doping(DopingInput new_doping);
-	void add_material_param(MaterialParam param_number, MaterialParamInput new_param);
-	void add_structure(StructureInput new_structure);
-	void add_region(RegionInput new_region);
-	void add_cavity(CavityInput new_cavity);
-	void add_mirror(MirrorInput new_mirror);
+	void add_grid(TSimulationContext *context, GridInput new_grid);
+	void add_doping(TSimulationContext *context, DopingInput new_doping);
+	void add_material_param(TSimulationContext *context, MaterialParam param_number,
+							MaterialParamInput new_param);
+	void add_structure(TSimulationContext *context, StructureInput new_structure);
+	void add_region(TSimulationContext *context, RegionInput new_region);
+	void add_cavity(TSimulationContext *context, CavityInput new_cavity);
+	void add_mirror(TSimulationContext *context, MirrorInput new_mirror);
 	void add_radius(prec new_radius) { radius=new_radius; }
 	void apply_defaults(void);
-	void check_device(void);
+	void check_device(TSimulationContext *context);
 	void delete_contents(void);
 	RegionType get_region_type(prec position);
 	AlloyType get_alloy_type(prec position);
@@ -81,13 +82,13 @@ private:
 
 ***********************************************************************************************/
 
-void TDeviceFileInput::add_grid(GridInput new_grid)
+void TDeviceFileInput::add_grid(TSimulationContext *context, GridInput new_grid)
 {
 	GridInput *temp_ptr;
 
 	temp_ptr=(GridInput *)realloc(grid_ptr,(number_grid+1)*sizeof(GridInput));
 	if (!temp_ptr) {
-		error_handler.set_error(ERROR_MEM_DEVICE_INPUT,0,"","");
+		context->error_handler.set_error(ERROR_MEM_DEVICE_INPUT,0,"","");
 		return;
 	}
 
@@ -98,7 +99,7 @@ void TDeviceFileInput::add_grid(GridInput new_grid)
 	total_points+=new_grid.number_points;
 }
 
-void TDeviceFileInput::add_doping(DopingInput new_doping)
+void TDeviceFileInput::add_doping(TSimulationContext *context, DopingInput new_doping)
 {
 	DopingInput *temp_ptr;
 
@@ -107,7 +108,7 @@ void TDeviceFileInput::add_doping(DopingInput new_doping)
 
 	temp_ptr=(DopingInput *)realloc(doping_ptr,(number_doping+1)*sizeof(DopingInput));
 	if (!temp_ptr) {
-		error_handler.set_error(ERROR_MEM_DEVICE_INPUT,0,"","");
+		context->error_handler.set_error(ERROR_MEM_DEVICE_INPUT,0,"","");
 		return;
 	}
 
@@ -122,7 +123,7 @@ void TDeviceFileInput::add_doping(DopingInput new_doping)
 	number_doping++;
 }
 
-void TDeviceFileInput::add_material_param(MaterialParam param_number,
+void TDeviceFileInput::add_material_param(TSimulationContext *context, MaterialParam param_number,
 										  MaterialParamInput new_param)
 {
 	MaterialParamInput *temp_ptr;
@@ -131,7 +132,7 @@ void TDeviceFileInput::add_material_param(MaterialParam param_number,
 	temp_ptr=(MaterialParamInput *)realloc(material_param_input[param_number-1],
 										   (number_material_param[param_number-1]+1)*sizeof(MaterialParamInput));
 	if (!temp_ptr) {
-		error_handler.set_error(ERROR_MEM_DEVICE_INPUT,0,"","");
+		context->error_handler.set_error(ERROR_MEM_DEVICE_INPUT,0,"","");
 		return;
 	}
 
@@ -142,7 +143,7 @@ void TDeviceFileInput::add_material_param(MaterialParam param_number,
 	number_material_param[param_number-1]++;
 }
 
-void TDeviceFileInput::add_structure(StructureInput new_structure)
+void TDeviceFileInput::add_structure(TSimulationContext *context, StructureInput new_structure)
 {
 	StructureInput *temp_ptr;
 
@@ -150,7 +151,7 @@ void TDeviceFileInput::add_structure(StructureInput new_structure)
 
 	temp_ptr=(StructureInput *)realloc(structure_ptr,(number_structure+1)*sizeof(StructureInput));
 	if (!temp_ptr) {
-		error_handler.set_error(ERROR_MEM_DEVICE_INPUT,0,"","");
+		context->error_handler.set_error(ERROR_MEM_DEVICE_INPUT,0,"","");
 		return;
 	}
 
@@ -163,13 +164,13 @@ void TDeviceFileInput::add_structure(StructureInput new_structure)
 	number_structure++;
 }
 
-void TDeviceFileInput::add_region(RegionInput new_region)
+void TDeviceFileInput::add_region(TSimulationContext *context, RegionInput new_region)
 {
 	RegionInput *temp_ptr;
 
 	temp_ptr=(RegionInput *)realloc(region_ptr,(number_region+1)*sizeof(RegionInput));
 	if (!temp_ptr) {
-		error_handler.set_error(ERROR_MEM_DEVICE_INPUT,0,"","");
+		context->error_handler.set_error(ERROR_MEM_DEVICE_INPUT,0,"","");
 		return;
 	}
 
@@ -180,18 +181,18 @@ void TDeviceFileInput::add_region(RegionInput new_region)
 	number_region++;
 }
 
-void TDeviceFileInput::add_cavity(CavityInput new_cavity)
+void TDeviceFileInput::add_cavity(TSimulationContext *context, CavityInput new_cavity)
 {
 	CavityInput *temp_ptr;
 
 	if (number_cavity==1) {
-		error_handler.set_error(ERROR_DEVICE_NUMBER_CAVITY,0,"","");
+		context->error_handler.set_error(ERROR_DEVICE_NUMBER_CAVITY,0,"","");
 		return;
 	}
 
 	temp_ptr=(CavityInput *)realloc(cavity_ptr,(number_cavity+1)*sizeof(CavityInput));
 	if (!temp_ptr) {
-		error_handler.set_error(ERROR_MEM_DEVICE_INPUT,0,"","");
+		context->error_handler.set_error(ERROR_MEM_DEVICE_INPUT,0,"","");
 		return;
 	}
 
@@ -202,8 +203,9 @@ void TDeviceFileInput::add_cavity(CavityInput new_cavity)
 	number_cavity++;
 }
 
-void TDeviceFileInput::add_mirror(MirrorInput new_mirror)
+void TDeviceFileInput::add_mirror(TSimulationContext *context, MirrorInput new_mirror)
 {
+	TErrorHandler& error_handler=context->error_handler;
 	MirrorInput *temp_ptr;
 
 	if (number_mirror==2) {
@@ -229,8 +231,9 @@ void TDeviceFileInput::add_mirror(MirrorInput new_mirror)
 	number_mirror++;
 }
 
-void TDeviceFileInput::check_device(void)
+void TDeviceFileInput::check_device(TSimulationContext *context)
 {
+	TErrorHandler& error_handler=context->error_handler;
 	int i;
 	MaterialParam j;
 	prec grid_total_length=0, region_total_length=0, doping_total_length=0;
@@ -655,7 +658,7 @@ void TDeviceFileInput::clear_contents(void)
 	structure_ptr=(StructureInput *)0;
 	number_region=0;
 	number_qw=0;
-	region_ptr=(StructureInput *)0;
+	region_ptr=(RegionInput *)0;
 	number_cavity=0;
 	cavity_ptr=(CavityInput *)0;
 	number_mirror=0;
@@ -668,6 +671,9 @@ void TDeviceFileInput::clear_contents(void)
 	}
 }
 
+/*
+	The input is copied by value, so a failed copy is reported to current_context.
+*/
 void TDeviceFileInput::copy_contents(const TDeviceFileInput& new_device_input)
 {
 	int i;
@@ -675,8 +681,9 @@ void TDeviceFileInput::copy_contents(const TDeviceFileInput& new_device_input)
 	MaterialParamInput new_param_input;
 	DopingInput new_doping;
 	StructureInput new_structure;
+	TSimulationContext *context=current_context;
 
-	for (i=0;i<new_device_input.number_grid;i++) add_grid(*(new_device_input.grid_ptr+i));
+	for (i=0;i<new_device_input.number_grid;i++) add_grid(context,*(new_device_input.grid_ptr+i));
 	for (i=0;i<new_device_input.number_doping;i++) {
 		new_doping.length=(new_device_input.doping_ptr+i)->length;
 		new_doping.acceptor_function=(new_device_input.doping_ptr+i)->acceptor_function->create_copy();
@@ -685,7 +692,7 @@ void TDeviceFileInput::copy_contents(const TDeviceFileInput& new_device_input)
 		new_doping.acceptor_level=(new_device_input.doping_ptr+i)->acceptor_level;
 		new_doping.donor_degeneracy=(new_device_input.doping_ptr+i)->donor_degeneracy;
 		new_doping.donor_level=(new_device_input.doping_ptr+i)->donor_level;
-		add_doping(new_doping);
+		add_doping(context,new_doping);
 	}
 
 	for (i=0;i<new_device_input.number_structure;i++) {
@@ -693,12 +700,12 @@ void TDeviceFileInput::copy_contents(const TDeviceFileInput& new_device_input)
 		new_structure.alloy_type=(new_device_input.structure_ptr+i)->alloy_type;
 		new_structure.length=(new_device_input.structure_ptr+i)->length;
 		new_structure.alloy_function=(new_device_input.structure_ptr+i)->alloy_function->create_copy();
-		add_structure(new_structure);
+		add_structure(context,new_structure);
 	}
 
-	for (i=0;i<new_device_input.number_region;i++) add_region(*(new_device_input.region_ptr+i));
-	for (i=0;i<new_device_input.number_cavity;i++) add_cavity(*(new_device_input.cavity_ptr+i));
-	for (i=0;i<new_device_input.number_mirror;i++) add_mirror(*(new_device_input.mirror_ptr+i));
+	for (i=0;i<new_device_input.number_region;i++) add_region(context,*(new_device_input.region_ptr+i));
+	for (i=0;i<new_device_input.number_cavity;i++) add_cavity(context,*(new_device_input.cavity_ptr+i));
+	for (i=0;i<new_device_input.number_mirror;i++) add_mirror(context,*(new_device_input.mirror_ptr+i));
 	radius=new_device_input.radius;
 
 	for (j=1;j<=MAT_MAX_NUMBER_PARAMETERS;j++) {
@@ -706,7 +713,7 @@ void TDeviceFileInput::copy_contents(const TDeviceFileInput& new_device_input)
 			new_param_input.length=(new_device_input.material_param_input[j-1]+i)->length;
 			new_param_input.material_model=
 				new TMaterialParamModel(*((new_device_input.material_param_input[j-1]+i)->material_model));
-			add_material_param(j,new_param_input);
+			add_material_param(context,j,new_param_input);
 		}
 	}
 
@@ -38,6 +38,10 @@ public:
 };
 */
 
+/*
+	The material models are copied with the device input and the material storage, where no
+	context can be passed, so their memory errors are reported to the context of the thread.
+*/
 TMaterialParamModel::TMaterialParamModel(const TMaterialParamModel& new_model)
 {
 	int i;
@@ -46,7 +50,7 @@ TMaterialParamModel::TMaterialParamModel(const TMaterialParamModel& new_model)
 
 	function=(TPieceWiseFunction **)malloc(number_functions*sizeof(TPieceWiseFunction *));
 	if (!function) {
-		error_handler.set_error(ERROR_MEM_MATERIAL_MODEL,0,"","");
+		current_context->error_handler.set_error(ERROR_MEM_MATERIAL_MODEL,0,"","");
 		return;
 	}
 
@@ -71,7 +75,7 @@ void TMaterialParamModel::add_function(TPieceWiseFunction *new_function)
 
 	temp_ptr=(TPieceWiseFunction **)realloc(function,(number_functions+1)*sizeof(TPieceWiseFunction *));
 	if (!temp_ptr) {
-		error_handler.set_error(ERROR_MEM_MATERIAL_MODEL,0,"","");
+		current_context->error_handler.set_error(ERROR_MEM_MATERIAL_MODEL,0,"","");
 		return;
 	}
 	function=temp_ptr;
@@ -105,7 +109,7 @@ void TMaterialParamModel::read_state_file(FILE *file_ptr)
 
 	function=(TPieceWiseFunction **)malloc(number_functions*sizeof(TPieceWiseFunction *));
 	if (!function) {
-		error_handler.set_error(ERROR_MEM_MATERIAL_MODEL,0,"","");
+		current_context->error_handler.set_error(ERROR_MEM_MATERIAL_MODEL,0,"","");
 		return;
 	}
 	for (i=0;i<number_functions;i++) function[i]=new TPieceWiseFunction(file_ptr);
@@ -120,6 +124,7 @@ private:
 	TMaterialParamModel *parameters[MAT_MAX_NUMBER_PARAMETERS];
 public:
 	TAlloy(string& alloy_name);
+	TAlloy(const TAlloy& new_alloy);
 	~TAlloy(void);
 	void add_model(MaterialParam param, TMaterialParamModel *new_model)
 		{ assert((param>=1) && (param<=MAT_MAX_NUMBER_PARAMETERS));
@@ -136,6 +141,16 @@ TAlloy::TAlloy(string& alloy_name)
 	for (i=0;i<MAT_MAX_NUMBER_PARAMETERS;i++) parameters[i]=(TMaterialParamModel *)NULL;
 }
 
+TAlloy::TAlloy(const TAlloy& new_alloy)
+	: name(new_alloy.name)
+{
+	int i;
+	for (i=0;i<MAT_MAX_NUMBER_PARAMETERS;i++) {
+		if (new_alloy.parameters[i]!=(TMaterialParamModel *)NULL)
+			parameters[i]=new TMaterialParamModel(*new_alloy.parameters[i]);
+		else parameters[i]=(TMaterialParamModel *)NULL;
+	}
+}
 
 TAlloy::~TAlloy(void)
 {
@@ -155,6 +170,7 @@ private:
 	TAlloy **alloys;
 public:
 	TMaterial(string& material_name) : name(material_name) { number_alloys=0; alloys=(TAlloy **)0; }
+	TMaterial(const TMaterial& new_material);
 	~TMaterial(void);
 	void add_alloy(string& alloy_name);
 	logical valid_alloy(string& alloy_name);
@@ -172,6 +188,21 @@ public:
 
 */
 
+TMaterial::TMaterial(const TMaterial& new_material)
+	: name(new_material.name)
+{
+	int i;
+
+	number_alloys=0;
+	alloys=(TAlloy **)malloc(new_material.number_alloys*sizeof(TAlloy *));
+	if (new_material.number_alloys && !alloys) {
+		current_context->error_handler.set_error(ERROR_MEM_ALLOY,0,"","");
+		return;
+	}
+	for (i=0;i<new_material.number_alloys;i++) alloys[i]=new TAlloy(*new_material.alloys[i]);
+	number_alloys=new_material.number_alloys;
+}
+
 TMaterial::~TMaterial(void)
 {
 	int i;
@@ -186,7 +217,7 @@ void TMaterial::add_alloy(string& alloy_name)
 
 	temp_ptr=(TAlloy **)realloc(alloys,(number_alloys+1)*sizeof(TAlloy *));
 	if (!temp_ptr) {
-		error_handler.set_error(ERROR_MEM_ALLOY,0,"","");
+		current_context->error_handler.set_error(ERROR_MEM_ALLOY,0,"","");
 		return;
 	}
 	alloys=temp_ptr;
@@ -224,14 +255,16 @@ string TMaterial::get_alloy_name(AlloyType alloy_type)
 
 class TMaterialStorage {
 private:
+	TSimulationContext *context;
 	logical ready;
 	int number_materials;
 	TMaterial **materials;
 	TDeviceFileInput *device_file;
 public:
-	TMaterialStorage(void);
+	TMaterialStorage(TSimulationContext *new_context);
 	~TMaterialStorage(void) { clear(); }
 	void clear(void);
+	void copy(const TMaterialStorage& new_storage);
 	void add_material(string& material_name);
 	void add_alloy(string& material_name, string& alloy_name)
 		{ assert(valid_material(material_name));
@@ -272,8 +305,9 @@ public:
 
 */
 
-TMaterialStorage::TMaterialStorage(void)
+TMaterialStorage::TMaterialStorage(TSimulationContext *new_context)
 {
+	context=new_context;
 	ready=FALSE;
 	number_materials=0;
 	materials=(TMaterial **)0;
@@ -293,13 +327,36 @@ void TMaterialStorage::clear(void)
 	ready=FALSE;
 }
 
+/*
+	Replaces the stored materials with copies of the materials in new_storage, e.g.
+	to give another simulation context its own material parameters. Device file
+	overrides are not copied, they belong to the device of each context.
+*/
+void TMaterialStorage::copy(const TMaterialStorage& new_storage)
+{
+	int i;
+
+	clear();
+
+	if (new_storage.number_materials) {
+		materials=(TMaterial **)malloc(new_storage.number_materials*sizeof(TMaterial *));
+		if (!materials) {
+			context->error_handler.set_error(ERROR_MEM_MATERIAL,0,"","");
+			return;
+		}
+	}
+	for (i=0;i<new_storage.number_materials;i++) materials[i]=new TMaterial(*new_storage.materials[i]);
+	number_materials=new_storage.number_materials;
+	ready=new_storage.ready;
+}
+
 void TMaterialStorage::add_material(string& material_name)
 {
 	TMaterial **temp_ptr;
 
 	temp_ptr=(TMaterial **)realloc(materials,(number_materials+1)*sizeof(TMaterial *));
 	if (!temp_ptr) {
-		error_handler.set_error(ERROR_MEM_MATERIAL,0,"","");
+		context->error_handler.set_error(ERROR_MEM_MATERIAL,0,"","");
 		return;
 	}
 	materials=temp_ptr;
@@ -368,6 +425,7 @@ logical TMaterialStorage::valid_material(string& material_name)
 
 void TMaterialStorage::set_normalization(MaterialType material_type)
 {
+	NormalizeConstants& normalization=context->normalization;
 	prec electron_dos_mass, hole_dos_mass;
 	prec alloy_conc=0.0;
 
@@ -24,6 +24,7 @@
 
 class TMirror {
 private:
+	TSimulationContext *context;
 	TDevice *device_ptr;
 	MirrorType type;
 	prec position;
@@ -31,7 +32,7 @@ private:
 	prec reflectivity;
 	float output_power;
 public:
-	TMirror(TDevice *ptr);
+	TMirror(TSimulationContext *new_context, TDevice *ptr);
 	void init(void);
 
 	void comp_power(float photon_number, float photon_energy,
@@ -45,8 +46,9 @@ public:
 };
 */
 
-TMirror::TMirror(TDevice *ptr)
+TMirror::TMirror(TSimulationContext *new_context, TDevice *ptr)
 {
+	context=new_context;
 	device_ptr=ptr;
 	type=(MirrorType) 0;
 	reflectivity=0.0;
@@ -79,27 +81,27 @@ prec TMirror::get_value(flag flag_value, ScaleType scale)
 		default: assert(FALSE); break;
 	}
 
-	if (scale==UNNORMALIZED) return_value*=get_normalize_value(MIRROR,flag_value);
+	if (scale==UNNORMALIZED) return_value*=get_normalize_value(context,MIRROR,flag_value);
 	return(return_value);
 }
 
 void TMirror::put_value(flag flag_value, prec value, ScaleType scale)
 {
-	if (scale==UNNORMALIZED) value/=get_normalize_value(MIRROR,flag_value);
+	if (scale==UNNORMALIZED) value/=get_normalize_value(context,MIRROR,flag_value);
 
 	switch(flag_value) {
 		case TYPE: type=(MirrorType)value; return;
 		case REFLECTIVITY:
 			if (reflectivity!=value) {
 				reflectivity=value;
-				environment.set_update_flags(MIRROR,REFLECTIVITY);
+				context->environment.set_update_flags(MIRROR,REFLECTIVITY);
 			}
 			return;
 		case POSITION:
 			if (value!=position) {
 				position=value;
 				node_number=device_ptr->get_node(position,-1,-1,NORMALIZED);
-				environment.set_update_flags(MIRROR,POSITION);
+				context->environment.set_update_flags(MIRROR,POSITION);
 			}
 			return;
 		case NODE_NUMBER:
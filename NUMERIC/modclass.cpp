@@ -28,6 +28,7 @@
 
 class TMode {
 private:
+	TSimulationContext *context;
 	TNode** grid_ptr;
 	flag effects;
 	prec total_photons;
@@ -42,8 +43,9 @@ private:
 	prec mirror_loss;
 	prec waveguide_loss;
 	prec energy;
+	int error_sign;
 public:
-	TMode(TNode** grid);
+	TMode(TSimulationContext *new_context, TNode** grid);
 	void init(void);
 
 	void comp_group_velocity(int start_node, int end_node);
@@ -65,8 +67,9 @@ public:
 };
 */
 
-TMode::TMode(TNode** grid)
+TMode::TMode(TSimulationContext *new_context, TNode** grid)
 {
+	context=new_context;
 	grid_ptr=grid;
 	total_photons=0.0;
 	previous_total_photons=0.0;
@@ -81,6 +84,7 @@ TMode::TMode(TNode** grid)
 	energy=0.0;
 	waveguide_loss=0.0;
 	effects=0.0;
+	error_sign=0;
 }
 
 void TMode::init(void)
@@ -90,7 +94,7 @@ void TMode::init(void)
 	previous_mode_gain=0.0;
 	total_spont=0.0;
 	previous_total_spont=0.0;
-	environment.put_value(GRID_OPTICAL,MODE_TOTAL_PHOTONS,0.0,-1,-1,NORMALIZED);
+	context->environment.put_value(GRID_OPTICAL,MODE_TOTAL_PHOTONS,0.0,-1,-1,NORMALIZED);
 }
 
 void TMode::comp_group_velocity(int start_node, int end_node)
@@ -121,7 +125,7 @@ void TMode::comp_group_velocity(int start_node, int end_node)
 
 	average_index/=(next_position-first_position);
 
-	group_velocity=SIM_c/(average_index*get_normalize_value(MODE,MODE_GROUP_VELOCITY));
+	group_velocity=SIM_c/(average_index*get_normalize_value(context,MODE,MODE_GROUP_VELOCITY));
 }
 
 void TMode::comp_mirror_loss(prec reflectivity_1, prec reflectivity_2,
@@ -157,12 +161,13 @@ void TMode::comp_mode_gain(int start_node, int end_node, prec cavity_area)
 		previous_position=next_position;
 	}
 
-	mode_gain*=cavity_area*sq(get_normalize_value(GRID_OPTICAL,MODE_TOTAL_FIELD_MAG))*1e12*
-							  pow(normalization.length,3.0);
+	mode_gain*=cavity_area*sq(get_normalize_value(context,GRID_OPTICAL,MODE_TOTAL_FIELD_MAG))*1e12*
+							  pow(context->normalization.length,3.0);
 }
 
 void TMode::comp_mode_normalization(int start_node, int end_node, prec cavity_area)
 {
+	TEnvironment& environment=context->environment;
 	int i;
 	prec normalization_value;
 	prec previous_value, previous_position;
@@ -187,8 +192,8 @@ void TMode::comp_mode_normalization(int start_node, int end_node, prec cavity_ar
 		previous_position=next_position;
 	}
 
-	normalization_value*=cavity_area*sq(get_normalize_value(GRID_OPTICAL,MODE_TOTAL_FIELD_MAG))*1e12*
-									 pow(normalization.length,3.0);
+	normalization_value*=cavity_area*sq(get_normalize_value(context,GRID_OPTICAL,MODE_TOTAL_FIELD_MAG))*1e12*
+									 pow(context->normalization.length,3.0);
 	normalization_value=sqrt(normalization_value);
 
 	if (normalization_value) {
@@ -213,7 +218,9 @@ void TMode::comp_mode_normalization(int start_node, int end_node, prec cavity_ar
 
 void TMode::comp_mode_optical_field(int start_node, int end_node)
 {
+	TEnvironment& environment=context->environment;
 	TNode** temp_grid_ptr;
+	OpticalFieldSweep sweep;
 
 	assert(start_node<end_node);
 
@@ -227,7 +234,7 @@ void TMode::comp_mode_optical_field(int start_node, int end_node)
 	for (temp_grid_ptr=grid_ptr+end_node;
 		 temp_grid_ptr>=grid_ptr+start_node;
 		 temp_grid_ptr--) {
-		(*temp_grid_ptr)->comp_mode_optical_field(end_node);
+		(*temp_grid_ptr)->comp_mode_optical_field(end_node,sweep);
 	}
 	environment.comp_value(SURFACE,MODE_SURFACE_FIELD,0);
 }
@@ -262,12 +269,12 @@ void TMode::comp_total_spontaneous(int start_node, int end_node, prec cavity_are
 		previous_position=next_position;
 	}
 
-	total_spont*=spont_factor*cavity_area*normalization.conc*pow(normalization.length,3.0);
+	total_spont*=spont_factor*cavity_area*context->normalization.conc*pow(context->normalization.length,3.0);
 }
 
 error TMode::field_iterate(prec& iteration_error, prec initial_error, int iteration_number)
 {
-	static error_sign;
+	TEnvironment& environment=context->environment;
 	prec curr_wavelength;
 	prec next_forward_poynting, prev_forward_poynting, curr_forward_poynting;
 
@@ -316,6 +323,7 @@ error TMode::field_iterate(prec& iteration_error, prec initial_error, int iterat
 
 error TMode::photon_iterate(prec& iteration_error)
 {
+	TEnvironment& environment=context->environment;
 	prec rate_function;
 	prec deriv_rate_function, deriv_gain, deriv_spont;
 	prec photon_update;
@@ -371,20 +379,21 @@ prec TMode::get_value(flag flag_value, ScaleType scale)
 		case SPONT_FACTOR: return_value=spont_factor; break;
 		case MODE_GROUP_VELOCITY: return_value=group_velocity; break;
 		case MODE_PHOTON_ENERGY: return_value=energy; break;
-		case MODE_PHOTON_WAVELENGTH: return_value=(1.242/(energy*normalization.energy))*1e-4/normalization.length; break;
+		case MODE_PHOTON_WAVELENGTH: return_value=(1.242/(energy*context->normalization.energy))*1e-4/context->normalization.length; break;
 		case MIRROR_LOSS: return_value=mirror_loss; break;
 		case WAVEGUIDE_LOSS: return_value=waveguide_loss; break;
 		case TOTAL_SPONTANEOUS: return_value=total_spont; break;
 		default: assert(FALSE); break;
 	}
 
-	if (scale==UNNORMALIZED) return_value*=get_normalize_value(MODE,flag_value);
+	if (scale==UNNORMALIZED) return_value*=get_normalize_value(context,MODE,flag_value);
 	return(return_value);
 }
 
 void TMode::put_value(flag flag_value, prec value, ScaleType scale)
 {
-	if (scale==UNNORMALIZED) value/=get_normalize_value(MODE, flag_value);
+	TEnvironment& environment=context->environment;
+	if (scale==UNNORMALIZED) value/=get_normalize_value(context,MODE, flag_value);
 
 	switch(flag_value) {
 		case MODE_TOTAL_PHOTONS: total_photons=value; return;
@@ -408,7 +417,7 @@ void TMode::put_value(flag flag_value, prec value, ScaleType scale)
 			}
 			return;
 		case MODE_PHOTON_WAVELENGTH:
-			value=(1.242/(value*normalization.length*1e4))/normalization.energy;
+			value=(1.242/(value*context->normalization.length*1e4))/context->normalization.energy;
 			if (energy!=value) {
 				energy=value;
 				environment.set_update_flags(MODE,MODE_PHOTON_ENERGY);
@@ -48,31 +48,41 @@ private:
 	RadiativeHeat radiative_heat;
 	prec total_heat;
 public:
-	TNode(int node_number, RegionType region_type, TQuantumWell *qw_ptr=NULL);
+	TNode(TSimulationContext *new_context, int node_number, RegionType region_type,
+		  TQuantumWell *qw_ptr=NULL);
 	void comp_charge(void)
 		{ total_charge=(THole::total_conc-TElectron::total_conc+
 						TElectron::ionized_doping_conc-THole::ionized_doping_conc); }
-	void comp_current(FlagType flag_type, int start_node_number);
+	void comp_current(FlagType flag_type, int start_node_number, CurrentSweep& sweep);
 	void comp_deriv_conc(void)
 		{ TElectron::comp_deriv_conc(); THole::comp_deriv_conc();
 		  TElectron::comp_deriv_ionized_doping(); THole::comp_deriv_ionized_doping(); }
+	void comp_deriv_ionized_doping(void)
+		{ TElectron::comp_deriv_ionized_doping(); THole::comp_deriv_ionized_doping(); }
+	static void comp_grid_conc(TNode **node_ptr, int nodes, FlagType flag_type);
+	static void comp_grid_deriv_conc(TNode **node_ptr, int nodes, FlagType flag_type);
+	static void comp_grid_hotcarriers(TNode **node_ptr, int nodes, FlagType flag_type, flag flag_value);
+	static void comp_grid_deriv_hotcarriers(TNode **node_ptr, int nodes, FlagType flag_type);
 	void comp_deriv_gain(void);
 	void comp_deriv_recomb(void);
-	void comp_deriv_electron_hotcarriers(void)
+	void comp_deriv_electron_hotcarriers(prec fermi_ratio=0.0)
 		{ TElectron::comp_deriv_hotcarriers(recombination,lattice_temp,intrinsic_conc,
-											TFreeHole::concentration, THole::shr_lifetime); }
-	void comp_deriv_hole_hotcarriers(void)
-		{ THole::comp_deriv_hotcarriers(recombination,lattice_temp); }
+											TFreeHole::concentration,
+                                            THole::shr_lifetime, THole::auger_coefficient, fermi_ratio); }
+	void comp_deriv_hole_hotcarriers(prec fermi_ratio=0.0)
+		{ THole::comp_deriv_hotcarriers(recombination,lattice_temp,intrinsic_conc,
+        							    TFreeElectron::concentration,
+                                        TElectron::shr_lifetime, TElectron::auger_coefficient, fermi_ratio); }
 	void comp_deriv_thermal_conduct(void)
 		{ TGrid::comp_deriv_thermal_conduct(); TGrid::comp_deriv_lateral_conduct(); }
-	void comp_field(int start_node_number)
-		{ TGrid::comp_field(start_node_number,total_charge); }
-	void comp_incident_optical_field(int start_node_number)
-		{ TGrid::comp_incident_optical_field(start_node_number); }
+	void comp_field(int start_node_number, FieldSweep& sweep)
+		{ TGrid::comp_field(start_node_number,total_charge,sweep); }
+	void comp_incident_optical_field(int start_node_number, OpticalFieldSweep& sweep)
+		{ TGrid::comp_incident_optical_field(start_node_number,sweep); }
 	void comp_incident_total_poynting(prec intensity_multiplier, int max_overflow_count)
 		{ TGrid::comp_incident_total_poynting(intensity_multiplier, max_overflow_count); }
-	void comp_mode_optical_field(int start_node_number)
-		{ TGrid::comp_mode_optical_field(start_node_number); }
+	void comp_mode_optical_field(int start_node_number, OpticalFieldSweep& sweep)
+		{ TGrid::comp_mode_optical_field(start_node_number,sweep); }
 	void comp_intrinsic_conc(void);
 	void comp_gain(void);
 	void comp_optical_generation(void);
@@ -86,6 +96,7 @@ public:
 	void comp_radiative_heat(void);
 	void comp_heat(void);
 	void comp_reduced_dos_mass(void);
+	void comp_hotcarriers(FlagType flag_type, flag flag_value, prec fermi_ratio=0.0);
 	void comp_value(FlagType flag_type, flag flag_value);
 	void store_temperature(void) { TElectron::store_temperature();
 		THole::store_temperature(); TGrid::store_temperature(); }
@@ -101,10 +112,11 @@ public:
 };
 */
 
-TNode::TNode(int node_number, RegionType region_type, TQuantumWell *qw_ptr)
-	: TElectron(region_type, qw_ptr),
-	  THole(region_type, qw_ptr),
-	  TGrid(node_number,region_type, qw_ptr)
+TNode::TNode(TSimulationContext *new_context, int node_number, RegionType region_type,
+			 TQuantumWell *qw_ptr)
+	: TElectron(new_context, region_type, qw_ptr),
+	  THole(new_context, region_type, qw_ptr),
+	  TGrid(new_context, node_number,region_type, qw_ptr)
 {
 	total_charge=0.0;
 	intrinsic_conc=0.0;
@@ -131,16 +143,16 @@ TNode::TNode(int node_number, RegionType region_type, TQuantumWell *qw_ptr)
 	total_heat=0.0;
 }
 
-void TNode::comp_current(FlagType flag_type, int start_node_number)
+void TNode::comp_current(FlagType flag_type, int start_node_number, CurrentSweep& sweep)
 {
 	if (flag_type==ELECTRON) {
 		TElectron::comp_current(start_node_number, node_number,
-								position, recombination.total);
+								position, recombination.total, sweep);
 	}
 
 	if (flag_type==HOLE) {
 		THole::comp_current(start_node_number, node_number,
-							position,recombination.total);
+							position,recombination.total, sweep);
 	}
 }
 
@@ -228,8 +240,10 @@ void TNode::comp_intrinsic_conc(void)
 				   exp(-band_gap/(2.0*lattice_temp));
 
 	if (TGrid::effects & GRID_FERMI_DIRAC) {
-		intrinsic_conc*=sqrt((fermi_integral_1_half(TElectron::equil_planck_potential)/exp(TElectron::equil_planck_potential))*
-							 (fermi_integral_1_half(THole::equil_planck_potential)/exp(THole::equil_planck_potential)));
+		intrinsic_conc*=sqrt((fermi_integral_1_half(TGrid::context,TElectron::equil_planck_potential)/
+							  exp(TElectron::equil_planck_potential))*
+							 (fermi_integral_1_half(TGrid::context,THole::equil_planck_potential)/
+							  exp(THole::equil_planck_potential)));
 	}
 }
 
@@ -384,6 +398,203 @@ void TNode::comp_reduced_dos_mass(void)
 					 (TElectron::dos_mass+THole::dos_mass);
 }
 
+/*
+	Full grid passes of the free carrier concentrations and of their derivatives. The Planck
+	potentials of the bulk nodes with Fermi-Dirac statistics are gathered in blocks of
+	FERMI_BATCH_NODES and the fermi integrals of each block are taken with one call to the array
+	forms in globfunc.cpp. The nodes in quantum wells or with Boltzmann statistics are computed
+	one at a time as before.
+*/
+void TNode::comp_grid_conc(TNode **node_ptr, int nodes, FlagType flag_type)
+{
+	int i, j, batch_nodes;
+	TNode *batch_node[FERMI_BATCH_NODES];
+	prec planck_potential[FERMI_BATCH_NODES];
+	prec fermi_integral[FERMI_BATCH_NODES];
+
+	assert((flag_type==ELECTRON) || (flag_type==HOLE));
+
+	batch_nodes=0;
+	for (i=0;i<nodes;i++) {
+		if (flag_type==ELECTRON) {
+			if (node_ptr[i]->TElectron::bulk_fermi_dirac()) {
+				batch_node[batch_nodes]=node_ptr[i];
+				planck_potential[batch_nodes++]=node_ptr[i]->TElectron::planck_potential;
+			}
+			else node_ptr[i]->TElectron::comp_conc();
+		}
+		else {
+			if (node_ptr[i]->THole::bulk_fermi_dirac()) {
+				batch_node[batch_nodes]=node_ptr[i];
+				planck_potential[batch_nodes++]=node_ptr[i]->THole::planck_potential;
+			}
+			else node_ptr[i]->THole::comp_conc();
+		}
+
+		if ((batch_nodes==FERMI_BATCH_NODES) || ((i==nodes-1) && batch_nodes)) {
+			fermi_integral_1_half(batch_node[0]->TGrid::context,planck_potential,fermi_integral,
+										batch_nodes);
+			for (j=0;j<batch_nodes;j++) {
+				if (flag_type==ELECTRON) batch_node[j]->TElectron::comp_fermi_conc(fermi_integral[j]);
+				else batch_node[j]->THole::comp_fermi_conc(fermi_integral[j]);
+			}
+			batch_nodes=0;
+		}
+	}
+}
+
+void TNode::comp_grid_deriv_conc(TNode **node_ptr, int nodes, FlagType flag_type)
+{
+	int i, j, batch_nodes;
+	TNode *batch_node[FERMI_BATCH_NODES];
+	prec planck_potential[FERMI_BATCH_NODES];
+	prec fermi_integral[FERMI_BATCH_NODES];
+
+	assert((flag_type==ELECTRON) || (flag_type==HOLE));
+
+	batch_nodes=0;
+	for (i=0;i<nodes;i++) {
+		if (flag_type==ELECTRON) {
+			if (node_ptr[i]->TElectron::bulk_fermi_dirac()) {
+				batch_node[batch_nodes]=node_ptr[i];
+				planck_potential[batch_nodes++]=node_ptr[i]->TElectron::planck_potential;
+			}
+			else node_ptr[i]->TElectron::comp_deriv_conc();
+		}
+		else {
+			if (node_ptr[i]->THole::bulk_fermi_dirac()) {
+				batch_node[batch_nodes]=node_ptr[i];
+				planck_potential[batch_nodes++]=node_ptr[i]->THole::planck_potential;
+			}
+			else node_ptr[i]->THole::comp_deriv_conc();
+		}
+
+		if ((batch_nodes==FERMI_BATCH_NODES) || ((i==nodes-1) && batch_nodes)) {
+			fermi_integral_minus_1_half(batch_node[0]->TGrid::context,planck_potential,fermi_integral,
+										batch_nodes);
+			for (j=0;j<batch_nodes;j++) {
+				if (flag_type==ELECTRON) batch_node[j]->TElectron::comp_fermi_deriv_conc(fermi_integral[j]);
+				else batch_node[j]->THole::comp_fermi_deriv_conc(fermi_integral[j]);
+			}
+			batch_nodes=0;
+		}
+	}
+}
+
+/*
+	Full grid passes of the hot carrier heat terms that scale with the mean kinetic energy of the
+	free carriers and of their derivatives. As in comp_grid_conc(), the bulk nodes with
+	Fermi-Dirac statistics are gathered in blocks of FERMI_BATCH_NODES and F3/2/F1/2 of each
+	block is taken from the array forms of the fermi integrals.
+*/
+void TNode::comp_grid_hotcarriers(TNode **node_ptr, int nodes, FlagType flag_type, flag flag_value)
+{
+	int i, j, batch_nodes;
+	TNode *batch_node[FERMI_BATCH_NODES];
+	prec planck_potential[FERMI_BATCH_NODES];
+	prec fermi_3_half[FERMI_BATCH_NODES];
+	prec fermi_1_half[FERMI_BATCH_NODES];
+
+	assert((flag_type==ELECTRON) || (flag_type==HOLE));
+
+	batch_nodes=0;
+	for (i=0;i<nodes;i++) {
+		if (flag_type==ELECTRON) {
+			if (node_ptr[i]->TElectron::bulk_fermi_dirac()) {
+				batch_node[batch_nodes]=node_ptr[i];
+				planck_potential[batch_nodes++]=node_ptr[i]->TElectron::planck_potential;
+			}
+			else node_ptr[i]->comp_hotcarriers(flag_type,flag_value);
+		}
+		else {
+			if (node_ptr[i]->THole::bulk_fermi_dirac()) {
+				batch_node[batch_nodes]=node_ptr[i];
+				planck_potential[batch_nodes++]=node_ptr[i]->THole::planck_potential;
+			}
+			else node_ptr[i]->comp_hotcarriers(flag_type,flag_value);
+		}
+
+		if ((batch_nodes==FERMI_BATCH_NODES) || ((i==nodes-1) && batch_nodes)) {
+			fermi_integral_3_half(batch_node[0]->TGrid::context,planck_potential,fermi_3_half,batch_nodes);
+			fermi_integral_1_half(batch_node[0]->TGrid::context,planck_potential,fermi_1_half,batch_nodes);
+			for (j=0;j<batch_nodes;j++)
+				batch_node[j]->comp_hotcarriers(flag_type,flag_value,fermi_3_half[j]/fermi_1_half[j]);
+			batch_nodes=0;
+		}
+	}
+}
+
+void TNode::comp_grid_deriv_hotcarriers(TNode **node_ptr, int nodes, FlagType flag_type)
+{
+	int i, j, batch_nodes;
+	TNode *batch_node[FERMI_BATCH_NODES];
+	prec planck_potential[FERMI_BATCH_NODES];
+	prec fermi_3_half[FERMI_BATCH_NODES];
+	prec fermi_1_half[FERMI_BATCH_NODES];
+
+	assert((flag_type==ELECTRON) || (flag_type==HOLE));
+
+	batch_nodes=0;
+	for (i=0;i<nodes;i++) {
+		if (flag_type==ELECTRON) {
+			if (node_ptr[i]->TElectron::bulk_fermi_dirac()) {
+				batch_node[batch_nodes]=node_ptr[i];
+				planck_potential[batch_nodes++]=node_ptr[i]->TElectron::planck_potential;
+			}
+			else node_ptr[i]->comp_deriv_electron_hotcarriers();
+		}
+		else {
+			if (node_ptr[i]->THole::bulk_fermi_dirac()) {
+				batch_node[batch_nodes]=node_ptr[i];
+				planck_potential[batch_nodes++]=node_ptr[i]->THole::planck_potential;
+			}
+			else node_ptr[i]->comp_deriv_hole_hotcarriers();
+		}
+
+		if ((batch_nodes==FERMI_BATCH_NODES) || ((i==nodes-1) && batch_nodes)) {
+			fermi_integral_3_half(batch_node[0]->TGrid::context,planck_potential,fermi_3_half,batch_nodes);
+			fermi_integral_1_half(batch_node[0]->TGrid::context,planck_potential,fermi_1_half,batch_nodes);
+			for (j=0;j<batch_nodes;j++) {
+				if (flag_type==ELECTRON)
+					batch_node[j]->comp_deriv_electron_hotcarriers(fermi_3_half[j]/fermi_1_half[j]);
+				else batch_node[j]->comp_deriv_hole_hotcarriers(fermi_3_half[j]/fermi_1_half[j]);
+			}
+			batch_nodes=0;
+		}
+	}
+}
+
+/*
+	The hot carrier heat terms that depend on F3/2/F1/2. fermi_ratio is passed on to the
+	carrier, see TElectron::fermi_energy_ratio().
+*/
+void TNode::comp_hotcarriers(FlagType flag_type, flag flag_value, prec fermi_ratio)
+{
+	switch(flag_type) {
+		case ELECTRON:
+			switch(flag_value) {
+				case B_B_HEAT: TElectron::comp_b_b_hotcarriers(recombination.b_b,fermi_ratio); return;
+				case RELAX_HEAT: TElectron::comp_relax_hotcarriers(lattice_temp,fermi_ratio); return;
+				case AUGER_HEAT:
+					TElectron::comp_auger_hotcarriers(intrinsic_conc,TFreeHole::concentration,
+													  THole::auger_coefficient,recombination.auger,fermi_ratio);
+					return;
+				default: assert(FALSE); return;
+			}
+		case HOLE:
+			switch(flag_value) {
+				case B_B_HEAT: THole::comp_b_b_hotcarriers(recombination.b_b,fermi_ratio); return;
+				case RELAX_HEAT: THole::comp_relax_hotcarriers(lattice_temp,fermi_ratio); return;
+				case AUGER_HEAT:
+					THole::comp_auger_hotcarriers(intrinsic_conc,TFreeElectron::concentration,
+												  TElectron::auger_coefficient,recombination.auger,fermi_ratio);
+					return;
+				default: assert(FALSE); return;
+			}
+		default: assert(FALSE); return;
+	}
+}
+
 void TNode::comp_value(FlagType flag_type, flag flag_value)
 {
 	switch(flag_type) {
@@ -424,7 +635,7 @@ void TNode::comp_value(FlagType flag_type, flag flag_value)
 				case STIMULATED_FACTOR:
 					TElectron::comp_stimulated_factor(reduced_dos_mass,mode_photon_energy,band_gap);
 					return;
-				case B_B_HEAT: TElectron::comp_b_b_hotcarriers(recombination.b_b); return;
+				case B_B_HEAT: comp_hotcarriers(ELECTRON,B_B_HEAT); return;
 				case OPTICAL_GENERATION_REF:
 					TElectron::comp_ref_optical_generation_hotcarriers(recombination.opt_gen);
 					return;
@@ -432,12 +643,10 @@ void TNode::comp_value(FlagType flag_type, flag flag_value)
 					TElectron::comp_stim_hotcarriers(recombination.stim,reduced_dos_mass,
 													 band_gap,incident_photon_energy);
 					return;
-				case RELAX_HEAT: TElectron::comp_relax_hotcarriers(lattice_temp); return;
+				case RELAX_HEAT: comp_hotcarriers(ELECTRON,RELAX_HEAT); return;
 				case SHR_HEAT: TElectron::comp_shr_hotcarriers(intrinsic_conc, lattice_temp, TFreeHole::concentration,
 															   THole::shr_lifetime,recombination.shr); return;
-                case AUGER_HEAT: TElectron::comp_auger_hotcarriers(intrinsic_conc, TFreeHole::concentration,
-                												   THole::auger_coefficient, recombination.auger);
-                	return;
+                case AUGER_HEAT: comp_hotcarriers(ELECTRON,AUGER_HEAT); return;
 				case TOTAL_HEAT: TElectron::comp_total_hotcarriers(); return;
 				case COLLISION_FACTOR: TElectron::comp_collision_factor(material,position); return;
 				default: assert(FALSE); return;
@@ -464,18 +673,16 @@ void TNode::comp_value(FlagType flag_type, flag flag_value)
 				case STIMULATED_FACTOR:
 					THole::comp_stimulated_factor(reduced_dos_mass,mode_photon_energy,band_gap);
 					return;
-				case B_B_HEAT: THole::comp_b_b_hotcarriers(recombination.b_b); return;
+				case B_B_HEAT: comp_hotcarriers(HOLE,B_B_HEAT); return;
 				case OPTICAL_GENERATION_REF:
 					THole::comp_ref_optical_generation_hotcarriers(recombination.opt_gen); return;
 				case STIM_HEAT:
 					THole::comp_stim_hotcarriers(recombination.stim,reduced_dos_mass,band_gap,incident_photon_energy);
 					return;
-				case RELAX_HEAT:THole::comp_relax_hotcarriers(lattice_temp); return;
+				case RELAX_HEAT: comp_hotcarriers(HOLE,RELAX_HEAT); return;
 				case SHR_HEAT:THole::comp_shr_hotcarriers(recombination.shr, lattice_temp, TFreeElectron::concentration,
                 										  TElectron::shr_lifetime,recombination.shr); return;
-                case AUGER_HEAT: THole::comp_auger_hotcarriers(intrinsic_conc, TFreeElectron::concentration,
-                											   TElectron::auger_coefficient, recombination.auger);
-                	return;
+                case AUGER_HEAT: comp_hotcarriers(HOLE,AUGER_HEAT); return;
 				case TOTAL_HEAT:THole::comp_total_hotcarriers(); return;
 				case COLLISION_FACTOR: THole::comp_collision_factor(material,position); return;
 				default: assert(FALSE); return;
@@ -483,7 +690,7 @@ void TNode::comp_value(FlagType flag_type, flag flag_value)
 		case GRID_ELECTRICAL:
 			switch(flag_value) {
 				case TEMPERATURE:
-					lattice_temp=environment.get_value(ENVIRONMENT,TEMPERATURE,0,NORMALIZED);
+					lattice_temp=TGrid::context->environment.get_value(ENVIRONMENT,TEMPERATURE,0,NORMALIZED);
 					return;
 				case ELECTRON_AFFINITY: comp_electron_affinity(); return;
 				case PERMITIVITY: comp_permitivity(); return;
@@ -630,14 +837,14 @@ prec TNode::get_value(FlagType flag_type, flag flag_value, ScaleType scale)
 				default: assert(FALSE); return(0.0);
 			}
 	}
-	if (scale==UNNORMALIZED) return_value*=get_normalize_value(flag_type,flag_value);
+	if (scale==UNNORMALIZED) return_value*=get_normalize_value(TGrid::context,flag_type,flag_value);
 	return(return_value);
 }
 
 void TNode::put_value(FlagType flag_type, flag flag_value, prec value,
 					  ScaleType scale)
 {
-	if (scale==UNNORMALIZED) value/=get_normalize_value(flag_type,flag_value);
+	if (scale==UNNORMALIZED) value/=get_normalize_value(TGrid::context,flag_type,flag_value);
 
 	switch(flag_type) {
 		case FREE_ELECTRON:
@@ -649,7 +856,7 @@ void TNode::put_value(FlagType flag_type, flag flag_value, prec value,
 		case GRID_ELECTRICAL:
 			switch(flag_value) {
 				case EFFECTS:
-					environment.set_effects_change_flags(GRID_ELECTRICAL,TGrid::effects^(flag)value);
+					TGrid::context->environment.set_effects_change_flags(GRID_ELECTRICAL,TGrid::effects^(flag)value);
 					TGrid::effects=(flag)value;
 					TElectron::effects=(flag)value;
 					THole::effects=(flag)value;
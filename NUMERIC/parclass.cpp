@@ -23,12 +23,13 @@
 
 class TParse {
 protected:
+	TSimulationContext *context;
 	int line_number;
 	ifstream input_file_stream;
 	int number_string;
 	string file_name;
 public:
-	TParse(const char *file);
+	TParse(TSimulationContext *new_context, const char *file);
 	~TParse(void) { input_file_stream.close(); }
 	void set_filename(const char *file);
 protected:
@@ -47,8 +48,9 @@ protected:
 };
 */
 
-TParse::TParse(const char *file)
+TParse::TParse(TSimulationContext *new_context, const char *file)
 {
+	context=new_context;
 	set_filename(file);
 	line_number=0;
 	number_string=0;
@@ -59,7 +61,7 @@ void TParse::set_filename(const char *file)
 	file_name=file;
 	input_file_stream.close();
 	input_file_stream.open(file,ios::in);
-	if (input_file_stream.fail()) error_handler.set_error(ERROR_FILE_NOT_OPEN,0,"",file);
+	if (input_file_stream.fail()) context->error_handler.set_error(ERROR_FILE_NOT_OPEN,0,"",file);
 }
 
 string TParse::get_string(void)
@@ -84,6 +86,7 @@ string TParse::get_string(void)
 
 string TParse::get_name(string& line_string, string value_string)
 {
+	TErrorHandler& error_handler=context->error_handler;
 	string result_string;
 	size_t token_position,name_start,name_end;
 
@@ -115,7 +118,7 @@ string TParse::get_name(string& line_string, string value_string)
 FunctionType TParse::get_function_type(string line_string, string value_string)
 {
 	string test_string(get_name(line_string,value_string));
-	if (error_handler.fail()) return(NON_FUNCTION);
+	if (context->error_handler.fail()) return(NON_FUNCTION);
 	if (test_string.find_first_not_of("0123456789.eE+-")==NPOS) return(CONSTANT);
 	if (test_string.find_first_not_of("0123456789.eE+-,")==NPOS) return(POLYNOMIAL);
 	return(USER_FUNCTION);
@@ -124,9 +127,9 @@ FunctionType TParse::get_function_type(string line_string, string value_string)
 prec TParse::get_float(string& line_string, string value_string)
 {
 	string number_string(get_name(line_string,value_string));
-	if(error_handler.fail()) return(0);
+	if(context->error_handler.fail()) return(0);
 	if (number_string.find_first_not_of("0123456789.eE+-")!=NPOS) {
-		error_handler.set_error(ERROR_PARSE_FLOAT,line_number,value_string,file_name);
+		context->error_handler.set_error(ERROR_PARSE_FLOAT,line_number,value_string,file_name);
 		return(0);
 	}
 	return(atof(number_string.c_str()));
@@ -135,9 +138,9 @@ prec TParse::get_float(string& line_string, string value_string)
 long TParse::get_long(string& line_string, string value_string)
 {
 	string number_string(get_name(line_string,value_string));
-	if(error_handler.fail()) return(0);
+	if(context->error_handler.fail()) return(0);
 	if (number_string.find_first_not_of("0123456789")!=NPOS) {
-		error_handler.set_error(ERROR_PARSE_LONG,line_number,value_string,file_name);
+		context->error_handler.set_error(ERROR_PARSE_LONG,line_number,value_string,file_name);
 		return(0);
 	}
 	return(atol(number_string.c_str()));
@@ -147,6 +150,7 @@ long TParse::get_long(string& line_string, string value_string)
 void TParse::get_function_limit(string& line_string, string limit_variable, string function_variables,
 								TFunction* &lower_limit, TFunction* &upper_limit)
 {
+	TErrorHandler& error_handler=context->error_handler;
 	logical lower_entered, upper_entered;
 
 	string lower_string("START_"+limit_variable);
@@ -185,6 +189,7 @@ void TParse::get_function_limit(string& line_string, string limit_variable, stri
 
 int TParse::get_terms(string& line_string, string value_string, prec* &terms)
 {
+	TErrorHandler& error_handler=context->error_handler;
 	int i;
 	string term_string;
 	size_t comma_position;
@@ -227,13 +232,14 @@ TPolynomial *TParse::get_polynomial(string& line_string, string value_string, st
 	int number_terms;
 
 	number_terms=get_terms(line_string,value_string,terms);
-	if (error_handler.fail()) return(NULL);
+	if (context->error_handler.fail()) return(NULL);
 	return_function=new TPolynomial(number_terms, terms, variable_string.length());
 	return(return_function);
 }
 
 TUserFunction *TParse::get_function(string& line_string, string value_string, string variable_string)
 {
+	TErrorHandler& error_handler=context->error_handler;
 	TUserFunction *return_function;
 	string function_string;
 
@@ -255,6 +261,7 @@ TUserFunction *TParse::get_function(string& line_string, string value_string, st
 TFunction *TParse::get_general_function(string& line_string, string value_string,
 										string variable_string)
 {
+	TErrorHandler& error_handler=context->error_handler;
 	prec constant_value;
 	TPolynomial *user_polynomial;
 	TUserFunction *user_function;
@@ -284,14 +291,15 @@ TFunction *TParse::get_general_function(string& line_string, string value_string
 void TParse::test_string(const string& line_string)
 {
 	if (line_string.find_first_not_of(" \n\t")!=NPOS)
-		error_handler.set_error(ERROR_PARSE_UNKNOWN_SYMBOL,line_number,"",file_name);
+		context->error_handler.set_error(ERROR_PARSE_UNKNOWN_SYMBOL,line_number,"",file_name);
 }
 
 /******************************* class TParseMaterialParam ************************************
 
 class TParseMaterialParam: public TParse {
 public:
-	TParseMaterialParam(const char *file) : TParse(file) {}
+	TParseMaterialParam(TSimulationContext *new_context, const char *file)
+		: TParse(new_context,file) {}
 protected:
 	TMaterialParamModel *get_material_parameter(MaterialParam param,
 												string parameter_line,
@@ -309,6 +317,7 @@ TMaterialParamModel *TParseMaterialParam::get_material_parameter(MaterialParam p
 																 string function_variables,
 																 string limit_variables)
 {
+	TErrorHandler& error_handler=context->error_handler;
 	int i,j,segments;
 	int number_limit_variables;
 	TMaterialParamModel *return_model;
@@ -367,6 +376,7 @@ TFunction *TParseMaterialParam::get_material_param_function(MaterialParam param,
 															string parameter_line,
 															string function_variables)
 {
+	TErrorHandler& error_handler=context->error_handler;
 	string model_name;
 	TFunction *general_function;
 	TFunction *model_function;
@@ -559,7 +569,7 @@ private:
 	logical region_entered;
 	logical radius_entered;
 public:
-	TParseDevice(const char *file);
+	TParseDevice(TSimulationContext *new_context, const char *file);
 	~TParseDevice(void) {}
 	TDeviceFileInput parse_device(void);
 private:
@@ -577,8 +587,8 @@ private:
 };
 */
 
-TParseDevice::TParseDevice(const char *file)
-	: TParseMaterialParam(file)
+TParseDevice::TParseDevice(TSimulationContext *new_context, const char *file)
+	: TParseMaterialParam(new_context,file)
 {
 	structure_total_length=0.0;
 	start_repeat_pos=0;
@@ -592,11 +602,11 @@ TDeviceFileInput TParseDevice::parse_device(void)
 	string new_line;
 
 	device_input.delete_contents();
-	while (!input_file_stream.eof() && !error_handler.fail()) {
+	while (!input_file_stream.eof() && !context->error_handler.fail()) {
 		new_line=get_string();
 		if (!new_line.is_null()) process_line(new_line);
 	}
-	if (!error_handler.fail()) apply_defaults();
+	if (!context->error_handler.fail()) apply_defaults();
 	return(device_input);
 }
 
@@ -645,11 +655,12 @@ void TParseDevice::process_line(string line_string)
 			return;
 		}
 	}
-	error_handler.set_error(ERROR_PARSE_KEYWORD,line_number,"",file_name);
+	context->error_handler.set_error(ERROR_PARSE_KEYWORD,line_number,"",file_name);
 }
 
 void TParseDevice::process_grid(string line_string)
 {
+	TErrorHandler& error_handler=context->error_handler;
 	prec size;
 	GridInput new_grid;
 
@@ -667,11 +678,12 @@ void TParseDevice::process_grid(string line_string)
 		else return;
 	}
 
-	device_input.add_grid(new_grid);
+	device_input.add_grid(context,new_grid);
 }
 
 void TParseDevice::process_doping(string line_string)
 {
+	TErrorHandler& error_handler=context->error_handler;
 	TFunction *donor_function, *acceptor_function;
 	logical donor_entered=FALSE, acceptor_entered=FALSE;
 	DopingInput new_doping;
@@ -727,12 +739,13 @@ void TParseDevice::process_doping(string line_string)
 	if (acceptor_entered) new_doping.acceptor_function=acceptor_function;
 	else new_doping.acceptor_function=new TConstant(0.0,1);
 
-	device_input.add_doping(new_doping);
+	device_input.add_doping(context,new_doping);
 	doping_entered=TRUE;
 }
 
 void TParseDevice::process_structure(string line_string)
 {
+	TErrorHandler& error_handler=context->error_handler;
 	string material_name, alloy_name;
 	StructureInput new_structure;
 
@@ -741,7 +754,7 @@ void TParseDevice::process_structure(string line_string)
 
 	material_name=get_name(line_string,"MATERIAL");
 	if (error_handler.fail()) return;
-	new_structure.material_type=material_parameters.get_material_type(material_name);
+	new_structure.material_type=context->material_parameters.get_material_type(material_name);
 	if (new_structure.material_type==MAT_NO_MATERIAL) {
 		error_handler.set_error(ERROR_MAT_INVALID_NAME,line_number,material_name,file_name);
 		return;
@@ -762,13 +775,13 @@ void TParseDevice::process_structure(string line_string)
 		}
 	}
 
-	new_structure.alloy_type=material_parameters.get_alloy_type(material_name,alloy_name);
+	new_structure.alloy_type=context->material_parameters.get_alloy_type(material_name,alloy_name);
 	if (new_structure.alloy_type==MAT_NO_ALLOY) {
 		error_handler.set_error(ERROR_ALLOY_INVALID_NAME,line_number,alloy_name,file_name);
 		delete new_structure.alloy_function;
 		return;
 	}
-	device_input.add_structure(new_structure);
+	device_input.add_structure(context,new_structure);
 	structure_total_length+=new_structure.length;
 }
 
@@ -777,23 +790,24 @@ void TParseDevice::process_region(string line_string)
 	RegionInput new_region;
 
 	new_region.length=get_float(line_string,"LENGTH");
-	if (error_handler.fail()) return;
+	if (context->error_handler.fail()) return;
 
 	if (line_string.find("BULK")!=NPOS) new_region.type=BULK;
 	else {
 		if (line_string.find("QW")!=NPOS) new_region.type=QW;
 		else {
-			error_handler.set_error(ERROR_PARSE_REGION_TYPE,line_number,"",file_name);
+			context->error_handler.set_error(ERROR_PARSE_REGION_TYPE,line_number,"",file_name);
 			return;
 		}
 	}
 
-	device_input.add_region(new_region);
+	device_input.add_region(context,new_region);
 	region_entered=TRUE;
 }
 
 void TParseDevice::process_cavity(string line_string)
 {
+	TErrorHandler& error_handler=context->error_handler;
 	CavityInput new_cavity;
 
 	new_cavity.area=get_float(line_string,"AREA");
@@ -811,11 +825,12 @@ void TParseDevice::process_cavity(string line_string)
 		}
 	}
 
-	device_input.add_cavity(new_cavity);
+	device_input.add_cavity(context,new_cavity);
 }
 
 void TParseDevice::process_mirror(string line_string)
 {
+	TErrorHandler& error_handler=context->error_handler;
 	MirrorInput new_mirror;
 
 	new_mirror.position=get_float(line_string,"POSITION");
@@ -833,11 +848,12 @@ void TParseDevice::process_mirror(string line_string)
 		}
 	}
 
-	device_input.add_mirror(new_mirror);
+	device_input.add_mirror(context,new_mirror);
 }
 
 void TParseDevice::process_repeat(string line_string)
 {
+	TErrorHandler& error_handler=context->error_handler;
 	int i,repeat_times;
 	string new_line;
 
@@ -848,7 +864,7 @@ void TParseDevice::process_repeat(string line_string)
 			error_handler.set_error(ERROR_PARSE_DOUBLE_REPEAT,line_number,"",file_name);
 			return;
 		}
-		else start_repeat_pos=input_file_stream.rdbuf()->seekoff(0,ios::cur,ios::in);
+		else start_repeat_pos=input_file_stream.tellg();
 	}
 	else {
 		repeat_times=(int)get_long(line_string,"REPEAT");
@@ -859,7 +875,7 @@ void TParseDevice::process_repeat(string line_string)
 			return;
 		}
 		for (i=1;i<repeat_times;i++) {
-			input_file_stream.rdbuf()->seekoff(start_repeat_pos,ios::beg,ios::in);
+			input_file_stream.seekg(start_repeat_pos);
 			new_line=get_string();
 			while (new_line!=current_repeat_string) {
 				process_line(new_line);
@@ -875,12 +891,12 @@ void TParseDevice::process_radius(string line_string)
 	prec new_radius;
 
 	if (radius_entered) {
-		error_handler.set_error(ERROR_PARSE_RADIUS,line_number,"",file_name);
+		context->error_handler.set_error(ERROR_PARSE_RADIUS,line_number,"",file_name);
 		return;
 	}
 
 	new_radius=get_float(line_string,"RADIUS");
-	if (error_handler.fail()) return;
+	if (context->error_handler.fail()) return;
 
 	device_input.add_radius(new_radius);
 	radius_entered=TRUE;
@@ -892,17 +908,17 @@ void TParseDevice::process_material_param(string line_string, MaterialParam para
 	extern char *material_parameters_variables[];
 
 	new_param_input.length=get_float(line_string,"LENGTH");
-	if (error_handler.fail()) return;
+	if (context->error_handler.fail()) return;
 
 	string function_variables(string(material_parameters_variables[param-1])+"D");
 	string limit_variables(material_parameters_variables[param-1]);
 
 	new_param_input.material_model=get_material_parameter(param,line_string,function_variables,limit_variables);
-	if (error_handler.fail()) {
+	if (context->error_handler.fail()) {
 		delete new_param_input.material_model;
 		return;
 	}
-	else device_input.add_material_param(param,new_param_input);
+	else device_input.add_material_param(context,param,new_param_input);
 }
 
 void TParseDevice::apply_defaults(void)
@@ -913,7 +929,7 @@ void TParseDevice::apply_defaults(void)
 	if (!region_entered) {
 		new_region.type=BULK;
 		new_region.length=structure_total_length;
-		device_input.add_region(new_region);
+		device_input.add_region(context,new_region);
 	}
 
 	if (!doping_entered) {
@@ -924,7 +940,7 @@ void TParseDevice::apply_defaults(void)
 		new_doping.acceptor_level=0.0;
 		new_doping.donor_degeneracy=0;
 		new_doping.donor_level=0.0;
-		device_input.add_doping(new_doping);
+		device_input.add_doping(context,new_doping);
 	}
 
 	if (!radius_entered) device_input.add_radius(1.0);
@@ -937,18 +953,20 @@ private:
 	MaterialType current_material_type;
 	AlloyType current_alloy_type;
 public:
-	TParseMaterial(const char *file) : TParseMaterialParam(file)
+	TParseMaterial(TSimulationContext *new_context, const char *file)
+		: TParseMaterialParam(new_context,file)
 		{ current_material_type=(MaterialType)0; current_alloy_type=(AlloyType)0; }
 	void parse_material(void);
 private:
 	void process_material(string line_string);
 	void process_alloy(string line_string);
-	void init(void) { material_parameters.clear(); }
+	void init(void) { context->material_parameters.clear(); }
 };
 */
 
 void TParseMaterial::parse_material(void)
 {
+	TErrorHandler& error_handler=context->error_handler;
 	string line_string;
 
 	init();
@@ -967,7 +985,7 @@ void TParseMaterial::parse_material(void)
 		if (!line_string.is_null())
 			error_handler.set_error(ERROR_PARSE_UNKNOWN_SYMBOL,line_number,"",file_name);
 	}
-	if (!error_handler.fail()) material_parameters.set_ready(TRUE);
+	if (!error_handler.fail()) context->material_parameters.set_ready(TRUE);
 }
 
 void TParseMaterial::process_material(string line_string)
@@ -975,15 +993,17 @@ void TParseMaterial::process_material(string line_string)
 	string material_name;
 
 	material_name=get_name(line_string,"MATERIAL");
-	if (error_handler.fail()) return;
+	if (context->error_handler.fail()) return;
 
-	material_parameters.add_material(material_name);
-	if (error_handler.fail()) return;
-	current_material_type=material_parameters.get_material_type(material_name);
+	context->material_parameters.add_material(material_name);
+	if (context->error_handler.fail()) return;
+	current_material_type=context->material_parameters.get_material_type(material_name);
 }
 
 void TParseMaterial::process_alloy(string line_string)
 {
+	TMaterialStorage& material_parameters=context->material_parameters;
+	TErrorHandler& error_handler=context->error_handler;
 	TMaterialParamModel *material_param_model;
 	MaterialParam i,j;
 	logical mat_processed;
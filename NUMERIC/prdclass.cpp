@@ -0,0 +1,193 @@
+/*
+    SimWindows - 1D Semiconductor Device Simulator
+    Copyright (C) 2013 David W. Winston
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "comincl.h"
+
+//********************************* class TSolutionPredictor *********************************
+/*
+class TSolutionPredictor {
+private:
+	TSimulationContext *context;
+	PredictorType predictor_type;
+	int solution_size;
+	int number_points;
+	prec bias[MAX_PREDICTOR_POINTS];
+	prec *solution[MAX_PREDICTOR_POINTS];
+	prec *predicted_solution;
+public:
+	TSolutionPredictor(TSimulationContext *new_context, PredictorType new_type=PREDICT_NONE);
+	~TSolutionPredictor(void) { delete_solutions(); }
+	void put_type(PredictorType new_type) { predictor_type=new_type; }
+	PredictorType get_type(void) { return(predictor_type); }
+	void clear(void) { number_points=0; }
+	void store(prec new_bias);
+	void predict(prec new_bias);
+private:
+	void create_solutions(int new_solution_size);
+	void delete_solutions(void);
+	void extrapolate(prec new_bias, int order, int start_value);
+};
+*/
+
+TSolutionPredictor::TSolutionPredictor(TSimulationContext *new_context, PredictorType new_type)
+{
+	int i;
+
+	context=new_context;
+	predictor_type=new_type;
+	solution_size=0;
+	number_points=0;
+	for (i=0;i<MAX_PREDICTOR_POINTS;i++) {
+		bias[i]=0.0;
+		solution[i]=(prec *)0;
+	}
+	predicted_solution=(prec *)0;
+}
+
+/*
+	Keeps the present solution of the device as the solution at new_bias. A solution at the
+	same bias as the newest point replaces it.
+*/
+void TSolutionPredictor::store(prec new_bias)
+{
+	TEnvironment& environment=context->environment;
+	int i;
+	prec *oldest_solution;
+
+	if (predictor_type==PREDICT_NONE) return;
+
+	if (environment.get_solution_size()!=solution_size)
+		create_solutions(environment.get_solution_size());
+	if (!solution_size) return;
+
+	if ((!number_points) || (bias[0]!=new_bias)) {
+		oldest_solution=solution[MAX_PREDICTOR_POINTS-1];
+		for (i=MAX_PREDICTOR_POINTS-1;i>0;i--) {
+			solution[i]=solution[i-1];
+			bias[i]=bias[i-1];
+		}
+		solution[0]=oldest_solution;
+		if (number_points<MAX_PREDICTOR_POINTS) number_points++;
+	}
+
+	bias[0]=new_bias;
+	environment.get_solution(solution[0]);
+}
+
+/*
+	Moves the device from the newest stored solution toward the solution at new_bias. Call
+	after the new bias has been put and before the device is solved.
+*/
+void TSolutionPredictor::predict(prec new_bias)
+{
+	TEnvironment& environment=context->environment;
+	int order;
+	flag device_effects;
+
+	if ((predictor_type==PREDICT_NONE) || (!number_points) || (new_bias==bias[0])) return;
+
+	if (environment.get_solution_size()!=solution_size) {
+		clear();
+		return;
+	}
+
+	order=number_points-1;
+	if ((predictor_type!=PREDICT_QUADRATIC) && (order>1)) order=1;
+
+	switch(predictor_type) {
+		case PREDICT_LINEAR:
+		case PREDICT_QUADRATIC:
+			if (order) extrapolate(new_bias,order,0);
+			break;
+		case PREDICT_TANGENT:
+			device_effects=(flag)environment.get_value(DEVICE,EFFECTS);
+			if (order && (device_effects & (DEVICE_NON_ISOTHERMAL | DEVICE_LASER)))
+				extrapolate(new_bias,order,3*environment.get_number_objects(NODE));
+			if (!context->error_handler.fail()) environment.predict_solution();
+			break;
+		default: break;
+	}
+}
+
+void TSolutionPredictor::create_solutions(int new_solution_size)
+{
+	int i;
+
+	delete_solutions();
+
+	solution_size=new_solution_size;
+	if (!solution_size) return;
+
+	for (i=0;i<MAX_PREDICTOR_POINTS;i++) solution[i]=new prec[solution_size];
+	predicted_solution=new prec[solution_size];
+}
+
+void TSolutionPredictor::delete_solutions(void)
+{
+	int i;
+
+	for (i=0;i<MAX_PREDICTOR_POINTS;i++) {
+		if (solution[i]) delete[] solution[i];
+		solution[i]=(prec *)0;
+	}
+	if (predicted_solution) delete[] predicted_solution;
+	predicted_solution=(prec *)0;
+	solution_size=0;
+	number_points=0;
+}
+
+/*
+	Lagrange extrapolation through the newest order+1 points. Values below start_value are
+	taken from the newest point. A temperature that would not stay positive or a photon
+	number that would become negative also keeps its newest value.
+*/
+void TSolutionPredictor::extrapolate(prec new_bias, int order, int start_value)
+{
+	TEnvironment& environment=context->environment;
+	int i,j,k;
+	int temperature_start, photon_start;
+	prec weight[MAX_PREDICTOR_POINTS];
+	prec value;
+
+	for (k=0;k<=order;k++) {
+		weight[k]=1.0;
+		for (j=0;j<=order;j++) {
+			if (j!=k) weight[k]*=(new_bias-bias[j])/(bias[k]-bias[j]);
+		}
+	}
+
+	temperature_start=3*environment.get_number_objects(NODE);
+	photon_start=6*environment.get_number_objects(NODE);
+
+	for (i=0;i<solution_size;i++) {
+		if (i<start_value) {
+			*(predicted_solution+i)=*(solution[0]+i);
+			continue;
+		}
+
+		value=0.0;
+		for (k=0;k<=order;k++) value+=weight[k]*(*(solution[k]+i));
+
+		if (((i>=temperature_start) && (i<photon_start) && (value<=0.0)) ||
+			((i>=photon_start) && (value<0.0))) value=*(solution[0]+i);
+
+		*(predicted_solution+i)=value;
+	}
+
+	environment.put_solution(predicted_solution);
+}
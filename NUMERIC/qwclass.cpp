@@ -32,6 +32,7 @@ class TQuantumWell: protected T2DElectron, protected T2DHole {
 	friend TNode;
 	friend TGrid;
 private:
+	TSimulationContext *context;
 	TDevice *device_ptr;
 	TNode** grid_ptr;
 	QuantumWellNodes nodes;
@@ -53,7 +54,7 @@ private:
 	prec comp_absorption(prec energy);
 
 public:
-	TQuantumWell(TDevice *device, TNode** grid);
+	TQuantumWell(TSimulationContext *new_context, TDevice *device, TNode** grid);
 	void comp_auger_recombination(void);
 	void comp_band_gap(void);
 	void comp_b_b_recomb_const_2D(void);
@@ -84,9 +85,10 @@ public:
 };
 */
 
-TQuantumWell::TQuantumWell(TDevice *device, TNode** grid)
-	: T2DElectron(grid), T2DHole(grid)
+TQuantumWell::TQuantumWell(TSimulationContext *new_context, TDevice *device, TNode** grid)
+	: T2DElectron(new_context, grid), T2DHole(new_context, grid)
 {
+	context=new_context;
 	grid_ptr=grid;
 	device_ptr=device;
 	nodes.prev_node_ptr=(TNode*)0;
@@ -121,7 +123,7 @@ prec TQuantumWell::comp_absorption(prec energy)
 	if (energy<band_gap)
 		return(0.0);
 	else
-		return(11700.0*sqrt((band_gap-bulk_band_gap)*normalization.energy)*normalization.length*qw_length);
+		return(11700.0*sqrt((band_gap-bulk_band_gap)*context->normalization.energy)*context->normalization.length*qw_length);
 }
 
 void TQuantumWell::comp_auger_recombination(void)
@@ -146,12 +148,13 @@ void TQuantumWell::comp_band_gap(void)
 
 void TQuantumWell::comp_b_b_recomb_const_2D(void)
 {
+	NormalizeConstants& normalization=context->normalization;
 	prec values[]={ nodes.curr_node_ptr->get_value(GRID_ELECTRICAL,ALLOY_CONC),
 					nodes.curr_node_ptr->get_value(GRID_ELECTRICAL,POSITION,NORMALIZED) };
 
-	b_b_recomb_const_2D=material_parameters.evaluate(MAT_QW_B_B_RECOMB_CONSTANT,
-													 (MaterialType)nodes.curr_node_ptr->get_value(GRID_ELECTRICAL,MATERIAL),
-													 (AlloyType)nodes.curr_node_ptr->get_value(GRID_ELECTRICAL,ALLOY_TYPE),
+	b_b_recomb_const_2D=context->material_parameters.evaluate(MAT_QW_B_B_RECOMB_CONSTANT,
+															  (MaterialType)nodes.curr_node_ptr->get_value(GRID_ELECTRICAL,MATERIAL),
+															  (AlloyType)nodes.curr_node_ptr->get_value(GRID_ELECTRICAL,ALLOY_TYPE),
 													  values)*normalization.length*normalization.conc*normalization.time;
 
 }
@@ -454,13 +457,13 @@ prec TQuantumWell::get_value(FlagType flag_type, flag flag_value, ScaleType scal
 		default: assert(FALSE); return(0.0);
 	}
 
-	if (scale==UNNORMALIZED) return_value*=get_normalize_value(flag_type,flag_value);
+	if (scale==UNNORMALIZED) return_value*=get_normalize_value(context,flag_type,flag_value);
 	return(return_value);
 }
 
 void TQuantumWell::put_value(FlagType flag_type, flag flag_value, prec value, ScaleType scale)
 {
-	if (scale==UNNORMALIZED) value/=get_normalize_value(flag_type,flag_value);
+	if (scale==UNNORMALIZED) value/=get_normalize_value(context,flag_type,flag_value);
 
 	switch(flag_type) {
 		case QW_ELECTRON: T2DElectron::put_value(flag_value,value,NORMALIZED); return;
@@ -25,15 +25,18 @@
 #include "sim2dcar.h"
 #include "simqw.h"
 #include "simelem.h"
+#include "simdual.h"
 #include "simecele.h"
 #include "simthele.h"
 #include "simdev.h"
+#include "simblock.h"
 #include "simsol.h"
 
 /************************************** class TSolution ***************************************
 
 class TSolution {
 private:
+	TSimulationContext *context;
 	SolveType solve_type;
 	flag device_effects;
 	flag contact_flag_0;
@@ -56,13 +59,49 @@ private:
 	int thermal_unknown_nodes;
 	TElectricalElement **electrical_element_ptr;
 	TThermalElement **thermal_element_ptr;
-	prec **electrical_jacobian;
+	TObjectArena electrical_arena;
+	TObjectArena thermal_arena;
+	ElementRange *element_range;
+	int element_ranges;
+	ElementValues *element_values;
+	ElementDerivatives *element_derivatives;
+	AssemblyPass assembly_pass;
+	logical assembly_fused_current;
+	int assembly_return_flag;
+	int assembly_first;
+	int assembly_last;
+	int assembly_blocks;
+	long assembly_evaluations[MAX_ASSEMBLY_BLOCKS];
+	TBlockJacobian electrical_jacobian;
 	prec *electrical_solution[3];
 	int number_elect_variables;
-	prec **thermal_jacobian;
+	logical jacobian_factored;
+	prec previous_elect_error;
+	prec previous_elect_ratio;
+	prec *electrical_step[3];
+	TBlockJacobian thermal_jacobian;
 	prec *thermal_solution;
+	logical coupled_thermal;
+	int coupled_start_node;
+	int coupled_end_node;
+	int coupled_unknown_nodes;
+	TBlockJacobian coupled_jacobian;
+	prec *coupled_solution[COUPLED_VARIABLES];
+	prec *coupled_step;
+	logical coupled_photons;
+	prec *photon_column[3];
+	int anderson_depth;
+	int anderson_passes;
+	int anderson_history;
+	int anderson_columns;
+	prec anderson_error;
+	prec anderson_ratio;
+	prec anderson_relaxed_ratio;
+	prec *anderson_residual[MAX_ANDERSON_DEPTH+1];
+	prec *anderson_step[MAX_ANDERSON_DEPTH+1];
+	prec anderson_photons[MAX_ANDERSON_DEPTH+1];
 public:
-	TSolution(TDevice *device, TNode** grd_ptr,
+	TSolution(TSimulationContext *new_context, TDevice *device, TNode** grd_ptr,
 			  TQuantumWell **qwell_ptr);
 	~TSolution(void);
 	void apply_electrical_boundary(void);
@@ -74,8 +113,14 @@ public:
 	void store_temperature(void);
 	void set_solution(SolveType type);
 	void electrical_iterate(FundamentalParam& iteration_error);
+	void electrical_predict(void);
+	void comp_electrical_values(void);
 	void thermal_iterate(prec& iteration_error);
-	void outer_thermal_update_device(void);
+	void outer_thermal_update_device(prec& outer_error);
+	logical is_coupled_thermal(void) { return(coupled_thermal); }
+	void coupled_iterate(FundamentalParam& elect_error, prec& therm_error);
+	logical is_coupled_photons(void) { return(coupled_photons); }
+	void photon_iterate(FundamentalParam& elect_error, prec& photon_error);
 private:
 	void establish_elements(void);
 	void comp_electrical_dep_param(SolveType solve);
@@ -85,17 +130,43 @@ private:
 	void comp_deriv_thermal_conduct(void);
 	void comp_deriv_electron_hotcarriers(void);
 	void comp_electrical_jacobian(void);
-	void comp_electrical_solution(void);
+	void comp_electrical_jacobian_rows(int first_node, int last_node);
+	void comp_electrical_solution(logical fused_current);
+	void comp_electrical_solution_rows(int first_node, int last_node);
 	void comp_thermal_jacobian(void);
+	void comp_thermal_jacobian_rows(int first_node, int last_node);
 	void comp_thermal_solution(void);
-	void factor_jacobian(prec **jacobian, int variables, int unknown_nodes);
-	void solve_electrical_jacobian(void);
+	void comp_thermal_solution_rows(int first_node, int last_node);
+	void run_assembly(AssemblyPass pass, int first, int last);
+	static void assembly_task(void *solution, int block_number);
+	void assemble_block(int block_number);
+	void comp_coupled_thermal_solution(void);
+	void comp_coupled_jacobian(void);
+	void comp_coupled_column(int color, int variable, int start_node, int end_node,
+							 logical electrical_rows);
+	int comp_partitions(int unknown_nodes);
+	void factor_jacobian(TBlockJacobian& jacobian, int variables, int unknown_nodes);
+	void solve_electrical_jacobian(prec **solution);
 	void solve_thermal_jacobian(void);
+	void solve_coupled_jacobian(void);
 	void electrical_update_device(void);
+	void electrical_step_device(prec **step, prec step_factor);
+	void electrical_line_search(prec *initial_residual);
+	void clamp_electrical_step(void);
+	prec comp_trial_norm(void);
+	void comp_electrical_residual(prec *residual);
+	void put_total_photons(prec total_photons);
+	prec comp_photon_residual(prec total_photons, prec& photon_deriv);
+	prec comp_photon_deriv(prec **direction, prec total_photons, prec photon_residual);
 	void thermal_update_device(void);
+	void anderson_update_device(prec clamp_value, prec relaxation_value, prec& outer_error);
+	int comp_anderson_coefficients(int columns, prec *coefficient);
 	void electrical_update_sub_nodes(void);
 	void thermal_update_sub_nodes(void);
 	FundamentalParam comp_electrical_error(void);
+	prec comp_max_elect_error(FundamentalParam& error);
+	prec comp_chord_limit(prec refactor_ratio);
+	void store_elect_error(prec max_error);
 	prec comp_thermal_error(void);
 	FundamentalParam comp_deriv_poisson(int i, NodeSide node, int return_flag);
 	FundamentalParam comp_deriv_electron_rate(int i, NodeSide node, int return_flag);
@@ -105,9 +176,12 @@ private:
 };
 */
 
-TSolution::TSolution(TDevice *device, TNode** grd_ptr,
+TSolution::TSolution(TSimulationContext *new_context, TDevice *device, TNode** grd_ptr,
 					 TQuantumWell **qwell_ptr)
 {
+	int i;
+
+	context=new_context;
 	device_ptr=device;
 	device_grid_points=device_ptr->get_number_objects(NODE);
 	device_grid_ptr=grd_ptr;
@@ -129,13 +203,46 @@ TSolution::TSolution(TDevice *device, TNode** grd_ptr,
 	electrical_solution[0]=(prec *)0;
 	electrical_solution[1]=(prec *)0;
 	electrical_solution[2]=(prec *)0;
-	electrical_jacobian=(prec **)0;
+	electrical_step[0]=electrical_step[1]=electrical_step[2]=(prec *)0;
 	thermal_solution=(prec *)0;
-	thermal_jacobian=(prec **)0;
+	coupled_thermal=FALSE;
+	coupled_start_node=0;
+	coupled_end_node=0;
+	coupled_unknown_nodes=0;
+	for (i=0;i<COUPLED_VARIABLES;i++) coupled_solution[i]=(prec *)0;
+	coupled_step=(prec *)0;
+	coupled_photons=FALSE;
+	photon_column[0]=photon_column[1]=photon_column[2]=(prec *)0;
+	anderson_depth=0;
+	anderson_passes=0;
+	anderson_history=0;
+	anderson_columns=0;
+	anderson_error=0.0;
+	anderson_ratio=0.0;
+	anderson_relaxed_ratio=0.0;
+	for (i=0;i<=MAX_ANDERSON_DEPTH;i++) {
+		anderson_residual[i]=(prec *)0;
+		anderson_step[i]=(prec *)0;
+		anderson_photons[i]=0.0;
+	}
 	electrical_element_ptr=(TElectricalElement **)0;
 	thermal_element_ptr=(TThermalElement **)0;
+	element_range=(ElementRange *)0;
+	element_ranges=0;
+	element_values=(ElementValues *)0;
+	element_derivatives=(ElementDerivatives *)0;
+	assembly_pass=ASSEMBLE_ELECTRICAL_VALUES;
+	assembly_fused_current=FALSE;
+	assembly_return_flag=0;
+	assembly_first=0;
+	assembly_last=0;
+	assembly_blocks=0;
+	for (i=0;i<MAX_ASSEMBLY_BLOCKS;i++) assembly_evaluations[i]=0;
 	solution_grid_ptr=(TNode **)0;
 	number_elect_variables=0;
+	jacobian_factored=FALSE;
+	previous_elect_error=0.0;
+	previous_elect_ratio=0.0;
 
 	establish_elements();
 }
@@ -148,28 +255,35 @@ TSolution::~TSolution(void)
 	if (electrical_solution[1]) delete[] electrical_solution[1];
 	if (electrical_solution[2]) delete[] electrical_solution[2];
 
-	if (electrical_jacobian) {
-		for (i=0;i<solution_grid_points;i++) delete[] electrical_jacobian[i];
-		delete[] electrical_jacobian;
-	}
+	for (i=0;i<3;i++) if (electrical_step[i]) delete[] electrical_step[i];
 
 	if (thermal_solution) delete[] thermal_solution;
 
-	if (thermal_jacobian) {
-		for (i=0;i<solution_grid_points;i++) delete[] thermal_jacobian[i];
-		delete[] thermal_jacobian;
+	for (i=0;i<COUPLED_VARIABLES;i++) if (coupled_solution[i]) delete[] coupled_solution[i];
+	if (coupled_step) delete[] coupled_step;
+
+	for (i=0;i<3;i++) if (photon_column[i]) delete[] photon_column[i];
+
+	for (i=0;i<=MAX_ANDERSON_DEPTH;i++) {
+		if (anderson_residual[i]) delete[] anderson_residual[i];
+		if (anderson_step[i]) delete[] anderson_step[i];
 	}
 
+// The elements themselves are freed with their arenas
 	if (electrical_element_ptr) {
-		for (i=0;i<elements;i++) delete electrical_element_ptr[i];
+		for (i=0;i<elements;i++) electrical_element_ptr[i]->~TElectricalElement();
 		delete[] electrical_element_ptr;
 	}
 
 	if (thermal_element_ptr) {
-		for (i=0;i<elements;i++) delete thermal_element_ptr[i];
+		for (i=0;i<elements;i++) thermal_element_ptr[i]->~TThermalElement();
 		delete[] thermal_element_ptr;
 	}
 
+	if (element_range) delete[] element_range;
+	if (element_values) delete[] element_values;
+	if (element_derivatives) delete[] element_derivatives;
+
 	if (solution_grid_ptr) delete[] solution_grid_ptr;
 }
 
@@ -187,11 +301,7 @@ void TSolution::apply_thermal_boundary(void)
 
 void TSolution::comp_electrical_dep_param(SolveType solve)
 {
-	int i;
-	TElectricalElement **temp_ele_ptr;
-
-	temp_ele_ptr=electrical_element_ptr;
-	for (i=0;i<elements;i++) (*(temp_ele_ptr++))->comp_dependent_param(solve);
+	TBulkElectricalElement::comp_grid_dependent_param(electrical_element_ptr,elements,solve);
 }
 
 void TSolution::comp_thermal_dep_param(void)
@@ -248,7 +358,9 @@ void TSolution::comp_thermoelectric_param(void)
 
 void TSolution::establish_elements(void)
 {
+	TErrorHandler& error_handler=context->error_handler;
 	int i, req_elements, req_solution_grid_points;
+	size_t electrical_bytes, thermal_bytes;
 	TNode** temp_solution_grid_ptr;
 	TNode** temp_device_grid_ptr;
 	TQuantumWell **temp_qw_ptr;
@@ -292,10 +404,26 @@ void TSolution::establish_elements(void)
 		return;
 	}
 
+// Each kind of element gets its own arena block, so the elements lie in grid order
+	electrical_bytes=TObjectArena::object_size(sizeof(TBulkElectricalElement));
+	if (TObjectArena::object_size(sizeof(TQWElectricalElement))>electrical_bytes)
+		electrical_bytes=TObjectArena::object_size(sizeof(TQWElectricalElement));
+	thermal_bytes=TObjectArena::object_size(sizeof(TBulkThermalElement));
+	if (TObjectArena::object_size(sizeof(TQWThermalElement))>thermal_bytes)
+		thermal_bytes=TObjectArena::object_size(sizeof(TQWThermalElement));
+
+	if ((!electrical_arena.reserve((req_elements-2)*electrical_bytes+
+								   2*TObjectArena::object_size(sizeof(TOhmicBoundaryElement)))) ||
+		(!thermal_arena.reserve((req_elements-2)*thermal_bytes+
+								2*TObjectArena::object_size(sizeof(TBoundaryThermalElement))))) {
+		error_handler.set_error(ERROR_MEM_SOLUTION_ELEMENT,0,"","");
+		return;
+	}
+
 	temp_solution_grid_ptr=solution_grid_ptr;
 
-	*electrical_element_ptr=new TOhmicBoundaryElement(device_ptr,NULL,*temp_solution_grid_ptr,0);
-	*thermal_element_ptr=new TBoundaryThermalElement(device_ptr,NULL,*temp_solution_grid_ptr,0);
+	*electrical_element_ptr=new(electrical_arena) TOhmicBoundaryElement(device_ptr,NULL,*temp_solution_grid_ptr,0);
+	*thermal_element_ptr=new(thermal_arena) TBoundaryThermalElement(device_ptr,NULL,*temp_solution_grid_ptr,0);
 	if ((!(*thermal_element_ptr)) || (!(*electrical_element_ptr))) {
 		error_handler.set_error(ERROR_MEM_SOLUTION_ELEMENT,0,"","");
 		return;
@@ -305,22 +433,22 @@ void TSolution::establish_elements(void)
 
 	for (i=1;i<req_elements-1;i++) {
 		if ((RegionType)(*(temp_solution_grid_ptr+1))->get_value(GRID_ELECTRICAL,REGION_TYPE,NORMALIZED)==QW) {
-			*(electrical_element_ptr+i)=new TQWElectricalElement(device_ptr, device_grid_ptr,
+			*(electrical_element_ptr+i)=new(electrical_arena) TQWElectricalElement(device_ptr, device_grid_ptr,
 																 *(temp_solution_grid_ptr),*(temp_solution_grid_ptr+1));
-			*(thermal_element_ptr+i)=new TQWThermalElement(device_ptr,device_grid_ptr,
+			*(thermal_element_ptr+i)=new(thermal_arena) TQWThermalElement(device_ptr,device_grid_ptr,
 														   *(temp_solution_grid_ptr),*(temp_solution_grid_ptr+1));
 		}
 		else {
 			if ((RegionType)(*(temp_solution_grid_ptr))->get_value(GRID_ELECTRICAL,REGION_TYPE,NORMALIZED)==QW) {
-				*(electrical_element_ptr+i)=new TQWElectricalElement(device_ptr, device_grid_ptr,
+				*(electrical_element_ptr+i)=new(electrical_arena) TQWElectricalElement(device_ptr, device_grid_ptr,
 																	 *(temp_solution_grid_ptr),*(temp_solution_grid_ptr+1));
-				*(thermal_element_ptr+i)=new TQWThermalElement(device_ptr, device_grid_ptr,
+				*(thermal_element_ptr+i)=new(thermal_arena) TQWThermalElement(device_ptr, device_grid_ptr,
 															   *(temp_solution_grid_ptr),*(temp_solution_grid_ptr+1));
 			}
 			else {
-				*(electrical_element_ptr+i)=new TBulkElectricalElement(device_ptr, device_grid_ptr,
+				*(electrical_element_ptr+i)=new(electrical_arena) TBulkElectricalElement(device_ptr, device_grid_ptr,
 																	   *(temp_solution_grid_ptr),*(temp_solution_grid_ptr+1));
-				*(thermal_element_ptr+i)=new TBulkThermalElement(device_ptr, device_grid_ptr,
+				*(thermal_element_ptr+i)=new(thermal_arena) TBulkThermalElement(device_ptr, device_grid_ptr,
 																 *(temp_solution_grid_ptr),*(temp_solution_grid_ptr+1));
 			}
 		}
@@ -333,17 +461,39 @@ void TSolution::establish_elements(void)
 		temp_solution_grid_ptr++;
 	}
 
-	*(electrical_element_ptr+req_elements-1)=new TOhmicBoundaryElement(device_ptr,*temp_solution_grid_ptr,NULL,1);
-	*(thermal_element_ptr+req_elements-1)=new TBoundaryThermalElement(device_ptr,*temp_solution_grid_ptr,NULL,1);
+	*(electrical_element_ptr+req_elements-1)=new(electrical_arena) TOhmicBoundaryElement(device_ptr,*temp_solution_grid_ptr,NULL,1);
+	*(thermal_element_ptr+req_elements-1)=new(thermal_arena) TBoundaryThermalElement(device_ptr,*temp_solution_grid_ptr,NULL,1);
 	if ((!(*(thermal_element_ptr+req_elements-1))) || (!(*(electrical_element_ptr+req_elements-1)))) {
 		error_handler.set_error(ERROR_MEM_SOLUTION_ELEMENT,0,"","");
 		return;
 	}
 	elements++;
+
+// Runs of electrical elements of one type, evaluated together by TElectricalElement::comp_range_values()
+	element_range=new ElementRange[elements];
+	element_values=new ElementValues[elements];
+	element_derivatives=new ElementDerivatives[elements];
+	if ((!element_range) || (!element_values) || (!element_derivatives)) {
+		error_handler.set_error(ERROR_MEM_SOLUTION_ELEMENT,0,"","");
+		return;
+	}
+
+	for (i=0;i<elements;i++) {
+		if ((element_ranges==0) ||
+			(element_range[element_ranges-1].type!=electrical_element_ptr[i]->get_region_type())) {
+			element_range[element_ranges].type=electrical_element_ptr[i]->get_region_type();
+			element_range[element_ranges].start=i;
+			element_range[element_ranges].count=0;
+			element_ranges++;
+		}
+		element_range[element_ranges-1].count++;
+	}
 }
 
 void TSolution::set_solution(SolveType type)
 {
+	TEnvironment& environment=context->environment;
+	TErrorHandler& error_handler=context->error_handler;
 	int i;
 
 	device_effects=(flag)device_ptr->get_value(DEVICE,EFFECTS,0);
@@ -351,20 +501,27 @@ void TSolution::set_solution(SolveType type)
 	for (i=0;i<elements;i++) (*(thermal_element_ptr+i))->get_effects();
 
 	solve_type=type;
-
-	if (!electrical_jacobian) {
-		electrical_jacobian = new prec*[3*solution_grid_points];
-		if (!electrical_jacobian) {
-			error_handler.set_error(ERROR_MEM_SOLUTION_ARRAYS,0,"","");
-			return;
-		}
-		for (i=0;i<3*solution_grid_points;i++) {
-			*(electrical_jacobian+i)=new prec[9];
-			if (!(*(electrical_jacobian+i))) {
-				error_handler.set_error(ERROR_MEM_SOLUTION_ARRAYS,0,"","");
-				return;
-			}
-		}
+	coupled_thermal=((flag)environment.get_value(ENVIRONMENT,EFFECTS) & ENV_COUPLED_THERMAL) &&
+					(solve_type==STEADY_STATE) && (device_effects & DEVICE_NON_ISOTHERMAL) &&
+					(device_effects & (DEVICE_SINGLE_TEMP | DEVICE_VARY_LATTICE_TEMP));
+	coupled_photons=((flag)environment.get_value(ENVIRONMENT,EFFECTS) & ENV_COUPLED_PHOTONS) &&
+					(solve_type==STEADY_STATE) && (device_effects & DEVICE_LASER);
+	if ((device_effects & DEVICE_NON_ISOTHERMAL) &&	(solve_type!=EQUILIBRIUM))
+		anderson_depth=(int)environment.get_value(ENVIRONMENT,ANDERSON_DEPTH);
+	else anderson_depth=0;
+	anderson_passes=0;
+	anderson_history=0;
+	anderson_columns=0;
+	anderson_error=0.0;
+	anderson_ratio=0.0;
+	anderson_relaxed_ratio=0.0;
+	jacobian_factored=FALSE;
+	previous_elect_error=0.0;
+	previous_elect_ratio=0.0;
+
+	if (!electrical_jacobian.allocate(3*MAX_ELECT_VARIABLES*MAX_ELECT_VARIABLES*solution_grid_points)) {
+		error_handler.set_error(ERROR_MEM_SOLUTION_ARRAYS,0,"","");
+		return;
 	}
 
 	if (!electrical_solution[0]) {
@@ -391,31 +548,88 @@ void TSolution::set_solution(SolveType type)
 		}
 	}
 
+	if (environment.get_value(ENVIRONMENT,MAX_LINE_SEARCH_ITER)>0) {
+		for (i=0;i<3;i++) {
+			if (!electrical_step[i]) {
+				electrical_step[i] = new prec[solution_grid_points];
+				if (!electrical_step[i]) {
+					error_handler.set_error(ERROR_MEM_SOLUTION_ARRAYS,0,"","");
+					return;
+				}
+			}
+		}
+	}
+
 	if ((device_effects & DEVICE_NON_ISOTHERMAL) &&	(solve_type!=EQUILIBRIUM)) {
-		if (!thermal_jacobian) {
-			thermal_jacobian = new prec*[solution_grid_points];
-			if (!thermal_jacobian) {
+		if (!thermal_jacobian.allocate(3*solution_grid_points)) {
+			error_handler.set_error(ERROR_MEM_SOLUTION_ARRAYS,0,"","");
+			return;
+		}
+
+		if (!thermal_solution) {
+			thermal_solution= new prec[solution_grid_points];
+			if (!thermal_solution) {
 				error_handler.set_error(ERROR_MEM_SOLUTION_ARRAYS,0,"","");
 				return;
 			}
-			for (i=0;i<solution_grid_points;i++) {
-				*(thermal_jacobian+i)=new prec[3];
-				if (!(*(electrical_jacobian+i))) {
+		}
+
+		for (i=0;i<anderson_depth+1;i++) {
+			if (!anderson_residual[i]) {
+				anderson_residual[i]= new prec[3*solution_grid_points];
+				if (!anderson_residual[i]) {
+					error_handler.set_error(ERROR_MEM_SOLUTION_ARRAYS,0,"","");
+					return;
+				}
+			}
+
+			if (!anderson_step[i]) {
+				anderson_step[i]= new prec[3*solution_grid_points];
+				if (!anderson_step[i]) {
 					error_handler.set_error(ERROR_MEM_SOLUTION_ARRAYS,0,"","");
 					return;
 				}
 			}
 		}
+	}
 
-		if (!thermal_solution) {
-			thermal_solution= new prec[solution_grid_points];
-			if (!thermal_solution) {
+	if (coupled_thermal) {
+		if (!coupled_jacobian.allocate(3*COUPLED_VARIABLES*COUPLED_VARIABLES*solution_grid_points)) {
+			error_handler.set_error(ERROR_MEM_SOLUTION_ARRAYS,0,"","");
+			return;
+		}
+
+		for (i=0;i<COUPLED_VARIABLES;i++) {
+			if (!coupled_solution[i]) {
+				coupled_solution[i] = new prec[solution_grid_points];
+				if (!coupled_solution[i]) {
+					error_handler.set_error(ERROR_MEM_SOLUTION_ARRAYS,0,"","");
+					return;
+				}
+			}
+		}
+
+		if (!coupled_step) {
+			coupled_step= new prec[solution_grid_points];
+			if (!coupled_step) {
 				error_handler.set_error(ERROR_MEM_SOLUTION_ARRAYS,0,"","");
 				return;
 			}
 		}
 	}
 
+	if (coupled_photons) {
+		for (i=0;i<3;i++) {
+			if (!photon_column[i]) {
+				photon_column[i] = new prec[solution_grid_points];
+				if (!photon_column[i]) {
+					error_handler.set_error(ERROR_MEM_SOLUTION_ARRAYS,0,"","");
+					return;
+				}
+			}
+		}
+	}
+
 	contact_flag_0=(flag)device_ptr->get_value(CONTACT,EFFECTS,0);
 	contact_flag_1=(flag)device_ptr->get_value(CONTACT,EFFECTS,1);
 	surface_flag_0=(flag)device_ptr->get_value(SURFACE,EFFECTS,0);
@@ -448,6 +662,14 @@ void TSolution::set_solution(SolveType type)
 		default: break;
 	}
 	electrical_unknown_nodes=electrical_end_node-electrical_start_node+1;
+
+	if (coupled_thermal) {
+		if (electrical_start_node<thermal_start_node) coupled_start_node=electrical_start_node;
+		else coupled_start_node=thermal_start_node;
+		if (electrical_end_node>thermal_end_node) coupled_end_node=electrical_end_node;
+		else coupled_end_node=thermal_end_node;
+		coupled_unknown_nodes=coupled_end_node-coupled_start_node+1;
+	}
 }
 
 void TSolution::comp_deriv_recomb(void)
@@ -469,8 +691,11 @@ void TSolution::comp_deriv_conc(void)
 
 	for (i=0;i<quantum_wells;i++) (*(qw_ptr+i))->comp_deriv_conc();
 
+	TNode::comp_grid_deriv_conc(device_grid_ptr,device_grid_points,ELECTRON);
+	TNode::comp_grid_deriv_conc(device_grid_ptr,device_grid_points,HOLE);
+
 	temp_ptr=device_grid_ptr;
-	for (i=0;i<device_grid_points;i++) (*(temp_ptr++))->comp_deriv_conc();
+	for (i=0;i<device_grid_points;i++) (*(temp_ptr++))->comp_deriv_ionized_doping();
 }
 
 void TSolution::comp_deriv_thermal_conduct(void)
@@ -485,18 +710,30 @@ void TSolution::comp_deriv_thermal_conduct(void)
 
 void TSolution::comp_deriv_electron_hotcarriers(void)
 {
-	int i;
+	TNode::comp_grid_deriv_hotcarriers(device_grid_ptr,device_grid_points,ELECTRON);
+}
 
-	TNode**temp_ptr;
+/*
+	The jacobian and the residuals are assembled in two passes, each over contiguous blocks of
+	elements or nodes, see run_assembly(). The first pass evaluates the elements and the second
+	builds the rows of the nodes from the elements on either side. A node at the seam of two
+	blocks reads the elements of both only once the first pass is complete, so each row is
+	added up in the same order as in the serial assembly.
+*/
+void TSolution::comp_electrical_jacobian(void)
+{
+	if (solve_type==STEADY_STATE) assembly_return_flag=ALL_DERIV;
+	else assembly_return_flag=D_PSI;
 
-	temp_ptr=device_grid_ptr;
-	for (i=0;i<device_grid_points;i++) (*temp_ptr++)->comp_deriv_electron_hotcarriers();
+	run_assembly(ASSEMBLE_ELECTRICAL_DERIVATIVES,electrical_start_node,electrical_end_node+1);
+	run_assembly(ASSEMBLE_ELECTRICAL_JACOBIAN,electrical_start_node,electrical_end_node);
 }
 
-void TSolution::comp_electrical_jacobian(void)
+void TSolution::comp_electrical_jacobian_rows(int first_node, int last_node)
 {
 	int i,k,l;
-	prec **jacobian_ptr;
+	int row_number;
+	BlockJacobianView jacobian;
 	prec *row_ptr;
 	int required_deriv;
 
@@ -512,44 +749,44 @@ void TSolution::comp_electrical_jacobian(void)
 					  electron_rate_deriv_next,
 					  hole_rate_deriv_next;
 
-	jacobian_ptr=electrical_jacobian;
+	jacobian=electrical_jacobian.get_view(number_elect_variables);
+	row_number=(first_node-electrical_start_node)*number_elect_variables;
+	required_deriv=assembly_return_flag;
 
 	switch(solve_type) {
 		case EQUILIBRIUM:
 
-			for (i=electrical_start_node;i<=electrical_end_node;i++) {
-				row_ptr=*(jacobian_ptr);
+			for (i=first_node;i<=last_node;i++) {
+				row_ptr=jacobian.get_row(row_number);
 
 				// Previous element value
 
 				if (i==electrical_start_node) *(row_ptr++)=0;
 				else {
-					poisson_deriv_prev=comp_deriv_poisson(i,PREVIOUS_NODE,D_PSI);
+					poisson_deriv_prev=comp_deriv_poisson(i,PREVIOUS_NODE,required_deriv);
 					*(row_ptr++)=poisson_deriv_prev.psi;
 				}
 
 				// Current element value
 
-				poisson_deriv_curr=comp_deriv_poisson(i,CURRENT_NODE,D_PSI);
+				poisson_deriv_curr=comp_deriv_poisson(i,CURRENT_NODE,required_deriv);
 				*(row_ptr++)=poisson_deriv_curr.psi;
 
 				// Next element value
 
 				if (i==electrical_end_node) *(row_ptr)=0;
 				else {
-					poisson_deriv_next=comp_deriv_poisson(i,NEXT_NODE,D_PSI);
+					poisson_deriv_next=comp_deriv_poisson(i,NEXT_NODE,required_deriv);
 					*(row_ptr)=poisson_deriv_next.psi;
 				}
-				jacobian_ptr++;
+				row_number++;
 			}
 			break;
 		case STEADY_STATE:
 
-			required_deriv=ALL_DERIV;
-
-			for (i=electrical_start_node;i<=electrical_end_node;i++) {
+			for (i=first_node;i<=last_node;i++) {
 				for (k=0;k<3;k++) {
-					row_ptr=*(jacobian_ptr);
+					row_ptr=jacobian.get_row(row_number);
 					switch(k) {
 						case 0:
 							if (i==electrical_start_node) {
@@ -694,68 +931,68 @@ void TSolution::comp_electrical_jacobian(void)
 							break;
 						default: break;
 					}
-					jacobian_ptr++;
+					row_number++;
 				}
 			}
 		default: break;
 	}
 }
 
-void TSolution::comp_electrical_solution(void)
+/*
+	Residual of the electrical equations. With fused_current each element also evaluates the
+	partials of its currents in the same pass, for the comp_electrical_jacobian() that follows.
+	The element values are taken first, one run of element types at a time, and the residual
+	of each node is then put together from the values of the elements on either side.
+*/
+void TSolution::comp_electrical_solution(logical fused_current)
+{
+	int i;
+	long evaluations=0;
+
+	assembly_fused_current=fused_current;
+	run_assembly(ASSEMBLE_ELECTRICAL_VALUES,electrical_start_node,electrical_end_node+1);
+	for (i=0;i<assembly_blocks;i++) evaluations+=assembly_evaluations[i];
+	device_ptr->get_tunnel_quadrature().evaluations+=evaluations;
+
+	run_assembly(ASSEMBLE_ELECTRICAL_SOLUTION,electrical_start_node,electrical_end_node);
+}
+
+void TSolution::comp_electrical_solution_rows(int first_node, int last_node)
 {
 	int i;
 
-	prec electron_current_0, electron_current_1;
-	prec hole_current_0, hole_current_1;
 	prec recombination_integral;
-	prec field_0, field_1;
 
-	TElectricalElement** temp_ele_ptr;
-	TElectricalElement* prev_elem, *next_elem;
+	ElementValues *prev_values, *next_values;
 	prec *solution_ptr_0, *solution_ptr_1, *solution_ptr_2;
 
-	solution_ptr_0=electrical_solution[0];
-	solution_ptr_1=electrical_solution[1];
-	solution_ptr_2=electrical_solution[2];
-	temp_ele_ptr=electrical_element_ptr+electrical_start_node;
+	solution_ptr_0=electrical_solution[0]+first_node-electrical_start_node;
+	solution_ptr_1=electrical_solution[1]+first_node-electrical_start_node;
+	solution_ptr_2=electrical_solution[2]+first_node-electrical_start_node;
 
-	prev_elem=*(temp_ele_ptr++);
+	prev_values=element_values+first_node;
 
 	switch(solve_type) {
 		case EQUILIBRIUM:
 
-			field_0=prev_elem->comp_field();
+			for (i=first_node;i<=last_node;i++) {
+				next_values=prev_values+1;
 
-			for (i=electrical_start_node;i<=electrical_end_node;i++) {
-				next_elem=*temp_ele_ptr++;
-
-				field_1=next_elem->comp_field();
-
-				*(solution_ptr_0++)=field_1-field_0-
-									next_elem->comp_integral_charge(FIRSTHALF)-
-									prev_elem->comp_integral_charge(SECONDHALF);
-
-				field_0=field_1;
+				*(solution_ptr_0++)=next_values->field-prev_values->field-
+									next_values->integral_charge_first-
+									prev_values->integral_charge_second;
 
-				prev_elem=next_elem;
+				prev_values=next_values;
 			}
 			break;
 		case STEADY_STATE:
-			electron_current_0=prev_elem->comp_electron_current();
-			hole_current_0=prev_elem->comp_hole_current();
-			field_0=prev_elem->comp_field();
-
-			for (i=electrical_start_node;i<=electrical_end_node;i++) {
-				next_elem=*temp_ele_ptr;
-
-				electron_current_1=next_elem->comp_electron_current();
-				hole_current_1=next_elem->comp_hole_current();
-				field_1=next_elem->comp_field();
+			for (i=first_node;i<=last_node;i++) {
+				next_values=prev_values+1;
 
-				recombination_integral=prev_elem->comp_integral_recomb(SECONDHALF)+
-									   next_elem->comp_integral_recomb(FIRSTHALF);
+				recombination_integral=prev_values->integral_recomb_second+
+									   next_values->integral_recomb_first;
 
-            	*(solution_ptr_0++)=electron_current_1-electron_current_0-
+            	*(solution_ptr_0++)=next_values->electron_current-prev_values->electron_current-
                 			 		recombination_integral;
 
                 if ( ((i==electrical_start_node) && !(contact_flag_0 & CONTACT_IDEALOHMIC)) ||
@@ -763,37 +1000,38 @@ void TSolution::comp_electrical_solution(void)
                 	*(solution_ptr_1++)=0.0;
                 }
                 else {
-                	*(solution_ptr_1++)=field_1-field_0-
-                    					next_elem->comp_integral_charge(FIRSTHALF)-
-                                        prev_elem->comp_integral_charge(SECONDHALF);
+                	*(solution_ptr_1++)=next_values->field-prev_values->field-
+                    					next_values->integral_charge_first-
+                                        prev_values->integral_charge_second;
                 }
 
-                *(solution_ptr_2++)=hole_current_1-hole_current_0+
+                *(solution_ptr_2++)=next_values->hole_current-prev_values->hole_current+
                 					recombination_integral;
 
-				electron_current_0=electron_current_1;
-				hole_current_0=hole_current_1;
-				field_0=field_1;
-
-				prev_elem=next_elem;
-
-				temp_ele_ptr++;
+				prev_values=next_values;
 			}
 			break;
 	}
 }
 
 void TSolution::comp_thermal_jacobian(void)
+{
+	run_assembly(ASSEMBLE_THERMAL_JACOBIAN,thermal_start_node,thermal_end_node);
+}
+
+void TSolution::comp_thermal_jacobian_rows(int first_node, int last_node)
 {
 	int i;
-	prec **jacobian_ptr;
+	int row_number;
+	BlockJacobianView jacobian;
 	prec *row_ptr;
 
-	jacobian_ptr=thermal_jacobian;
+	jacobian=thermal_jacobian.get_view(1);
+	row_number=first_node-thermal_start_node;
 
 	if (device_effects & (DEVICE_SINGLE_TEMP | (DEVICE_VARY_LATTICE_TEMP))) {
-		for (i=thermal_start_node;i<=thermal_end_node;i++) {
-			row_ptr=*(jacobian_ptr);
+		for (i=first_node;i<=last_node;i++) {
+			row_ptr=jacobian.get_row(row_number);
 
 			// Previous element value
 
@@ -809,13 +1047,13 @@ void TSolution::comp_thermal_jacobian(void)
 			if (i==thermal_end_node) *(row_ptr)=0;
 			else *(row_ptr)=comp_deriv_heat_rate(i,NEXT_NODE);
 
-			jacobian_ptr++;
+			row_number++;
 		}
 	}
 	else {
 		if (device_effects & (DEVICE_VARY_ELECTRON_TEMP)) {
-			for (i=thermal_start_node;i<=thermal_end_node;i++) {
-				row_ptr=*(jacobian_ptr);
+			for (i=first_node;i<=last_node;i++) {
+				row_ptr=jacobian.get_row(row_number);
 
 				// Previous element value
 
@@ -831,13 +1069,23 @@ void TSolution::comp_thermal_jacobian(void)
 				if (i==thermal_end_node) *(row_ptr)=0;
 				else *(row_ptr)=comp_deriv_rate_hotcarriers_electron(i,NEXT_NODE);
 
-				jacobian_ptr++;
+				row_number++;
 			}
 		}
 	}
 }
 
 void TSolution::comp_thermal_solution(void)
+{
+	run_assembly(ASSEMBLE_THERMAL_SOLUTION,thermal_start_node,thermal_end_node);
+}
+
+/*
+	The heat flows of each element are used by the nodes on both sides. A block of nodes
+	evaluates the flows of the element before its first node itself, the same values the
+	block before it finds for the element after its last node.
+*/
+void TSolution::comp_thermal_solution_rows(int first_node, int last_node)
 {
 	int i;
 	TThermalElement **temp_ele_ptr;
@@ -848,8 +1096,8 @@ void TSolution::comp_thermal_solution(void)
 	prec hole_heat_flow_0, hole_heat_flow_1;
 	prec trans_heat_flow_0, trans_heat_flow_1;
 
-	solution_ptr=thermal_solution;
-	temp_ele_ptr=thermal_element_ptr+thermal_start_node;
+	solution_ptr=thermal_solution+first_node-thermal_start_node;
+	temp_ele_ptr=thermal_element_ptr+first_node;
 
 	prev_elem=*(temp_ele_ptr++);
 
@@ -859,7 +1107,7 @@ void TSolution::comp_thermal_solution(void)
 		hole_heat_flow_0=prev_elem->comp_hole_heat_flow();
 		trans_heat_flow_0=prev_elem->comp_trans_heat_flow();
 
-		for (i=thermal_start_node;i<=thermal_end_node;i++) {
+		for (i=first_node;i<=last_node;i++) {
 			next_elem=*temp_ele_ptr++;
 
 			lat_heat_flow_1=next_elem->comp_lat_heat_flow();
@@ -893,7 +1141,7 @@ void TSolution::comp_thermal_solution(void)
 		if(device_effects & DEVICE_VARY_ELECTRON_TEMP) {
 			electron_heat_flow_0=prev_elem->comp_electron_heat_flow();
 
-			for (i=thermal_start_node;i<=thermal_end_node;i++) {
+			for (i=first_node;i<=last_node;i++) {
 				next_elem=*temp_ele_ptr++;
 
 				electron_heat_flow_1=next_elem->comp_electron_heat_flow();
@@ -911,177 +1159,113 @@ void TSolution::comp_thermal_solution(void)
 	}
 }
 
-void TSolution::factor_jacobian(prec **jacobian, int variables, int unknown_nodes)
+/*
+	Runs one pass of the assembly over first to last, the elements or the nodes depending on
+	the pass. A device with at least ASSEMBLY_MIN_NODES nodes has the range split into one
+	contiguous block per worker of the worker pool of its context, each block assembled
+	on its own thread. The blocks of a pass only write their own elements or rows, so the
+	result does not depend on the number of blocks. Below the limit, or with it at zero, the
+	pass is one block on the calling thread.
+*/
+void TSolution::run_assembly(AssemblyPass pass, int first, int last)
 {
-	int i,k,l,m;
-	prec **current_row_ptr;
-	prec *diagonal_ptr;
-	prec **reduce_row_ptr;
-	prec *reduce_element_ptr;
-
-	current_row_ptr=jacobian;
-
-	for (i=0;i<unknown_nodes;i++) {
-
-		for (l=0;l<variables;l++) {
-			diagonal_ptr=*(current_row_ptr)+variables+l;
-			reduce_row_ptr=current_row_ptr+1;
-
-			for (k=l+1;k<variables;k++) {
-				reduce_element_ptr=*(reduce_row_ptr)+variables+l;
-
-				*reduce_element_ptr/=(*(diagonal_ptr));
-
-				for(m=1;m<variables-l;m++) {
-					*(reduce_element_ptr+m)-=(*(reduce_element_ptr))*(*(diagonal_ptr+m));
-				}
-
-				if (i!=unknown_nodes-1) {
-					for(m=0;m<variables;m++) {
-						*(reduce_element_ptr+variables-l+m)-=
-							(*(reduce_element_ptr))*(*(diagonal_ptr+variables-l+m));
-					}
-				}
-				reduce_row_ptr++;
-			}
-
-			if (i!=unknown_nodes-1) {
-
-				for (k=0;k<variables;k++) {
-					reduce_element_ptr=*(reduce_row_ptr)+l;
-
-					*(reduce_element_ptr)/=(*(diagonal_ptr));
-
-					for(m=1;m<variables-l;m++) {
-						*(reduce_element_ptr+m)-=(*(reduce_element_ptr))*(*(diagonal_ptr+m));
-					}
-
-					for(m=0;m<variables;m++) {
-						*(reduce_element_ptr+variables-l+m)-=
-							(*(reduce_element_ptr))*(*(diagonal_ptr+variables-l+m));
-					}
-					reduce_row_ptr++;
-				}
-			}
-			current_row_ptr++;
-		}
+	long min_nodes;
+	TWorkerPool *pool=(TWorkerPool *)0;
+
+	assembly_pass=pass;
+	assembly_first=first;
+	assembly_last=last;
+	assembly_blocks=1;
+
+	min_nodes=(long)context->environment.get_value(ENVIRONMENT,ASSEMBLY_MIN_NODES);
+	if (min_nodes && (solution_grid_points>=min_nodes)) {
+		pool=context->get_worker_pool();
+		assembly_blocks=pool->get_number_workers();
+		if (assembly_blocks>MAX_ASSEMBLY_BLOCKS) assembly_blocks=MAX_ASSEMBLY_BLOCKS;
+		if (assembly_blocks>last-first+1) assembly_blocks=last-first+1;
 	}
+
+	if (assembly_blocks>1) pool->run(assembly_task,this,assembly_blocks);
+	else assemble_block(0);
 }
 
-void TSolution::solve_electrical_jacobian(void)
+void TSolution::assembly_task(void *solution, int block_number)
 {
-	int i,k,l;
-	prec** jacobian_ptr;
-	prec *diagonal_ptr;
-	prec *solution_ptr[3];
-
-//	Forward Solve
-
-	jacobian_ptr=electrical_jacobian;
-	solution_ptr[0]=electrical_solution[0];
-	solution_ptr[1]=electrical_solution[1];
-	solution_ptr[2]=electrical_solution[2];
+	((TSolution *)solution)->assemble_block(block_number);
+}
 
-	for (i=1;i<=electrical_unknown_nodes;i++) {
-		for (k=0;k<number_elect_variables;k++) {
-			diagonal_ptr=*(jacobian_ptr)+number_elect_variables+k;
+void TSolution::assemble_block(int block_number)
+{
+	int first, last, count;
 
-			if (i!=1) {
-				for (l=-number_elect_variables-k;l<=-1-k;l++)
-					*(solution_ptr[k])-=*(diagonal_ptr+l)*(*(solution_ptr[l+k+number_elect_variables]-1));
-			}
+	count=assembly_last-assembly_first+1;
+	first=assembly_first+(int)(((long)count*block_number)/assembly_blocks);
+	last=assembly_first+(int)(((long)count*(block_number+1))/assembly_blocks)-1;
 
-			for (l=-k;l<=-1;l++)
-				*(solution_ptr[k])-=*(diagonal_ptr+l)*(*(solution_ptr[k+l]));
+	assembly_evaluations[block_number]=0;
 
-			jacobian_ptr++;
-		}
-		solution_ptr[0]++;
-		solution_ptr[1]++;
-		solution_ptr[2]++;
+	switch(assembly_pass) {
+		case ASSEMBLE_ELECTRICAL_VALUES:
+			assembly_evaluations[block_number]=
+				TElectricalElement::comp_range_values(electrical_element_ptr,element_range,element_ranges,
+													  first,last,element_values,solve_type,
+													  assembly_fused_current);
+			break;
+		case ASSEMBLE_ELECTRICAL_DERIVATIVES:
+			TElectricalElement::comp_range_derivatives(electrical_element_ptr,element_range,element_ranges,
+													   first,last,element_derivatives,
+													   assembly_return_flag,solve_type);
+			break;
+		case ASSEMBLE_ELECTRICAL_SOLUTION: comp_electrical_solution_rows(first,last); break;
+		case ASSEMBLE_ELECTRICAL_JACOBIAN: comp_electrical_jacobian_rows(first,last); break;
+		case ASSEMBLE_THERMAL_SOLUTION: comp_thermal_solution_rows(first,last); break;
+		case ASSEMBLE_THERMAL_JACOBIAN: comp_thermal_jacobian_rows(first,last); break;
 	}
+}
 
-//	Backward Solve
-
-	jacobian_ptr=electrical_jacobian+number_elect_variables*electrical_unknown_nodes-1;
-	solution_ptr[0]=electrical_solution[0]+electrical_unknown_nodes-1;
-	solution_ptr[1]=electrical_solution[1]+electrical_unknown_nodes-1;
-	solution_ptr[2]=electrical_solution[2]+electrical_unknown_nodes-1;
+/*
+	Number of partitions of the partitioned solver for a jacobian of unknown_nodes nodes, 0
+	for the sequential solver. A jacobian with at least PARTITION_MIN_NODES nodes gets one
+	partition per worker, with at least MIN_PARTITION_NODES nodes each and at most
+	MAX_BLOCK_PARTITIONS. The partitioned solver does several times the work of the
+	sequential one, so a single worker always uses the sequential solver.
+*/
+int TSolution::comp_partitions(int unknown_nodes)
+{
+	long min_nodes;
+	int partitions, workers;
 
-	for (i=electrical_unknown_nodes;i>=1;i--) {
-		for (k=0;k<number_elect_variables;k++) {
-			diagonal_ptr=*(jacobian_ptr)+2*number_elect_variables-(k+1);
+	min_nodes=(long)context->environment.get_value(ENVIRONMENT,PARTITION_MIN_NODES);
+	if ((!min_nodes) || (unknown_nodes<min_nodes)) return(0);
 
-			if (i!=electrical_unknown_nodes) {
-				for (l=number_elect_variables+k;l>=1+k;l--)
-					*(solution_ptr[number_elect_variables-1-k])-=*(diagonal_ptr+l)*(*(solution_ptr[l-k-1]+1));
-			}
+	workers=context->get_worker_pool()->get_number_workers();
+	if (workers<2) return(0);
 
-			for (l=k;l>=1;l--)
-				*(solution_ptr[number_elect_variables-1-k])-=*(diagonal_ptr+l)*(*(solution_ptr[number_elect_variables-1-k+l]));
+	partitions=unknown_nodes/MIN_PARTITION_NODES;
+	if (partitions>workers) partitions=workers;
+	if (partitions>MAX_BLOCK_PARTITIONS) partitions=MAX_BLOCK_PARTITIONS;
+	if (partitions<2) return(0);
+	return(partitions);
+}
 
-			*(solution_ptr[number_elect_variables-1-k])/=*(diagonal_ptr);
+void TSolution::factor_jacobian(TBlockJacobian& jacobian, int variables, int unknown_nodes)
+{
+	jacobian.factor(variables,unknown_nodes,comp_partitions(unknown_nodes),context->get_worker_pool());
+}
 
-			jacobian_ptr--;
-		}
-		solution_ptr[0]--;
-		solution_ptr[1]--;
-		solution_ptr[2]--;
-	}
+void TSolution::solve_electrical_jacobian(prec **solution)
+{
+	electrical_jacobian.solve(number_elect_variables,solution,electrical_unknown_nodes);
 }
 
 void TSolution::solve_thermal_jacobian(void)
 {
-	int i,k,l;
-	prec** jacobian_ptr;
-	prec *diagonal_ptr;
-	prec *solution_ptr;
-
-//	Forward Solve
-
-	jacobian_ptr=thermal_jacobian;
-	solution_ptr=thermal_solution;
-
-	for (i=1;i<=thermal_unknown_nodes;i++) {
-		for (k=0;k<1;k++) {
-			diagonal_ptr=*(jacobian_ptr)+1+k;
-
-			if (i!=1) {
-				for (l=-1-k;l<=-1-k;l++)
-					*(solution_ptr)-=*(diagonal_ptr+l)*(*(solution_ptr+l));
-			}
-
-			for (l=-k;l<=-1;l++)
-				*(solution_ptr)-=*(diagonal_ptr+l)*(*(solution_ptr+l));
-
-			solution_ptr++;
-			jacobian_ptr++;
-		}
-	}
-
-//	Backward Solve
-
-	jacobian_ptr=thermal_jacobian+1*thermal_unknown_nodes-1;
-	solution_ptr=thermal_solution+1*thermal_unknown_nodes-1;
-
-	for (i=thermal_unknown_nodes;i>=1;i--) {
-		for (k=0;k<1;k++) {
-			diagonal_ptr=*(jacobian_ptr)+2*1-(k+1);
-
-			if (i!=thermal_unknown_nodes) {
-				for (l=1+k;l>=1+k;l--)
-					*(solution_ptr)-=*(diagonal_ptr+l)*(*(solution_ptr+l));
-			}
-
-			for (l=k;l>=1;l--)
-				*(solution_ptr)-=*(diagonal_ptr+l)*(*(solution_ptr+l));
-
-			*(solution_ptr)/=*(diagonal_ptr);
+	thermal_jacobian.solve(1,&thermal_solution,thermal_unknown_nodes);
+}
 
-			solution_ptr--;
-			jacobian_ptr--;
-		}
-	}
+void TSolution::solve_coupled_jacobian(void)
+{
+	coupled_jacobian.solve(COUPLED_VARIABLES,coupled_solution,coupled_unknown_nodes);
 }
 
 void TSolution::electrical_update_device(void)
@@ -1098,8 +1282,8 @@ void TSolution::electrical_update_device(void)
 	solution_ptr_2=electrical_solution[2];
 	temp_ptr=electrical_element_ptr+electrical_start_node;
 
-	clamp_value=environment.get_value(ENVIRONMENT,POT_CLAMP_VALUE);
-	should_clamp=((flag)environment.get_value(ENVIRONMENT,EFFECTS) & ENV_CLAMP_POTENTIAL)!=0;
+	clamp_value=context->environment.get_value(ENVIRONMENT,POT_CLAMP_VALUE);
+	should_clamp=((flag)context->environment.get_value(ENVIRONMENT,EFFECTS) & ENV_CLAMP_POTENTIAL)!=0;
 
 	switch(solve_type) {
 		case EQUILIBRIUM:
@@ -1154,8 +1338,177 @@ void TSolution::electrical_update_device(void)
 	}
 }
 
+/*
+	Moves the device by step_factor times the update in step, one array per electrical
+	variable. The update is not clamped.
+*/
+void TSolution::electrical_step_device(prec **step, prec step_factor)
+{
+	int i;
+	prec *step_ptr_0, *step_ptr_1, *step_ptr_2;
+	TElectricalElement **temp_ptr;
+	FundamentalParam update_amount;
+
+	step_ptr_0=step[0];
+	step_ptr_1=step[1];
+	step_ptr_2=step[2];
+	temp_ptr=electrical_element_ptr+electrical_start_node;
+
+	switch(solve_type) {
+		case EQUILIBRIUM:
+			update_amount.eta_c=update_amount.eta_v=0.0;
+
+			for (i=0;i<electrical_unknown_nodes;i++) {
+				update_amount.psi=step_factor*(*(step_ptr_0++));
+				(*(temp_ptr++))->update(update_amount);
+			}
+			break;
+		case STEADY_STATE:
+			for (i=0;i<electrical_unknown_nodes;i++) {
+				update_amount.eta_c=step_factor*(*(step_ptr_0++));
+				update_amount.psi=step_factor*(*(step_ptr_1++));
+				update_amount.eta_v=step_factor*(*(step_ptr_2++));
+				(*(temp_ptr++))->update(update_amount);
+			}
+			break;
+		default: break;
+	}
+}
+
+/*
+	Damped Newton update. As long as every component of the Newton update in
+	electrical_solution is below POT_CLAMP_VALUE the whole update is taken. Otherwise the
+	unclamped update is cut by LINE_SEARCH_REDUCTION, at most MAX_LINE_SEARCH_ITER times,
+	until the norm of the residual has dropped by a fraction LINE_SEARCH_DECREASE of the step
+	and below the norm after the clamped update. The first trial moves no component by more
+	than LINE_SEARCH_MAX_CLAMPS times the clamp value, which keeps the trial values finite, and
+	the search stops once the largest component falls below the clamp value. Each trial
+	evaluates only the residual, no jacobian is built. If no step is accepted the clamped
+	update is taken. The device values are left computed at the new solution.
+*/
+void TSolution::electrical_line_search(prec *initial_residual)
+{
+	TEnvironment& environment=context->environment;
+	int i,j;
+	int max_line_search_iter;
+	prec step_factor, applied_factor;
+	prec clamp_value, max_update;
+	prec initial_norm, clamp_norm, trial_norm;
+
+	max_line_search_iter=(int)environment.get_value(ENVIRONMENT,MAX_LINE_SEARCH_ITER);
+	clamp_value=environment.get_value(ENVIRONMENT,POT_CLAMP_VALUE);
+
+	max_update=0.0;
+	for (i=0;i<number_elect_variables;i++) {
+		for (j=0;j<electrical_unknown_nodes;j++) {
+			electrical_step[i][j]=electrical_solution[i][j];
+			if (fabs(electrical_step[i][j])>max_update) max_update=fabs(electrical_step[i][j]);
+		}
+	}
+
+	if (max_update<clamp_value) {
+		electrical_step_device(electrical_step,1.0);
+		comp_electrical_values();
+		return;
+	}
+
+	initial_norm=0.0;
+	for (i=0;i<number_elect_variables;i++) initial_norm+=initial_residual[i]*initial_residual[i];
+	initial_norm=sqrt(initial_norm);
+
+	clamp_electrical_step();
+	electrical_step_device(electrical_solution,1.0);
+	clamp_norm=comp_trial_norm();
+	clamp_electrical_step();
+	electrical_step_device(electrical_solution,-1.0);
+
+	if (max_update>LINE_SEARCH_MAX_CLAMPS*clamp_value)
+		step_factor=LINE_SEARCH_MAX_CLAMPS*clamp_value/max_update;
+	else step_factor=1.0;
+	applied_factor=0.0;
+	for (i=0;(i<=max_line_search_iter) && (step_factor*max_update>=clamp_value);i++) {
+		electrical_step_device(electrical_step,step_factor-applied_factor);
+		applied_factor=step_factor;
+
+		trial_norm=comp_trial_norm();
+		if ((trial_norm<=(1.0-LINE_SEARCH_DECREASE*step_factor)*initial_norm) &&
+			(trial_norm<clamp_norm)) return;
+
+		step_factor*=LINE_SEARCH_REDUCTION;
+	}
+
+	electrical_step_device(electrical_step,-applied_factor);
+	clamp_electrical_step();
+	electrical_step_device(electrical_solution,1.0);
+	comp_electrical_values();
+}
+
+/*
+	Puts the update in electrical_step into electrical_solution with the components limited to
+	the clamp value as electrical_update_device() does.
+*/
+void TSolution::clamp_electrical_step(void)
+{
+	TEnvironment& environment=context->environment;
+	int i,j;
+	prec clamp_value, update_amount;
+	logical should_clamp;
+
+	clamp_value=environment.get_value(ENVIRONMENT,POT_CLAMP_VALUE);
+	for (i=0;i<number_elect_variables;i++) {
+		if ((solve_type==STEADY_STATE) && (i!=1)) should_clamp=TRUE;
+		else should_clamp=((flag)environment.get_value(ENVIRONMENT,EFFECTS) & ENV_CLAMP_POTENTIAL)!=0;
+
+		for (j=0;j<electrical_unknown_nodes;j++) {
+			update_amount=electrical_step[i][j];
+			if (should_clamp && (fabs(update_amount)>=clamp_value)) {
+				if (update_amount>0) update_amount=clamp_value;
+				else update_amount=-clamp_value;
+			}
+			electrical_solution[i][j]=update_amount;
+		}
+	}
+}
+
+/*
+	Norm of the residual of all electrical equations at the present device solution. The
+	residual is left in electrical_solution.
+*/
+prec TSolution::comp_trial_norm(void)
+{
+	int i;
+	prec residual[MAX_ELECT_VARIABLES];
+	prec norm;
+
+	comp_electrical_values();
+	comp_electrical_dep_param(solve_type);
+	comp_electrical_solution(FALSE);
+	comp_electrical_residual(residual);
+
+	norm=0.0;
+	for (i=0;i<number_elect_variables;i++) norm+=residual[i]*residual[i];
+	return(sqrt(norm));
+}
+
+/*
+	Euclidean norm of the residual of each equation in electrical_solution, as left by
+	comp_electrical_solution().
+*/
+void TSolution::comp_electrical_residual(prec *residual)
+{
+	int i,j;
+	prec sum;
+
+	for (i=0;i<number_elect_variables;i++) {
+		sum=0.0;
+		for (j=0;j<electrical_unknown_nodes;j++) sum+=electrical_solution[i][j]*electrical_solution[i][j];
+		residual[i]=sqrt(sum);
+	}
+}
+
 void TSolution::thermal_update_device(void)
 {
+	TEnvironment& environment=context->environment;
 	int i;
 	prec *solution_ptr;
 	TThermalElement **temp_ptr;
@@ -1203,13 +1556,19 @@ void TSolution::thermal_update_device(void)
 	}
 }
 
-void TSolution::outer_thermal_update_device(void)
+/*
+	Update of the temperatures at the end of an outer thermal pass. outer_error is set to the
+	largest change of a normalized temperature in the pass.
+*/
+void TSolution::outer_thermal_update_device(prec& outer_error)
 {
-	int i;
+	TEnvironment& environment=context->environment;
+	int i,j;
 	TThermalElement **temp_therm_ptr;
 	logical should_clamp;
 	prec relaxation_value;
 	prec clamp_value;
+	prec residual[3];
 
 	should_clamp=((flag)environment.get_value(ENVIRONMENT,EFFECTS) & ENV_CLAMP_TEMPERATURE)!=0;
 	relaxation_value=environment.get_value(ENVIRONMENT,TEMP_RELAX_VALUE);
@@ -1217,13 +1576,173 @@ void TSolution::outer_thermal_update_device(void)
 	if (should_clamp) clamp_value=environment.get_value(ENVIRONMENT,TEMP_CLAMP_VALUE);
 	else clamp_value=0.0;
 
-	temp_therm_ptr=thermal_element_ptr+thermal_start_node;
-	for (i=0;i<thermal_unknown_nodes;i++) {
-		(*(temp_therm_ptr++))->outer_update(clamp_value,relaxation_value);
+	if (anderson_depth>0) anderson_update_device(clamp_value,relaxation_value,outer_error);
+	else {
+		outer_error=0.0;
+		temp_therm_ptr=thermal_element_ptr+thermal_start_node;
+		for (i=0;i<thermal_unknown_nodes;i++) {
+			(*temp_therm_ptr)->comp_outer_residual(residual);
+			for (j=0;j<3;j++) if (fabs(residual[j])>outer_error) outer_error=fabs(residual[j]);
+			(*(temp_therm_ptr++))->outer_update(clamp_value,relaxation_value);
+		}
 	}
 	thermal_update_sub_nodes();
 }
 
+/*
+	Anderson mixing of the outer thermal loop. r is the change of the temperatures in a pass
+	(see TThermalElement::comp_outer_residual()) and the relaxed update of outer_update() is
+	the step s=b*r, with b the relaxation value. With the last m passes the step of pass k is
+
+		s(k)=b*r(k)-sum(g(j)*(s(j)+b*(r(j+1)-r(j))))
+
+	where the coefficients g minimize |r(k)-sum(g(j)*(r(j+1)-r(j)))|. Older passes are
+	dropped while the least squares problem is singular. The relaxed step is taken unless
+	both of the last relaxed passes reduced the largest change by a ratio between
+	ANDERSON_MIN_RATIO and one, since the outer loop then already converges about as fast as
+	the mixing can make it. When a mixed pass reduces the largest change less than the last
+	relaxed pass did, the history restarts with the present pass, which takes the relaxed
+	step. The photon number of a laser is extrapolated with the same coefficients from its
+	values after each pass.
+*/
+void TSolution::anderson_update_device(prec clamp_value, prec relaxation_value, prec& outer_error)
+{
+	int i,j,columns,vector_size;
+	int slot, column_slot, next_slot;
+	prec ratio;
+	prec coefficient[MAX_ANDERSON_DEPTH];
+	prec *residual, *step;
+	prec total_photons, new_photons;
+	TThermalElement **temp_therm_ptr;
+
+	vector_size=3*thermal_unknown_nodes;
+	slot=anderson_passes%(anderson_depth+1);
+	residual=anderson_residual[slot];
+	step=anderson_step[slot];
+
+	outer_error=0.0;
+	temp_therm_ptr=thermal_element_ptr+thermal_start_node;
+	for (i=0;i<thermal_unknown_nodes;i++) (*(temp_therm_ptr++))->comp_outer_residual(residual+3*i);
+	for (i=0;i<vector_size;i++) if (fabs(residual[i])>outer_error) outer_error=fabs(residual[i]);
+
+	if (anderson_error>0.0) ratio=outer_error/anderson_error;
+	else ratio=1.0;
+
+	if (anderson_columns>0) {
+		if (ratio>anderson_relaxed_ratio) anderson_history=0;
+	}
+	else {
+		if (anderson_passes>0) {
+			if (ratio<anderson_relaxed_ratio) anderson_ratio=ratio;
+			else anderson_ratio=anderson_relaxed_ratio;
+			anderson_relaxed_ratio=ratio;
+		}
+	}
+	anderson_error=outer_error;
+
+	if ((anderson_ratio<ANDERSON_MIN_RATIO) || (anderson_ratio>=1.0)) columns=0;
+	else {
+		if (anderson_history<anderson_depth) columns=anderson_history;
+		else columns=anderson_depth;
+	}
+	columns=comp_anderson_coefficients(columns,coefficient);
+	anderson_columns=columns;
+
+	for (i=0;i<vector_size;i++) step[i]=relaxation_value*residual[i];
+	for (j=0;j<columns;j++) {
+		column_slot=(anderson_passes-columns+j)%(anderson_depth+1);
+		next_slot=(anderson_passes-columns+j+1)%(anderson_depth+1);
+		for (i=0;i<vector_size;i++)
+			step[i]-=coefficient[j]*(anderson_step[column_slot][i]+
+									 relaxation_value*(anderson_residual[next_slot][i]-anderson_residual[column_slot][i]));
+	}
+
+	temp_therm_ptr=thermal_element_ptr+thermal_start_node;
+	for (i=0;i<thermal_unknown_nodes;i++) (*(temp_therm_ptr++))->outer_step(step+3*i,clamp_value);
+
+	if ((device_effects & DEVICE_LASER) && (solve_type==STEADY_STATE)) {
+		total_photons=device_ptr->get_value(MODE,MODE_TOTAL_PHOTONS,0,NORMALIZED);
+		anderson_photons[slot]=total_photons;
+		new_photons=total_photons;
+		for (j=0;j<columns;j++) {
+			column_slot=(anderson_passes-columns+j)%(anderson_depth+1);
+			next_slot=(anderson_passes-columns+j+1)%(anderson_depth+1);
+			new_photons-=coefficient[j]*(anderson_photons[next_slot]-anderson_photons[column_slot]);
+		}
+		if (new_photons<PHOTON_MIN_FRACTION*total_photons) new_photons=PHOTON_MIN_FRACTION*total_photons;
+		if (new_photons!=total_photons) {
+			put_total_photons(new_photons);
+			device_ptr->comp_value(NODE,STIM_RECOMB);
+			device_ptr->comp_value(NODE,TOTAL_RECOMB);
+		}
+	}
+
+	anderson_passes++;
+	anderson_history++;
+}
+
+/*
+	Solves the normal equations of the least squares problem of anderson_update_device()
+	for the last columns passes. Returns the number of passes used, the oldest ones are
+	dropped while a pivot is below ANDERSON_PIVOT_RATIO of its diagonal value.
+*/
+int TSolution::comp_anderson_coefficients(int columns, prec *coefficient)
+{
+	int i,j,k,l,vector_size;
+	int first_pass, slot_j, slot_k, slot;
+	logical singular;
+	prec matrix[MAX_ANDERSON_DEPTH][MAX_ANDERSON_DEPTH];
+	prec diagonal[MAX_ANDERSON_DEPTH];
+	prec sum;
+
+	vector_size=3*thermal_unknown_nodes;
+	slot=anderson_passes%(anderson_depth+1);
+
+	while (columns>0) {
+		first_pass=anderson_passes-columns;
+
+		for (j=0;j<columns;j++) {
+			slot_j=(first_pass+j)%(anderson_depth+1);
+			for (k=0;k<=j;k++) {
+				slot_k=(first_pass+k)%(anderson_depth+1);
+				sum=0.0;
+				for (i=0;i<vector_size;i++)
+					sum+=(anderson_residual[(slot_j+1)%(anderson_depth+1)][i]-anderson_residual[slot_j][i])*
+						 (anderson_residual[(slot_k+1)%(anderson_depth+1)][i]-anderson_residual[slot_k][i]);
+				matrix[j][k]=matrix[k][j]=sum;
+			}
+			sum=0.0;
+			for (i=0;i<vector_size;i++)
+				sum+=(anderson_residual[(slot_j+1)%(anderson_depth+1)][i]-anderson_residual[slot_j][i])*
+					 anderson_residual[slot][i];
+			coefficient[j]=sum;
+			diagonal[j]=matrix[j][j];
+		}
+
+		singular=FALSE;
+		for (l=0;(l<columns) && (!singular);l++) {
+			if (matrix[l][l]<=ANDERSON_PIVOT_RATIO*diagonal[l]) singular=TRUE;
+			else {
+				for (j=l+1;j<columns;j++) {
+					sum=matrix[j][l]/matrix[l][l];
+					for (k=l+1;k<columns;k++) matrix[j][k]-=sum*matrix[l][k];
+					coefficient[j]-=sum*coefficient[l];
+				}
+			}
+		}
+
+		if (!singular) {
+			for (j=columns-1;j>=0;j--) {
+				for (k=j+1;k<columns;k++) coefficient[j]-=matrix[j][k]*coefficient[k];
+				coefficient[j]/=matrix[j][j];
+			}
+			return(columns);
+		}
+		columns--;
+	}
+	return(0);
+}
+
 void TSolution::electrical_update_sub_nodes(void)
 {
 	int i;
@@ -1296,6 +1815,34 @@ FundamentalParam TSolution::comp_electrical_error(void)
 	return(error);
 }
 
+prec TSolution::comp_max_elect_error(FundamentalParam& error)
+{
+	prec max_error;
+
+	if (error.psi>error.eta_c) max_error=error.psi;
+	else max_error=error.eta_c;
+	if (error.eta_v>max_error) max_error=error.eta_v;
+	return(max_error);
+}
+
+/*
+	Largest error a chord step may have to be taken: refactor_ratio times the error of the
+	iteration before, and no more than that iteration's own reduction of the error, so a
+	chord step never converges slower than the step before it.
+*/
+prec TSolution::comp_chord_limit(prec refactor_ratio)
+{
+	if (previous_elect_ratio<refactor_ratio) return(previous_elect_ratio*previous_elect_error);
+	return(refactor_ratio*previous_elect_error);
+}
+
+void TSolution::store_elect_error(prec max_error)
+{
+	if (previous_elect_error>0.0) previous_elect_ratio=max_error/previous_elect_error;
+	else previous_elect_ratio=0.0;
+	previous_elect_error=max_error;
+}
+
 prec TSolution::comp_thermal_error(void)
 {
 	int i;
@@ -1329,21 +1876,21 @@ FundamentalParam TSolution::comp_deriv_poisson(int i, NodeSide node,
 										  int return_flag)
 {
 	FundamentalParam result;
-	TElectricalElement *prev_elem, *next_elem;
+	ElementDerivatives *prev_deriv, *next_deriv;
 	FundamentalParam deriv_field_0, deriv_field_1;
 	FundamentalParam deriv_integral_charge_0, deriv_integral_charge_1;
 
 	result.psi=result.eta_c=result.eta_v=0;
 
-	prev_elem=*(electrical_element_ptr+i);
-	next_elem=*(electrical_element_ptr+i+1);
+	prev_deriv=element_derivatives+i;
+	next_deriv=element_derivatives+i+1;
 
 	switch(node) {
 		case CURRENT_NODE:
-			deriv_field_0=next_elem->comp_deriv_field(PREVIOUS_NODE,return_flag);
-			deriv_field_1=prev_elem->comp_deriv_field(NEXT_NODE,return_flag);
-			deriv_integral_charge_0=next_elem->comp_deriv_integral_charge(FIRSTHALF,PREVIOUS_NODE,return_flag,solve_type);
-			deriv_integral_charge_1=prev_elem->comp_deriv_integral_charge(SECONDHALF,NEXT_NODE,return_flag,solve_type);
+			deriv_field_0=next_deriv->field_prev;
+			deriv_field_1=prev_deriv->field_next;
+			deriv_integral_charge_0=next_deriv->integral_charge_first_prev;
+			deriv_integral_charge_1=prev_deriv->integral_charge_second_next;
 
 			if (return_flag & D_PSI)
 				result.psi=deriv_field_0.psi-deriv_field_1.psi-
@@ -1361,8 +1908,8 @@ FundamentalParam TSolution::comp_deriv_poisson(int i, NodeSide node,
 			return(result);
 
 		case PREVIOUS_NODE:
-			deriv_field_0=prev_elem->comp_deriv_field(PREVIOUS_NODE,return_flag);
-			deriv_integral_charge_0=prev_elem->comp_deriv_integral_charge(SECONDHALF,PREVIOUS_NODE,return_flag,solve_type);
+			deriv_field_0=prev_deriv->field_prev;
+			deriv_integral_charge_0=prev_deriv->integral_charge_second_prev;
 
 			if (return_flag & D_PSI)
 				result.psi=-deriv_field_0.psi
@@ -1377,8 +1924,8 @@ FundamentalParam TSolution::comp_deriv_poisson(int i, NodeSide node,
 			return(result);
 
 		case NEXT_NODE:
-			deriv_field_0=next_elem->comp_deriv_field(NEXT_NODE,return_flag);
-			deriv_integral_charge_0=next_elem->comp_deriv_integral_charge(FIRSTHALF,NEXT_NODE,return_flag,solve_type);
+			deriv_field_0=next_deriv->field_next;
+			deriv_integral_charge_0=next_deriv->integral_charge_first_next;
 
 			if (return_flag & D_PSI)
 				result.psi=deriv_field_0.psi
@@ -1401,19 +1948,22 @@ FundamentalParam TSolution::comp_deriv_electron_rate(int i, NodeSide node, int r
 	FundamentalParam result,deriv_current_1, deriv_current_0;
 	FundamentalParam deriv_integral_recomb_1, deriv_integral_recomb_0;
 	TElectricalElement *next_elem, *prev_elem;
+	ElementDerivatives *prev_deriv, *next_deriv;
 
 	result.eta_c=result.psi=result.eta_v=0;
 
 	prev_elem=*(electrical_element_ptr+i);
 	next_elem=*(electrical_element_ptr+i+1);
+	prev_deriv=element_derivatives+i;
+	next_deriv=element_derivatives+i+1;
 
 	switch(node) {
 		case CURRENT_NODE:
 
 			deriv_current_0=next_elem->comp_deriv_electron_current(PREVIOUS_NODE,return_flag);
 			deriv_current_1=prev_elem->comp_deriv_electron_current(NEXT_NODE,return_flag);
-			deriv_integral_recomb_0=next_elem->comp_deriv_integral_recomb(FIRSTHALF,PREVIOUS_NODE,return_flag);
-			deriv_integral_recomb_1=prev_elem->comp_deriv_integral_recomb(SECONDHALF,NEXT_NODE,return_flag);
+			deriv_integral_recomb_0=next_deriv->integral_recomb_first_prev;
+			deriv_integral_recomb_1=prev_deriv->integral_recomb_second_next;
 
 			if (return_flag & D_PSI)
 				result.psi=deriv_current_0.psi-deriv_current_1.psi;
@@ -1432,7 +1982,7 @@ FundamentalParam TSolution::comp_deriv_electron_rate(int i, NodeSide node, int r
 		case PREVIOUS_NODE:
 
 			deriv_current_0=prev_elem->comp_deriv_electron_current(PREVIOUS_NODE,return_flag);
-			deriv_integral_recomb_0=prev_elem->comp_deriv_integral_recomb(SECONDHALF,PREVIOUS_NODE,return_flag);
+			deriv_integral_recomb_0=prev_deriv->integral_recomb_second_prev;
 
 			if (return_flag & D_PSI)
 				result.psi=-deriv_current_0.psi;
@@ -1449,7 +1999,7 @@ FundamentalParam TSolution::comp_deriv_electron_rate(int i, NodeSide node, int r
 		case NEXT_NODE:
 
 			deriv_current_0=next_elem->comp_deriv_electron_current(NEXT_NODE,return_flag);
-			deriv_integral_recomb_0=next_elem->comp_deriv_integral_recomb(FIRSTHALF,NEXT_NODE,return_flag);
+			deriv_integral_recomb_0=next_deriv->integral_recomb_first_next;
 
 			if (return_flag & D_PSI)
 				result.psi=deriv_current_0.psi;
@@ -1473,19 +2023,22 @@ FundamentalParam TSolution::comp_deriv_hole_rate(int i, NodeSide node, int retur
 	FundamentalParam result,deriv_current_0, deriv_current_1;
 	FundamentalParam deriv_integral_recomb_0, deriv_integral_recomb_1;
 	TElectricalElement *next_elem, *prev_elem;
+	ElementDerivatives *prev_deriv, *next_deriv;
 
 	result.psi=result.eta_c=result.eta_v=0;
 
 	prev_elem=*(electrical_element_ptr+i);
 	next_elem=*(electrical_element_ptr+i+1);
+	prev_deriv=element_derivatives+i;
+	next_deriv=element_derivatives+i+1;
 
 	switch(node) {
 		case CURRENT_NODE:
 
 			deriv_current_0=next_elem->comp_deriv_hole_current(PREVIOUS_NODE,return_flag);
 			deriv_current_1=prev_elem->comp_deriv_hole_current(NEXT_NODE,return_flag);
-			deriv_integral_recomb_0=next_elem->comp_deriv_integral_recomb(FIRSTHALF,PREVIOUS_NODE,return_flag);
-			deriv_integral_recomb_1=prev_elem->comp_deriv_integral_recomb(SECONDHALF,NEXT_NODE,return_flag);
+			deriv_integral_recomb_0=next_deriv->integral_recomb_first_prev;
+			deriv_integral_recomb_1=prev_deriv->integral_recomb_second_next;
 
 			if (return_flag & D_PSI)
 				result.psi=deriv_current_0.psi-deriv_current_1.psi;
@@ -1504,7 +2057,7 @@ FundamentalParam TSolution::comp_deriv_hole_rate(int i, NodeSide node, int retur
 		case PREVIOUS_NODE:
 
 			deriv_current_0=prev_elem->comp_deriv_hole_current(PREVIOUS_NODE,return_flag);
-			deriv_integral_recomb_0=prev_elem->comp_deriv_integral_recomb(SECONDHALF,PREVIOUS_NODE,return_flag);
+			deriv_integral_recomb_0=prev_deriv->integral_recomb_second_prev;
 
 			if (return_flag & D_PSI)
 				result.psi=-deriv_current_0.psi;
@@ -1521,7 +2074,7 @@ FundamentalParam TSolution::comp_deriv_hole_rate(int i, NodeSide node, int retur
 		case NEXT_NODE:
 
 			deriv_current_0=next_elem->comp_deriv_hole_current(NEXT_NODE,return_flag);
-			deriv_integral_recomb_0=next_elem->comp_deriv_integral_recomb(FIRSTHALF,NEXT_NODE,return_flag);
+			deriv_integral_recomb_0=next_deriv->integral_recomb_first_next;
 
 			if (return_flag & D_PSI)
 				result.psi=deriv_current_0.psi;
@@ -1631,19 +2184,246 @@ prec TSolution::comp_deriv_rate_hotcarriers_electron(int i, NodeSide node)
 	}
 }
 
+/*
+	With a NEWTON_REFACTOR_RATIO above zero the iteration is a modified Newton (chord)
+	iteration: the factored jacobian is kept and only the residual is recomputed as long as
+	the largest error of each iteration is at most NEWTON_REFACTOR_RATIO times the error of
+	the iteration before, and drops at least as fast as in that iteration. A chord step with a
+	larger error is discarded before it reaches the device and the iteration is repeated with
+	a new jacobian. The first iteration of a solution always uses a new jacobian.
+
+	With MAX_LINE_SEARCH_ITER above zero a large update is damped by a line search on the
+	residual instead of only being clamped.
+*/
 void TSolution::electrical_iterate(FundamentalParam& iteration_error)
 {
+	prec refactor_ratio, max_error;
+	prec initial_residual[MAX_ELECT_VARIABLES];
+	logical line_search, chord_step;
+
+	refactor_ratio=context->environment.get_value(ENVIRONMENT,NEWTON_REFACTOR_RATIO);
+	line_search=(context->environment.get_value(ENVIRONMENT,MAX_LINE_SEARCH_ITER)>0) && electrical_step[0];
+
 	comp_electrical_dep_param(solve_type);
 
-	comp_deriv_conc();
-	if (solve_type==STEADY_STATE) comp_deriv_recomb();
+	chord_step=(refactor_ratio>0.0) && jacobian_factored && (previous_elect_error>0.0);
+	if (chord_step) {
+		comp_electrical_solution(FALSE);
+		if (line_search) comp_electrical_residual(initial_residual);
+		solve_electrical_jacobian(electrical_solution);
+		iteration_error=comp_electrical_error();
+		max_error=comp_max_elect_error(iteration_error);
+		chord_step=(max_error<=comp_chord_limit(refactor_ratio));
+	}
 
-	comp_electrical_solution();
-	comp_electrical_jacobian();
-	factor_jacobian(electrical_jacobian,number_elect_variables,electrical_unknown_nodes);
-	solve_electrical_jacobian();
-	iteration_error=comp_electrical_error();
+	if (!chord_step) {
+		comp_deriv_conc();
+		if (solve_type==STEADY_STATE) comp_deriv_recomb();
+
+		comp_electrical_solution(TRUE);
+		comp_electrical_jacobian();
+		factor_jacobian(electrical_jacobian,number_elect_variables,electrical_unknown_nodes);
+		jacobian_factored=TRUE;
+
+		if (line_search) comp_electrical_residual(initial_residual);
+		solve_electrical_jacobian(electrical_solution);
+		iteration_error=comp_electrical_error();
+		max_error=comp_max_elect_error(iteration_error);
+	}
+	store_elect_error(max_error);
+
+	if (line_search) electrical_line_search(initial_residual);
+	else {
+		electrical_update_device();
+		comp_electrical_values();
+	}
+}
+
+/*
+	Moves the solution toward a new contact bias with one step of the chord method. The
+	residual is computed with the new boundary values and solved with the jacobian that was
+	factored in the last iteration, so the step follows the tangent d(solution)/d(bias).
+	Nothing is done unless the last solution was a steady state solution.
+*/
+void TSolution::electrical_predict(void)
+{
+	if ((solve_type!=STEADY_STATE) || (!jacobian_factored)) return;
+
+	comp_electrical_boundary();
+	apply_electrical_boundary();
+	comp_electrical_dep_param(solve_type);
+	comp_electrical_solution(FALSE);
+	solve_electrical_jacobian(electrical_solution);
 	electrical_update_device();
+	comp_electrical_values();
+}
+
+/*
+	Newton iteration of the electrical equations with the total number of photons of the
+	laser mode as one more unknown, in place of the outer photon loop. The photon number
+	enters the electrical equations through the stimulated recombination and its own rate
+	equation (gain-loss)*photons+spontaneous=0 through the mode gain and the spontaneous
+	emission of every node, so the system is the block tridiagonal electrical jacobian A
+	bordered by one column b and one row c:
+
+		| A  b | |x|   |F|
+		| c' d | |s| = |G|
+
+	It is solved with the factored A, s=(G-c'y)/(d-c'z) and x=y-zs where Ay=F and Az=b.
+	b and c'y, c'z are found by forward differences, the stimulated recombination is
+	proportional to the photon number so b is exact. The jacobian A is reused, and a chord
+	step discarded, as in electrical_iterate(). The photon number can drop at most to PHOTON_MIN_FRACTION of its
+	value in one iteration.
+*/
+void TSolution::photon_iterate(FundamentalParam& elect_error, prec& photon_error)
+{
+	int i,j;
+	prec refactor_ratio, max_error;
+	prec total_photons, new_photons, photon_step;
+	prec photon_residual, photon_deriv, photon_update;
+	prec deriv_solution, deriv_column, total_deriv, value;
+	logical chord_step, repeat_step;
+
+	refactor_ratio=context->environment.get_value(ENVIRONMENT,NEWTON_REFACTOR_RATIO);
+
+	comp_electrical_dep_param(solve_type);
+
+	chord_step=(refactor_ratio>0.0) && jacobian_factored && (previous_elect_error>0.0);
+	do {
+		if (!chord_step) {
+			comp_deriv_conc();
+			comp_deriv_recomb();
+
+			comp_electrical_solution(TRUE);
+			comp_electrical_jacobian();
+			factor_jacobian(electrical_jacobian,number_elect_variables,electrical_unknown_nodes);
+			jacobian_factored=TRUE;
+		}
+		else comp_electrical_solution(FALSE);
+
+		total_photons=device_ptr->get_value(MODE,MODE_TOTAL_PHOTONS,0,NORMALIZED);
+		photon_residual=comp_photon_residual(total_photons,photon_deriv);
+
+// Border column, the residual is kept in photon_column while the photon number is moved
+
+		if (total_photons>1.0) photon_step=total_photons;
+		else photon_step=1.0;
+
+		for (i=0;i<number_elect_variables;i++) {
+			for (j=0;j<electrical_unknown_nodes;j++) photon_column[i][j]=electrical_solution[i][j];
+		}
+
+		put_total_photons(total_photons+photon_step);
+		device_ptr->comp_value(NODE,STIM_RECOMB);
+		device_ptr->comp_value(NODE,TOTAL_RECOMB);
+		comp_electrical_solution(FALSE);
+
+		for (i=0;i<number_elect_variables;i++) {
+			for (j=0;j<electrical_unknown_nodes;j++) {
+				value=electrical_solution[i][j];
+				electrical_solution[i][j]=photon_column[i][j];
+				photon_column[i][j]=(value-photon_column[i][j])/photon_step;
+			}
+		}
+		put_total_photons(total_photons);
+
+		solve_electrical_jacobian(electrical_solution);
+		solve_electrical_jacobian(photon_column);
+
+		deriv_solution=comp_photon_deriv(electrical_solution,total_photons,photon_residual);
+		deriv_column=comp_photon_deriv(photon_column,total_photons,photon_residual);
+
+		total_deriv=photon_deriv-deriv_column;
+		photon_update=(photon_residual-deriv_solution)/total_deriv;
+
+		for (i=0;i<number_elect_variables;i++) {
+			for (j=0;j<electrical_unknown_nodes;j++) electrical_solution[i][j]-=photon_column[i][j]*photon_update;
+		}
+
+		elect_error=comp_electrical_error();
+		max_error=comp_max_elect_error(elect_error);
+
+// As in the outer photon loop the error is the update needed by the photon rate equation alone,
+// the part of the update that follows the electrical update vanishes with the electrical error
+		if (total_photons!=0.0) photon_error=fabs(photon_residual/(total_deriv*total_photons));
+		else photon_error=1.0;
+		if (photon_error>max_error) max_error=photon_error;
+
+// A rejected chord step is repeated with a new jacobian from the recombination at the
+// unperturbed photon number
+		repeat_step=chord_step && (max_error>comp_chord_limit(refactor_ratio));
+		if (repeat_step) {
+			chord_step=FALSE;
+			device_ptr->comp_value(NODE,STIM_RECOMB);
+			device_ptr->comp_value(NODE,TOTAL_RECOMB);
+		}
+	} while (repeat_step);
+	store_elect_error(max_error);
+
+	new_photons=total_photons-photon_update;
+	if (new_photons<PHOTON_MIN_FRACTION*total_photons) new_photons=PHOTON_MIN_FRACTION*total_photons;
+
+	electrical_update_device();
+	put_total_photons(new_photons);
+	comp_electrical_values();
+}
+
+void TSolution::put_total_photons(prec total_photons)
+{
+	device_ptr->put_value(MODE,MODE_TOTAL_PHOTONS,total_photons,0,0,NORMALIZED);
+	device_ptr->put_value(GRID_OPTICAL,MODE_TOTAL_PHOTONS,total_photons,-1,-1,NORMALIZED);
+}
+
+/*
+	Residual of the photon rate equation at the present device values. photon_deriv is set
+	to its derivative with respect to the photon number.
+*/
+prec TSolution::comp_photon_residual(prec total_photons, prec& photon_deriv)
+{
+	prec gain, loss;
+
+	device_ptr->comp_value(GRID_OPTICAL,MODE_GAIN);
+	device_ptr->comp_value(MODE,MODE_GAIN);
+	device_ptr->comp_value(MODE,TOTAL_SPONTANEOUS);
+
+	gain=device_ptr->get_value(MODE,MODE_GROUP_VELOCITY,0,NORMALIZED)*
+		 device_ptr->get_value(MODE,MODE_GAIN,0,NORMALIZED);
+	loss=1.0/device_ptr->get_value(MODE,PHOTON_LIFETIME,0,NORMALIZED);
+
+	photon_deriv=gain-loss;
+	return((gain-loss)*total_photons+device_ptr->get_value(MODE,TOTAL_SPONTANEOUS,0,NORMALIZED));
+}
+
+/*
+	Derivative of the photon rate equation along direction, by a forward difference with a
+	largest change of COUPLED_PERTURBATION in any variable. The device is moved back, but
+	its values are left computed at the moved solution.
+*/
+prec TSolution::comp_photon_deriv(prec **direction, prec total_photons, prec photon_residual)
+{
+	int i,j;
+	prec max_direction, step, rate_deriv, photon_deriv;
+
+	max_direction=0.0;
+	for (i=0;i<number_elect_variables;i++) {
+		for (j=0;j<electrical_unknown_nodes;j++) {
+			if (fabs(direction[i][j])>max_direction) max_direction=fabs(direction[i][j]);
+		}
+	}
+	if (max_direction==0.0) return(0.0);
+
+	step=COUPLED_PERTURBATION/max_direction;
+
+	electrical_step_device(direction,-step);
+	comp_electrical_values();
+	photon_deriv=(comp_photon_residual(total_photons,rate_deriv)-photon_residual)/step;
+	electrical_step_device(direction,step);
+
+	return(photon_deriv);
+}
+
+void TSolution::comp_electrical_values(void)
+{
 	electrical_update_sub_nodes();
 
 	if (solve_type==EQUILIBRIUM) {
@@ -1693,4 +2473,239 @@ void TSolution::thermal_iterate(prec& iteration_error)
 	}
 }
 
+/*
+	Newton iteration of the electrical and heat flow equations as one system, with the
+	lattice temperature as fourth unknown of every node (carrier temperatures follow the
+	lattice). Replaces electrical_iterate() and thermal_iterate() in a non-isothermal steady
+	state solution when ENV_COUPLED_THERMAL is set.
+*/
+void TSolution::coupled_iterate(FundamentalParam& elect_error, prec& therm_error)
+{
+	int i,k;
+
+	comp_coupled_jacobian();
+	if (context->error_handler.fail()) return;
+
+	factor_jacobian(coupled_jacobian,COUPLED_VARIABLES,coupled_unknown_nodes);
+	solve_coupled_jacobian();
+
+	for (i=coupled_start_node;i<=coupled_end_node;i++) {
+		if ((i>=electrical_start_node) && (i<=electrical_end_node)) {
+			for (k=0;k<3;k++)
+				electrical_solution[k][i-electrical_start_node]=coupled_solution[k][i-coupled_start_node];
+		}
+		if ((i>=thermal_start_node) && (i<=thermal_end_node))
+			thermal_solution[i-thermal_start_node]=coupled_solution[COUPLED_VARIABLES-1][i-coupled_start_node];
+	}
+
+	elect_error=comp_electrical_error();
+	therm_error=comp_thermal_error();
+
+	electrical_update_device();
+	thermal_update_device();
+	thermal_update_sub_nodes();
+	device_ptr->update_temperature_param();
+	if (context->error_handler.fail()) return;
+	comp_electrical_values();
+
+// The electrical jacobian has been replaced, it is rebuilt by the next electrical iteration
+	jacobian_factored=FALSE;
+}
+
+void TSolution::comp_coupled_thermal_solution(void)
+{
+	device_ptr->comp_value(NODE,TOTAL_RADIATIVE_HEAT);
+	device_ptr->comp_value(ELECTRON,SHR_HEAT);
+	device_ptr->comp_value(ELECTRON,B_B_HEAT);
+	device_ptr->comp_value(ELECTRON,STIM_HEAT);
+	device_ptr->comp_value(ELECTRON,AUGER_HEAT);
+	device_ptr->comp_value(ELECTRON,RELAX_HEAT);
+	device_ptr->comp_value(ELECTRON,OPTICAL_GENERATION_REF);
+	device_ptr->comp_value(HOLE,OPTICAL_GENERATION_REF);
+	device_ptr->comp_value(ELECTRON,TOTAL_HEAT);
+
+	comp_thermoelectric_param();
+	comp_thermal_dep_param();
+	comp_thermal_solution();
+}
+
+/*
+	Builds the coupled jacobian and leaves the residuals of the present solution in
+	coupled_solution. The derivatives of the electrical equations with respect to eta_c, psi
+	and eta_v are the analytical ones. There are no analytical derivatives with respect to
+	the temperature, which enters through most material parameters, so these and the
+	derivatives of the heat flow equation are found by forward differences. A node only
+	couples to its neighbours, so every third node is perturbed at the same time. Nodes
+	outside the electrical or thermal range keep that part of the solution fixed.
+*/
+void TSolution::comp_coupled_jacobian(void)
+{
+	int i,j,k,l,m,color;
+	BlockJacobianView elect_jacobian, jacobian;
+	prec *elect_row_ptr, *row_ptr;
+	prec value, step;
+	FundamentalParam update_amount;
+
+	elect_jacobian=electrical_jacobian.get_view(number_elect_variables);
+	jacobian=coupled_jacobian.get_view(COUPLED_VARIABLES);
 
+	comp_electrical_dep_param(solve_type);
+	comp_deriv_conc();
+	comp_deriv_recomb();
+	comp_electrical_solution(TRUE);
+	comp_electrical_jacobian();
+	comp_coupled_thermal_solution();
+
+	for (i=coupled_start_node;i<=coupled_end_node;i++) {
+		l=i-coupled_start_node;
+		for (k=0;k<COUPLED_VARIABLES;k++) {
+			row_ptr=jacobian.get_row(l*COUPLED_VARIABLES+k);
+			for (m=0;m<3*COUPLED_VARIABLES;m++) row_ptr[m]=0.0;
+		}
+
+		if ((i>=electrical_start_node) && (i<=electrical_end_node)) {
+			for (k=0;k<3;k++) {
+				elect_row_ptr=elect_jacobian.get_row((i-electrical_start_node)*3+k);
+				row_ptr=jacobian.get_row(l*COUPLED_VARIABLES+k);
+				for (m=0;m<3;m++) {
+					for (j=0;j<3;j++) row_ptr[m*COUPLED_VARIABLES+j]=elect_row_ptr[m*3+j];
+				}
+				coupled_solution[k][l]=electrical_solution[k][i-electrical_start_node];
+			}
+		}
+		else {
+			for (k=0;k<3;k++) {
+				jacobian.get_row(l*COUPLED_VARIABLES+k)[COUPLED_VARIABLES+k]=1.0;
+				coupled_solution[k][l]=0.0;
+			}
+		}
+
+		if ((i>=thermal_start_node) && (i<=thermal_end_node))
+			coupled_solution[COUPLED_VARIABLES-1][l]=thermal_solution[i-thermal_start_node];
+		else {
+			jacobian.get_row(l*COUPLED_VARIABLES+COUPLED_VARIABLES-1)[2*COUPLED_VARIABLES-1]=1.0;
+			coupled_solution[COUPLED_VARIABLES-1][l]=0.0;
+		}
+	}
+
+// Temperature columns. The steps are rounded so that the temperatures are restored exactly.
+
+	for (color=0;color<3;color++) {
+		for (j=thermal_start_node;j<=thermal_end_node;j++) {
+			if ((j-coupled_start_node)%3==color) {
+				value=solution_grid_ptr[j]->get_value(GRID_ELECTRICAL,TEMPERATURE,NORMALIZED);
+				step=(value+COUPLED_PERTURBATION*value)-value;
+				coupled_step[j-coupled_start_node]=step;
+				thermal_element_ptr[j]->update(-step,-step,-step);
+			}
+		}
+		thermal_update_sub_nodes();
+		device_ptr->update_temperature_param();
+		if (context->error_handler.fail()) return;
+
+		comp_electrical_values();
+		comp_electrical_dep_param(solve_type);
+		comp_electrical_solution(FALSE);
+		comp_coupled_thermal_solution();
+		comp_coupled_column(color,COUPLED_VARIABLES-1,thermal_start_node,thermal_end_node,TRUE);
+
+		for (j=thermal_start_node;j<=thermal_end_node;j++) {
+			if ((j-coupled_start_node)%3==color) {
+				step=coupled_step[j-coupled_start_node];
+				thermal_element_ptr[j]->update(step,step,step);
+			}
+		}
+	}
+	thermal_update_sub_nodes();
+	device_ptr->update_temperature_param();
+	if (context->error_handler.fail()) return;
+
+// Derivatives of the heat flow equation with respect to eta_c, psi and eta_v
+
+	for (k=0;k<3;k++) {
+		for (color=0;color<3;color++) {
+			for (j=electrical_start_node;j<=electrical_end_node;j++) {
+				if ((j-coupled_start_node)%3==color) {
+					switch(k) {
+						case 0: value=solution_grid_ptr[j]->get_value(ELECTRON,PLANCK_POT,NORMALIZED); break;
+						case 1: value=solution_grid_ptr[j]->get_value(GRID_ELECTRICAL,POTENTIAL,NORMALIZED); break;
+						default: value=solution_grid_ptr[j]->get_value(HOLE,PLANCK_POT,NORMALIZED); break;
+					}
+					if (fabs(value)>1.0) step=COUPLED_PERTURBATION*fabs(value);
+					else step=COUPLED_PERTURBATION;
+					step=(value+step)-value;
+					coupled_step[j-coupled_start_node]=step;
+
+					update_amount.eta_c=update_amount.psi=update_amount.eta_v=0.0;
+					switch(k) {
+						case 0: update_amount.eta_c=-step; break;
+						case 1: update_amount.psi=-step; break;
+						default: update_amount.eta_v=-step; break;
+					}
+					electrical_element_ptr[j]->update(update_amount);
+				}
+			}
+
+			comp_electrical_values();
+			comp_coupled_thermal_solution();
+			comp_coupled_column(color,k,electrical_start_node,electrical_end_node,FALSE);
+
+			for (j=electrical_start_node;j<=electrical_end_node;j++) {
+				if ((j-coupled_start_node)%3==color) {
+					step=coupled_step[j-coupled_start_node];
+					update_amount.eta_c=update_amount.psi=update_amount.eta_v=0.0;
+					switch(k) {
+						case 0: update_amount.eta_c=step; break;
+						case 1: update_amount.psi=step; break;
+						default: update_amount.eta_v=step; break;
+					}
+					electrical_element_ptr[j]->update(update_amount);
+				}
+			}
+		}
+	}
+	comp_electrical_values();
+}
+
+/*
+	Fills the column of unknown variable of the nodes of the given color from the residuals
+	of the perturbed solution, found in electrical_solution and thermal_solution. The rows of
+	the electrical equations are only filled if electrical_rows is TRUE.
+*/
+void TSolution::comp_coupled_column(int color, int variable, int start_node, int end_node,
+									logical electrical_rows)
+{
+	int i,j,k,l,m;
+	BlockJacobianView jacobian;
+	prec *row_ptr;
+	prec step;
+
+	jacobian=coupled_jacobian.get_view(COUPLED_VARIABLES);
+
+	for (i=coupled_start_node;i<=coupled_end_node;i++) {
+		l=i-coupled_start_node;
+
+// Only one of the previous, present and next node has the color
+		for (m=0;m<3;m++) {
+			j=i+m-1;
+			if ((j>=start_node) && (j<=end_node) && ((j-coupled_start_node)%3==color)) break;
+		}
+		if (m==3) continue;
+
+		step=coupled_step[j-coupled_start_node];
+
+		if (electrical_rows && (i>=electrical_start_node) && (i<=electrical_end_node)) {
+			for (k=0;k<3;k++) {
+				row_ptr=jacobian.get_row(l*COUPLED_VARIABLES+k);
+				row_ptr[m*COUPLED_VARIABLES+variable]=
+					(electrical_solution[k][i-electrical_start_node]-coupled_solution[k][l])/step;
+			}
+		}
+
+		if ((i>=thermal_start_node) && (i<=thermal_end_node)) {
+			row_ptr=jacobian.get_row(l*COUPLED_VARIABLES+COUPLED_VARIABLES-1);
+			row_ptr[m*COUPLED_VARIABLES+variable]=
+				(thermal_solution[i-thermal_start_node]-coupled_solution[COUPLED_VARIABLES-1][l])/step;
+		}
+	}
+}
@@ -28,6 +28,7 @@
 
 class TSurface {
 private:
+	TSimulationContext *context;
 	TNode *surface_node;
 	int surface_node_number;
 	TNode *second_node;
@@ -43,7 +44,7 @@ private:
 	OpticalField mode_field;
 
 public:
-	TSurface(TNode* surface_node_ptr, TNode* next_node_ptr);
+	TSurface(TSimulationContext *new_context, TNode* surface_node_ptr, TNode* next_node_ptr);
 	prec get_value(flag flag_value, ScaleType scale=UNNORMALIZED);
 	void put_value(flag flag_value, prec value, ScaleType scale=UNNORMALIZED);
 	void comp_incident_surface_field(void);
@@ -63,14 +64,15 @@ public:
 };
 */
 
-TSurface::TSurface(TNode* surface_node_ptr, TNode* next_node_ptr)
+TSurface::TSurface(TSimulationContext *new_context, TNode* surface_node_ptr, TNode* next_node_ptr)
 {
+	context=new_context;
 	surface_node=surface_node_ptr;
 	surface_node_number=surface_node->get_value(GRID_ELECTRICAL,NODE_NUMBER);
 	second_node=next_node_ptr;
 	second_node_number=second_node->get_value(GRID_ELECTRICAL,NODE_NUMBER);
 	effects=SURFACE_HEAT_SINK;
-	temp=environment.get_value(ENVIRONMENT,TEMPERATURE,0,NORMALIZED);
+	temp=context->environment.get_value(ENVIRONMENT,TEMPERATURE,0,NORMALIZED);
 	electron_temp=temp;
 	hole_temp=temp;
 	thermal_conduct=0.0;
@@ -116,15 +118,16 @@ prec TSurface::get_value(flag flag_value, ScaleType scale)
 		default: assert(FALSE); return(0.0);
 	}
 
-	if (scale==UNNORMALIZED) return_value*=get_normalize_value(SURFACE,flag_value);
+	if (scale==UNNORMALIZED) return_value*=get_normalize_value(context,SURFACE,flag_value);
 	return(return_value);
 }
 
 void TSurface::put_value(flag flag_value, prec value, ScaleType scale)
 {
+	TEnvironment& environment=context->environment;
 	prec prev_value;
 
-	if (scale==UNNORMALIZED) value/=get_normalize_value(SURFACE,flag_value);
+	if (scale==UNNORMALIZED) value/=get_normalize_value(context,SURFACE,flag_value);
 
 	switch(flag_value) {
 		case EFFECTS:
@@ -180,6 +183,7 @@ void TSurface::put_value(flag flag_value, prec value, ScaleType scale)
 
 void TSurface::comp_incident_surface_field(void)
 {
+	TEnvironment& environment=context->environment;
 	int start_grid_point;
 	complex impedance_sum, impedance_diff;
 	complex internal_forward_field, internal_reverse_field;
@@ -228,6 +232,7 @@ void TSurface::comp_incident_surface_field(void)
 
 void TSurface::comp_incident_internal_field(void)
 {
+	TEnvironment& environment=context->environment;
 	int end_grid_point;
 	complex impedance_sum, impedance_diff;
 	complex internal_forward_field, internal_reverse_field;
@@ -271,7 +276,7 @@ void TSurface::comp_emitted_total_poynting(prec multiplier)
 	incident_field.forward_poynting*=multiplier;
 	incident_field.reverse_poynting*=multiplier;
 
-	if ((flag)environment.get_value(ENVIRONMENT,EFFECTS) & ENV_INCIDENT_REFLECTION) {
+	if ((flag)context->environment.get_value(ENVIRONMENT,EFFECTS) & ENV_INCIDENT_REFLECTION) {
 		if (norm(incident_field.forward_field)!=0.0)
 			incident_field.forward_field*=sqrt(2.0*incident_field.forward_poynting/
 											   (incident_refractive_index*norm(incident_field.forward_field)));
@@ -298,7 +303,7 @@ prec TSurface::comp_input_total_poynting(int spectral_component)
 	prec incident_input_intensity;
 	prec multiplier;
 
-	incident_input_intensity=environment.get_value(SPECTRUM,INCIDENT_INPUT_INTENSITY,spectral_component,NORMALIZED);
+	incident_input_intensity=context->environment.get_value(SPECTRUM,INCIDENT_INPUT_INTENSITY,spectral_component,NORMALIZED);
 
 	if (incident_field.reverse_poynting<incident_field.forward_poynting)
 		multiplier=incident_input_intensity/incident_field.forward_poynting;
@@ -314,6 +319,7 @@ prec TSurface::comp_input_total_poynting(int spectral_component)
 
 void TSurface::comp_mode_surface_field(void)
 {
+	TEnvironment& environment=context->environment;
 	int start_grid_point;
 	complex impedance_sum, impedance_diff;
 	complex internal_forward_field, internal_reverse_field;
@@ -343,6 +349,7 @@ void TSurface::comp_mode_surface_field(void)
 
 void TSurface::comp_mode_internal_field(void)
 {
+	TEnvironment& environment=context->environment;
 	int end_grid_point;
 	complex impedance_sum, impedance_diff;
 	complex internal_forward_field, internal_reverse_field;
@@ -372,7 +379,7 @@ void TSurface::comp_mode_internal_field(void)
 void TSurface::comp_value(flag flag_value)
 {
 	switch(flag_value) {
-		case TEMPERATURE: temp=environment.get_value(ENVIRONMENT,TEMPERATURE,0,NORMALIZED); return;
+		case TEMPERATURE: temp=context->environment.get_value(ENVIRONMENT,TEMPERATURE,0,NORMALIZED); return;
 		case ELECTRON_TEMPERATURE: electron_temp=temp; return;
 		case HOLE_TEMPERATURE: hole_temp=temp; return;
 		case INCIDENT_SURFACE_FIELD: comp_incident_surface_field(); return;
@@ -387,7 +394,7 @@ void TSurface::init_forward_incident_field(void)
 {
 	incident_field.forward_field=complex(1.0,0.0);
 
-	if ((flag)environment.get_value(ENVIRONMENT,EFFECTS) & ENV_INCIDENT_REFLECTION)
+	if ((flag)context->environment.get_value(ENVIRONMENT,EFFECTS) & ENV_INCIDENT_REFLECTION)
 		incident_field.forward_poynting=0.5*incident_refractive_index;
 	else
 		incident_field.forward_poynting=0.5;
@@ -403,7 +410,7 @@ void TSurface::init_reverse_incident_field(void)
 	incident_field.forward_poynting=0.0;
 	incident_field.reverse_field=complex(1.0,0.0);
 
-	if ((flag)environment.get_value(ENVIRONMENT,EFFECTS) & ENV_INCIDENT_REFLECTION)
+	if ((flag)context->environment.get_value(ENVIRONMENT,EFFECTS) & ENV_INCIDENT_REFLECTION)
 		incident_field.reverse_poynting=0.5*incident_refractive_index;
 	else
 		incident_field.reverse_poynting=0.5;
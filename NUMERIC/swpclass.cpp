@@ -0,0 +1,689 @@
+/*
+    SimWindows - 1D Semiconductor Device Simulator
+    Copyright (C) 2013 David W. Winston
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "comincl.h"
+
+// The sweep whose execute() the thread is in, set for the calling thread only
+static SIM_THREAD_LOCAL TBiasSweep *calling_sweep=(TBiasSweep *)0;
+
+//************************************* class TBiasSweep **************************************
+/*
+class TBiasSweep {
+private:
+	int contact_number;
+	prec start_bias;
+	prec increment;
+	int number_values;
+	int number_parameters;
+	FlagType *flag_type_array;
+	flag *flag_array;
+	int *object_array;
+	prec **record_data;
+	int number_chunks;
+	SweepChunk *chunks;
+	float coarse_error_factor;
+	float max_error[3];
+	PredictorType predictor_type;
+	logical adaptive_step;
+	int adaptive_size;
+	prec **adaptive_data;
+	logical *stop_flag;
+	TSimulationContext *master_context;
+	int solved_values;
+	SweepPointFunction point_function;
+	void *point_data;
+	int reported_values;
+	TWorkerLock progress_lock;
+public:
+	TBiasSweep(TSimulationContext *new_context, int new_contact_number, prec new_start_bias,
+			   prec new_increment, int new_number_values, int new_number_parameters,
+			   FlagType *new_flag_type_array, flag *new_flag_array, int *new_object_array,
+			   prec **new_record_data);
+	~TBiasSweep(void) { delete_chunks(); delete_adaptive_data(); }
+	void put_number_workers(int number_workers);
+	void put_coarse_error_factor(float factor) { coarse_error_factor=factor; }
+	void put_predictor(PredictorType new_type) { predictor_type=new_type; }
+	void put_adaptive_step(logical adaptive) { adaptive_step=adaptive; }
+	void put_stop_flag(logical *new_stop_flag) { stop_flag=new_stop_flag; }
+	void put_point_function(SweepPointFunction function, void *data)
+		{ point_function=function; point_data=data; }
+	int get_number_chunks(void) { return(number_chunks); }
+	int get_solved_values(void) { return(solved_values); }
+	prec get_record_value(int parameter, int value_number);
+	void execute(void);
+	void write_data_file(const char *filename);
+private:
+	void record_values(TSimulationContext *context, prec **data, int value_number);
+	void create_chunks(void);
+	void delete_chunks(void);
+	void put_tolerance(TSimulationContext *context, float factor);
+	FILE *save_state(TSimulationContext *context);
+	void restore_state(TSimulationContext *context, FILE *file_ptr);
+	logical coarse_solve(prec bias);
+	void coarse_pass(void);
+	void prepare_chunk(SweepChunk *chunk);
+	void solve_chunk(int chunk_number);
+	void merge_chunks(void);
+	void copy_chunk_state(SweepChunk *chunk);
+	static void chunk_task(void *sweep, int chunk_number);
+	void report_points(void);
+	void adaptive_pass(void);
+	void store_adaptive_values(prec bias);
+	void delete_adaptive_data(void);
+	int get_monitor_values(prec *values);
+	static prec comp_deviation(prec bias_0, prec value_0, prec bias_1, prec value_1,
+							   prec bias_2, prec value_2);
+};
+*/
+
+TBiasSweep::TBiasSweep(TSimulationContext *new_context, int new_contact_number, prec new_start_bias,
+					   prec new_increment, int new_number_values, int new_number_parameters,
+					   FlagType *new_flag_type_array, flag *new_flag_array, int *new_object_array,
+					   prec **new_record_data)
+{
+	contact_number=new_contact_number;
+	start_bias=new_start_bias;
+	increment=new_increment;
+	number_values=new_number_values;
+	number_parameters=new_number_parameters;
+	flag_type_array=new_flag_type_array;
+	flag_array=new_flag_array;
+	object_array=new_object_array;
+	record_data=new_record_data;
+	chunks=(SweepChunk *)0;
+	coarse_error_factor=SWEEP_COARSE_ERROR_FACTOR;
+	max_error[0]=max_error[1]=max_error[2]=0.0;
+	predictor_type=PREDICT_QUADRATIC;
+	adaptive_step=FALSE;
+	adaptive_size=0;
+	adaptive_data=(prec **)0;
+	stop_flag=(logical *)0;
+	master_context=new_context;
+	solved_values=0;
+	point_function=(SweepPointFunction)0;
+	point_data=(void *)0;
+	reported_values=0;
+	put_number_workers(get_number_processors());
+}
+
+void TBiasSweep::put_number_workers(int number_workers)
+{
+	if (number_workers>number_values) number_workers=number_values;
+	if (number_workers<1) number_workers=1;
+	number_chunks=number_workers;
+}
+
+void TBiasSweep::execute(void)
+{
+	TEnvironment& environment=master_context->environment;
+	int i;
+	TWorkerPool *worker_pool;
+	TBiasSweep *previous_sweep;
+
+	solved_values=0;
+	reported_values=0;
+
+	if (adaptive_step) {
+		adaptive_pass();
+		return;
+	}
+
+	for (i=0;i<number_values;i++) record_data[0][i]=start_bias+(prec)i*increment;
+
+	create_chunks();
+
+	if (number_chunks>1) {
+		max_error[0]=(float)environment.get_value(ENVIRONMENT,MAX_ELECTRICAL_ERROR);
+		max_error[1]=(float)environment.get_value(ENVIRONMENT,MAX_THERMAL_ERROR);
+		max_error[2]=(float)environment.get_value(ENVIRONMENT,MAX_OPTIC_ERROR);
+		coarse_pass();
+		for (i=0;(i<number_chunks) && (!master_context->error_handler.fail());i++) {
+			if (chunks[i].start_value!=chunks[i].end_value) prepare_chunk(chunks+i);
+		}
+	}
+
+	if (!master_context->error_handler.fail()) {
+		worker_pool=new TWorkerPool(master_context,number_chunks);
+		previous_sweep=calling_sweep;
+		calling_sweep=this;
+		worker_pool->run(chunk_task,this,number_chunks);
+		calling_sweep=previous_sweep;
+		delete worker_pool;
+		merge_chunks();
+		report_points();
+	}
+
+	delete_chunks();
+}
+
+void TBiasSweep::write_data_file(const char *filename)
+{
+	int i,j,new_precision=4;
+	ofstream output_file(filename);
+
+	if (!output_file) {
+		master_context->error_handler.set_error(ERROR_FILE_NOT_OPEN,0,"",filename);
+		return;
+	}
+
+	output_file.setf(ios::scientific,ios::floatfield);
+	output_file.precision(new_precision);
+
+	for (i=0;i<number_parameters;i++) {
+		output_file << get_short_string(flag_type_array[i], flag_array[i]) <<
+					   get_short_location_string(master_context,flag_type_array[i],object_array[i]);
+		if (i<number_parameters-1) output_file << ",";
+	}
+	output_file << '\n';
+
+	for (i=0;i<solved_values;i++) {
+		for (j=0;j<number_parameters;j++) {
+			output_file << get_record_value(j,i);
+			if (j<number_parameters-1) output_file << ",";
+		}
+		output_file << '\n';
+	}
+}
+
+prec TBiasSweep::get_record_value(int parameter, int value_number)
+{
+	if (adaptive_data) return(adaptive_data[parameter][value_number]);
+	else return(record_data[parameter][value_number]);
+}
+
+void TBiasSweep::record_values(TSimulationContext *context, prec **data, int value_number)
+{
+	int i;
+
+	for (i=1;i<number_parameters;i++)
+		data[i][value_number]=context->environment.get_value(flag_type_array[i],flag_array[i],object_array[i]);
+}
+
+void TBiasSweep::create_chunks(void)
+{
+	int i;
+
+	delete_chunks();
+
+	chunks=new SweepChunk[number_chunks];
+	for (i=0;i<number_chunks;i++) {
+		chunks[i].start_value=(int)(((long)i*number_values)/number_chunks);
+		chunks[i].end_value=(int)(((long)(i+1)*number_values)/number_chunks);
+		chunks[i].solved_values=0;
+		chunks[i].state_file=(FILE *)0;
+		chunks[i].context=(TSimulationContext *)0;
+	}
+}
+
+void TBiasSweep::delete_chunks(void)
+{
+	int i;
+
+	if (chunks) {
+		for (i=0;i<number_chunks;i++) {
+			if (chunks[i].state_file) fclose(chunks[i].state_file);
+			if (chunks[i].context) delete chunks[i].context;
+		}
+		delete[] chunks;
+		chunks=(SweepChunk *)0;
+	}
+}
+
+void TBiasSweep::put_tolerance(TSimulationContext *context, float factor)
+{
+	TEnvironment& environment=context->environment;
+	environment.put_value(ENVIRONMENT,MAX_ELECTRICAL_ERROR,max_error[0]*factor);
+	environment.put_value(ENVIRONMENT,MAX_THERMAL_ERROR,max_error[1]*factor);
+	environment.put_value(ENVIRONMENT,MAX_OPTIC_ERROR,max_error[2]*factor);
+}
+
+FILE *TBiasSweep::save_state(TSimulationContext *context)
+{
+	FILE *file_ptr;
+
+	file_ptr=tmpfile();
+	if (!file_ptr) {
+		context->error_handler.set_error(ERROR_FILE_NOT_OPEN,0,"","temporary state file");
+		return((FILE *)0);
+	}
+	context->environment.write_state_file(file_ptr);
+	return(file_ptr);
+}
+
+void TBiasSweep::restore_state(TSimulationContext *context, FILE *file_ptr)
+{
+	rewind(file_ptr);
+	context->environment.load_state_file(file_ptr);
+}
+
+logical TBiasSweep::coarse_solve(prec bias)
+{
+	TEnvironment& environment=master_context->environment;
+	environment.put_value(CONTACT,APPLIED_BIAS,bias,contact_number);
+	environment.solve();
+	if (master_context->error_handler.fail()) {
+		master_context->error_handler.clear();
+		return(FALSE);
+	}
+	return(environment.get_value(DEVICE,CURRENT_STATUS)!=NOT_CONVERGED);
+}
+
+/*
+	Steps the device of the sweep context to the first bias of each chunk with relaxed
+	tolerances and keeps a copy of each solution. A step that fails is retried from the last
+	good solution with half the step. A chunk that cannot be reached is added to the chunk
+	before it.
+*/
+void TBiasSweep::coarse_pass(void)
+{
+	TErrorHandler& error_handler=master_context->error_handler;
+	int i, split_count;
+	prec bias, step, present_bias, target_bias;
+	FILE *good_state, *new_state;
+	logical own_good_state=FALSE;
+	SweepChunk *chunk_ptr, *previous_chunk;
+
+	chunks[0].state_file=save_state(master_context);
+	if (error_handler.fail()) return;
+
+	good_state=chunks[0].state_file;
+	previous_chunk=chunks;
+	present_bias=master_context->environment.get_value(CONTACT,APPLIED_BIAS,contact_number);
+	put_tolerance(master_context,coarse_error_factor);
+
+	for (i=1;i<number_chunks;i++) {
+		chunk_ptr=chunks+i;
+		if (stop_flag && *stop_flag) {
+			chunk_ptr->start_value=chunk_ptr->end_value;
+			continue;
+		}
+
+		target_bias=record_data[0][chunk_ptr->start_value];
+		step=target_bias-present_bias;
+		split_count=0;
+		while ((present_bias!=target_bias) && (split_count<=SWEEP_MAX_COARSE_SPLITS)) {
+			if (fabs(step)>=fabs(target_bias-present_bias)) bias=target_bias;
+			else bias=present_bias+step;
+
+			if (coarse_solve(bias)) {
+				new_state=save_state(master_context);
+				if (error_handler.fail()) break;
+				if (own_good_state) fclose(good_state);
+				good_state=new_state;
+				own_good_state=TRUE;
+				present_bias=bias;
+			}
+			else {
+				restore_state(master_context,good_state);
+				if (error_handler.fail()) break;
+				put_tolerance(master_context,coarse_error_factor);
+				step/=2.0;
+				split_count++;
+			}
+		}
+		if (error_handler.fail()) break;
+
+		if (present_bias==target_bias) {
+			if (!own_good_state) {
+				good_state=save_state(master_context);
+				if (error_handler.fail()) break;
+			}
+			chunk_ptr->state_file=good_state;
+			own_good_state=FALSE;
+			previous_chunk=chunk_ptr;
+		}
+		else {
+			previous_chunk->end_value=chunk_ptr->end_value;
+			chunk_ptr->start_value=chunk_ptr->end_value;
+		}
+	}
+
+	if (own_good_state) fclose(good_state);
+	put_tolerance(master_context,1.0);
+}
+
+/*
+	Creates the simulation context of a chunk with copies of the material parameters and of
+	the coarse solution. Workers do not write undo files or convergence output, and assemble
+	and solve their jacobians and compute node properties serially since the chunks already
+	keep every processor busy.
+*/
+void TBiasSweep::prepare_chunk(SweepChunk *chunk)
+{
+	flag env_effects;
+	prec refactor_ratio, line_search_iter, anderson_depth;
+	prec tunnel_quad_order, tunnel_quad_tolerance;
+	TSimulationContext *context;
+
+// Settings that are not part of the state file
+	refactor_ratio=master_context->environment.get_value(ENVIRONMENT,NEWTON_REFACTOR_RATIO);
+	line_search_iter=master_context->environment.get_value(ENVIRONMENT,MAX_LINE_SEARCH_ITER);
+	anderson_depth=master_context->environment.get_value(ENVIRONMENT,ANDERSON_DEPTH);
+	tunnel_quad_order=master_context->environment.get_value(ENVIRONMENT,TUNNEL_QUAD_ORDER);
+	tunnel_quad_tolerance=master_context->environment.get_value(ENVIRONMENT,TUNNEL_QUAD_TOLERANCE);
+
+	context=chunk->context=new TSimulationContext;
+	context->report_progress=FALSE;
+
+	context->material_parameters.copy(master_context->material_parameters);
+	if (!context->error_handler.fail()) restore_state(context,chunk->state_file);
+	if (!context->error_handler.fail()) {
+		put_tolerance(context,1.0);
+		context->environment.put_value(ENVIRONMENT,NEWTON_REFACTOR_RATIO,refactor_ratio);
+		context->environment.put_value(ENVIRONMENT,MAX_LINE_SEARCH_ITER,line_search_iter);
+		context->environment.put_value(ENVIRONMENT,ANDERSON_DEPTH,anderson_depth);
+		context->environment.put_value(ENVIRONMENT,TUNNEL_QUAD_ORDER,tunnel_quad_order);
+		context->environment.put_value(ENVIRONMENT,TUNNEL_QUAD_TOLERANCE,tunnel_quad_tolerance);
+		context->environment.put_value(ENVIRONMENT,ASSEMBLY_MIN_NODES,0.0);
+		context->environment.put_value(ENVIRONMENT,PARTITION_MIN_NODES,0.0);
+		context->environment.put_value(ENVIRONMENT,PROPERTY_MIN_NODES,0.0);
+		env_effects=(flag)context->environment.get_value(ENVIRONMENT,EFFECTS);
+		context->environment.put_value(ENVIRONMENT,EFFECTS,(prec)(env_effects & ~ENV_UNDO_SIMULATION));
+		context->environment.process_recompute_flags();
+	}
+}
+
+void TBiasSweep::solve_chunk(int chunk_number)
+{
+	int i;
+	SweepChunk *chunk_ptr=chunks+chunk_number;
+	TSimulationContext *context=(chunk_ptr->context) ? chunk_ptr->context : master_context;
+	TContextBinding binding(context);
+	TSolutionPredictor predictor(context,predictor_type);
+	TEnvironment& environment=context->environment;
+	TErrorHandler& error_handler=context->error_handler;
+
+	for (i=chunk_ptr->start_value;i<chunk_ptr->end_value;i++) {
+		if (error_handler.fail() || (stop_flag && *stop_flag)) break;
+
+		environment.put_value(CONTACT,APPLIED_BIAS,record_data[0][i],contact_number);
+		predictor.predict(record_data[0][i]);
+		if (error_handler.fail()) break;
+		if (context->report_progress) out_operating_condition();
+		environment.solve();
+		if (error_handler.fail()) break;
+		if (context->report_progress) out_simulation_result();
+
+		if (environment.get_value(DEVICE,CURRENT_STATUS)==NOT_CONVERGED) predictor.clear();
+		else predictor.store(record_data[0][i]);
+
+		record_values(context,record_data,i);
+		progress_lock.lock();
+		chunk_ptr->solved_values++;
+		progress_lock.unlock();
+		if (calling_sweep==this) report_points();
+	}
+}
+
+/*
+	Counts the points solved in order from the first bias and leaves the device of the
+	sweep context where the sweep ended, as if the points had been solved one by one.
+	An error in a chunk is passed on to the sweep context.
+*/
+void TBiasSweep::merge_chunks(void)
+{
+	int i;
+	SweepChunk *chunk_ptr, *last_chunk=(SweepChunk *)0, *failed_chunk=(SweepChunk *)0;
+	TErrorHandler chunk_error;
+
+	for (i=0;i<number_chunks;i++) {
+		chunk_ptr=chunks+i;
+		if (chunk_ptr->start_value==chunk_ptr->end_value) continue;
+		solved_values+=chunk_ptr->solved_values;
+		if (chunk_ptr->solved_values<chunk_ptr->end_value-chunk_ptr->start_value) {
+			failed_chunk=chunk_ptr;
+			break;
+		}
+		last_chunk=chunk_ptr;
+	}
+
+	if (failed_chunk && failed_chunk->context) chunk_error=failed_chunk->context->error_handler;
+	if (failed_chunk && !chunk_error.fail()) last_chunk=failed_chunk;
+
+	if (last_chunk) copy_chunk_state(last_chunk);
+	else if (chunks[0].state_file) restore_state(master_context,chunks[0].state_file);
+
+	if (chunk_error.fail()) master_context->error_handler=chunk_error;
+}
+
+void TBiasSweep::copy_chunk_state(SweepChunk *chunk)
+{
+	TEnvironment& environment=master_context->environment;
+	FILE *file_ptr;
+	flag env_effects;
+
+	if (!chunk->context) return;
+
+	env_effects=(flag)environment.get_value(ENVIRONMENT,EFFECTS);
+
+	file_ptr=tmpfile();
+	if (!file_ptr) {
+		master_context->error_handler.set_error(ERROR_FILE_NOT_OPEN,0,"","temporary state file");
+		return;
+	}
+	chunk->context->environment.write_state_file(file_ptr);
+	restore_state(master_context,file_ptr);
+	fclose(file_ptr);
+
+	environment.put_value(ENVIRONMENT,EFFECTS,(prec)env_effects);
+	environment.process_recompute_flags();
+}
+
+void TBiasSweep::chunk_task(void *sweep, int chunk_number)
+{
+	((TBiasSweep *)sweep)->solve_chunk(chunk_number);
+}
+
+/*
+	Passes the points solved in order from the first bias that have not been reported yet to
+	the point function. Only called on the thread that called execute(). The counts of the
+	other chunks are read under the lock, which also makes their recorded values visible here.
+*/
+void TBiasSweep::report_points(void)
+{
+	int i, ready_values=0;
+	SweepChunk *chunk_ptr;
+
+	if (!point_function) return;
+
+	progress_lock.lock();
+	for (i=0;i<number_chunks;i++) {
+		chunk_ptr=chunks+i;
+		if (chunk_ptr->start_value==chunk_ptr->end_value) continue;
+		ready_values=chunk_ptr->start_value+chunk_ptr->solved_values;
+		if (ready_values<chunk_ptr->end_value) break;
+	}
+	progress_lock.unlock();
+
+	TContextBinding binding(master_context);
+	for (;reported_values<ready_values;reported_values++) point_function(point_data,reported_values);
+}
+
+/*
+	Solves the points one after another in the sweep context with a variable step. The
+	step grows while Newton needs few iterations and the monitored values follow the trend
+	of the last two points. A point that does not converge or that leaves the trend is
+	solved again from the last point with half the step. The step stays between
+	SWEEP_MIN_STEP_FACTOR and SWEEP_MAX_STEP_FACTOR times the increment and a point that
+	still fails at the smallest step is kept, as in a fixed step sweep.
+*/
+void TBiasSweep::adaptive_pass(void)
+{
+	TEnvironment& environment=master_context->environment;
+	TErrorHandler& error_handler=master_context->error_handler;
+	int i, number_monitors;
+	int number_history=0;
+	prec bias, present_bias, end_bias;
+	prec step, min_step, max_step, deviation, value;
+	prec history_bias[2]={0.0,0.0};
+	prec history_values[2][SWEEP_MAX_MONITORS]={{0.0}};
+	prec monitor_values[SWEEP_MAX_MONITORS];
+	logical converged;
+	FILE *good_state=(FILE *)0;
+	TSolutionPredictor predictor(master_context,predictor_type);
+
+	delete_adaptive_data();
+
+	end_bias=start_bias+(prec)(number_values-1)*increment;
+	min_step=fabs(increment)*SWEEP_MIN_STEP_FACTOR;
+	max_step=fabs(increment)*SWEEP_MAX_STEP_FACTOR;
+	step=increment;
+	present_bias=start_bias;
+
+	for (;;) {
+		if (stop_flag && *stop_flag) break;
+
+// The last step is not allowed to overshoot or to leave a step smaller than the minimum
+		if (!solved_values) bias=start_bias;
+		else if ((end_bias-present_bias-step)*increment<min_step*fabs(increment)) bias=end_bias;
+		else bias=present_bias+step;
+
+		environment.put_value(CONTACT,APPLIED_BIAS,bias,contact_number);
+		predictor.predict(bias);
+		if (error_handler.fail()) break;
+		if (master_context->report_progress) out_operating_condition();
+		environment.solve();
+		if (error_handler.fail()) break;
+		if (master_context->report_progress) out_simulation_result();
+
+		converged=(environment.get_value(DEVICE,CURRENT_STATUS)!=NOT_CONVERGED);
+		number_monitors=get_monitor_values(monitor_values);
+
+// With fewer than two accepted points there is no trend and only convergence is checked
+		deviation=0.0;
+		if (number_history>=2) {
+			for (i=0;i<number_monitors;i++) {
+				value=comp_deviation(history_bias[1],history_values[1][i],
+									 history_bias[0],history_values[0][i],
+									 bias,monitor_values[i]);
+				if (value>deviation) deviation=value;
+			}
+		}
+
+		if (solved_values && (fabs(step)>min_step) &&
+			((!converged) || (deviation>SWEEP_MAX_DEVIATION))) {
+			restore_state(master_context,good_state);
+			if (error_handler.fail()) break;
+			step=(bias-present_bias)/2.0;
+			continue;
+		}
+
+		store_adaptive_values(bias);
+		if (point_function) point_function(point_data,solved_values-1);
+		if (converged) predictor.store(bias);
+		else predictor.clear();
+
+		history_bias[1]=history_bias[0];
+		history_bias[0]=bias;
+		for (i=0;i<number_monitors;i++) {
+			history_values[1][i]=history_values[0][i];
+			history_values[0][i]=monitor_values[i];
+		}
+		if (number_history<2) number_history++;
+		present_bias=bias;
+
+		if ((end_bias-present_bias)*increment<=0.0) break;
+
+		if (good_state) fclose(good_state);
+		good_state=save_state(master_context);
+		if (error_handler.fail()) break;
+
+		if (converged && (deviation<0.25*SWEEP_MAX_DEVIATION) &&
+			(environment.get_value(DEVICE,INNER_ELECT_ITER)<=SWEEP_GROW_ITERATIONS))
+			step*=2.0;
+		else if ((!converged) || (deviation>0.5*SWEEP_MAX_DEVIATION)) step/=2.0;
+
+		if (fabs(step)>max_step) step=(step>0.0) ? max_step : -max_step;
+		if (fabs(step)<min_step) step=(step>0.0) ? min_step : -min_step;
+	}
+
+	if (good_state) fclose(good_state);
+}
+
+void TBiasSweep::store_adaptive_values(prec bias)
+{
+	int i,j;
+	prec **new_data;
+
+	if (solved_values>=adaptive_size) {
+		new_data=new prec*[number_parameters];
+		for (i=0;i<number_parameters;i++) {
+			new_data[i]=new prec[2*adaptive_size+number_values];
+			for (j=0;j<solved_values;j++) new_data[i][j]=adaptive_data[i][j];
+		}
+		delete_adaptive_data();
+		adaptive_data=new_data;
+		adaptive_size=2*adaptive_size+number_values;
+	}
+
+	adaptive_data[0][solved_values]=bias;
+	record_values(master_context,adaptive_data,solved_values);
+	solved_values++;
+}
+
+void TBiasSweep::delete_adaptive_data(void)
+{
+	int i;
+
+	if (adaptive_data) {
+		for (i=0;i<number_parameters;i++) delete[] adaptive_data[i];
+		delete[] adaptive_data;
+		adaptive_data=(prec **)0;
+	}
+	adaptive_size=0;
+}
+
+/*
+	The step control follows the total current of the swept contact and the photon number
+	of a laser.
+*/
+int TBiasSweep::get_monitor_values(prec *values)
+{
+	TEnvironment& environment=master_context->environment;
+	int number_monitors=0;
+
+	values[number_monitors++]=environment.get_value(CONTACT,TOTAL_CURRENT,contact_number);
+	if ((flag)environment.get_value(DEVICE,EFFECTS) & DEVICE_LASER)
+		values[number_monitors++]=environment.get_value(MODE,MODE_TOTAL_PHOTONS);
+	return(number_monitors);
+}
+
+/*
+	Deviation of value_2 from the line through the two points before it. Values that keep
+	their sign are compared on a log scale, so an exponential rise is a smooth trend and the
+	result is in units of e. Otherwise the deviation is relative to the largest value.
+*/
+prec TBiasSweep::comp_deviation(prec bias_0, prec value_0, prec bias_1, prec value_1,
+								prec bias_2, prec value_2)
+{
+	prec scale, trend_value;
+
+	scale=fabs(value_0);
+	if (fabs(value_1)>scale) scale=fabs(value_1);
+	if (fabs(value_2)>scale) scale=fabs(value_2);
+	if (scale==0.0) return(0.0);
+
+	if ((value_0*value_1>0.0) && (value_1*value_2>0.0)) {
+		trend_value=log(fabs(value_1))+(log(fabs(value_1))-log(fabs(value_0)))*
+									   (bias_2-bias_1)/(bias_1-bias_0);
+		return(fabs(log(fabs(value_2))-trend_value));
+	}
+
+	trend_value=value_1+(value_1-value_0)*(bias_2-bias_1)/(bias_1-bias_0);
+	return(fabs(value_2-trend_value)/scale);
+}
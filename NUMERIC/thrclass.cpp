@@ -37,6 +37,8 @@ public:
 	virtual void update(prec update_lattice_temp, prec update_electron_temp,
 						prec update_hole_temp);
 	virtual void outer_update(prec clamp_value, prec relaxation_value);
+	virtual void comp_outer_residual(prec *residual);
+	virtual void outer_step(prec *step, prec clamp_value);
 	virtual void update_sub_nodes(void) {}
 
 	virtual void apply_boundary(void) {}
@@ -117,6 +119,44 @@ void TThermalElement::outer_update(prec clamp_value, prec relaxation_value)
 	}
 }
 
+/*
+	Change of the lattice, electron and hole temperature of the node in the last outer pass,
+	the stored temperature minus the present one.
+*/
+void TThermalElement::comp_outer_residual(prec *residual)
+{
+	residual[0]=next_node->stored_lattice_temp-next_node->lattice_temp;
+	residual[1]=next_node->TElectron::stored_temperature-next_node->TElectron::temperature;
+	residual[2]=next_node->THole::stored_temperature-next_node->THole::temperature;
+}
+
+/*
+	Sets the lattice, electron and hole temperature to the stored temperature minus step.
+	With clamp_value not zero a step is limited to clamp_value, and a temperature drops at
+	most to half the stored one as in update(). step is set to the steps taken.
+*/
+void TThermalElement::outer_step(prec *step, prec clamp_value)
+{
+	int i;
+	prec stored_temperature[3];
+
+	stored_temperature[0]=next_node->stored_lattice_temp;
+	stored_temperature[1]=next_node->TElectron::stored_temperature;
+	stored_temperature[2]=next_node->THole::stored_temperature;
+
+	for (i=0;i<3;i++) {
+		if (clamp_value!=0.0) {
+			if (step[i]>clamp_value) step[i]=clamp_value;
+			if (step[i]<-clamp_value) step[i]=-clamp_value;
+		}
+		if (step[i]>=stored_temperature[i]) step[i]=stored_temperature[i]/2.0;
+	}
+
+	next_node->lattice_temp=stored_temperature[0]-step[0];
+	next_node->TElectron::temperature=stored_temperature[1]-step[1];
+	next_node->THole::temperature=stored_temperature[2]-step[2];
+}
+
 /********************************* class TBulkThermalElement *********************************
 
 class TBulkThermalElement: public TThermalElement, public TElectricalServices {
@@ -250,20 +290,20 @@ void TBulkThermalElement::comp_therm_cond_drift_diff_param(void)
 	if (grid_effects & GRID_FERMI_DIRAC) {
 		switch(collision_factor) {
 			case -1:
-				therm_ec.fermi_ratio_5_half_3_half_col=fermi_integral_4_half(planck_potential)/
-													   fermi_integral_2_half(planck_potential);
+				therm_ec.fermi_ratio_5_half_3_half_col=fermi_integral_4_half(TElectricalServices::context,planck_potential)/
+													   fermi_integral_2_half(TElectricalServices::context,planck_potential);
 				break;
 			case 0:
-				therm_ec.fermi_ratio_5_half_3_half_col=fermi_integral_5_half(planck_potential)/
-													   fermi_integral_3_half(planck_potential);
+				therm_ec.fermi_ratio_5_half_3_half_col=fermi_integral_5_half(TElectricalServices::context,planck_potential)/
+													   fermi_integral_3_half(TElectricalServices::context,planck_potential);
 				break;
 			case 1:
-				therm_ec.fermi_ratio_5_half_3_half_col=fermi_integral_6_half(planck_potential)/
-													   fermi_integral_4_half(planck_potential);
+				therm_ec.fermi_ratio_5_half_3_half_col=fermi_integral_6_half(TElectricalServices::context,planck_potential)/
+													   fermi_integral_4_half(TElectricalServices::context,planck_potential);
 				break;
 			case 3:
-				therm_ec.fermi_ratio_5_half_3_half_col=fermi_integral_8_half(planck_potential)/
-													   fermi_integral_6_half(planck_potential);
+				therm_ec.fermi_ratio_5_half_3_half_col=fermi_integral_8_half(TElectricalServices::context,planck_potential)/
+													   fermi_integral_6_half(TElectricalServices::context,planck_potential);
 				break;
 			default: assert(FALSE); break;
 		}
@@ -296,20 +336,20 @@ void TBulkThermalElement::comp_therm_val_drift_diff_param(void)
 	if (grid_effects & GRID_FERMI_DIRAC) {
 		switch(collision_factor) {
 			case -1:
-				therm_ev.fermi_ratio_5_half_3_half_col=fermi_integral_4_half(planck_potential)/
-													   fermi_integral_2_half(planck_potential);
+				therm_ev.fermi_ratio_5_half_3_half_col=fermi_integral_4_half(TElectricalServices::context,planck_potential)/
+													   fermi_integral_2_half(TElectricalServices::context,planck_potential);
 				break;
 			case 0:
-				therm_ev.fermi_ratio_5_half_3_half_col=fermi_integral_5_half(planck_potential)/
-													   fermi_integral_3_half(planck_potential);
+				therm_ev.fermi_ratio_5_half_3_half_col=fermi_integral_5_half(TElectricalServices::context,planck_potential)/
+													   fermi_integral_3_half(TElectricalServices::context,planck_potential);
 				break;
 			case 1:
-				therm_ev.fermi_ratio_5_half_3_half_col=fermi_integral_6_half(planck_potential)/
-													   fermi_integral_4_half(planck_potential);
+				therm_ev.fermi_ratio_5_half_3_half_col=fermi_integral_6_half(TElectricalServices::context,planck_potential)/
+													   fermi_integral_4_half(TElectricalServices::context,planck_potential);
 				break;
 			case 3:
-				therm_ev.fermi_ratio_5_half_3_half_col=fermi_integral_8_half(planck_potential)/
-													   fermi_integral_6_half(planck_potential);
+				therm_ev.fermi_ratio_5_half_3_half_col=fermi_integral_8_half(TElectricalServices::context,planck_potential)/
+													   fermi_integral_6_half(TElectricalServices::context,planck_potential);
 				break;
 			default: assert(FALSE); break;
 		}
@@ -546,7 +586,7 @@ prec TBulkThermalElement::comp_trans_heat_flow(void)
 	prec environ_temp;
 
 	if (grid_effects & GRID_LATERAL_HEAT) {
-		environ_temp=environment.get_value(ENVIRONMENT,TEMPERATURE,0,NORMALIZED);
+		environ_temp=TElectricalServices::context->environment.get_value(ENVIRONMENT,TEMPERATURE,0,NORMALIZED);
 		result=length*((next_node->lateral_thermal_conduct+prev_node->lateral_thermal_conduct)/2.0)*
 					 (((next_node->lattice_temp+prev_node->lattice_temp)/2.0)-environ_temp);
 	}
@@ -560,7 +600,7 @@ prec TBulkThermalElement::comp_deriv_trans_heat_flow(NodeSide node)
 	prec result,environ_temp;
 
 	if (grid_effects & GRID_LATERAL_HEAT) {
-		environ_temp=environment.get_value(ENVIRONMENT,TEMPERATURE,0,NORMALIZED);
+		environ_temp=TElectricalServices::context->environment.get_value(ENVIRONMENT,TEMPERATURE,0,NORMALIZED);
 
 		result=length*((next_node->lateral_thermal_conduct+prev_node->lateral_thermal_conduct)/4.0);
 
@@ -1502,7 +1542,7 @@ prec TQWThermalElement::comp_trans_heat_flow(void)
 	prec environ_temp;
 
 	if (grid_effects & GRID_LATERAL_HEAT) {
-		environ_temp=environment.get_value(ENVIRONMENT,TEMPERATURE,0,NORMALIZED);
+		environ_temp=TElectricalServices::context->environment.get_value(ENVIRONMENT,TEMPERATURE,0,NORMALIZED);
 		result=length*((next_node->lateral_thermal_conduct+prev_node->lateral_thermal_conduct)/2.0)*
 					 (((next_node->lattice_temp+prev_node->lattice_temp)/2.0)-environ_temp);
 	}
@@ -1516,7 +1556,7 @@ prec TQWThermalElement::comp_deriv_trans_heat_flow(NodeSide node)
 	prec result,environ_temp;
 
 	if (grid_effects & GRID_LATERAL_HEAT) {
-		environ_temp=environment.get_value(ENVIRONMENT,TEMPERATURE,0,NORMALIZED);
+		environ_temp=TElectricalServices::context->environment.get_value(ENVIRONMENT,TEMPERATURE,0,NORMALIZED);
 
 		result=length*((next_node->lateral_thermal_conduct+prev_node->lateral_thermal_conduct)/4.0);
 
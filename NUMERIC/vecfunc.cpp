@@ -0,0 +1,344 @@
+/*
+    SimWindows - 1D Semiconductor Device Simulator
+    Copyright (C) 2013 David W. Winston
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "comincl.h"
+#include <string.h>
+
+/***********************************************************************************************
+	SIMD kernels of the array forms of the fermi integrals. With GCC or Clang on x86 the
+	analytic approximations are evaluated four values at a time with AVX2 and FMA or eight at
+	a time with AVX-512. The kernels are written once with the vector extensions of the
+	compiler and compiled for each instruction set through the target attribute, so the rest
+	of the program is built for the base instruction set and the kernel is chosen when the
+	program starts from what the processor supports. Without the extensions, or on a processor
+	without AVX2 and FMA, the functions below do nothing and the array forms use the scalar
+	loop.
+
+	pow(a,b) is taken as exp(b*ln(a)). exp reduces its argument by multiples of ln(2) and sums
+	the Taylor series of the remainder to the 13th power, ln reduces its argument to
+	[sqrt(1/2),sqrt(2)) and sums the series of 2*atanh((m-1)/(m+1)) to the 23rd power. Both are
+	accurate to a few units in the last place, and the fermi integrals differ from the single
+	value functions by at most 5e-15 relative over -800<=x<=800 (see CONSOLE/frmbench.cpp).
+	They are not bit identical to them, so a node can get slightly different values from the
+	array and the single value forms. Every value of an array is computed by the kernel,
+	including the tail that does not fill a vector, so the result for a node does not depend
+	on where it falls in a block or on how the grid is split between workers.
+*/
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+
+#define FERMI_VECTOR_KERNELS
+
+// The helpers below are always inlined, so their vector results never pass through the ABI
+#pragma GCC diagnostic ignored "-Wpsabi"
+
+typedef double FermiVector4 __attribute__((vector_size(32)));
+typedef long long FermiIndex4 __attribute__((vector_size(32)));
+typedef double FermiVector8 __attribute__((vector_size(64)));
+typedef long long FermiIndex8 __attribute__((vector_size(64)));
+
+#define VECTOR_INLINE			static inline __attribute__((always_inline))
+#define VECTOR_MAGIC			6755399441055744.0
+#define VECTOR_MAGIC_BITS		0x4338000000000000LL
+#define VECTOR_EXP_MAX			709.782712893384
+#define VECTOR_EXP_MIN			-745.2
+#define VECTOR_LN2_HI			6.93147180369123816490e-01
+#define VECTOR_LN2_LO			1.90821492927058770002e-10
+#define VECTOR_LOG2E			1.44269504088896338700
+#define VECTOR_SQRT2			1.41421356237309504880
+#define VECTOR_MIN_NORMAL		2.2250738585072014e-308
+#define VECTOR_SUBNORMAL_SCALE	18014398509481984.0
+
+/*
+	Elementwise mask?a:b. The comparisons of the vector extensions give -1 where true and 0
+	where false in each element.
+*/
+template <class V, class I> VECTOR_INLINE V vector_select(const I& mask, const V& a, const V& b)
+{
+	return((V)((mask & (I)a) | (~mask & (I)b)));
+}
+
+template <class V, class I> VECTOR_INLINE V vector_fabs(const V& x)
+{
+	return((V)((I)x & 0x7fffffffffffffffLL));
+}
+
+/*
+	Elements below VECTOR_EXP_MIN give 0 and above VECTOR_EXP_MAX give infinity, as exp()
+	does. 2^n is built in two halves so that it stays a normal number for every n in range.
+*/
+template <class V, class I> VECTOR_INLINE V vector_exp(const V& x)
+{
+	V clamped, t, n, r, p, scale_1, scale_2;
+	I low, high, n_int, n_1;
+
+	low=(I)(x<VECTOR_EXP_MIN);
+	high=(I)(x>VECTOR_EXP_MAX);
+	clamped=vector_select<V,I>(low,V()+VECTOR_EXP_MIN,x);
+	clamped=vector_select<V,I>(high,V()+VECTOR_EXP_MAX,clamped);
+
+	t=clamped*VECTOR_LOG2E+VECTOR_MAGIC;
+	n=t-VECTOR_MAGIC;
+	r=(clamped-n*VECTOR_LN2_HI)-n*VECTOR_LN2_LO;
+
+	p=V()+1.0/6227020800.0;
+	p=p*r+1.0/479001600.0;
+	p=p*r+1.0/39916800.0;
+	p=p*r+1.0/3628800.0;
+	p=p*r+1.0/362880.0;
+	p=p*r+1.0/40320.0;
+	p=p*r+1.0/5040.0;
+	p=p*r+1.0/720.0;
+	p=p*r+1.0/120.0;
+	p=p*r+1.0/24.0;
+	p=p*r+1.0/6.0;
+	p=p*r+0.5;
+	p=p*r+1.0;
+	p=p*r+1.0;
+
+	n_int=(I)t-VECTOR_MAGIC_BITS;
+	n_1=n_int>>1;
+	scale_1=(V)((n_1+1023LL)<<52);
+	scale_2=(V)((n_int-n_1+1023LL)<<52);
+	p=(p*scale_1)*scale_2;
+
+	p=vector_select<V,I>(low,V(),p);
+	return(vector_select<V,I>(high,V()+HUGE_VAL,p));
+}
+
+/*
+	Natural logarithm of elements greater than zero.
+*/
+template <class V, class I> VECTOR_INLINE V vector_log(const V& value)
+{
+	V x, m, f, f2, p, exponent;
+	I subnormal, bits, e, upper;
+
+	subnormal=(I)(value<VECTOR_MIN_NORMAL);
+	x=vector_select<V,I>(subnormal,value*VECTOR_SUBNORMAL_SCALE,value);
+	bits=(I)x;
+	e=(bits>>52)-(1023LL+(subnormal & 54LL));
+	m=(V)((bits & 0x000fffffffffffffLL) | 0x3ff0000000000000LL);
+	upper=(I)(m>VECTOR_SQRT2);
+	m=vector_select<V,I>(upper,m*0.5,m);
+	e=e-upper;
+	exponent=(V)(e+VECTOR_MAGIC_BITS)-VECTOR_MAGIC;
+
+	f=(m-1.0)/(m+1.0);
+	f2=f*f;
+	p=V()+1.0/23.0;
+	p=p*f2+1.0/21.0;
+	p=p*f2+1.0/19.0;
+	p=p*f2+1.0/17.0;
+	p=p*f2+1.0/15.0;
+	p=p*f2+1.0/13.0;
+	p=p*f2+1.0/11.0;
+	p=p*f2+1.0/9.0;
+	p=p*f2+1.0/7.0;
+	p=p*f2+1.0/5.0;
+	p=p*f2+1.0/3.0;
+	p=p*f2+1.0;
+
+	return(exponent*VECTOR_LN2_HI+(2.0*f*p+exponent*VECTOR_LN2_LO));
+}
+
+/*
+	pow(x,y) for elements greater than or equal to zero
+*/
+template <class V, class I> VECTOR_INLINE V vector_pow(const V& x, prec y)
+{
+	return(vector_select<V,I>((I)(x==0.0),V(),vector_exp<V,I>(y*vector_log<V,I>(x))));
+}
+
+/*
+	The expressions of fermi_integral_minus_1_half(prec x), fermi_integral_1_half(prec x) and
+	fermi_integral_3_half(prec x)
+*/
+template <class V, class I> VECTOR_INLINE V vector_minus_1_half(const V& x)
+{
+	V inner;
+
+	inner=vector_pow<V,I>(vector_fabs<V,I>(x-1.495),2.828427125)+4.466276461;
+	return(1.0/(1.253314137*vector_pow<V,I>(1.495+x+vector_pow<V,I>(inner,0.353553391),-0.5)+
+				vector_exp<V,I>(-x)));
+}
+
+template <class V, class I> VECTOR_INLINE V vector_1_half(const V& x)
+{
+	V inner;
+
+	inner=vector_pow<V,I>(vector_fabs<V,I>(x-2.105),2.414213562)+9.901280188;
+	return(1.0/(3.759942412*vector_pow<V,I>(2.105+x+vector_pow<V,I>(inner,0.414213562),-1.5)+
+				vector_exp<V,I>(-x)));
+}
+
+template <class V, class I> VECTOR_INLINE V vector_3_half(const V& x)
+{
+	V inner;
+
+	inner=vector_pow<V,I>(vector_fabs<V,I>(x-2.715),2.207106781)+13.4388215;
+	return(1.0/(18.79971206*vector_pow<V,I>(2.715+x+vector_pow<V,I>(inner,0.453081839),-2.5)+
+				vector_exp<V,I>(-x)));
+}
+
+/*
+	Runs a kernel over whole vectors and then over the tail, padded with zeros
+*/
+template <class V, class I, int order> VECTOR_INLINE void vector_fermi_integral(const prec *x, prec *result,
+																				 int count)
+{
+	int i, tail;
+	V value;
+	prec padded[sizeof(V)/sizeof(prec)];
+
+	for (i=0;i+(int)(sizeof(V)/sizeof(prec))<=count;i+=sizeof(V)/sizeof(prec)) {
+		memcpy(&value,x+i,sizeof(V));
+		switch(order) {
+			case -1: value=vector_minus_1_half<V,I>(value); break;
+			case 1: value=vector_1_half<V,I>(value); break;
+			default: value=vector_3_half<V,I>(value); break;
+		}
+		memcpy(result+i,&value,sizeof(V));
+	}
+
+	tail=count-i;
+	if (tail) {
+		memset(padded,0,sizeof(V));
+		memcpy(padded,x+i,tail*sizeof(prec));
+		memcpy(&value,padded,sizeof(V));
+		switch(order) {
+			case -1: value=vector_minus_1_half<V,I>(value); break;
+			case 1: value=vector_1_half<V,I>(value); break;
+			default: value=vector_3_half<V,I>(value); break;
+		}
+		memcpy(padded,&value,sizeof(V));
+		memcpy(result+i,padded,tail*sizeof(prec));
+	}
+}
+
+__attribute__((target("avx2,fma")))
+static void avx2_fermi_integral_minus_1_half(const prec *x, prec *result, int count)
+{
+	vector_fermi_integral<FermiVector4,FermiIndex4,-1>(x,result,count);
+}
+
+__attribute__((target("avx2,fma")))
+static void avx2_fermi_integral_1_half(const prec *x, prec *result, int count)
+{
+	vector_fermi_integral<FermiVector4,FermiIndex4,1>(x,result,count);
+}
+
+__attribute__((target("avx2,fma")))
+static void avx2_fermi_integral_3_half(const prec *x, prec *result, int count)
+{
+	vector_fermi_integral<FermiVector4,FermiIndex4,3>(x,result,count);
+}
+
+__attribute__((target("avx512f")))
+static void avx512_fermi_integral_minus_1_half(const prec *x, prec *result, int count)
+{
+	vector_fermi_integral<FermiVector8,FermiIndex8,-1>(x,result,count);
+}
+
+__attribute__((target("avx512f")))
+static void avx512_fermi_integral_1_half(const prec *x, prec *result, int count)
+{
+	vector_fermi_integral<FermiVector8,FermiIndex8,1>(x,result,count);
+}
+
+__attribute__((target("avx512f")))
+static void avx512_fermi_integral_3_half(const prec *x, prec *result, int count)
+{
+	vector_fermi_integral<FermiVector8,FermiIndex8,3>(x,result,count);
+}
+
+/*
+	Chosen once before main() is entered, so the threads that solve only read it.
+	__builtin_cpu_supports() also checks that the operating system saves the vector registers.
+*/
+static int select_vector_width(void)
+{
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx512f")) return(8);
+	if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) return(4);
+	return(1);
+}
+
+static int fermi_vector_width_value=select_vector_width();
+
+#endif
+
+/***********************************************************************************************
+int fermi_vector_width(void)
+	Returns the number of values the fermi integral kernels take at a time, 1 when the array
+	forms use the scalar loop.
+*/
+
+int fermi_vector_width(void)
+{
+#ifdef FERMI_VECTOR_KERNELS
+	return(fermi_vector_width_value);
+#else
+	return(1);
+#endif
+}
+
+/***********************************************************************************************
+logical vector_fermi_integral_minus_1_half(const prec *x, prec *result, int count)
+logical vector_fermi_integral_1_half(const prec *x, prec *result, int count)
+logical vector_fermi_integral_3_half(const prec *x, prec *result, int count)
+	Fill result[0] to result[count-1] with the analytic approximations and return TRUE if the
+	processor has a kernel. Return FALSE and leave result alone if it does not.
+*/
+
+logical vector_fermi_integral_minus_1_half(const prec *x, prec *result, int count)
+{
+#ifdef FERMI_VECTOR_KERNELS
+	switch(fermi_vector_width_value) {
+		case 8: avx512_fermi_integral_minus_1_half(x,result,count); return(TRUE);
+		case 4: avx2_fermi_integral_minus_1_half(x,result,count); return(TRUE);
+		default: break;
+	}
+#endif
+	return(FALSE);
+}
+
+logical vector_fermi_integral_1_half(const prec *x, prec *result, int count)
+{
+#ifdef FERMI_VECTOR_KERNELS
+	switch(fermi_vector_width_value) {
+		case 8: avx512_fermi_integral_1_half(x,result,count); return(TRUE);
+		case 4: avx2_fermi_integral_1_half(x,result,count); return(TRUE);
+		default: break;
+	}
+#endif
+	return(FALSE);
+}
+
+logical vector_fermi_integral_3_half(const prec *x, prec *result, int count)
+{
+#ifdef FERMI_VECTOR_KERNELS
+	switch(fermi_vector_width_value) {
+		case 8: avx512_fermi_integral_3_half(x,result,count); return(TRUE);
+		case 4: avx2_fermi_integral_3_half(x,result,count); return(TRUE);
+		default: break;
+	}
+#endif
+	return(FALSE);
+}
+
@@ -0,0 +1,374 @@
+/*
+    SimWindows - 1D Semiconductor Device Simulator
+    Copyright (C) 2013 David W. Winston
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "comincl.h"
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
+
+//************************************* struct WorkerSync *************************************
+/*
+	Platform threads and synchronization. The start and done counts work as
+	semaphores: run() posts one start per thread and waits for one done per thread.
+*/
+
+struct WorkerSync {
+#ifdef _WIN32
+	HANDLE *threads;
+	CRITICAL_SECTION lock;
+	HANDLE start_semaphore;
+	HANDLE done_semaphore;
+	static DWORD WINAPI entry(LPVOID pool)
+		{ TWorkerPool::thread_main((TWorkerPool *)pool); return(0); }
+#else
+	pthread_t *threads;
+	pthread_mutex_t lock;
+	pthread_cond_t start_condition;
+	pthread_cond_t done_condition;
+	int start_count;
+	int done_count;
+	static void *entry(void *pool)
+		{ TWorkerPool::thread_main((TWorkerPool *)pool); return((void *)0); }
+#endif
+};
+
+static void sync_init(WorkerSync *sync, int number_threads)
+{
+#ifdef _WIN32
+	sync->threads=new HANDLE[number_threads];
+	InitializeCriticalSection(&sync->lock);
+	sync->start_semaphore=CreateSemaphore(NULL,0,number_threads,NULL);
+	sync->done_semaphore=CreateSemaphore(NULL,0,number_threads,NULL);
+#else
+	sync->threads=new pthread_t[number_threads];
+	pthread_mutex_init(&sync->lock,NULL);
+	pthread_cond_init(&sync->start_condition,NULL);
+	pthread_cond_init(&sync->done_condition,NULL);
+	sync->start_count=0;
+	sync->done_count=0;
+#endif
+}
+
+static void sync_destroy(WorkerSync *sync)
+{
+#ifdef _WIN32
+	CloseHandle(sync->start_semaphore);
+	CloseHandle(sync->done_semaphore);
+	DeleteCriticalSection(&sync->lock);
+#else
+	pthread_cond_destroy(&sync->start_condition);
+	pthread_cond_destroy(&sync->done_condition);
+	pthread_mutex_destroy(&sync->lock);
+#endif
+	delete[] sync->threads;
+}
+
+static logical sync_create_thread(WorkerSync *sync, int thread_number, TWorkerPool *pool)
+{
+#ifdef _WIN32
+	DWORD thread_id;
+
+	sync->threads[thread_number]=CreateThread(NULL,0,WorkerSync::entry,pool,0,&thread_id);
+	return(sync->threads[thread_number]!=NULL);
+#else
+	return(pthread_create(sync->threads+thread_number,NULL,WorkerSync::entry,pool)==0);
+#endif
+}
+
+static void sync_join_thread(WorkerSync *sync, int thread_number)
+{
+#ifdef _WIN32
+	WaitForSingleObject(sync->threads[thread_number],INFINITE);
+	CloseHandle(sync->threads[thread_number]);
+#else
+	pthread_join(sync->threads[thread_number],NULL);
+#endif
+}
+
+static void sync_lock(WorkerSync *sync)
+{
+#ifdef _WIN32
+	EnterCriticalSection(&sync->lock);
+#else
+	pthread_mutex_lock(&sync->lock);
+#endif
+}
+
+static void sync_unlock(WorkerSync *sync)
+{
+#ifdef _WIN32
+	LeaveCriticalSection(&sync->lock);
+#else
+	pthread_mutex_unlock(&sync->lock);
+#endif
+}
+
+static void sync_post_start(WorkerSync *sync, int count)
+{
+#ifdef _WIN32
+	ReleaseSemaphore(sync->start_semaphore,count,NULL);
+#else
+	pthread_mutex_lock(&sync->lock);
+	sync->start_count+=count;
+	pthread_cond_broadcast(&sync->start_condition);
+	pthread_mutex_unlock(&sync->lock);
+#endif
+}
+
+static void sync_wait_start(WorkerSync *sync)
+{
+#ifdef _WIN32
+	WaitForSingleObject(sync->start_semaphore,INFINITE);
+#else
+	pthread_mutex_lock(&sync->lock);
+	while (!sync->start_count) pthread_cond_wait(&sync->start_condition,&sync->lock);
+	sync->start_count--;
+	pthread_mutex_unlock(&sync->lock);
+#endif
+}
+
+static void sync_post_done(WorkerSync *sync)
+{
+#ifdef _WIN32
+	ReleaseSemaphore(sync->done_semaphore,1,NULL);
+#else
+	pthread_mutex_lock(&sync->lock);
+	sync->done_count++;
+	pthread_cond_signal(&sync->done_condition);
+	pthread_mutex_unlock(&sync->lock);
+#endif
+}
+
+static void sync_wait_done(WorkerSync *sync, int count)
+{
+#ifdef _WIN32
+	int i;
+
+	for (i=0;i<count;i++) WaitForSingleObject(sync->done_semaphore,INFINITE);
+#else
+	pthread_mutex_lock(&sync->lock);
+	while (sync->done_count<count) pthread_cond_wait(&sync->done_condition,&sync->lock);
+	sync->done_count-=count;
+	pthread_mutex_unlock(&sync->lock);
+#endif
+}
+
+//************************************* class TWorkerPool *************************************
+/*
+class TWorkerPool {
+private:
+	int number_threads;
+	WorkerSync *sync;
+	WorkerTask task;
+	void *task_data;
+	int number_tasks;
+	int next_task;
+	logical running;
+	logical shutdown;
+	TSimulationContext *context;
+public:
+	TWorkerPool(TSimulationContext *new_context, int number_workers=0);
+	~TWorkerPool(void);
+	int get_number_workers(void) { return(number_threads+1); }
+	void run(WorkerTask new_task, void *new_task_data, int new_number_tasks);
+private:
+	void execute_tasks(void);
+	logical get_next_task(int& task_number);
+	static void thread_main(TWorkerPool *pool);
+	friend struct WorkerSync;
+};
+*/
+
+TWorkerPool::TWorkerPool(TSimulationContext *new_context, int number_workers)
+{
+	int i;
+
+	if (number_workers<=0) number_workers=get_number_processors();
+
+	task=(WorkerTask)0;
+	task_data=(void *)0;
+	number_tasks=0;
+	next_task=0;
+	running=FALSE;
+	shutdown=FALSE;
+	context=new_context;
+
+	sync=new WorkerSync;
+	sync_init(sync,number_workers);
+
+// The calling thread is one of the workers
+	for (i=0;i<number_workers-1;i++) {
+		if (!sync_create_thread(sync,i,this)) break;
+	}
+	number_threads=i;
+}
+
+TWorkerPool::~TWorkerPool(void)
+{
+	int i;
+
+	sync_lock(sync);
+	shutdown=TRUE;
+	sync_unlock(sync);
+	sync_post_start(sync,number_threads);
+
+	for (i=0;i<number_threads;i++) sync_join_thread(sync,i);
+	sync_destroy(sync);
+	delete sync;
+}
+
+/*
+	Executes task(task_data,i) for i=0..new_number_tasks-1. A pool that is already
+	running, e.g. when a task itself calls run(), executes the tasks on the calling thread.
+*/
+void TWorkerPool::run(WorkerTask new_task, void *new_task_data, int new_number_tasks)
+{
+	int i;
+	logical parallel;
+
+	sync_lock(sync);
+	parallel=(!running) && (number_threads>0) && (new_number_tasks>1);
+	if (parallel) running=TRUE;
+	sync_unlock(sync);
+
+	if (!parallel) {
+		for (i=0;i<new_number_tasks;i++) new_task(new_task_data,i);
+		return;
+	}
+
+	task=new_task;
+	task_data=new_task_data;
+	number_tasks=new_number_tasks;
+	next_task=0;
+
+	sync_post_start(sync,number_threads);
+	execute_tasks();
+	sync_wait_done(sync,number_threads);
+
+	sync_lock(sync);
+	running=FALSE;
+	sync_unlock(sync);
+}
+
+void TWorkerPool::execute_tasks(void)
+{
+	int task_number;
+	TContextBinding binding(context);
+
+	while (get_next_task(task_number)) task(task_data,task_number);
+}
+
+logical TWorkerPool::get_next_task(int& task_number)
+{
+	logical result;
+
+	sync_lock(sync);
+	result=(next_task<number_tasks);
+	if (result) task_number=next_task++;
+	sync_unlock(sync);
+	return(result);
+}
+
+void TWorkerPool::thread_main(TWorkerPool *pool)
+{
+	for (;;) {
+		sync_wait_start(pool->sync);
+		if (pool->shutdown) break;
+		pool->execute_tasks();
+		sync_post_done(pool->sync);
+	}
+}
+
+//************************************* class TWorkerLock *************************************
+/*
+class TWorkerLock {
+private:
+	WorkerMutex *mutex;
+public:
+	TWorkerLock(void);
+	~TWorkerLock(void);
+	void lock(void);
+	void unlock(void);
+};
+*/
+
+struct WorkerMutex {
+#ifdef _WIN32
+	CRITICAL_SECTION section;
+#else
+	pthread_mutex_t mutex;
+#endif
+};
+
+TWorkerLock::TWorkerLock(void)
+{
+	mutex=new WorkerMutex;
+#ifdef _WIN32
+	InitializeCriticalSection(&mutex->section);
+#else
+	pthread_mutex_init(&mutex->mutex,NULL);
+#endif
+}
+
+TWorkerLock::~TWorkerLock(void)
+{
+#ifdef _WIN32
+	DeleteCriticalSection(&mutex->section);
+#else
+	pthread_mutex_destroy(&mutex->mutex);
+#endif
+	delete mutex;
+}
+
+void TWorkerLock::lock(void)
+{
+#ifdef _WIN32
+	EnterCriticalSection(&mutex->section);
+#else
+	pthread_mutex_lock(&mutex->mutex);
+#endif
+}
+
+void TWorkerLock::unlock(void)
+{
+#ifdef _WIN32
+	LeaveCriticalSection(&mutex->section);
+#else
+	pthread_mutex_unlock(&mutex->mutex);
+#endif
+}
+
+//************************************* Global functions *************************************
+
+int get_number_processors(void)
+{
+	int number_processors;
+
+#ifdef _WIN32
+	SYSTEM_INFO system_info;
+
+	GetSystemInfo(&system_info);
+	number_processors=(int)system_info.dwNumberOfProcessors;
+#else
+	number_processors=(int)sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+	if (number_processors<1) number_processors=1;
+	return(number_processors);
+}
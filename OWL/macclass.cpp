@@ -57,6 +57,7 @@ protected:
 	prec start_value;
 	prec end_value;
 	prec increment;
+	logical adaptive_step;
 	int number_parameters;
 	int number_values;
 	prec **record_data;
@@ -75,6 +76,7 @@ public:
 		{ flag_type=increment_flag_type; flag_value=increment_flag; object_number=increment_object_number; }
 	int get_increment_object_number(void) { return(increment_object_number); }
 	prec get_increment_value(void) { return(increment); }
+	logical get_adaptive_step(void) { return(adaptive_step); }
 	int get_number_values(void) { return(number_values); }
 	int get_data_point(prec value, int start_point=-1, int end_point=-1);
 	prec get_value(FlagType flag_type, flag flag_value, int object_number, int data_number);
@@ -88,10 +90,12 @@ public:
 	void put_end_value(prec new_end) { end_value=new_end; }
 	void put_increment_object_number(int new_object) { increment_object_number=new_object; }
 	void put_increment_value(prec new_increment) { increment=new_increment; }
+	void put_adaptive_step(logical adaptive) { adaptive_step=adaptive; }
 	void write_data_file(const char *filename, FlagType y_flag_type, flag y_flag);
 	virtual void execute(const char *filename)=0;
 protected:
 	void allocate_data(void);
+	void resize_data(int new_number_values);
 	void initialize_data(void);
 };
 */
@@ -104,6 +108,7 @@ TMacro::TMacro(FlagType new_flag_type, flag new_flag)
 	start_value=0.0;
 	end_value=0.0;
 	increment=0.0;
+	adaptive_step=FALSE;
 	number_parameters=0;
 	number_values=0;
 	record_data=(prec **)0;
@@ -205,6 +210,24 @@ void TMacro::allocate_data(void)
 	}
 }
 
+/*
+	Used when the number of points is only known after the macro is executed. The
+	recorded values are cleared, at least one point is kept.
+*/
+void TMacro::resize_data(int new_number_values)
+{
+	int i,j;
+
+	if (new_number_values<1) new_number_values=1;
+
+	for (i=0;i<number_parameters;i++) {
+		delete[] record_data[i];
+		record_data[i]=new prec[new_number_values];
+		for (j=0;j<new_number_values;j++) record_data[i][j]=0.0;
+	}
+	number_values=new_number_values;
+}
+
 void TMacro::initialize_data(void)
 {
 	int i;
@@ -240,7 +263,7 @@ void TMacro::write_data_file(const char *filename, FlagType y_flag_type, flag y_
 	ofstream output_file(filename);
 
 	if (!output_file) {
-		error_handler.set_error(ERROR_FILE_NOT_OPEN,0,"",filename);
+		current_context->error_handler.set_error(ERROR_FILE_NOT_OPEN,0,"",filename);
 		return;
 	}
 
@@ -248,14 +271,14 @@ void TMacro::write_data_file(const char *filename, FlagType y_flag_type, flag y_
 	output_file.precision(new_precision);
 
 	output_file << get_short_string(flag_type_array[0], flag_array[0]) <<
-				   get_short_location_string(flag_type_array[0],object_array[0]);
+				   get_short_location_string(current_context,flag_type_array[0],object_array[0]);
 
 	for (i=1;i<number_parameters;i++) {
 		present_flag=flag_array[i];
 		present_flag_type=flag_type_array[i];
 		if ((present_flag_type==y_flag_type) && (present_flag==y_flag)) {
 			output_file << "," << get_short_string(present_flag_type, present_flag) <<
-								  get_short_location_string(present_flag_type,object_array[i]);
+								  get_short_location_string(current_context,present_flag_type,object_array[i]);
 		}
 	}
 	output_file << '\n';
@@ -278,24 +301,29 @@ void TMacro::write_data_file(const char *filename, FlagType y_flag_type, flag y_
 class TVoltageMacro: public TMacro {
 protected:
 	logical reset_device;
+	TBiasSweep *bias_sweep;
+	const char *data_filename;
+	TMDIClient *client_window;
 public:
 	TVoltageMacro(void)
-		: TMacro(CONTACT,APPLIED_BIAS) {}
+		: TMacro(CONTACT,APPLIED_BIAS), bias_sweep((TBiasSweep *)0),
+		  data_filename((const char *)0), client_window((TMDIClient *)0) {}
 	virtual ~TVoltageMacro(void) {}
 	logical get_reset_device(void) { return(reset_device); }
 	void put_reset_device(logical reset) { reset_device=reset; }
 	virtual void execute(const char *filename);
+protected:
+	static void point_solved(void *macro, int value_number);
+	void write_point(int value_number);
 };
 */
 void TVoltageMacro::execute(const char *filename)
 {
-	TMDIClient *client_window;
+	TErrorHandler& error_handler=current_context->error_handler;
+	int i,j,new_precision=4;
 	clock_t start_time, end_time;
-	int i,iteration_count, new_precision=4;
 	char time_string[40];
-	FlagType present_flag_type;
-	flag present_flag;
-	int present_object;
+	char sweep_string[60];
 	ofstream output_file;
 
     solving=TRUE;
@@ -303,12 +331,14 @@ void TVoltageMacro::execute(const char *filename)
 	start_time=clock();
 
 	client_window=dynamic_cast<TMDIClient *>(status_window->GetApplication()->GetMainWindow()->GetClientWindow());
+	data_filename=filename;
 
 	allocate_data();
 	output_file.open(filename,ios::out | ios::trunc);
 
 	if (output_file.fail()) {
 		error_handler.set_error(ERROR_FILE_NOT_OPEN,0,"",filename);
+		solving=FALSE;
 		return;
 	}
 
@@ -318,7 +348,7 @@ void TVoltageMacro::execute(const char *filename)
 	status_window->UpdateWindow();
 
 	if (reset_device) {
-		environment.init_device();
+		current_context->environment.init_device();
 		status_window->Insert("Reset Device\r\n\r\n");
 	}
 
@@ -330,47 +360,46 @@ void TVoltageMacro::execute(const char *filename)
 	output_file.precision(new_precision);
 
 	for (i=0;i<number_parameters;i++) {
-		present_flag=flag_array[i];
-		present_flag_type=flag_type_array[i];
-		output_file << get_short_string(present_flag_type, present_flag) <<
-					   get_short_location_string(present_flag_type,object_array[i]);
+		output_file << get_short_string(flag_type_array[i], flag_array[i]) <<
+					   get_short_location_string(current_context,flag_type_array[i],object_array[i]);
 		if (i<number_parameters-1) output_file << ",";
 	}
 	output_file << '\n';
 
 	output_file.close();
 
-	for (iteration_count=0;iteration_count<number_values;iteration_count++)
-		record_data[0][iteration_count]=start_value+(prec)iteration_count*increment;
-
-	for (iteration_count=0;iteration_count<number_values;iteration_count++) {
-		environment.put_value(CONTACT,APPLIED_BIAS,record_data[0][iteration_count],increment_object_number);
-		status_window->Insert("\r\n");
-		out_operating_condition();
-		environment.solve();
-		out_simulation_result();
-		if (error_handler.fail()) break;
-		client_window->ForEach(UpdateValidEnvironPlot);
-		output_file.open(filename,ios::out | ios::app);
-		if (output_file.fail()) {
-			error_handler.set_error(ERROR_FILE_NOT_OPEN,0,"",filename);
-			break;
-		}
-		output_file << record_data[0][iteration_count];
-		if (number_parameters>1) output_file << ",";
-		for (i=1;i<number_parameters;i++) {
-			present_flag=flag_array[i];
-			present_flag_type=flag_type_array[i];
-			present_object=object_array[i];
-			record_data[i][iteration_count]=environment.get_value(present_flag_type,present_flag,present_object);
-			output_file << record_data[i][iteration_count];
-			if (i<number_parameters-1) output_file << ",";
-		}
-		output_file << '\n';
+// The bias points are split among the processors, each solving its points on its own copy
+// of the device. The recorded values end up in record_data as for a point by point sweep.
+// Each point comes back in order on this thread through point_solved().
+	bias_sweep=new TBiasSweep(current_context,increment_object_number,start_value,increment,
+							  number_values,number_parameters,flag_type_array,flag_array,object_array,
+							  record_data);
+	bias_sweep->put_stop_flag(&stop_solution);
+	bias_sweep->put_point_function(point_solved,this);
+	bias_sweep->put_adaptive_step(adaptive_step);
+	if (adaptive_step)
+		sprintf(sweep_string,"Adaptive Bias Sweep: initial step %.3f V\r\n",increment);
+	else
+		sprintf(sweep_string,"Bias Sweep: %d points in %d chunks\r\n",number_values,bias_sweep->get_number_chunks());
+	status_window->Insert(sweep_string);
 
-		output_file.close();
-        if (stop_solution) iteration_count=number_values;
+	bias_sweep->execute();
+
+// With an adaptive step the sweep chooses its own biases and keeps the values itself
+	if (adaptive_step) {
+		resize_data(bias_sweep->get_solved_values());
+		for (i=0;i<bias_sweep->get_solved_values();i++) {
+			for (j=0;j<number_parameters;j++) record_data[j][i]=bias_sweep->get_record_value(j,i);
+		}
 	}
+	client_window->ForEach(UpdateValidEnvironPlot);
+
+	sprintf(sweep_string,"Points Solved: %d\r\n",bias_sweep->get_solved_values());
+	status_window->Insert(sweep_string);
+	if (!error_handler.fail()) out_simulation_result();
+	delete bias_sweep;
+	bias_sweep=(TBiasSweep *)0;
+
 	if (record_flags.any_set()) data_valid=TRUE;
 	end_time=clock();
 	if (error_handler.fail())
@@ -383,6 +412,42 @@ void TVoltageMacro::execute(const char *filename)
     solving=FALSE;
 }
 
+/*
+	Called by the bias sweep for each solved point, in bias order and on the thread that runs
+	the macro, never on a sweep worker. Refreshes the plots and appends the point to the data
+	file as the point by point loop did. A data file that cannot be opened stops the sweep.
+*/
+void TVoltageMacro::point_solved(void *macro, int value_number)
+{
+	((TVoltageMacro *)macro)->write_point(value_number);
+}
+
+void TVoltageMacro::write_point(int value_number)
+{
+	int i,new_precision=4;
+	ofstream output_file;
+
+	client_window->ForEach(UpdateValidEnvironPlot);
+
+	output_file.open(data_filename,ios::out | ios::app);
+	if (output_file.fail()) {
+		current_context->error_handler.set_error(ERROR_FILE_NOT_OPEN,0,"",data_filename);
+		stop_solution=TRUE;
+		return;
+	}
+
+	output_file.setf(ios::scientific,ios::floatfield);
+	output_file.precision(new_precision);
+
+	for (i=0;i<number_parameters;i++) {
+		output_file << bias_sweep->get_record_value(i,value_number);
+		if (i<number_parameters-1) output_file << ",";
+	}
+	output_file << '\n';
+
+	output_file.close();
+}
+
 //****************************** class TMacroStorage *******************************************
 /*
 class TMacroStorage {
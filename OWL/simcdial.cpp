@@ -299,7 +299,7 @@ TDialogEnvironmentPreferences::TDialogEnvironmentPreferences(TWindow *parent, TR
     IdcMultiThread=new TCheckBox(this, IDC_MULTITHREAD);
     IdcPriority=new THSlider(this, IDC_PRIORITY);
 
-	environment_effects=(flag)environment.get_value(ENVIRONMENT,EFFECTS);
+	environment_effects=(flag)current_context->environment.get_value(ENVIRONMENT,EFFECTS);
 }
 
 void TDialogEnvironmentPreferences::SetupWindow(void)
@@ -362,7 +362,7 @@ void TDialogEnvironmentPreferences::CmOk(void)
 
         preferences.put_thread_priority(IdcPriority->GetPosition());
 
-		environment.put_value(ENVIRONMENT,EFFECTS,(prec)environment_effects);
+		current_context->environment.put_value(ENVIRONMENT,EFFECTS,(prec)environment_effects);
 	}
 
 	TDialog::CmOk();
@@ -387,6 +387,17 @@ protected:
 	TEdit *IdcInnerMode;
 	TEdit *IdcOuterOptical;
 	TEdit *IdcOuterThermal;
+	TEdit *IdcRefactorRatio;
+	TEdit *IdcLineSearch;
+	TEdit *IdcAndersonDepth;
+	TEdit *IdcTunnelQuadOrder;
+	TEdit *IdcTunnelQuadTol;
+	TEdit *IdcAssemblyNodes;
+	TEdit *IdcPartitionNodes;
+	TEdit *IdcPropertyNodes;
+	TCheckBox *IdcCoupledThermal;
+	TCheckBox *IdcCoupledPhotons;
+	TCheckBox *IdcFermiTable;
 
 	flag environment_effects;
 
@@ -430,12 +441,32 @@ TDialogSimulationPreferences::TDialogSimulationPreferences(TWindow *parent, TRes
 	IdcOuterOptical->SetValidator(new TRangeValidator(1,100));
 	IdcOuterThermal=new TEdit(this,IDC_OUTERTHERMAL);
 	IdcOuterThermal->SetValidator(new TRangeValidator(1,100));
-
-	environment_effects=(flag)environment.get_value(ENVIRONMENT,EFFECTS);
+	IdcRefactorRatio=new TEdit(this,IDC_REFACTORRATIO);
+	IdcRefactorRatio->SetValidator(new TScientificLowerValidator(0,INCLUSIVE));
+	IdcLineSearch=new TEdit(this,IDC_LINESEARCH);
+	IdcLineSearch->SetValidator(new TRangeValidator(0,100));
+	IdcAndersonDepth=new TEdit(this,IDC_ANDERSONDEPTH);
+	IdcAndersonDepth->SetValidator(new TRangeValidator(0,MAX_ANDERSON_DEPTH));
+	IdcTunnelQuadOrder=new TEdit(this,IDC_TUNNELQUADORDER);
+	IdcTunnelQuadOrder->SetValidator(new TRangeValidator(0,MAX_TUNNEL_QUAD_ORDER));
+	IdcTunnelQuadTol=new TEdit(this,IDC_TUNNELQUADTOL);
+	IdcTunnelQuadTol->SetValidator(new TScientificLowerValidator(0,INCLUSIVE));
+	IdcAssemblyNodes=new TEdit(this,IDC_ASSEMBLYNODES);
+	IdcAssemblyNodes->SetValidator(new TRangeValidator(0,1000000));
+	IdcPartitionNodes=new TEdit(this,IDC_PARTITIONNODES);
+	IdcPartitionNodes->SetValidator(new TRangeValidator(0,1000000));
+	IdcPropertyNodes=new TEdit(this,IDC_PROPERTYNODES);
+	IdcPropertyNodes->SetValidator(new TRangeValidator(0,1000000));
+	IdcCoupledThermal=new TCheckBox(this,IDC_COUPLEDTHERMAL);
+	IdcCoupledPhotons=new TCheckBox(this,IDC_COUPLEDPHOTONS);
+	IdcFermiTable=new TCheckBox(this,IDC_FERMITABLE);
+
+	environment_effects=(flag)current_context->environment.get_value(ENVIRONMENT,EFFECTS);
 }
 
 void TDialogSimulationPreferences::SetupWindow(void)
 {
+	TEnvironment& environment=current_context->environment;
 	char number_string[20];
 
 	TDialog::SetupWindow();
@@ -471,6 +502,26 @@ void TDialogSimulationPreferences::SetupWindow(void)
 	IdcOuterOptical->SetText(number_string);
 	sprintf(number_string,"%d",(int)environment.get_value(ENVIRONMENT,MAX_OUTER_THERM_ITER));
 	IdcOuterThermal->SetText(number_string);
+	sprintf(number_string,"%.3f",(float)environment.get_value(ENVIRONMENT,NEWTON_REFACTOR_RATIO));
+	IdcRefactorRatio->SetText(number_string);
+	sprintf(number_string,"%d",(int)environment.get_value(ENVIRONMENT,MAX_LINE_SEARCH_ITER));
+	IdcLineSearch->SetText(number_string);
+	sprintf(number_string,"%d",(int)environment.get_value(ENVIRONMENT,ANDERSON_DEPTH));
+	IdcAndersonDepth->SetText(number_string);
+	sprintf(number_string,"%d",(int)environment.get_value(ENVIRONMENT,TUNNEL_QUAD_ORDER));
+	IdcTunnelQuadOrder->SetText(number_string);
+	sprintf(number_string,"%.3e",(float)environment.get_value(ENVIRONMENT,TUNNEL_QUAD_TOLERANCE));
+	IdcTunnelQuadTol->SetText(number_string);
+	sprintf(number_string,"%ld",(long)environment.get_value(ENVIRONMENT,ASSEMBLY_MIN_NODES));
+	IdcAssemblyNodes->SetText(number_string);
+	sprintf(number_string,"%ld",(long)environment.get_value(ENVIRONMENT,PARTITION_MIN_NODES));
+	IdcPartitionNodes->SetText(number_string);
+	sprintf(number_string,"%ld",(long)environment.get_value(ENVIRONMENT,PROPERTY_MIN_NODES));
+	IdcPropertyNodes->SetText(number_string);
+
+	if (environment_effects & ENV_COUPLED_THERMAL) IdcCoupledThermal->Check();
+	if (environment_effects & ENV_COUPLED_PHOTONS) IdcCoupledPhotons->Check();
+	if (environment_effects & ENV_FERMI_TABLE) IdcFermiTable->Check();
 }
 
 DEFINE_RESPONSE_TABLE1(TDialogSimulationPreferences, TDialog)
@@ -479,13 +530,17 @@ END_RESPONSE_TABLE;
 
 void TDialogSimulationPreferences::CmOk(void)
 {
+	TEnvironment& environment=current_context->environment;
 	char number_string[20];
 
 	if (IdcClampValue->IsValid() && IdcMaxElectError->IsValid() &&
 		IdcMaxThermError->IsValid() && IdcMaxOpticError->IsValid() && IdcCoarseModeError->IsValid() &&
 		IdcFineModeError->IsValid() && IdcInnerElectrical->IsValid() && IdcInnerThermal->IsValid() &&
 		IdcInnerMode->IsValid() && IdcOuterOptical->IsValid() && IdcOuterThermal->IsValid() &&
-		IdcTempClampValue->IsValid() && IdcTempRelaxValue->IsValid()) {
+		IdcTempClampValue->IsValid() && IdcTempRelaxValue->IsValid() && IdcRefactorRatio->IsValid() &&
+		IdcLineSearch->IsValid() && IdcAndersonDepth->IsValid() && IdcTunnelQuadOrder->IsValid() &&
+		IdcTunnelQuadTol->IsValid() && IdcAssemblyNodes->IsValid() && IdcPartitionNodes->IsValid() &&
+		IdcPropertyNodes->IsValid()) {
 
 		if (IdcClampPot->GetCheck()==BF_CHECKED) environment_effects|=ENV_CLAMP_POTENTIAL;
 		else environment_effects&=(~ENV_CLAMP_POTENTIAL);
@@ -494,6 +549,12 @@ void TDialogSimulationPreferences::CmOk(void)
 
 		if (IdcClampTemp->GetCheck()==BF_CHECKED) environment_effects|=ENV_CLAMP_TEMPERATURE;
 		else environment_effects&=(~ENV_CLAMP_TEMPERATURE);
+		if (IdcCoupledThermal->GetCheck()==BF_CHECKED) environment_effects|=ENV_COUPLED_THERMAL;
+		else environment_effects&=(~ENV_COUPLED_THERMAL);
+		if (IdcCoupledPhotons->GetCheck()==BF_CHECKED) environment_effects|=ENV_COUPLED_PHOTONS;
+		else environment_effects&=(~ENV_COUPLED_PHOTONS);
+		if (IdcFermiTable->GetCheck()==BF_CHECKED) environment_effects|=ENV_FERMI_TABLE;
+		else environment_effects&=(~ENV_FERMI_TABLE);
 		IdcTempClampValue->GetText(number_string,sizeof(number_string));
 		environment.put_value(ENVIRONMENT,TEMP_CLAMP_VALUE,atof(number_string));
 
@@ -521,6 +582,22 @@ void TDialogSimulationPreferences::CmOk(void)
 		environment.put_value(ENVIRONMENT,MAX_OUTER_OPTIC_ITER,atof(number_string));
 		IdcOuterThermal->GetText(number_string,sizeof(number_string));
 		environment.put_value(ENVIRONMENT,MAX_OUTER_THERM_ITER,atof(number_string));
+		IdcRefactorRatio->GetText(number_string,sizeof(number_string));
+		environment.put_value(ENVIRONMENT,NEWTON_REFACTOR_RATIO,atof(number_string));
+		IdcLineSearch->GetText(number_string,sizeof(number_string));
+		environment.put_value(ENVIRONMENT,MAX_LINE_SEARCH_ITER,atof(number_string));
+		IdcAndersonDepth->GetText(number_string,sizeof(number_string));
+		environment.put_value(ENVIRONMENT,ANDERSON_DEPTH,atof(number_string));
+		IdcTunnelQuadOrder->GetText(number_string,sizeof(number_string));
+		environment.put_value(ENVIRONMENT,TUNNEL_QUAD_ORDER,atof(number_string));
+		IdcTunnelQuadTol->GetText(number_string,sizeof(number_string));
+		environment.put_value(ENVIRONMENT,TUNNEL_QUAD_TOLERANCE,atof(number_string));
+		IdcAssemblyNodes->GetText(number_string,sizeof(number_string));
+		environment.put_value(ENVIRONMENT,ASSEMBLY_MIN_NODES,atof(number_string));
+		IdcPartitionNodes->GetText(number_string,sizeof(number_string));
+		environment.put_value(ENVIRONMENT,PARTITION_MIN_NODES,atof(number_string));
+		IdcPropertyNodes->GetText(number_string,sizeof(number_string));
+		environment.put_value(ENVIRONMENT,PROPERTY_MIN_NODES,atof(number_string));
 
 		environment.put_value(ENVIRONMENT,EFFECTS,(prec)environment_effects);
 
@@ -611,6 +688,7 @@ protected:
 	TEdit *IdcStartValue;
 	TEdit *IdcEndValue;
 	TEdit *IdcIncrement;
+	TCheckBox *IdcAdaptiveStep;
 	TCheckBox *IdcLeftContact;
 	TCheckBox *IdcRightContact;
 	TCheckBox *IdcInitialState;
@@ -640,6 +718,7 @@ TDialogVoltageMacro::TDialogVoltageMacro(TWindow *parent, TResId resId,
 	IdcStartValue=new TEdit(this, IDC_STARTVALUE);
 	IdcEndValue=new TEdit(this, IDC_ENDVALUE);
 	IdcIncrement=new TEdit(this, IDC_INCREMENT);
+	IdcAdaptiveStep=new TCheckBox(this, IDC_ADAPTIVESTEP);
 	IdcLeftContact=new TCheckBox(this, IDC_LEFTCONTACT);
 	IdcRightContact=new TCheckBox(this, IDC_RIGHTCONTACT);
 	IdcInitialState=new TCheckBox(this, IDC_INITIALSTATE);
@@ -662,6 +741,7 @@ void TDialogVoltageMacro::SetupWindow(void)
 		IdcEndValue->SetText(number_string);
 		sprintf(number_string,"%.3f",macro->get_increment_value());
 		IdcIncrement->SetText(number_string);
+		if (macro->get_adaptive_step()) IdcAdaptiveStep->SetCheck(BF_CHECKED);
 
 		if (macro->get_increment_object_number()==0) IdcLeftContact->SetCheck(BF_CHECKED);
 		else IdcRightContact->SetCheck(BF_CHECKED);
@@ -716,6 +796,8 @@ void TDialogVoltageMacro::CmOk(void)
 
 			IdcIncrement->GetText(number_string,sizeof(number_string));
 			macro->put_increment_value(atof(number_string));
+			if (IdcAdaptiveStep->GetCheck()==BF_CHECKED) macro->put_adaptive_step(TRUE);
+			else macro->put_adaptive_step(FALSE);
 
 			if (IdcLeftContact->GetCheck()==BF_CHECKED) macro->put_increment_object_number(0);
 			else macro->put_increment_object_number(1);
@@ -793,6 +875,7 @@ TDialogDeviceInfo::TDialogDeviceInfo(TWindow *parent, TResId resId, TModule *mod
 
 void TDialogDeviceInfo::SetupWindow(void)
 {
+	TEnvironment& environment=current_context->environment;
 	char number_string[20];
 	string message_string;
 
@@ -914,6 +997,7 @@ END_RESPONSE_TABLE;
 
 void TDialogScale::CmOk(void)
 {
+	TErrorHandler& error_handler=current_context->error_handler;
 	char number_string[20];
 	logical y_min_valid, y_max_valid;
 	logical x_min_valid, x_max_valid;
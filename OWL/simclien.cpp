@@ -202,6 +202,7 @@ TSimWindowsMDIClient::~TSimWindowsMDIClient(void)
 #ifndef NDEBUG
 bool TSimWindowsMDIClient::IdleAction(long /*idleCount*/)
 {
+	TEnvironment& environment=current_context->environment;
 	if (enable_flag_check) {
     	assert(!environment.effects_change_flags_any_set());
         assert(!environment.update_flags_any_set());
@@ -223,11 +224,11 @@ void TSimWindowsMDIClient::SetupWindow(void)
 	TMDIClient::SetupWindow();
 	material_string=string(executable_path)+preferences.get_material_parameters_file();
 	strcpy(MaterialFileData.FileName,material_string.c_str());
-	material_parser=new TParseMaterial(MaterialFileData.FileName);
+	material_parser=new TParseMaterial(current_context,MaterialFileData.FileName);
 	material_parser->parse_material();
 	delete material_parser;
 
-	if (error_handler.fail()) out_error_message(TRUE);
+	if (current_context->error_handler.fail()) out_error_message(TRUE);
 	else {
 		if (number_params>=2) {
 			strcpy(DeviceFileData.FileName,command_ptr[1]);
@@ -249,7 +250,7 @@ void TSimWindowsMDIClient::OpenFile(const char *filename)
 
 	file_ptr=fopen(filename,"rb");
 	if (!file_ptr) {
-		error_handler.set_error(ERROR_FILE_NOT_OPEN,0,"",filename);
+		current_context->error_handler.set_error(ERROR_FILE_NOT_OPEN,0,"",filename);
 		out_error_message(TRUE);
 		return;
 	}
@@ -340,7 +341,7 @@ void TSimWindowsMDIClient::CreateSingleEnvironPlot(TValueFlag plot_flags, string
 
 	plot=new TMDIChild(*this,title.c_str(),
 					   new TSimWindowsEnvironPlot(0,x_flag_type, x_flag, plot_flags,y_label.c_str(),multi_colored));
-	if (!error_handler.fail()) {
+	if (!current_context->error_handler.fail()) {
 		plot->SetIcon(GetApplication(),IDI_PLOT);
 		plot->Create();
 	}
@@ -455,7 +456,7 @@ void TSimWindowsMDIClient::EvMDIDestroy(HWND hWnd)
 {
 	if (status_window) {
 		if (hWnd==status_window->Parent->HWindow) {
-			environment.delete_device();
+			current_context->environment.delete_device();
 			ForEach(UpdateValidEnvironPlot);
 			status_window=(TSimWindowsDeviceStatus *)0;
 		}
@@ -471,7 +472,7 @@ void TSimWindowsMDIClient::CmMacroMenuEnabler(TCommandEnabler& commandHandler)
 
 void TSimWindowsMDIClient::CmDeviceStartEnabler(TCommandEnabler& commandHandler)
 {
-	commandHandler.Enable(environment.device() &&
+	commandHandler.Enable(current_context->environment.device() &&
     					  simulate_thread.GetStatus()!=TThread::Running &&
                           macro_thread.GetStatus()!=TThread::Running);
 }
@@ -484,7 +485,7 @@ void TSimWindowsMDIClient::CmDeviceStopEnabler(TCommandEnabler& commandHandler)
 
 void TSimWindowsMDIClient::CmDeviceExecuteMacroEnabler(TCommandEnabler& commandHandler)
 {
-	commandHandler.Enable(environment.device() && macro_storage.get_number_macros() &&
+	commandHandler.Enable(current_context->environment.device() && macro_storage.get_number_macros() &&
     					  simulate_thread.GetStatus()!=TThread::Running &&
                           macro_thread.GetStatus()!=TThread::Running);
 }
@@ -521,7 +522,7 @@ void TSimWindowsMDIClient::CmEnvironmentReset(void)
 {
 
 	if (MessageBox("Reset Environment?","Environment", MB_ICONQUESTION | MB_OKCANCEL)==IDOK) {
-		environment.init_environment();
+		current_context->environment.init_environment();
 		ForEach(UpdateValidEnvironPlot);
 	}
 
@@ -529,6 +530,7 @@ void TSimWindowsMDIClient::CmEnvironmentReset(void)
 
 void TSimWindowsMDIClient::CmEnvironmentTemperature(void)
 {
+	TEnvironment& environment=current_context->environment;
 	char string[20];
 	float temperature;
     bool accept_values;
@@ -565,6 +567,7 @@ void TSimWindowsMDIClient::CmEnvironmentTemperature(void)
 
 void TSimWindowsMDIClient::CmEnvironmentRadius(void)
 {
+	TEnvironment& environment=current_context->environment;
 	char string[20];
 	float device_radius,radius;
     bool accept_values;
@@ -606,7 +609,7 @@ void TSimWindowsMDIClient::CmEnvironmentOptical(void)
 {
 	if (TDialogOpticalInput(this,DG_OPTICALINPUT).Execute()==IDOK) {
 		::SetCursor(TCursor(NULL,IDC_WAIT));
-		if (environment.process_recompute_flags()) ForEach(UpdateValidEnvironPlot);
+		if (current_context->environment.process_recompute_flags()) ForEach(UpdateValidEnvironPlot);
 		::SetCursor(TCursor(NULL,IDC_ARROW));
 	}
 }
@@ -616,13 +619,13 @@ void TSimWindowsMDIClient::CmEnvironmentLoadMaterial(void)
 	TParseMaterial *material_parser;
 
 	if (TFileOpenDialog(this, MaterialFileData).Execute()==IDOK) {
-		material_parser=new TParseMaterial(MaterialFileData.FileName);
-		if (!error_handler.fail()) {
-			material_parameters.clear();
+		material_parser=new TParseMaterial(current_context,MaterialFileData.FileName);
+		if (!current_context->error_handler.fail()) {
+			current_context->material_parameters.clear();
 			material_parser->parse_material();
 		}
-		if (error_handler.fail()) {
-			material_parameters.clear();
+		if (current_context->error_handler.fail()) {
+			current_context->material_parameters.clear();
 			out_error_message(TRUE);
 		}
 		delete material_parser;
@@ -678,7 +681,7 @@ void TSimWindowsMDIClient::CmDeviceReset(void)
 {
 	if (MessageBox("Reset Device?","Device", MB_ICONQUESTION | MB_OKCANCEL)==IDOK) {
 		::SetCursor(TCursor(NULL,IDC_WAIT));
-		environment.init_device();
+		current_context->environment.init_device();
 		ForEach(UpdateValidEnvironPlot);
 		status_window->Clear();
 		status_window->Insert("Device Reset\r\n\r\n");
@@ -690,7 +693,7 @@ void TSimWindowsMDIClient::CmDeviceContacts(void)
 {
 	if (TDialogDeviceContacts(this,DG_CONTACT).Execute()==IDOK) {
 		::SetCursor(TCursor(NULL,IDC_WAIT));
-		if (environment.process_recompute_flags()) ForEach(UpdateValidEnvironPlot);
+		if (current_context->environment.process_recompute_flags()) ForEach(UpdateValidEnvironPlot);
 		::SetCursor(TCursor(NULL,IDC_ARROW));
 	}
 }
@@ -699,7 +702,7 @@ void TSimWindowsMDIClient::CmDeviceSurfaces(void)
 {
 	if (TDialogDeviceSurfaces(this,DG_SURFACE).Execute()==IDOK) {
 		::SetCursor(TCursor(NULL,IDC_WAIT));
-		if (environment.process_recompute_flags()) ForEach(UpdateValidEnvironPlot);
+		if (current_context->environment.process_recompute_flags()) ForEach(UpdateValidEnvironPlot);
 		::SetCursor(TCursor(NULL,IDC_ARROW));
 	}
 }
@@ -708,7 +711,7 @@ void TSimWindowsMDIClient::CmDeviceElectricalModels(void)
 {
 	if (TDialogElectricalModels(this,DG_ELECTRICALMODELS).Execute()==IDOK) {
 		::SetCursor(TCursor(NULL,IDC_WAIT));
-		if (environment.process_recompute_flags()) ForEach(UpdateValidEnvironPlot);
+		if (current_context->environment.process_recompute_flags()) ForEach(UpdateValidEnvironPlot);
 		::SetCursor(TCursor(NULL,IDC_ARROW));
 	}
 }
@@ -717,7 +720,7 @@ void TSimWindowsMDIClient::CmDeviceThermalModels(void)
 {
 	if (TDialogThermalModels(this,DG_THERMALMODELS).Execute()==IDOK) {
 		::SetCursor(TCursor(NULL,IDC_WAIT));
-		if (environment.process_recompute_flags()) ForEach(UpdateValidEnvironPlot);
+		if (current_context->environment.process_recompute_flags()) ForEach(UpdateValidEnvironPlot);
 		::SetCursor(TCursor(NULL,IDC_ARROW));
 	}
 }
@@ -726,7 +729,7 @@ void TSimWindowsMDIClient::CmDeviceLaserParameters(void)
 {
 	if (TDialogLaser(this,DG_LASER).Execute()==IDOK) {
 		::SetCursor(TCursor(NULL,IDC_WAIT));
-		if (environment.process_recompute_flags()) ForEach(UpdateValidEnvironPlot);
+		if (current_context->environment.process_recompute_flags()) ForEach(UpdateValidEnvironPlot);
 		::SetCursor(TCursor(NULL,IDC_ARROW));
 	}
 }
@@ -765,7 +768,7 @@ void TSimWindowsMDIClient::CmDeviceStop(void)
 
     solving_macro=macro_storage.get_solving_macro();
     if (solving_macro) solving_macro->set_stop_solution(TRUE);
-	environment.set_stop_solution(TRUE);
+	current_context->environment.set_stop_solution(TRUE);
 }
 
 void TSimWindowsMDIClient::CmDeviceExecuteMacro(void)
@@ -914,7 +917,7 @@ void TSimWindowsMDIClient::CmPlotBandDiagram(void)
 	::SetCursor(TCursor(NULL,IDC_WAIT));
 	plot=new TMDIChild(*this,"Band Diagram",
 					   new TSimWindowsBandDiagram(0,plot_flags,"Energy (eV)",TRUE));
-	if (!error_handler.fail()) {
+	if (!current_context->error_handler.fail()) {
 		plot->SetIcon(GetApplication(),IDI_PLOT);
 		plot->Create();
 	}
@@ -1021,6 +1024,7 @@ void TSimWindowsMDIClient::CmPlotPhotonDensity(void)
 
 void TSimWindowsMDIClient::CmPlotSelected(void)
 {
+	TEnvironment& environment=current_context->environment;
 	TValueFlag plot_flags;
 	TValueFlag selected_flags;
 
@@ -1060,7 +1064,7 @@ void TSimWindowsMDIClient::CmPlotSelected(void)
 			::SetCursor(TCursor(NULL,IDC_WAIT));
 			CreateMultipleEnvironPlot(selected_flags);
 			::SetCursor(TCursor(NULL,IDC_ARROW));
-			if (error_handler.fail()) out_error_message(TRUE);
+			if (current_context->error_handler.fail()) out_error_message(TRUE);
 		}
 	}
 }
@@ -1097,7 +1101,7 @@ void TSimWindowsMDIClient::CmPlotMacro(void)
 														x_flag_type, x_flag_value, x_object_number,
 														y_flag_type,y_flag_value,y_label.c_str(),TRUE));
 			::SetCursor(TCursor(NULL,IDC_ARROW));
-			if (!error_handler.fail()) {
+			if (!current_context->error_handler.fail()) {
 				plot->SetIcon(GetApplication(),IDI_PLOT);
 				plot->Create();
 			}
@@ -1115,9 +1119,9 @@ void TSimWindowsMDIClient::CmDataRead(void)
 
 	if ((new TFileOpenDialog(this, FileData))->Execute() == IDOK) {
 		::SetCursor(TCursor(NULL,IDC_WAIT));
-		environment.read_data_file(FileData.FileName);
-		if (environment.process_recompute_flags()) ForEach(UpdateValidEnvironPlot);
-		if (error_handler.fail()) out_error_message(TRUE);
+		current_context->environment.read_data_file(FileData.FileName);
+		if (current_context->environment.process_recompute_flags()) ForEach(UpdateValidEnvironPlot);
+		if (current_context->error_handler.fail()) out_error_message(TRUE);
 		::SetCursor(TCursor(NULL,IDC_ARROW));
 	}
 }
@@ -1132,9 +1136,9 @@ void TSimWindowsMDIClient::CmDataWriteDevice(void)
 	if ((new TFileSaveDialog(this, FileData))->Execute() == IDOK) {
 		write_flags.set_write_combo(COMBO_STRUCTURE);
 		::SetCursor(TCursor(NULL,IDC_WAIT));
-		environment.write_data_file(FileData.FileName,write_flags);
+		current_context->environment.write_data_file(FileData.FileName,write_flags);
 		::SetCursor(TCursor(NULL,IDC_ARROW));
-		if (error_handler.fail()) out_error_message(TRUE);
+		if (current_context->error_handler.fail()) out_error_message(TRUE);
 	}
 }
 
@@ -1148,14 +1152,15 @@ void TSimWindowsMDIClient::CmDataWriteMaterial(void)
 	if ((new TFileSaveDialog(this, FileData))->Execute() == IDOK) {
 		write_flags.set_write_combo(COMBO_MATERIAL);
 		::SetCursor(TCursor(NULL,IDC_WAIT));
-		environment.write_data_file(FileData.FileName,write_flags);
+		current_context->environment.write_data_file(FileData.FileName,write_flags);
 		::SetCursor(TCursor(NULL,IDC_ARROW));
-		if (error_handler.fail()) out_error_message(TRUE);
+		if (current_context->error_handler.fail()) out_error_message(TRUE);
 	}
 }
 
 void TSimWindowsMDIClient::CmDataWriteSelected(void)
 {
+	TEnvironment& environment=current_context->environment;
 	TValueFlag write_flags;
 	static TValueFlag selected_flags;
 	static TOpenSaveDialog::TData FileData(OFN_HIDEREADONLY|OFN_PATHMUSTEXIST|OFN_OVERWRITEPROMPT,
@@ -1237,7 +1242,7 @@ void TSimWindowsMDIClient::CmDataWriteSelected(void)
 				::SetCursor(TCursor(NULL,IDC_WAIT));
 				environment.write_data_file(FileData.FileName,selected_flags);
 				::SetCursor(TCursor(NULL,IDC_ARROW));
-				if (error_handler.fail()) out_error_message(TRUE);
+				if (current_context->error_handler.fail()) out_error_message(TRUE);
 			}
 		}
 	}
@@ -117,8 +117,8 @@ TDialogOpticalInput::TDialogOpticalInput(TWindow *parent, TResId resId, TModule
 	IdcSpectrumMultiplier=new TEdit(this, IDC_SPECTRUMMULTIPLIER);
 	IdcSpectrumMultiplier->SetValidator(new TScientificLowerValidator(0,INCLUSIVE));
 
-	environment_effects=(flag)environment.get_value(ENVIRONMENT,EFFECTS);
-	number_components=environment.get_number_objects(SPECTRUM);
+	environment_effects=(flag)current_context->environment.get_value(ENVIRONMENT,EFFECTS);
+	number_components=current_context->environment.get_number_objects(SPECTRUM);
 
 	calc_wavelength=TRUE;
 	light_entered=FALSE;
@@ -130,6 +130,7 @@ TDialogOpticalInput::TDialogOpticalInput(TWindow *parent, TResId resId, TModule
 
 void TDialogOpticalInput::SetupWindow(void)
 {
+	TEnvironment& environment=current_context->environment;
 	char number_string[20];
 
 	TDialog::SetupWindow();
@@ -201,6 +202,7 @@ END_RESPONSE_TABLE;
 
 void TDialogOpticalInput::CmOk(void)
 {
+	TEnvironment& environment=current_context->environment;
 	char number_string[20];
 	float light_energy, light_intensity;
     bool accept_values;
@@ -266,7 +268,7 @@ void TDialogOpticalInput::CmOk(void)
 						default: environment.delete_spectrum(); environment.add_spectral_comp(); break;
 					}
 
-					if (!error_handler.fail()) {
+					if (!current_context->error_handler.fail()) {
 						if (IdcCheckEnergy->GetCheck()==BF_CHECKED) {
 							energy_selected=TRUE;
 							environment.put_value(SPECTRUM,INCIDENT_PHOTON_ENERGY,light_energy,0);
@@ -301,7 +303,7 @@ void TDialogOpticalInput::CmOk(void)
 			environment.put_value(ENVIRONMENT,EFFECTS,(prec)environment_effects);
 		}
 
-		if (!error_handler.fail()) TDialog::CmOk();
+		if (!current_context->error_handler.fail()) TDialog::CmOk();
 		else out_error_message(TRUE);
     }
 
@@ -369,7 +371,8 @@ void TDialogOpticalInput::EvEnergy(void)
 	char number_string[20];
 
 	if ((number_components==1) && (calc_wavelength)) {
-		sprintf(number_string,"%.3f",(float)environment.get_value(SPECTRUM,INCIDENT_PHOTON_ENERGY,0));
+		sprintf(number_string,"%.3f",
+				(float)current_context->environment.get_value(SPECTRUM,INCIDENT_PHOTON_ENERGY,0));
 		IdcEditEnergy->SetText(number_string);
 	}
 }
@@ -379,7 +382,8 @@ void TDialogOpticalInput::EvWavelength(void)
 	char number_string[20];
 
 	if ((number_components==1) && (calc_wavelength)) {
-		sprintf(number_string,"%.3f",(float)environment.get_value(SPECTRUM,INCIDENT_PHOTON_WAVELENGTH,0));
+		sprintf(number_string,"%.3f",
+				(float)current_context->environment.get_value(SPECTRUM,INCIDENT_PHOTON_WAVELENGTH,0));
 		IdcEditEnergy->SetText(number_string);
 	}
 }
@@ -437,8 +441,8 @@ protected:
 TDialogDeviceContacts::TDialogDeviceContacts(TWindow *parent, TResId resId,TModule *module)
 	: TDialog(parent,resId,module)
 {
-	left_contact_effects=(flag)environment.get_value(CONTACT,EFFECTS,0);
-	right_contact_effects=(flag)environment.get_value(CONTACT,EFFECTS,1);
+	left_contact_effects=(flag)current_context->environment.get_value(CONTACT,EFFECTS,0);
+	right_contact_effects=(flag)current_context->environment.get_value(CONTACT,EFFECTS,1);
 
 	IdcLPosition=new TStatic(this, IDC_LPOSITION);
 	IdcLBias=new TEdit(this, IDC_LBIAS);
@@ -469,6 +473,7 @@ TDialogDeviceContacts::TDialogDeviceContacts(TWindow *parent, TResId resId,TModu
 
 void TDialogDeviceContacts::SetupWindow(void)
 {
+	TEnvironment& environment=current_context->environment;
 	char number_string[20];
 
 	TDialog::SetupWindow();
@@ -508,6 +513,7 @@ END_RESPONSE_TABLE;
 
 void TDialogDeviceContacts::CmOk(void)
 {
+	TEnvironment& environment=current_context->environment;
 	char number_string[20];
     bool accept_values;
 
@@ -606,8 +612,8 @@ protected:
 TDialogDeviceSurfaces::TDialogDeviceSurfaces(TWindow *parent, TResId resId, TModule *module)
 	: TDialog(parent,resId,module)
 {
-	left_surface_effects=(flag)environment.get_value(SURFACE,EFFECTS,0);
-	right_surface_effects=(flag)environment.get_value(SURFACE,EFFECTS,1);
+	left_surface_effects=(flag)current_context->environment.get_value(SURFACE,EFFECTS,0);
+	right_surface_effects=(flag)current_context->environment.get_value(SURFACE,EFFECTS,1);
 
 	IdcLSurfacePosition=new TStatic(this, IDC_LSURFACEPOSITION);
 	IdcLTemp=new TEdit(this, IDC_LTEMPERATURE);
@@ -636,6 +642,7 @@ TDialogDeviceSurfaces::TDialogDeviceSurfaces(TWindow *parent, TResId resId, TMod
 
 void TDialogDeviceSurfaces::SetupWindow(void)
 {
+	TEnvironment& environment=current_context->environment;
 	char number_string[20];
 
 	TDialog::SetupWindow();
@@ -675,6 +682,7 @@ END_RESPONSE_TABLE;
 
 void TDialogDeviceSurfaces::CmOk(void)
 {
+	TEnvironment& environment=current_context->environment;
 	char number_string[20];
     bool accept_values;
 
@@ -771,6 +779,7 @@ protected:
 TDialogElectricalModels::TDialogElectricalModels(TWindow *parent, TResId resId, TModule *module)
 	: TDialog(parent,resId,module)
 {
+	TEnvironment& environment=current_context->environment;
 	grid_effects=(flag)environment.get_value(GRID_ELECTRICAL,EFFECTS);
 	device_effects=(flag)environment.get_value(DEVICE,EFFECTS);
 	environment_effects=(flag)environment.get_value(ENVIRONMENT,EFFECTS);
@@ -851,6 +860,7 @@ END_RESPONSE_TABLE;
 
 void TDialogElectricalModels::CmOk(void)
 {
+	TEnvironment& environment=current_context->environment;
     bool accept_values;
 
     TMacro *solving_macro=macro_storage.get_solving_macro();
@@ -954,8 +964,8 @@ protected:
 TDialogThermalModels::TDialogThermalModels(TWindow *parent, TResId resId, TModule *module)
 	: TDialog(parent,resId,module)
 {
-	grid_effects=(flag)environment.get_value(GRID_ELECTRICAL,EFFECTS);
-	device_effects=(flag)environment.get_value(DEVICE,EFFECTS);
+	grid_effects=(flag)current_context->environment.get_value(GRID_ELECTRICAL,EFFECTS);
+	device_effects=(flag)current_context->environment.get_value(DEVICE,EFFECTS);
 
 	IdcIsothermal=new TCheckBox(this, IDC_ISOTHERMAL);
 	IdcSingleTemp=new TCheckBox(this, IDC_SINGLETEMP);
@@ -1020,6 +1030,7 @@ END_RESPONSE_TABLE;
 
 void TDialogThermalModels::CmOk(void)
 {
+	TEnvironment& environment=current_context->environment;
     bool accept_values;
 
     TMacro *solving_macro=macro_storage.get_solving_macro();
@@ -1178,12 +1189,13 @@ TDialogLaser::TDialogLaser(TWindow *parent, TResId resId, TModule *module)
 	IdcPhotonLifetime=new TStatic(this, IDC_PHOTONLIFETIME);
 	IdcPhotonNumber=new TStatic(this, IDC_PHOTONNUMBER);
 
-	mode_effects=environment.get_value(MODE,EFFECTS);
+	mode_effects=current_context->environment.get_value(MODE,EFFECTS);
 	load_mode=FALSE;
 }
 
 void TDialogLaser::SetupWindow(void)
 {
+	TEnvironment& environment=current_context->environment;
 	char number_string[20];
 
 	TDialog::SetupWindow();
@@ -1235,6 +1247,7 @@ END_RESPONSE_TABLE;
 
 void TDialogLaser::CmOk(void)
 {
+	TEnvironment& environment=current_context->environment;
 	char number_string[20];
     bool accept_values;
 
@@ -1288,7 +1301,7 @@ void TDialogLaser::CmOk(void)
 
 			environment.put_value(MODE,EFFECTS,mode_effects);
 
-			if (!error_handler.fail()) TDialog::CmOk();
+			if (!current_context->error_handler.fail()) TDialog::CmOk();
 			else out_error_message(TRUE);
 		}
 		else TDialog::CmOk();
@@ -1439,6 +1452,7 @@ TDialogDataWriteAll::TDialogDataWriteAll(TWindow *parent, TResId resId, TModule
 
 void TDialogDataWriteAll::SetupWindow(void)
 {
+	TEnvironment& environment=current_context->environment;
 	TDialog::SetupWindow();
 
 	if (environment.device()) {
@@ -1473,7 +1487,7 @@ void TDialogDataWriteAll::CmOk(void)
 			write_flags.set(FREE_ELECTRON,FREE_ELECTRON_WRITE);
 			write_flags.set(FREE_HOLE,FREE_HOLE_WRITE);
 
-			if (environment.get_number_objects(QUANTUM_WELL)) {
+			if (current_context->environment.get_number_objects(QUANTUM_WELL)) {
 				write_flags.set(BOUND_ELECTRON,BOUND_ELECTRON_WRITE);
 				write_flags.set(BOUND_HOLE,BOUND_HOLE_WRITE);
 			}
@@ -1506,9 +1520,9 @@ void TDialogDataWriteAll::CmOk(void)
 		if (IdcEnvDep->GetCheck()==BF_CHECKED) write_flags.set(ENVIRONMENT,ENVIRONMENT_WRITE);
 
 		::SetCursor(TCursor(NULL,IDC_WAIT));
-		environment.write_data_file(FileData.FileName,write_flags);
+		current_context->environment.write_data_file(FileData.FileName,write_flags);
 		::SetCursor(TCursor(NULL,IDC_ARROW));
-		if (error_handler.fail()) out_error_message(TRUE);
+		if (current_context->error_handler.fail()) out_error_message(TRUE);
 
 		TDialog::CmOk();
 	}
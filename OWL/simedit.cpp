@@ -363,7 +363,7 @@ bool TSimWindowsDeviceStatus::CanClear(void)
     						GetApplication()->GetName(), MB_YESNO|MB_ICONQUESTION);
 		if (result==IDYES) {
         	if (solving_macro) solving_macro->set_stop_solution(TRUE);
-        	environment.set_stop_solution(TRUE);
+        	current_context->environment.set_stop_solution(TRUE);
         }
         else
         	return FALSE;
@@ -435,9 +435,9 @@ bool TSimWindowsDeviceStatus::Read(const char far* fileName)
 		else return FALSE;
 
 	::SetCursor(TCursor(NULL,IDC_WAIT));
-	environment.load_file(fileName);
+	current_context->environment.load_file(fileName);
 	::SetCursor(TCursor(NULL,IDC_ARROW));
-	return(!error_handler.fail());
+	return(!current_context->error_handler.fail());
 }
 
 bool TSimWindowsDeviceStatus::Write(const char far* fileName)
@@ -447,9 +447,9 @@ bool TSimWindowsDeviceStatus::Write(const char far* fileName)
 		else return FALSE;
 
 	::SetCursor(TCursor(NULL,IDC_WAIT));
-	environment.write_state_file(fileName);
+	current_context->environment.write_state_file(fileName);
 	::SetCursor(TCursor(NULL,IDC_ARROW));
-	return(!error_handler.fail());
+	return(!current_context->error_handler.fail());
 }
 
 DEFINE_RESPONSE_TABLE1(TSimWindowsDeviceStatus,TPrintEditFile)
@@ -474,7 +474,7 @@ END_RESPONSE_TABLE;
 void TSimWindowsDeviceStatus::CmEditUndoEnabler(TCommandEnabler& commandHandler)
 {
 	commandHandler.SetText("&Undo Simulation\tCtrl+Z");
-	commandHandler.Enable(environment.canundo());
+	commandHandler.Enable(current_context->environment.canundo());
 }
 
 void TSimWindowsDeviceStatus::CmEditUndo(void)
@@ -482,12 +482,12 @@ void TSimWindowsDeviceStatus::CmEditUndo(void)
 	TMDIClient *client_window;
 
 	::SetCursor(TCursor(NULL,IDC_WAIT));
-	environment.undo();
+	current_context->environment.undo();
 	client_window=dynamic_cast<TMDIClient *>(GetApplication()->GetMainWindow()->GetClientWindow());
 	client_window->ForEach(UpdateValidEnvironPlot);
 	::SetCursor(TCursor(NULL,IDC_ARROW));
 
-	if (error_handler.fail()) out_error_message(TRUE);
+	if (current_context->error_handler.fail()) out_error_message(TRUE);
 	else Insert("Simulation Successfully Restored\r\n\r\n");
 }
 
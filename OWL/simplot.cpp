@@ -314,7 +314,7 @@ void TPlotPrintout::allocate_coordinates(void)
 		if (x_coord) delete[] x_coord;
 		if (y_coord) delete[] y_coord;
 		if (y_skip) delete[] y_skip;
-		error_handler.set_error(ERROR_MEM_PLOT,0,"","");
+		current_context->error_handler.set_error(ERROR_MEM_PLOT,0,"","");
 		return;
 	}
 
@@ -324,7 +324,7 @@ void TPlotPrintout::allocate_coordinates(void)
 		if (!y_coord[plot_count] || !y_skip[plot_count]) {
 			for (i=0;i<plot_count;i++) if (!y_coord[i]) delete[] y_coord[i];
 			for (i=0;i<plot_count;i++) if (!y_skip[i]) delete[] y_skip[i];
-			error_handler.set_error(ERROR_MEM_PLOT,0,"","");
+			current_context->error_handler.set_error(ERROR_MEM_PLOT,0,"","");
 			return;
 		}
 	}
@@ -617,7 +617,7 @@ void TSimWindowsPlot::allocate_coordinates(int new_number_plots, int new_data_po
 			if (y_skip) delete[] y_skip;
 			if (trace_labels) delete[] trace_labels;
 			if (trace_values) delete[] trace_values;
-			error_handler.set_error(ERROR_MEM_PLOT,0,"","");
+			current_context->error_handler.set_error(ERROR_MEM_PLOT,0,"","");
 			return;
 		}
 
@@ -630,7 +630,7 @@ void TSimWindowsPlot::allocate_coordinates(int new_number_plots, int new_data_po
 				for (i=0;i<plot_count;i++) if (!y_coord[i]) delete[] y_coord[i];
 				for (i=0;i<plot_count;i++) if (!y_skip[i]) delete[] y_skip[i];
 				delete[] x_coord;
-				error_handler.set_error(ERROR_MEM_PLOT,0,"","");
+				current_context->error_handler.set_error(ERROR_MEM_PLOT,0,"","");
 				return;
 			}
 		}
@@ -863,7 +863,7 @@ void TSimWindowsPlot::write_data_file(float ref_value)
 	ofstream output_file(FileData.FileName);
 
 	if (!output_file) {
-		error_handler.set_error(ERROR_FILE_NOT_OPEN,0,"",FileData.FileName);
+		current_context->error_handler.set_error(ERROR_FILE_NOT_OPEN,0,"",FileData.FileName);
 		return;
 	}
 
@@ -1316,6 +1316,7 @@ public:
 
 void TSimWindowsEnvironPlot::update_data(void)
 {
+	TEnvironment& environment=current_context->environment;
 
 	float *x_data_ptr, *y_data_ptr;
 	int i,j,flag_type,plot_count;
@@ -1329,7 +1330,7 @@ void TSimWindowsEnvironPlot::update_data(void)
 		new_number_plots+=y_flags.count((FlagType)flag_type);
 
 	allocate_coordinates(new_number_plots, new_data_points);
-	if (error_handler.fail()) return;
+	if (current_context->error_handler.fail()) return;
 
 	x_data_ptr=x_data;
 
@@ -1401,7 +1402,7 @@ void TSimWindowsEnvironPlot::SaveAs(void)
 		::SetCursor(TCursor(NULL,IDC_WAIT));
 		write_data_file();
 		::SetCursor(TCursor(NULL,IDC_ARROW));
-		if (error_handler.fail()) out_error_message(TRUE);
+		if (current_context->error_handler.fail()) out_error_message(TRUE);
 		else modified=FALSE;
 	}
 }
@@ -1438,7 +1439,7 @@ void TSimWindowsBandDiagram::SaveAs(void)
 				}
 			}
 			write_data_file(reference_value);
-			if (error_handler.fail()) out_error_message(TRUE);
+			if (current_context->error_handler.fail()) out_error_message(TRUE);
 			else modified=FALSE;
 		}
 	}
@@ -1477,7 +1478,7 @@ TSimWindowsMacroPlot::TSimWindowsMacroPlot(TWindow* parent, int macro_number,
 	x_object_number=x_object;
 	y_flag_type=new_y_flag_type;
 	y_flag=new_y_flag;
-	x_label+=get_long_location_string(x_flag_type,x_object_number);
+	x_label+=get_long_location_string(current_context,x_flag_type,x_object_number);
 	macro=macro_storage.get_macro(macro_number);
 }
 
@@ -1522,7 +1523,7 @@ void TSimWindowsMacroPlot::update_data(void)
 	new_number_plots=record_flags.get_number_objects(y_flag_type);
 
 	allocate_coordinates(new_number_plots, new_data_points);
-	if (error_handler.fail()) return;
+	if (current_context->error_handler.fail()) return;
 
 	x_data_ptr=x_data;
 
@@ -1553,11 +1554,13 @@ void TSimWindowsMacroPlot::update_trace_labels(void)
 
 	record_flags=macro->get_record_flags();
 
-	trace_labels[0]=get_short_string(x_flag_type,x_flag)+get_short_location_string(x_flag_type,x_object_number);
+	trace_labels[0]=get_short_string(x_flag_type,x_flag)+
+					get_short_location_string(current_context,x_flag_type,x_object_number);
 
 	for (plot_count=1;plot_count<number_plots+1;plot_count++) {
 		trace_labels[plot_count]=get_short_string(y_flag_type,y_flag)+
-								 get_short_location_string(y_flag_type,record_flags.get_object(y_flag_type,plot_count-1));
+								 get_short_location_string(current_context,y_flag_type,
+														   record_flags.get_object(y_flag_type,plot_count-1));
 	}
 
 	trace_window.update_labels(trace_labels,number_plots+1);
@@ -1569,7 +1572,7 @@ void TSimWindowsMacroPlot::SaveAs(void)
 		::SetCursor(TCursor(NULL,IDC_WAIT));
 		write_data_file();
 		::SetCursor(TCursor(NULL,IDC_ARROW));
-		if (error_handler.fail()) out_error_message(TRUE);
+		if (current_context->error_handler.fail()) out_error_message(TRUE);
 		else modified=FALSE;
 	}
 }
@@ -45,12 +45,8 @@
 
 #include "strtable.h"
 
-TEnvironment environment;
-TMaterialStorage material_parameters;
-TErrorHandler error_handler;
 TMacroStorage macro_storage;
 TPreferences preferences;
-NormalizeConstants normalization;
 TSimulateThread simulate_thread;
 TMacroThread macro_thread;
 
@@ -240,14 +236,14 @@ void TSimWindows::CmEnvironmentPreferences(void)
         }
 
         SimWindowsFrame->Layout();
-        environment.process_recompute_flags();
+        current_context->environment.process_recompute_flags();
 	}
 }
 
 void TSimWindows::CmSimulationPreferences(void)
 {
 	if (TDialogSimulationPreferences(SimWindowsMDIClient,DG_SIMPREFERENCES).Execute()==IDOK) {
-		environment.process_recompute_flags();
+		current_context->environment.process_recompute_flags();
 	}
 }
 
@@ -273,10 +269,10 @@ void TSimulateThread::Solve(void)
 	status_window->Insert("Start Simulation\r\n");
 	out_operating_condition();
 	start_time=clock();
-	environment.solve();
+	current_context->environment.solve();
 	end_time=clock();
 	out_simulation_result();
-	if (error_handler.fail()) {
+	if (current_context->error_handler.fail()) {
 		sprintf(time_string,"Simulation Terminated - time = %.3f s\r\n\r\n",(end_time-start_time)/CLK_TCK);
 		status_window->Insert(time_string);
 		out_error_message(TRUE);
@@ -316,7 +312,7 @@ void TMacroThread::Execute(void)
 #endif
 	macro_storage.get_macro(MacroNumber)->execute(FileName);
     error_window->ForEach(UpdateValidMacroPlot);
-    if (error_handler.fail()) out_error_message(TRUE);
+    if (current_context->error_handler.fail()) out_error_message(TRUE);
 #ifndef NDEBUG
 	enable_flag_check=TRUE;
 #endif
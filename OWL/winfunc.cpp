@@ -95,6 +95,7 @@ void UpdateValidMacroPlot(TWindow *window, void*)
 
 void LoadPreferences(void)
 {
+	TEnvironment& environment=current_context->environment;
 	extern char executable_path[MAXPATH], ini_filename[];
 	flag env_effects;
 	char file_string[20];
@@ -127,12 +128,21 @@ void LoadPreferences(void)
 
 	if (profile.GetInt("ClampTemperature",0)!=0) env_effects|=ENV_CLAMP_TEMPERATURE;
 	else env_effects&=(~ENV_CLAMP_TEMPERATURE);
+	if (profile.GetInt("CoupledThermal",0)!=0) env_effects|=ENV_COUPLED_THERMAL;
+	else env_effects&=(~ENV_COUPLED_THERMAL);
+	if (profile.GetInt("CoupledPhotons",0)!=0) env_effects|=ENV_COUPLED_PHOTONS;
+	else env_effects&=(~ENV_COUPLED_PHOTONS);
+	if (profile.GetInt("FermiTable",0)!=0) env_effects|=ENV_FERMI_TABLE;
+	else env_effects&=(~ENV_FERMI_TABLE);
 	profile.GetString("TemperatureClampValue",number_string,sizeof(number_string),"6.000");
 	environment.put_value(ENVIRONMENT,TEMP_CLAMP_VALUE,atof(number_string));
 
 	profile.GetString("TemperatureRelaxValue",number_string,sizeof(number_string),"1.000");
 	environment.put_value(ENVIRONMENT,TEMP_RELAX_VALUE,atof(number_string));
 
+	profile.GetString("NewtonRefactorRatio",number_string,sizeof(number_string),"0.000");
+	environment.put_value(ENVIRONMENT,NEWTON_REFACTOR_RATIO,atof(number_string));
+
 	profile.GetString("MaxElectricalError",number_string,sizeof(number_string),"1e-8");
 	environment.put_value(ENVIRONMENT,MAX_ELECTRICAL_ERROR,atof(number_string));
 	profile.GetString("MaxThermalError",number_string,sizeof(number_string),"1e-8");
@@ -143,12 +153,20 @@ void LoadPreferences(void)
 	environment.put_value(ENVIRONMENT,COARSE_MODE_ERROR,atof(number_string));
 	profile.GetString("FineModeError",number_string,sizeof(number_string),"1e-4");
 	environment.put_value(ENVIRONMENT,FINE_MODE_ERROR,atof(number_string));
+	profile.GetString("TunnelQuadTolerance",number_string,sizeof(number_string),"0.0");
+	environment.put_value(ENVIRONMENT,TUNNEL_QUAD_TOLERANCE,atof(number_string));
 
 	environment.put_value(ENVIRONMENT,MAX_INNER_ELECT_ITER,profile.GetInt("MaxInnerElectricalIter",15));
 	environment.put_value(ENVIRONMENT,MAX_INNER_THERM_ITER,profile.GetInt("MaxInnerThermalIter",15));
 	environment.put_value(ENVIRONMENT,MAX_INNER_MODE_ITER,profile.GetInt("MaxInnerModeIter",15));
 	environment.put_value(ENVIRONMENT,MAX_OUTER_OPTIC_ITER,profile.GetInt("MaxOuterPhotonIter",15));
 	environment.put_value(ENVIRONMENT,MAX_OUTER_THERM_ITER,profile.GetInt("MaxOuterThermalIter",15));
+	environment.put_value(ENVIRONMENT,MAX_LINE_SEARCH_ITER,profile.GetInt("MaxLineSearchIter",0));
+	environment.put_value(ENVIRONMENT,ANDERSON_DEPTH,profile.GetInt("AndersonDepth",0));
+	environment.put_value(ENVIRONMENT,TUNNEL_QUAD_ORDER,profile.GetInt("TunnelQuadOrder",0));
+	environment.put_value(ENVIRONMENT,ASSEMBLY_MIN_NODES,profile.GetInt("AssemblyMinNodes",DEFAULT_ASSEMBLY_MIN_NODES));
+	environment.put_value(ENVIRONMENT,PARTITION_MIN_NODES,profile.GetInt("PartitionMinNodes",DEFAULT_PARTITION_MIN_NODES));
+	environment.put_value(ENVIRONMENT,PROPERTY_MIN_NODES,profile.GetInt("PropertyMinNodes",DEFAULT_PROPERTY_MIN_NODES));
 
 	environment.put_value(ENVIRONMENT,EFFECTS,env_effects);
 	environment.process_recompute_flags();
@@ -156,6 +174,7 @@ void LoadPreferences(void)
 
 void SavePreferences(void)
 {
+	TEnvironment& environment=current_context->environment;
 	extern char executable_path[MAXPATH], ini_filename[];
 	char number_string[20];
 	flag env_effects;
@@ -190,12 +209,21 @@ void SavePreferences(void)
 
 	if (env_effects & ENV_CLAMP_TEMPERATURE) profile.WriteInt("ClampTemperature",1);
 	else profile.WriteInt("ClampTemperature",0);
+	if (env_effects & ENV_COUPLED_THERMAL) profile.WriteInt("CoupledThermal",1);
+	else profile.WriteInt("CoupledThermal",0);
+	if (env_effects & ENV_COUPLED_PHOTONS) profile.WriteInt("CoupledPhotons",1);
+	else profile.WriteInt("CoupledPhotons",0);
+	if (env_effects & ENV_FERMI_TABLE) profile.WriteInt("FermiTable",1);
+	else profile.WriteInt("FermiTable",0);
 	sprintf(number_string,"%.3lf",environment.get_value(ENVIRONMENT,TEMP_CLAMP_VALUE));
 	profile.WriteString("TemperatureClampValue",number_string);
 
 	sprintf(number_string,"%.3lf",environment.get_value(ENVIRONMENT,TEMP_RELAX_VALUE));
 	profile.WriteString("TemperatureRelaxValue",number_string);
 
+	sprintf(number_string,"%.3lf",environment.get_value(ENVIRONMENT,NEWTON_REFACTOR_RATIO));
+	profile.WriteString("NewtonRefactorRatio",number_string);
+
 	sprintf(number_string,"%.3le",environment.get_value(ENVIRONMENT,MAX_ELECTRICAL_ERROR));
 	profile.WriteString("MaxElectricalError",number_string);
 	sprintf(number_string,"%.3le",environment.get_value(ENVIRONMENT,MAX_THERMAL_ERROR));
@@ -206,12 +234,20 @@ void SavePreferences(void)
 	profile.WriteString("CoarseModeError",number_string);
 	sprintf(number_string,"%.3le",environment.get_value(ENVIRONMENT,FINE_MODE_ERROR));
 	profile.WriteString("FineModeError",number_string);
+	sprintf(number_string,"%.3le",environment.get_value(ENVIRONMENT,TUNNEL_QUAD_TOLERANCE));
+	profile.WriteString("TunnelQuadTolerance",number_string);
 
 	profile.WriteInt("MaxInnerElectricalIter",(int)environment.get_value(ENVIRONMENT,MAX_INNER_ELECT_ITER));
 	profile.WriteInt("MaxInnerThermalIter",(int)environment.get_value(ENVIRONMENT,MAX_INNER_THERM_ITER));
 	profile.WriteInt("MaxInnerModeIter",(int)environment.get_value(ENVIRONMENT,MAX_INNER_MODE_ITER));
 	profile.WriteInt("MaxOuterPhotonIter",(int)environment.get_value(ENVIRONMENT,MAX_OUTER_OPTIC_ITER));
 	profile.WriteInt("MaxOuterThermalIter",(int)environment.get_value(ENVIRONMENT,MAX_OUTER_THERM_ITER));
+	profile.WriteInt("MaxLineSearchIter",(int)environment.get_value(ENVIRONMENT,MAX_LINE_SEARCH_ITER));
+	profile.WriteInt("AndersonDepth",(int)environment.get_value(ENVIRONMENT,ANDERSON_DEPTH));
+	profile.WriteInt("TunnelQuadOrder",(int)environment.get_value(ENVIRONMENT,TUNNEL_QUAD_ORDER));
+	profile.WriteInt("AssemblyMinNodes",(int)environment.get_value(ENVIRONMENT,ASSEMBLY_MIN_NODES));
+	profile.WriteInt("PartitionMinNodes",(int)environment.get_value(ENVIRONMENT,PARTITION_MIN_NODES));
+	profile.WriteInt("PropertyMinNodes",(int)environment.get_value(ENVIRONMENT,PROPERTY_MIN_NODES));
 }
 
 
@@ -52,6 +52,7 @@ extern logical enable_flag_check;
 
 void out_error_message(logical clear_error)
 {
+	TErrorHandler& error_handler=current_context->error_handler;
 	string error_string;
 
 	assert(error_window);
@@ -125,6 +126,38 @@ void out_therm_convergence(short iterations, prec error)
 	status_window->Insert(error_string);
 }
 
+void out_outer_therm_convergence(short iterations, prec error)
+{
+	char error_string[50];
+
+	assert(status_window);
+	assert(status_window->IsWindow());
+
+	if (status_window->GetNumLines()>200) {
+		status_window->Clear();
+		status_window->UpdateWindow();
+	}
+	status_window->Insert("Outer Thermal Convergence Values\r\n");
+	sprintf(error_string,"%d\tT = %.4le\r\n",iterations,error);
+	status_window->Insert(error_string);
+}
+
+void out_tunnel_evaluations(long evaluations)
+{
+	char evaluation_string[50];
+
+	assert(status_window);
+	assert(status_window->IsWindow());
+
+	if (status_window->GetNumLines()>200) {
+		status_window->Clear();
+		status_window->UpdateWindow();
+	}
+	status_window->Insert("Tunneling Transmission Evaluations\r\n");
+	sprintf(evaluation_string,"%ld\r\n",evaluations);
+	status_window->Insert(evaluation_string);
+}
+
 void out_coarse_mode_convergence(short iterations, prec error)
 {
 	char error_string[50];
@@ -163,6 +196,7 @@ void out_fine_mode_convergence(short iterations, prec error)
 
 void out_operating_condition(void)
 {
+	TEnvironment& environment=current_context->environment;
 
 	char output_string[75];
 
@@ -188,6 +222,7 @@ void out_simulation_result(void)
 {
 
 	string result_string;
+	TEnvironment& environment=current_context->environment;
 
 	assert(status_window);
 	assert(status_window->IsWindow());